@@ -736,6 +736,9 @@ public class GLSurfaceView_SDL extends SurfaceView implements SurfaceHolder.Call
             mRedSize = 5;
             mGreenSize = 6;
             mBlueSize = 5;
+            // Prefer a config with a stencil buffer, which is used for
+            // filling polygons, but accept one without.
+            mStencilSize = 8;
         }
     }
 
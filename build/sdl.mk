@@ -20,6 +20,8 @@ SDL_CPPFLAGS += -DENABLE_SDL
 ifeq ($(OPENGL),y)
 SDL_CPPFLAGS += -DENABLE_OPENGL
 ifneq ($(TARGET),ANDROID)
+# buffer objects are OpenGL 1.5, which is declared by glext.h
+SDL_CPPFLAGS += -DGL_GLEXT_PROTOTYPES
 SDL_LDLIBS += -lGL
 endif
 else # !OPENGL
@@ -49,9 +49,11 @@ TEST_NAMES = \
 	test_pressure \
 	test_task \
 	TestAngle TestUnits TestEarth TestSunEphemeris \
-	TestRadixTree TestGeoBounds \
-	TestLogger TestDriver \
-	TestWayPointFile TestThermalBase \
+	TestRadixTree TestGeoBounds TestGeoClip \
+	TestLogger TestDriver TestFLARMNet TestContestThread \
+	TestContestCandidates \
+	TestWayPointFile TestAirspaceParser TestTopologySnapshot \
+	TestThermalBase \
 	TestColorRamp \
 	test_replay_task
 
@@ -85,6 +87,17 @@ $(TARGET_BIN_DIR)/TestGeoBounds$(TARGET_EXEEXT): $(TEST_GEO_BOUNDS_OBJS) $(TEST_
 	@$(NQ)echo "  LINK    $@"
 	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
 
+TEST_GEO_CLIP_SOURCES = \
+	$(SRC)/Geo/GeoClip.cpp \
+	$(SRC)/Geo/DouglasPeucker.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestGeoClip.cpp
+TEST_GEO_CLIP_OBJS = $(call SRC_TO_OBJ,$(TEST_GEO_CLIP_SOURCES))
+TEST_GEO_CLIP_LDADD = $(MATH_LIBS)
+$(TARGET_BIN_DIR)/TestGeoClip$(TARGET_EXEEXT): $(TEST_GEO_CLIP_OBJS) $(TEST_GEO_CLIP_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
+
 TEST_UNITS_SOURCES = \
 	$(SRC)/Units.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -174,14 +187,22 @@ TEST_DRIVER_SOURCES = \
 	$(SRC)/Device/Port.cpp \
 	$(SRC)/Device/NullPort.cpp \
 	$(SRC)/Device/Driver.cpp \
+	$(SRC)/Device/Parser.cpp \
 	$(SRC)/Device/Driver/CAI302.cpp \
 	$(SRC)/Device/Driver/LX.cpp \
 	$(SRC)/Device/Driver/ILEC.cpp \
 	$(SRC)/NMEA/InputLine.cpp \
+	$(SRC)/FLARM/FlarmId.cpp \
+	$(SRC)/FLARM/State.cpp \
+	$(SRC)/FLARM/FlarmCalculations.cpp \
+	$(SRC)/ClimbAverageCalculator.cpp \
 	$(SRC)/Math/fixed.cpp \
 	$(SRC)/Math/Angle.cpp \
+	$(SRC)/Math/FastMath.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/Thread/Thread.cpp \
+	$(ENGINE_SRC_DIR)/Math/Earth.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/GeoPoint.cpp \
 	$(ENGINE_SRC_DIR)/Atmosphere/Pressure.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestDriver.cpp
@@ -193,11 +214,14 @@ $(TARGET_BIN_DIR)/TestDriver$(TARGET_EXEEXT): $(TEST_DRIVER_OBJS) $(TEST_DRIVER_
 TEST_WAY_POINT_FILE_SOURCES = \
 	$(SRC)/Units.cpp \
 	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
+	$(SRC)/OS/PathName.cpp \
 	$(SRC)/UtilsFile.cpp \
 	$(SRC)/Poco/RWLock.cpp \
 	$(SRC)/Thread/Debug.cpp \
 	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/WayPoint/WayPointFile.cpp \
+	$(SRC)/WayPoint/WayPointSnapshot.cpp \
 	$(SRC)/WayPoint/WayPointFileWinPilot.cpp \
 	$(SRC)/WayPoint/WayPointFileSeeYou.cpp \
 	$(SRC)/WayPoint/WayPointFileZander.cpp \
@@ -217,6 +241,87 @@ $(TARGET_BIN_DIR)/TestWayPointFile$(TARGET_EXEEXT): $(TEST_WAY_POINT_FILE_OBJS)
 	@$(NQ)echo "  LINK    $@"
 	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
 
+TEST_AIRSPACE_PARSER_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceSnapshot.cpp \
+	$(SRC)/Units.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
+	$(SRC)/OS/PathName.cpp \
+	$(SRC)/Thread/Debug.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/ParallelJob.cpp \
+	$(TEST_SRC_DIR)/FakeDialogs.cpp \
+	$(TEST_SRC_DIR)/FakeProgressGlue.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceParser.cpp
+TEST_AIRSPACE_PARSER_OBJS = $(call SRC_TO_OBJ,$(TEST_AIRSPACE_PARSER_SOURCES))
+TEST_AIRSPACE_PARSER_LDADD = \
+	$(ENGINE_LIBS) \
+	$(IO_LIBS) \
+	$(ZZIP_LIBS) \
+	$(MATH_LIBS) \
+	$(UTIL_LIBS)
+$(TARGET_BIN_DIR)/TestAirspaceParser$(TARGET_EXEEXT): $(TEST_AIRSPACE_PARSER_OBJS) $(TEST_AIRSPACE_PARSER_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
+
+TEST_FLARM_NET_SOURCES = \
+	$(SRC)/FLARM/FLARMNet.cpp \
+	$(SRC)/FLARM/FlarmId.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
+	$(SRC)/OS/PathName.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestFLARMNet.cpp
+TEST_FLARM_NET_OBJS = $(call SRC_TO_OBJ,$(TEST_FLARM_NET_SOURCES))
+TEST_FLARM_NET_LDADD = $(IO_LIBS) $(ZZIP_LIBS) $(UTIL_LIBS)
+$(TARGET_BIN_DIR)/TestFLARMNet$(TARGET_EXEEXT): $(TEST_FLARM_NET_OBJS) $(TEST_FLARM_NET_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
+
+TEST_TOPOLOGY_SNAPSHOT_SOURCES = \
+	$(SRC)/Topology/TopologySnapshot.cpp \
+	$(SRC)/Geo/DouglasPeucker.cpp \
+	$(SRC)/OS/FileMapping.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTopologySnapshot.cpp
+TEST_TOPOLOGY_SNAPSHOT_OBJS = $(call SRC_TO_OBJ,$(TEST_TOPOLOGY_SNAPSHOT_SOURCES))
+TEST_TOPOLOGY_SNAPSHOT_LDADD = \
+	$(MATH_LIBS) \
+	$(SHAPELIB_LIBS) \
+	$(ZZIP_LIBS)
+$(TARGET_BIN_DIR)/TestTopologySnapshot$(TARGET_EXEEXT): $(TEST_TOPOLOGY_SNAPSHOT_OBJS) $(TEST_TOPOLOGY_SNAPSHOT_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
+
+TEST_CONTEST_CANDIDATES_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestContestCandidates.cpp
+TEST_CONTEST_CANDIDATES_OBJS = $(call SRC_TO_OBJ,$(TEST_CONTEST_CANDIDATES_SOURCES))
+TEST_CONTEST_CANDIDATES_LDADD = $(ENGINE_CORE_LIBS) $(MATH_LIBS) $(UTIL_LIBS)
+$(TARGET_BIN_DIR)/TestContestCandidates$(TARGET_EXEEXT): $(TEST_CONTEST_CANDIDATES_OBJS) $(TEST_CONTEST_CANDIDATES_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
+
+TEST_CONTEST_THREAD_SOURCES = \
+	$(SRC)/ContestThread.cpp \
+	$(SRC)/Poco/RWLock.cpp \
+	$(SRC)/Thread/Debug.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/StoppableThread.cpp \
+	$(SRC)/Thread/WorkerThread.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestContestThread.cpp
+TEST_CONTEST_THREAD_OBJS = $(call SRC_TO_OBJ,$(TEST_CONTEST_THREAD_SOURCES))
+TEST_CONTEST_THREAD_LDADD = $(ENGINE_CORE_LIBS) $(MATH_LIBS) $(UTIL_LIBS)
+$(TARGET_BIN_DIR)/TestContestThread$(TARGET_EXEEXT): $(TEST_CONTEST_THREAD_OBJS) $(TEST_CONTEST_THREAD_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
+
 TEST_OLC_SOURCES = \
 	$(SRC)/Math/fixed.cpp \
 	$(SRC)/Math/Angle.cpp \
@@ -256,6 +361,7 @@ DEBUG_PROGRAM_NAMES = \
 	TestTrace \
 	TestOLC \
 	BenchmarkProjection \
+	BenchmarkSlopeShading \
 	DumpTextFile DumpTextZip WriteTextFile RunTextWriter \
 	ReadMO \
 	ReadProfileString ReadProfileInt \
@@ -289,6 +395,16 @@ $(TARGET_BIN_DIR)/BenchmarkProjection$(TARGET_EXEEXT): $(BENCHMARK_PROJECTION_OB
 	@$(NQ)echo "  LINK    $@"
 	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
 
+BENCHMARK_SLOPE_SHADING_SOURCES = \
+	$(SRC)/Terrain/SlopeShading.cpp \
+	$(TEST_SRC_DIR)/BenchmarkSlopeShading.cpp
+BENCHMARK_SLOPE_SHADING_OBJS = $(call SRC_TO_OBJ,$(BENCHMARK_SLOPE_SHADING_SOURCES))
+BENCHMARK_SLOPE_SHADING_LDADD = \
+	$(MATH_LIBS)
+$(TARGET_BIN_DIR)/BenchmarkSlopeShading$(TARGET_EXEEXT): $(BENCHMARK_SLOPE_SHADING_OBJS) $(BENCHMARK_SLOPE_SHADING_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(CC) $(LDFLAGS) $(TARGET_ARCH) $^ $(LOADLIBES) $(LDLIBS) -o $@
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_OBJS = $(call SRC_TO_OBJ,$(DUMP_TEXT_FILE_SOURCES))
@@ -446,11 +562,22 @@ LOAD_TOPOLOGY_SOURCES = \
 	$(SRC)/Topology/TopologyStore.cpp \
 	$(SRC)/Topology/TopologyFile.cpp \
 	$(SRC)/Topology/XShape.cpp \
+	$(SRC)/Topology/TopologySnapshot.cpp \
+	$(SRC)/Topology/TopologyUpdater.cpp \
+	$(SRC)/Geo/DouglasPeucker.cpp \
 	$(SRC)/Projection.cpp \
 	$(SRC)/WindowProjection.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/Screen/Layout.cpp \
 	$(SRC)/Engine/Math/Earth.cpp \
+	$(SRC)/OS/FileMapping.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/PathName.cpp \
+	$(SRC)/Thread/Debug.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/StoppableThread.cpp \
+	$(SRC)/Thread/WorkerThread.cpp \
 	$(TEST_SRC_DIR)/LoadTopology.cpp
 LOAD_TOPOLOGY_OBJS = $(call SRC_TO_OBJ,$(LOAD_TOPOLOGY_SOURCES))
 LOAD_TOPOLOGY_BIN = $(TARGET_BIN_DIR)/LoadTopology$(TARGET_EXEEXT)
@@ -481,11 +608,13 @@ $(TARGET_BIN_DIR)/RunInputParser$(TARGET_EXEEXT): $(RUN_INPUT_PARSER_OBJS) $(RUN
 
 RUN_WAY_POINT_PARSER_SOURCES = \
 	$(SRC)/WayPoint/WayPointFile.cpp \
+	$(SRC)/WayPoint/WayPointSnapshot.cpp \
 	$(SRC)/WayPoint/WayPointFileWinPilot.cpp \
 	$(SRC)/WayPoint/WayPointFileSeeYou.cpp \
 	$(SRC)/WayPoint/WayPointFileZander.cpp \
 	$(SRC)/UtilsFile.cpp \
 	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
 	$(SRC)/OS/PathName.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/Poco/RWLock.cpp \
@@ -508,7 +637,15 @@ $(TARGET_BIN_DIR)/RunWayPointParser$(TARGET_EXEEXT): $(RUN_WAY_POINT_PARSER_OBJS
 
 RUN_AIRSPACE_PARSER_SOURCES = \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceSnapshot.cpp \
 	$(SRC)/Units.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
+	$(SRC)/OS/PathName.cpp \
+	$(SRC)/Thread/Debug.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/ParallelJob.cpp \
 	$(TEST_SRC_DIR)/FakeDialogs.cpp \
 	$(TEST_SRC_DIR)/FakeProgressGlue.cpp \
 	$(TEST_SRC_DIR)/FakeLanguage.cpp \
@@ -527,6 +664,7 @@ $(TARGET_BIN_DIR)/RunAirspaceParser$(TARGET_EXEEXT): $(RUN_AIRSPACE_PARSER_OBJS)
 
 RUN_DEVICE_DRIVER_SOURCES = \
 	$(SRC)/FLARM/FlarmId.cpp \
+	$(SRC)/FLARM/State.cpp \
 	$(SRC)/UtilsText.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/Device/Port.cpp \
@@ -566,6 +704,7 @@ $(TARGET_BIN_DIR)/RunDeviceDriver$(TARGET_EXEEXT): $(RUN_DEVICE_DRIVER_OBJS) $(R
 RUN_IGC_WRITER_SOURCES = \
 	$(SRC)/Version.cpp \
 	$(SRC)/FLARM/FlarmId.cpp \
+	$(SRC)/FLARM/State.cpp \
 	$(SRC)/UtilsText.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/Device/Port.cpp \
@@ -609,6 +748,7 @@ $(TARGET_BIN_DIR)/RunIGCWriter$(TARGET_EXEEXT): $(RUN_IGC_WRITER_OBJS) $(RUN_IGC
 
 RUN_WIND_ZIG_ZAG_SOURCES = \
 	$(SRC)/FLARM/FlarmId.cpp \
+	$(SRC)/FLARM/State.cpp \
 	$(SRC)/UtilsText.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/Device/Port.cpp \
@@ -673,10 +813,12 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Poco/RWLock.cpp \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceSnapshot.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Appearance.cpp \
 	$(SRC)/LocalPath.cpp \
 	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
 	$(SRC)/OS/PathName.cpp \
 	$(SRC)/Projection.cpp \
 	$(SRC)/WindowProjection.cpp \
@@ -696,6 +838,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/MapWindowTimer.cpp \
 	$(SRC)/MapWindowTraffic.cpp \
 	$(SRC)/MapWindowTrail.cpp \
+	$(SRC)/TrailRenderer.cpp \
 	$(SRC)/MapWindowWaypoints.cpp \
 	$(SRC)/MapCanvas.cpp \
 	$(SRC)/MapDrawHelper.cpp \
@@ -707,10 +850,13 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
 	$(SRC)/Terrain/RasterTerrain.cpp \
+	$(SRC)/Terrain/TerrainLoader.cpp \
 	$(SRC)/Terrain/RasterWeather.cpp \
 	$(SRC)/Terrain/HeightMatrix.cpp \
 	$(SRC)/Terrain/RasterRenderer.cpp \
+	$(SRC)/Terrain/SlopeShading.cpp \
 	$(SRC)/Terrain/TerrainRenderer.cpp \
 	$(SRC)/Terrain/WeatherTerrainRenderer.cpp \
 	$(SRC)/Profile/Writer.cpp \
@@ -727,11 +873,20 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Task/ProtectedTaskManager.cpp \
 	$(SRC)/Thread/Debug.cpp \
 	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/StoppableThread.cpp \
+	$(SRC)/Thread/WorkerThread.cpp \
+	$(SRC)/Thread/ParallelJob.cpp \
 	$(SRC)/Topology/TopologyFile.cpp \
 	$(SRC)/Topology/TopologyStore.cpp \
 	$(SRC)/Topology/TopologyRenderer.cpp \
 	$(SRC)/Topology/TopologyGlue.cpp \
 	$(SRC)/Topology/XShape.cpp \
+	$(SRC)/Topology/TopologySnapshot.cpp \
+	$(SRC)/Topology/TopologyUpdater.cpp \
+	$(SRC)/Geo/GeoClip.cpp \
+	$(SRC)/Geo/DouglasPeucker.cpp \
+	$(SRC)/AirspaceShapeCache.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/UtilsText.cpp \
 	$(SRC)/UtilsFile.cpp \
@@ -739,6 +894,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Profile/ProfileKeys.cpp \
 	$(SRC)/WayPoint/WayPointGlue.cpp \
 	$(SRC)/WayPoint/WayPointFile.cpp \
+	$(SRC)/WayPoint/WayPointSnapshot.cpp \
 	$(SRC)/WayPoint/WayPointFileWinPilot.cpp \
 	$(SRC)/WayPoint/WayPointFileSeeYou.cpp \
 	$(SRC)/WayPoint/WayPointFileZander.cpp \
@@ -755,6 +911,9 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(TEST_SRC_DIR)/FakeProfileGlue.cpp \
 	$(TEST_SRC_DIR)/FakeProgressGlue.cpp \
 	$(TEST_SRC_DIR)/RunMapWindow.cpp
+ifeq ($(OPENGL),y)
+RUN_MAP_WINDOW_SOURCES += $(SRC)/GeoShapeBuffer.cpp
+endif
 RUN_MAP_WINDOW_OBJS = $(call SRC_TO_OBJ,$(RUN_MAP_WINDOW_SOURCES))
 RUN_MAP_WINDOW_BIN = $(TARGET_BIN_DIR)/RunMapWindow$(TARGET_EXEEXT)
 RUN_MAP_WINDOW_LDADD = \
@@ -874,6 +1033,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/NMEA/ThermalBand.cpp \
 	$(SRC)/OS/PathName.cpp \
 	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
 	$(SRC)/Task/ProtectedTaskManager.cpp \
 	$(SRC)/Math/Screen.cpp \
 	$(SRC)/Atmosphere.cpp \
@@ -902,6 +1062,10 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Screen/UnitSymbol.cpp \
 	$(SRC)/Thread/Debug.cpp \
 	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/StoppableThread.cpp \
+	$(SRC)/Thread/WorkerThread.cpp \
+	$(SRC)/Thread/ParallelJob.cpp \
 	$(SRC)/Poco/RWLock.cpp \
 	$(SRC)/Profile/Profile.cpp \
 	$(SRC)/Profile/ProfileKeys.cpp \
@@ -911,7 +1075,9 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
 	$(SRC)/Terrain/RasterTerrain.cpp \
+	$(SRC)/Terrain/TerrainLoader.cpp \
 	$(SRC)/Terrain/GlideTerrain.cpp \
 	$(SRC)/xmlParser.cpp \
 	$(SRC)/Dialogs/XML.cpp \
@@ -933,6 +1099,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/TeamCodeCalculation.cpp \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceSnapshot.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
 	$(SRC)/Math/SunEphemeris.cpp \
 	$(SRC)/Compatibility/string.c \
@@ -977,14 +1144,18 @@ RUN_AIRSPACE_WARNING_DIALOG_SOURCES = \
 	$(SRC)/Dialogs/dlgHelp.cpp \
 	$(SRC)/Dialogs/dlgAirspaceWarnings.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceSnapshot.cpp \
 	$(SRC)/Audio/Sound.cpp \
 	$(SRC)/Screen/Layout.cpp \
 	$(SRC)/Screen/Fonts.cpp \
 	$(SRC)/ResourceLoader.cpp \
 	$(SRC)/Thread/Debug.cpp \
 	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/ParallelJob.cpp \
 	$(SRC)/LocalPath.cpp \
 	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
 	$(SRC)/OS/PathName.cpp \
 	$(SRC)/UtilsText.cpp \
 	$(SRC)/UtilsFile.cpp \
@@ -1037,19 +1208,25 @@ RUN_TASK_EDITOR_DIALOG_SOURCES = \
 	$(SRC)/Math/SunEphemeris.cpp \
 	$(SRC)/LocalTime.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceSnapshot.cpp \
 	$(SRC)/Screen/Layout.cpp \
 	$(SRC)/Screen/Fonts.cpp \
 	$(SRC)/Task/ProtectedTaskManager.cpp \
 	$(SRC)/Thread/Debug.cpp \
 	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/ParallelJob.cpp \
 	$(SRC)/LocalPath.cpp \
 	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/FileMapping.cpp \
+	$(SRC)/OS/PathName.cpp \
 	$(SRC)/UtilsText.cpp \
 	$(SRC)/UtilsFont.cpp \
 	$(SRC)/UtilsFile.cpp \
 	$(SRC)/Units.cpp \
 	$(SRC)/WayPointGlue.cpp \
 	$(SRC)/WayPointFile.cpp \
+	$(SRC)/WayPoint/WayPointSnapshot.cpp \
 	$(SRC)/WayPointFileWinPilot.cpp \
 	$(SRC)/WayPointFileSeeYou.cpp \
 	$(SRC)/WayPointFileZander.cpp \
@@ -30,11 +30,54 @@ Copyright_License {
 #include "Language.hpp"
 #include "LogFile.hpp"
 #include "IO/ConfiguredFile.hpp"
+#include "Profile/Profile.hpp"
+#include "OS/FileUtil.hpp"
+
+#include <windef.h> /* for MAX_PATH */
+
+/**
+ * Reads one configured airspace file.  Files in the file system are
+ * loaded through a snapshot in the file cache, which is much faster
+ * than parsing them.
+ *
+ * @param in_map_file the fallback file name inside the map file, or
+ * NULL
+ * @return true if the file was found and loaded
+ */
+static bool
+ReadAirspaceFile(Airspaces &airspaces, FileCache *cache,
+                 const TCHAR *profile_key, const TCHAR *in_map_file,
+                 const TCHAR *cache_name, const TCHAR *error_message)
+{
+  TCHAR path[MAX_PATH];
+  if (cache != NULL && Profile::GetPath(profile_key, path) &&
+      File::Exists(path)) {
+    if (ReadAirspace(airspaces, path, *cache, cache_name))
+      return true;
+
+    LogStartUp(error_message);
+    return false;
+  }
+
+  TLineReader *reader = in_map_file != NULL
+    ? OpenConfiguredTextFile(profile_key, in_map_file)
+    : OpenConfiguredTextFile(profile_key);
+  if (reader == NULL)
+    return false;
+
+  const bool success = ReadAirspace(airspaces, *reader);
+  if (!success)
+    LogStartUp(error_message);
+
+  delete reader;
+  return success;
+}
 
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
-             const AtmosphericPressure &press)
+             const AtmosphericPressure &press,
+             FileCache *cache)
 {
   LogStartUp(_T("ReadAirspace"));
   ProgressGlue::Create(_("Loading Airspace File..."));
@@ -42,26 +85,15 @@ ReadAirspace(Airspaces &airspaces,
   bool airspace_ok = false;
 
   // Read the airspace filenames from the registry
-  TLineReader *reader =
-    OpenConfiguredTextFile(szProfileAirspaceFile, _T("airspace.txt"));
-  if (reader != NULL) {
-    if (!ReadAirspace(airspaces, *reader))
-      LogStartUp(_T("No airspace file 1"));
-    else
-      airspace_ok =  true;
-
-    delete reader;
-  }
-
-  reader = OpenConfiguredTextFile(szProfileAdditionalAirspaceFile);
-  if (reader != NULL) {
-    if (!ReadAirspace(airspaces, *reader))
-      LogStartUp(_T("No airspace file 2"));
-    else
-      airspace_ok = true;
+  if (ReadAirspaceFile(airspaces, cache,
+                       szProfileAirspaceFile, _T("airspace.txt"),
+                       _T("airspace-1"), _T("No airspace file 1")))
+    airspace_ok = true;
 
-    delete reader;
-  }
+  if (ReadAirspaceFile(airspaces, cache,
+                       szProfileAdditionalAirspaceFile, NULL,
+                       _T("airspace-2"), _T("No airspace file 2")))
+    airspace_ok = true;
 
   if (airspace_ok) {
     airspaces.optimise();
@@ -27,13 +27,17 @@ Copyright_License {
 class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
+class FileCache;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache the file cache for airspace snapshots; may be NULL
  */
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
-             const AtmosphericPressure &press);
+             const AtmosphericPressure &press,
+             FileCache *cache);
 
 #endif
@@ -31,9 +31,14 @@ Copyright_License {
 #include "Util/StringUtil.hpp"
 #include "Math/Earth.hpp"
 #include "IO/LineReader.hpp"
+#include "IO/FileLineReader.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
 #include "Airspace/AirspacePolygon.hpp"
 #include "Airspace/AirspaceCircle.hpp"
 #include "Compatibility/string.h"
+#include "Thread/ParallelJob.hpp"
+#include "AirspaceSnapshot.hpp"
 
 #include <math.h>
 #include <tchar.h>
@@ -41,6 +46,8 @@ Copyright_License {
 #include <assert.h>
 #include <stdio.h>
 
+#include <vector>
+
 #define fixed_75 fixed(7.5)
 
 enum asFileType {
@@ -80,6 +87,9 @@ static const int k_nAreaType[k_nAreaCount] = {
   CLASSF
 };
 
+/** Airspaces parsed from a part of the file, in file order */
+typedef std::vector<AbstractAirspace *> AirspaceList;
+
 // this can now be called multiple times to load several airspaces.
 
 struct TempAirspaceType
@@ -119,19 +129,19 @@ struct TempAirspaceType
   }
 
   void
-  AddPolygon(Airspaces &airspace_database)
+  AddPolygon(AirspaceList &airspaces)
   {
     AbstractAirspace *as = new AirspacePolygon(points);
     as->set_properties(Name, Type, Base, Top);
-    airspace_database.insert(as);
+    airspaces.push_back(as);
   }
 
   void
-  AddCircle(Airspaces &airspace_database)
+  AddCircle(AirspaceList &airspaces)
   {
     AbstractAirspace *as = new AirspaceCircle(Center, Radius);
     as->set_properties(Name, Type, Base, Top);
-    airspace_database.insert(as);
+    airspaces.push_back(as);
   }
 };
 
@@ -428,7 +438,7 @@ value_after_space(const TCHAR *p)
 }
 
 static bool
-ParseLine(Airspaces &airspace_database, const TCHAR *line,
+ParseLine(AirspaceList &airspaces, const TCHAR *line,
           TempAirspaceType &temp_area)
 {
   const TCHAR *value;
@@ -445,7 +455,7 @@ ParseLine(Airspaces &airspace_database, const TCHAR *line,
         break;
 
       if (!temp_area.Waiting)
-        temp_area.AddPolygon(airspace_database);
+        temp_area.AddPolygon(airspaces);
 
       temp_area.reset();
 
@@ -497,7 +507,7 @@ ParseLine(Airspaces &airspace_database, const TCHAR *line,
     case _T('c'):
       temp_area.Radius = Units::ToSysUnit(fixed(_tcstod(&line[2], NULL)),
                                           unNauticalMiles);
-      temp_area.AddCircle(airspace_database);
+      temp_area.AddCircle(airspaces);
       temp_area.reset();
       break;
 
@@ -699,7 +709,7 @@ ParseCircleTNP(const TCHAR *Text, TempAirspaceType &temp_area)
 }
 
 static bool
-ParseLineTNP(Airspaces &airspace_database, const TCHAR *line,
+ParseLineTNP(AirspaceList &airspaces, const TCHAR *line,
              TempAirspaceType &temp_area, bool &ignore)
 {
   const TCHAR* parameter;
@@ -719,7 +729,7 @@ ParseLineTNP(Airspaces &airspace_database, const TCHAR *line,
     temp_area.Name = parameter;
   } else if ((parameter = string_after_prefix_ci(line, _T("TYPE="))) != NULL) {
     if (!temp_area.Waiting)
-      temp_area.AddPolygon(airspace_database);
+      temp_area.AddPolygon(airspaces);
 
     temp_area.reset();
 
@@ -743,7 +753,7 @@ ParseLineTNP(Airspaces &airspace_database, const TCHAR *line,
     if (!ParseCircleTNP(parameter, temp_area))
       return false;
 
-    temp_area.AddCircle(airspace_database);
+    temp_area.AddCircle(airspaces);
   } else if ((parameter =
       string_after_prefix_ci(line, _T("CLOCKWISE "))) != NULL) {
     temp_area.Rotation = 1;
@@ -773,9 +783,400 @@ DetectFileType(const TCHAR *line)
   return ftUnknown;
 }
 
+/**
+ * Classifies a line for AirspaceBatch, without parsing it.  It also
+ * follows TNP's "INCLUDE=" switch, which decides whether the line
+ * counts at all.
+ */
+enum AirspaceLineKind {
+  /** a line which only affects the current airspace record */
+  lkOther,
+  /** the first line of an airspace record, e.g. "AC" */
+  lkRecord,
+  /** a line which sets the name, and stays valid for later records */
+  lkName,
+  /** a line which sets the base, and stays valid for later records */
+  lkBase,
+  /** a line which sets the top, and stays valid for later records */
+  lkTop,
+};
+
+static AirspaceLineKind
+ClassifyLine(const TCHAR *line)
+{
+  if (line[0] != _T('A') && line[0] != _T('a'))
+    return lkOther;
+
+  AirspaceLineKind kind;
+  switch (line[1]) {
+  case _T('C'):
+  case _T('c'):
+    kind = lkRecord;
+    break;
+
+  case _T('N'):
+  case _T('n'):
+    kind = lkName;
+    break;
+
+  case _T('L'):
+  case _T('l'):
+    kind = lkBase;
+    break;
+
+  case _T('H'):
+  case _T('h'):
+    kind = lkTop;
+    break;
+
+  default:
+    return lkOther;
+  }
+
+  // ParseLine() ignores these lines if they are malformed
+  return value_after_space(line + 2) != NULL ? kind : lkOther;
+}
+
+static AirspaceLineKind
+ClassifyLineTNP(const TCHAR *line, bool &ignore)
+{
+  const TCHAR* parameter;
+  if ((parameter = string_after_prefix_ci(line, _T("INCLUDE="))) != NULL) {
+    if (_tcsicmp(parameter, _T("YES")) == 0)
+      ignore = false;
+    else if (_tcsicmp(parameter, _T("NO")) == 0)
+      ignore = true;
+
+    return lkOther;
+  }
+
+  if (ignore)
+    return lkOther;
+
+  if (string_after_prefix_ci(line, _T("TITLE=")))
+    return lkName;
+  if (string_after_prefix_ci(line, _T("TYPE=")))
+    return lkRecord;
+  if (string_after_prefix_ci(line, _T("TOPS=")))
+    return lkTop;
+  if (string_after_prefix_ci(line, _T("BASE=")))
+    return lkBase;
+
+  return lkOther;
+}
+
+/**
+ * A block of consecutive lines of an airspace file, which begins with
+ * an airspace record.  The lines are split into chunks at record
+ * boundaries, and the chunks are parsed in parallel.  Name, base and
+ * top are not reset by a new record, so each chunk starts by
+ * re-parsing the last lines which set them before its first record.
+ * The airspaces and parse errors of all chunks are then merged in file
+ * order, i.e. the result is the same as if the lines had been parsed
+ * one after another.
+ */
+class AirspaceBatch : public ParallelJob {
+  /**
+   * Flush the batch when its text grows beyond this number of
+   * characters; this limits the memory used for large files.
+   */
+  static const unsigned MAX_TEXT = 256 * 1024;
+
+  /** the number of chunks per thread, for load balancing */
+  static const unsigned CHUNKS_PER_THREAD = 4;
+
+  struct Line {
+    /** position of the text in #text */
+    unsigned offset;
+    /** line number in the file, for error messages */
+    int number;
+  };
+
+  struct Record {
+    /** index of the first line of the record in #lines */
+    unsigned line;
+    /** the last name/base/top line before this record, or -1 */
+    int name, base, top;
+  };
+
+  struct Error {
+    /** index of the offending line in #lines */
+    unsigned line;
+    /** the number of airspaces parsed before this line */
+    unsigned position;
+  };
+
+  struct Chunk {
+    unsigned begin, end;
+    int name, base, top;
+
+    TempAirspaceType temp;
+    AirspaceList airspaces;
+    std::vector<Error> errors;
+  };
+
+  asFileType filetype;
+
+  std::vector<TCHAR> text;
+  std::vector<Line> lines;
+  std::vector<Record> records;
+  std::vector<Chunk> chunks;
+
+  /** the last name/base/top line of this batch, or -1 */
+  int last_name, last_base, last_top;
+
+  /** receives a copy of all airspaces which are inserted; may be NULL */
+  AirspaceSnapshotWriter *snapshot;
+
+  /** the number of chunks per batch, or 0 to pick one automatically */
+  unsigned num_chunks;
+
+  /** the number of parse warnings shown so far */
+  unsigned num_warnings;
+
+  /**
+   * Name, base and top as left behind by the previous batch.
+   */
+  TempAirspaceType carry;
+
+public:
+  AirspaceBatch(AirspaceSnapshotWriter *_snapshot, unsigned _num_chunks)
+    :filetype(ftUnknown), last_name(-1), last_base(-1), last_top(-1),
+     snapshot(_snapshot), num_chunks(_num_chunks), num_warnings(0) {}
+
+  void set_file_type(asFileType _filetype) {
+    filetype = _filetype;
+    text.reserve(MAX_TEXT + 256);
+  }
+
+  /**
+   * Is this batch full, i.e. should it be flushed before the given
+   * line is added?
+   */
+  bool full(AirspaceLineKind kind) const {
+    return kind == lkRecord && text.size() >= MAX_TEXT;
+  }
+
+  void add(const TCHAR *line, int number, AirspaceLineKind kind) {
+    const unsigned index = lines.size();
+
+    switch (kind) {
+    case lkOther:
+      break;
+
+    case lkRecord:
+      if (index > 0) {
+        const Record record = { index, last_name, last_base, last_top };
+        records.push_back(record);
+      }
+      break;
+
+    case lkName:
+      last_name = index;
+      break;
+
+    case lkBase:
+      last_base = index;
+      break;
+
+    case lkTop:
+      last_top = index;
+      break;
+    }
+
+    const Line l = { (unsigned)text.size(), number };
+    lines.push_back(l);
+    text.insert(text.end(), line, line + _tcslen(line) + 1);
+  }
+
+  /**
+   * Parse all lines of this batch, and insert the airspaces into the
+   * database.  After that, the batch is empty and can be filled
+   * again.
+   *
+   * @return false if the user has cancelled after a parse error
+   */
+  bool flush(Airspaces &airspace_database);
+
+  unsigned get_num_warnings() const {
+    return num_warnings;
+  }
+
+protected:
+  virtual void run_item(unsigned i);
+
+private:
+  const TCHAR *get_line(unsigned i) const {
+    return &text[lines[i].offset];
+  }
+
+  bool parse_line(const TCHAR *line, AirspaceList &airspaces,
+                  TempAirspaceType &temp, bool &ignore) const {
+    if (filetype == ftOpenAir)
+      return ParseLine(airspaces, line, temp);
+    else
+      return ParseLineTNP(airspaces, line, temp, ignore);
+  }
+
+  void split();
+  void insert(Airspaces &airspace_database, AbstractAirspace *airspace);
+  bool merge(Airspaces &airspace_database);
+};
+
+void
+AirspaceBatch::split()
+{
+  unsigned num_chunks = this->num_chunks;
+  if (num_chunks == 0) {
+    num_chunks = ParallelJob::get_concurrency();
+    if (num_chunks > 1)
+      num_chunks *= CHUNKS_PER_THREAD;
+  }
+
+  const unsigned target = lines.size() / num_chunks + 1;
+
+  chunks.clear();
+  chunks.reserve(num_chunks + 1);
+
+  Chunk first;
+  first.begin = 0;
+  first.name = first.base = first.top = -1;
+  chunks.push_back(first);
+
+  for (std::vector<Record>::const_iterator r = records.begin();
+       r != records.end(); ++r) {
+    if (r->line - chunks.back().begin < target)
+      continue;
+
+    chunks.back().end = r->line;
+
+    Chunk chunk;
+    chunk.begin = r->line;
+    chunk.name = r->name;
+    chunk.base = r->base;
+    chunk.top = r->top;
+    chunks.push_back(chunk);
+  }
+
+  chunks.back().end = lines.size();
+}
+
+void
+AirspaceBatch::run_item(unsigned i)
+{
+  Chunk &chunk = chunks[i];
+  TempAirspaceType &temp = chunk.temp;
+  bool ignore = false;
+
+  chunk.airspaces.reserve((chunk.end - chunk.begin) / 8 + 1);
+  temp.points.reserve(256);
+
+  temp.Name = carry.Name;
+  temp.Base = carry.Base;
+  temp.Top = carry.Top;
+
+  /* restore the state left behind by the previous chunk; these lines
+     have been parsed successfully before, and they never produce an
+     airspace */
+  if (chunk.name >= 0)
+    parse_line(get_line(chunk.name), chunk.airspaces, temp, ignore);
+  if (chunk.base >= 0)
+    parse_line(get_line(chunk.base), chunk.airspaces, temp, ignore);
+  if (chunk.top >= 0)
+    parse_line(get_line(chunk.top), chunk.airspaces, temp, ignore);
+
+  for (unsigned j = chunk.begin; j < chunk.end; ++j) {
+    if (!parse_line(get_line(j), chunk.airspaces, temp, ignore)) {
+      const Error error = { j, (unsigned)chunk.airspaces.size() };
+      chunk.errors.push_back(error);
+    }
+  }
+
+  /* the next chunk begins with a new record, which would have
+     finished this airspace */
+  if (!temp.Waiting)
+    temp.AddPolygon(chunk.airspaces);
+}
+
+inline void
+AirspaceBatch::insert(Airspaces &airspace_database, AbstractAirspace *airspace)
+{
+  if (snapshot != NULL)
+    snapshot->add(*airspace);
+
+  airspace_database.insert(airspace);
+}
+
+bool
+AirspaceBatch::merge(Airspaces &airspace_database)
+{
+  for (std::vector<Chunk>::const_iterator c = chunks.begin();
+       c != chunks.end(); ++c) {
+    AirspaceList::const_iterator a = c->airspaces.begin();
+
+    for (std::vector<Error>::const_iterator e = c->errors.begin();
+         e != c->errors.end(); ++e) {
+      for (; a != c->airspaces.begin() + e->position; ++a)
+        insert(airspace_database, *a);
+
+      ++num_warnings;
+      if (!ShowParseWarning(lines[e->line].number, get_line(e->line))) {
+        /* cancelled: discard everything after this line */
+        for (; a != c->airspaces.end(); ++a)
+          delete *a;
+
+        for (++c; c != chunks.end(); ++c)
+          for (a = c->airspaces.begin(); a != c->airspaces.end(); ++a)
+            delete *a;
+
+        return false;
+      }
+    }
+
+    for (; a != c->airspaces.end(); ++a)
+      insert(airspace_database, *a);
+  }
+
+  return true;
+}
+
 bool
-ReadAirspace(Airspaces &airspace_database, TLineReader &reader)
+AirspaceBatch::flush(Airspaces &airspace_database)
 {
+  if (lines.empty())
+    return true;
+
+  split();
+  execute(chunks.size());
+
+  const TempAirspaceType &last = chunks.back().temp;
+  carry.Name = last.Name;
+  carry.Base = last.Base;
+  carry.Top = last.Top;
+
+  const bool result = merge(airspace_database);
+
+  chunks.clear();
+  records.clear();
+  lines.clear();
+  text.clear();
+  last_name = last_base = last_top = -1;
+
+  return result;
+}
+
+/**
+ * @param snapshot receives a copy of all airspaces; may be NULL
+ * @param num_chunks see ReadAirspace()
+ * @param num_warnings_r receives the number of parse warnings
+ */
+static bool
+ParseAirspace(Airspaces &airspace_database, TLineReader &reader,
+              AirspaceSnapshotWriter *snapshot, unsigned num_chunks,
+              unsigned &num_warnings_r)
+{
+  num_warnings_r = 0;
+
   int LineCount = 0;
   bool ignore = false;
 
@@ -784,8 +1185,8 @@ ReadAirspace(Airspaces &airspace_database, TLineReader &reader)
 
   long file_size = reader.size();
 
-  TempAirspaceType temp_area;
   asFileType filetype = ftUnknown;
+  AirspaceBatch batch(snapshot, num_chunks);
 
   TCHAR *line;
   TCHAR *comment;
@@ -807,18 +1208,19 @@ ReadAirspace(Airspaces &airspace_database, TLineReader &reader)
       filetype = DetectFileType(line);
       if (filetype == ftUnknown)
         continue;
+
+      batch.set_file_type(filetype);
     }
 
-    // Parse the line
-    if (filetype == ftOpenAir)
-      if (!ParseLine(airspace_database, line, temp_area) &&
-          !ShowParseWarning(LineCount, line))
-        return false;
+    // Collect the line, parse when the batch is full
+    const AirspaceLineKind kind = filetype == ftOpenAir
+      ? ClassifyLine(line)
+      : ClassifyLineTNP(line, ignore);
 
-    if (filetype == ftTNP)
-      if (!ParseLineTNP(airspace_database, line, temp_area, ignore) &&
-          !ShowParseWarning(LineCount, line))
-        return false;
+    if (batch.full(kind) && !batch.flush(airspace_database))
+      return false;
+
+    batch.add(line, LineCount, kind);
 
     // Update the ProgressDialog
     if ((LineCount & 0x3f) == 0)
@@ -830,9 +1232,59 @@ ReadAirspace(Airspaces &airspace_database, TLineReader &reader)
     return false;
   }
 
-  // Process final area (if any)
-  if (!temp_area.Waiting)
-    temp_area.AddPolygon(airspace_database);
+  // Parse the remaining lines, and process the final area (if any)
+  const bool result = batch.flush(airspace_database);
+  num_warnings_r = batch.get_num_warnings();
+  return result;
+}
+
+bool
+ReadAirspace(Airspaces &airspace_database, TLineReader &reader,
+             unsigned num_chunks)
+{
+  unsigned num_warnings;
+  return ParseAirspace(airspace_database, reader, NULL, num_chunks,
+                       num_warnings);
+}
+
+bool
+ReadAirspace(Airspaces &airspace_database, const TCHAR *path,
+             FileCache &cache, const TCHAR *cache_name)
+{
+  size_t offset;
+  FileMapping *mapping = cache.map(cache_name, path, offset);
+  if (mapping != NULL) {
+    const bool success =
+      LoadAirspaceSnapshot(airspace_database, *mapping, offset);
+    delete mapping;
+    if (success)
+      return true;
+
+    cache.flush(cache_name);
+  }
+
+  FileLineReader reader(path);
+  if (reader.error())
+    return false;
+
+  AirspaceSnapshotWriter snapshot;
+  unsigned num_warnings;
+  if (!ParseAirspace(airspace_database, reader, &snapshot, 0, num_warnings))
+    return false;
+
+  /* a snapshot would hide the parse warnings next time, so such files
+     are always parsed */
+  if (num_warnings > 0)
+    return true;
+
+  FILE *file = cache.save(cache_name, path);
+  if (file == NULL)
+    return true;
+
+  if (snapshot.save(file))
+    cache.commit(cache_name, file);
+  else
+    cache.cancel(cache_name, file);
 
   return true;
 }
@@ -24,10 +24,32 @@ Copyright_License {
 #ifndef XCSOAR_AIRSPACE_PARSER_HPP
 #define XCSOAR_AIRSPACE_PARSER_HPP
 
+#include <tchar.h>
+
 class Airspaces;
 class TLineReader;
-
+class FileCache;
+
+/**
+ * Parses the airspaces of a file.
+ *
+ * @param num_chunks split the lines into this many chunks, which are
+ * parsed in parallel; 1 parses serially, and 0 picks a number
+ * depending on the number of processors
+ */
+bool
+ReadAirspace(Airspaces &airspace_database, TLineReader &reader,
+             unsigned num_chunks=0);
+
+/**
+ * Reads the airspaces of a file from its snapshot in the file cache.
+ * If there is no valid snapshot, the file is parsed, and a new
+ * snapshot is saved for the next time.
+ *
+ * @param cache_name the name of the snapshot in the file cache
+ */
 bool
-ReadAirspace(Airspaces &airspace_database, TLineReader &reader);
+ReadAirspace(Airspaces &airspace_database, const TCHAR *path,
+             FileCache &cache, const TCHAR *cache_name);
 
 #endif
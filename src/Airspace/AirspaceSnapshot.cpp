@@ -0,0 +1,237 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/AirspaceSnapshot.hpp"
+#include "Airspace/Airspaces.hpp"
+#include "Airspace/AirspacePolygon.hpp"
+#include "Airspace/AirspaceCircle.hpp"
+#include "OS/FileMapping.hpp"
+
+#include <string.h>
+
+struct AirspaceSnapshotHeader {
+  static const unsigned VERSION = 1;
+
+  unsigned version;
+
+  /** sizeof(TCHAR) of the writer */
+  unsigned char_size;
+
+  unsigned num_airspaces, num_points, num_strings;
+
+  unsigned reserved;
+};
+
+/** tables in the snapshot are aligned to this number of bytes */
+static const unsigned SNAPSHOT_ALIGNMENT = 8;
+
+static size_t
+AlignSnapshotOffset(size_t offset)
+{
+  return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT
+    * SNAPSHOT_ALIGNMENT;
+}
+
+static AirspaceSnapshotWriter::Altitude
+ExportAltitude(const AIRSPACE_ALT &alt)
+{
+  AirspaceSnapshotWriter::Altitude result;
+  result.altitude = (double)alt.Altitude;
+  result.fl = (double)alt.FL;
+  result.agl = (double)alt.AGL;
+  result.base = alt.Base;
+  result.reserved = 0;
+  return result;
+}
+
+static AIRSPACE_ALT
+ImportAltitude(const AirspaceSnapshotWriter::Altitude &alt)
+{
+  AIRSPACE_ALT result;
+  result.Altitude = fixed(alt.altitude);
+  result.FL = fixed(alt.fl);
+  result.AGL = fixed(alt.agl);
+  result.Base = (AirspaceAltBase_t)alt.base;
+  return result;
+}
+
+static GeoPoint
+ImportLocation(double latitude, double longitude)
+{
+  return GeoPoint(Angle::native(fixed(longitude)),
+                  Angle::native(fixed(latitude)));
+}
+
+void
+AirspaceSnapshotWriter::add(const AbstractAirspace &airspace)
+{
+  Entry entry;
+  memset(&entry, 0, sizeof(entry));
+
+  entry.shape = airspace.shape;
+  entry.type = airspace.get_type();
+  entry.base = ExportAltitude(airspace.get_base());
+  entry.top = ExportAltitude(airspace.get_top());
+
+  const tstring name = airspace.get_name_text(true);
+  entry.name_offset = strings.size();
+  entry.name_length = name.length();
+  strings.insert(strings.end(), name.begin(), name.end());
+
+  if (airspace.shape == AbstractAirspace::CIRCLE) {
+    const AirspaceCircle &circle = (const AirspaceCircle &)airspace;
+    const GeoPoint center = circle.get_center();
+    entry.center_latitude = (double)center.Latitude.value_native();
+    entry.center_longitude = (double)center.Longitude.value_native();
+    entry.radius = (double)circle.get_radius();
+  } else {
+    const AirspacePolygon &polygon = (const AirspacePolygon &)airspace;
+    const SearchPointVector &border = polygon.get_points();
+    entry.convex = polygon.is_convex_border();
+    entry.first_point = points.size();
+    entry.num_points = border.size();
+
+    for (SearchPointVector::const_iterator i = border.begin();
+         i != border.end(); ++i) {
+      const GeoPoint &location = i->get_location();
+      const Point point = {
+        (double)location.Latitude.value_native(),
+        (double)location.Longitude.value_native(),
+      };
+      points.push_back(point);
+    }
+  }
+
+  entries.push_back(entry);
+}
+
+bool
+AirspaceSnapshotWriter::save(FILE *file) const
+{
+  long base = ftell(file);
+  if (base < 0)
+    return false;
+
+  static const char zero[SNAPSHOT_ALIGNMENT] = { 0 };
+  const size_t padding = AlignSnapshotOffset(base) - base;
+  if (padding > 0 && fwrite(zero, 1, padding, file) != padding)
+    return false;
+
+  AirspaceSnapshotHeader header;
+  header.version = AirspaceSnapshotHeader::VERSION;
+  header.char_size = sizeof(TCHAR);
+  header.num_airspaces = entries.size();
+  header.num_points = points.size();
+  header.num_strings = strings.size();
+  header.reserved = 0;
+
+  return fwrite(&header, sizeof(header), 1, file) == 1 &&
+    (entries.empty() ||
+     fwrite(&entries[0], sizeof(entries[0]), entries.size(),
+            file) == entries.size()) &&
+    (points.empty() ||
+     fwrite(&points[0], sizeof(points[0]), points.size(),
+            file) == points.size()) &&
+    (strings.empty() ||
+     fwrite(&strings[0], sizeof(strings[0]), strings.size(),
+            file) == strings.size());
+}
+
+bool
+LoadAirspaceSnapshot(Airspaces &airspaces, const FileMapping &mapping,
+                     size_t offset)
+{
+  offset = AlignSnapshotOffset(offset);
+  if (mapping.size() < offset + sizeof(AirspaceSnapshotHeader))
+    return false;
+
+  const AirspaceSnapshotHeader &header =
+    *(const AirspaceSnapshotHeader *)mapping.at(offset);
+  if (header.version != AirspaceSnapshotHeader::VERSION ||
+      header.char_size != sizeof(TCHAR))
+    return false;
+
+  /* divide instead of multiplying the counts from the file, which
+     could overflow on 32 bit machines */
+  size_t available = mapping.size() - offset - sizeof(header);
+  if (header.num_airspaces >
+      available / sizeof(AirspaceSnapshotWriter::Entry))
+    return false;
+
+  available -= header.num_airspaces * sizeof(AirspaceSnapshotWriter::Entry);
+  if (header.num_points > available / sizeof(AirspaceSnapshotWriter::Point))
+    return false;
+
+  available -= header.num_points * sizeof(AirspaceSnapshotWriter::Point);
+  if (header.num_strings > available / sizeof(TCHAR))
+    return false;
+
+  const AirspaceSnapshotWriter::Entry *entries =
+    (const AirspaceSnapshotWriter::Entry *)(&header + 1);
+  const AirspaceSnapshotWriter::Point *points =
+    (const AirspaceSnapshotWriter::Point *)(entries + header.num_airspaces);
+  const TCHAR *strings = (const TCHAR *)(points + header.num_points);
+
+  /* check all references before anything is inserted */
+  for (unsigned i = 0; i < header.num_airspaces; ++i) {
+    const AirspaceSnapshotWriter::Entry &entry = entries[i];
+    if ((entry.shape != AbstractAirspace::CIRCLE &&
+         entry.shape != AbstractAirspace::POLYGON) ||
+        entry.name_offset > header.num_strings ||
+        entry.name_length > header.num_strings - entry.name_offset ||
+        entry.first_point > header.num_points ||
+        entry.num_points > header.num_points - entry.first_point)
+      return false;
+  }
+
+  SearchPointVector border;
+  for (unsigned i = 0; i < header.num_airspaces; ++i) {
+    const AirspaceSnapshotWriter::Entry &entry = entries[i];
+
+    AbstractAirspace *airspace;
+    if (entry.shape == AbstractAirspace::CIRCLE) {
+      airspace = new AirspaceCircle(ImportLocation(entry.center_latitude,
+                                                   entry.center_longitude),
+                                    fixed(entry.radius));
+    } else {
+      border.clear();
+      border.reserve(entry.num_points);
+
+      const AirspaceSnapshotWriter::Point *point = points + entry.first_point;
+      for (unsigned j = 0; j < entry.num_points; ++j, ++point)
+        border.push_back(SearchPoint(ImportLocation(point->latitude,
+                                                    point->longitude)));
+
+      airspace = new AirspacePolygon(border, entry.convex != 0);
+    }
+
+    airspace->set_properties(tstring(strings + entry.name_offset,
+                                     entry.name_length),
+                             (AirspaceClass_t)entry.type,
+                             ImportAltitude(entry.base),
+                             ImportAltitude(entry.top));
+    airspaces.insert(airspace);
+  }
+
+  return true;
+}
@@ -0,0 +1,97 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_SNAPSHOT_HPP
+#define XCSOAR_AIRSPACE_SNAPSHOT_HPP
+
+#include <stddef.h>
+#include <stdio.h>
+#include <tchar.h>
+#include <vector>
+
+class Airspaces;
+class AbstractAirspace;
+class FileMapping;
+
+/**
+ * Collects airspaces, and writes them into a binary snapshot file.
+ * The snapshot contains the airspace geometry after arcs have been
+ * expanded and the polygon borders have been checked, so it can be
+ * loaded by LoadAirspaceSnapshot() without any parsing.
+ */
+class AirspaceSnapshotWriter {
+public:
+  struct Altitude {
+    double altitude, fl, agl;
+    unsigned base, reserved;
+  };
+
+  struct Entry {
+    unsigned char shape, type, convex, reserved;
+
+    /** the name in the string table */
+    unsigned name_offset, name_length;
+
+    /** the polygon border in the point table */
+    unsigned first_point, num_points;
+
+    unsigned reserved2;
+
+    /** the circle */
+    double center_latitude, center_longitude, radius;
+
+    Altitude base, top;
+  };
+
+  struct Point {
+    double latitude, longitude;
+  };
+
+private:
+  std::vector<Entry> entries;
+  std::vector<Point> points;
+  std::vector<TCHAR> strings;
+
+public:
+  void add(const AbstractAirspace &airspace);
+
+  /**
+   * Writes the snapshot to the specified file, which is positioned
+   * after the FileCache header.
+   */
+  bool save(FILE *file) const;
+};
+
+/**
+ * Inserts the airspaces of a snapshot written by
+ * AirspaceSnapshotWriter into the database.
+ *
+ * @param offset the position of the snapshot in the mapping
+ * @return false if the snapshot is malformed; no airspaces have
+ * been inserted in this case
+ */
+bool
+LoadAirspaceSnapshot(Airspaces &airspaces, const FileMapping &mapping,
+                     size_t offset);
+
+#endif
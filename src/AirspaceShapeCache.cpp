@@ -0,0 +1,113 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceShapeCache.hpp"
+#include "Airspace/Airspaces.hpp"
+#include "Airspace/AirspacePolygon.hpp"
+#include "Geo/DouglasPeucker.hpp"
+#include "WindowProjection.hpp"
+
+#ifdef ENABLE_OPENGL
+#include "GeoShapeBuffer.hpp"
+#endif
+
+void
+AirspaceShapeCache::clear()
+{
+  for (ShapeMap::iterator i = shapes.begin(); i != shapes.end(); ++i) {
+    delete[] i->second.levels;
+#ifdef ENABLE_OPENGL
+    delete i->second.buffer;
+#endif
+  }
+
+  shapes.clear();
+}
+
+void
+AirspaceShapeCache::validate(const Airspaces &_airspaces)
+{
+  if (&_airspaces == airspaces && _airspaces.get_serial() == serial)
+    return;
+
+  clear();
+  airspaces = &_airspaces;
+  serial = _airspaces.get_serial();
+}
+
+void
+AirspaceShapeCache::set_projection(const WindowProjection &projection)
+{
+  /* the margin keeps the edges which were added by clipping off the
+     screen */
+  geo_clip.set_bounds(projection.GetScreenBounds().scale(fixed(1.1)));
+  min_level =
+    DouglasPeuckerMinLevel(projection.PixelsToAngle(1).value_radians());
+}
+
+const GeoPoint *
+AirspaceShapeCache::clip(const AirspacePolygon &airspace, unsigned &n)
+{
+  const SearchPointVector &border = airspace.get_points();
+  n = border.size();
+
+  GeoPoint *dest = points.get(n);
+
+  Shape &shape = shapes[&airspace];
+  if (shape.levels == NULL) {
+    for (unsigned j = 0; j < n; ++j)
+      dest[j] = border[j].get_location();
+
+    shape.levels = new unsigned char[n];
+    DouglasPeuckerLevels(dest, n, shape.levels);
+  }
+
+  unsigned m = 0;
+  for (unsigned j = 0; j < n; ++j)
+    if (shape.levels[j] >= min_level)
+      dest[m++] = border[j].get_location();
+
+  n = m;
+  return geo_clip.clip_polygon(dest, n);
+}
+
+#ifdef ENABLE_OPENGL
+
+const GeoShapeBuffer &
+AirspaceShapeCache::get(const AirspacePolygon &airspace)
+{
+  Shape &shape = shapes[&airspace];
+  if (shape.buffer != NULL)
+    return *shape.buffer;
+
+  const SearchPointVector &border = airspace.get_points();
+  const unsigned n = border.size();
+  GeoPoint *dest = points.get(n);
+  for (unsigned j = 0; j < n; ++j)
+    dest[j] = border[j].get_location();
+
+  shape.buffer = new GeoShapeBuffer(dest, n, true);
+  return *shape.buffer;
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_SHAPE_CACHE_HPP
+#define XCSOAR_AIRSPACE_SHAPE_CACHE_HPP
+
+#include "Geo/GeoClip.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Util/ReusableArray.hpp"
+
+#include <map>
+#include <stddef.h>
+
+class Airspaces;
+class AbstractAirspace;
+class AirspacePolygon;
+class WindowProjection;
+class GeoShapeBuffer;
+
+/**
+ * Data about airspace polygons which is needed for drawing them: the
+ * level of detail of their points and, with OpenGL, their vertex
+ * buffers.  It is created when an airspace is drawn for the first
+ * time; all of it is discarded when the airspaces are reloaded.
+ */
+class AirspaceShapeCache : private NonCopyable {
+  struct Shape {
+    /** see DouglasPeuckerLevels() */
+    unsigned char *levels;
+
+#ifdef ENABLE_OPENGL
+    GeoShapeBuffer *buffer;
+#endif
+
+    Shape():levels(NULL)
+#ifdef ENABLE_OPENGL
+           , buffer(NULL)
+#endif
+    {}
+  };
+
+  typedef std::map<const AbstractAirspace *, Shape> ShapeMap;
+
+  ShapeMap shapes;
+
+  const Airspaces *airspaces;
+
+  /** Airspaces::get_serial() of the cached airspaces */
+  unsigned serial;
+
+  /** clips the polygons against the screen */
+  GeoClip geo_clip;
+
+  /** the minimum level of detail at the current map scale */
+  unsigned char min_level;
+
+  /** the points of a polygon which are needed at the current scale */
+  ReusableArray<GeoPoint> points;
+
+public:
+  AirspaceShapeCache():airspaces(NULL), serial(0), min_level(0) {}
+
+  ~AirspaceShapeCache() {
+    clear();
+  }
+
+  void clear();
+
+  /**
+   * Discards all data if the airspaces have changed since the last
+   * call.  Must be called before the other methods in each frame.
+   */
+  void validate(const Airspaces &airspaces);
+
+  /**
+   * Prepares clip() for the specified projection.
+   */
+  void set_projection(const WindowProjection &projection);
+
+  /**
+   * Returns the visible part of a polygon, with the level of detail
+   * needed at the current map scale.
+   *
+   * @param n receives the number of points, which is less than 3 if
+   * the polygon is not visible
+   * @return the points, which are valid until the next call
+   */
+  const GeoPoint *clip(const AirspacePolygon &airspace, unsigned &n);
+
+#ifdef ENABLE_OPENGL
+  const GeoShapeBuffer &get(const AirspacePolygon &airspace);
+#endif
+};
+
+#endif
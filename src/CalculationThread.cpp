@@ -28,6 +28,7 @@ Copyright_License {
 #include "DeviceBlackboard.hpp"
 #include "Components.hpp"
 #include "DrawThread.hpp"
+#include "ContestThread.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
 
 #ifdef ENABLE_OPENGL
@@ -71,10 +72,14 @@ CalculationThread::tick()
   }
 
   // if (time advanced and slow calculations need to be updated)
-  if (gps_updated && glide_computer.ProcessGPS())
+  if (gps_updated && glide_computer.ProcessGPS()) {
     // do slow calculations
     glide_computer.ProcessIdle();
 
+    // the contest is solved in the background from the updated trace
+    contest_thread->trigger();
+  }
+
   // values changed, so copy them back now: ONLY CALCULATED INFO
   // should be changed in DoCalculations, so we only need to write
   // that one back (otherwise we may write over new data)
@@ -24,6 +24,12 @@ Copyright_License {
 #include "ClimbAverageCalculator.hpp"
 
 ClimbAverageCalculator::ClimbAverageCalculator()
+{
+  Reset();
+}
+
+void
+ClimbAverageCalculator::Reset()
 {
 	newestValIndex = -1;
 
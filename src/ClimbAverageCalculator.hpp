@@ -30,6 +30,12 @@ class ClimbAverageCalculator
 {
 public:
 	ClimbAverageCalculator();
+
+	/**
+	 * Forget all samples.
+	 */
+	void Reset();
+
 	fixed GetAverage(fixed curTime, fixed curAltitude, fixed averageTime);
 
 private:
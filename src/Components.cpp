@@ -64,6 +64,7 @@ Copyright_License {
 #include "GlideComputer.hpp"
 #include "StatusMessage.hpp"
 #include "CalculationThread.hpp"
+#include "ContestThread.hpp"
 #include "InstrumentThread.hpp"
 #include "Replay/Replay.hpp"
 #include "ResourceLoader.hpp"
@@ -103,6 +104,7 @@ DrawThread *draw_thread;
 #endif
 
 CalculationThread *calculation_thread;
+ContestThread *contest_thread;
 InstrumentThread *instrument_thread;
 
 Logger logger;
@@ -334,10 +336,11 @@ XCSoarInterface::Startup(HINSTANCE hInstance)
     task_manager.set_glide_polar(gp);
 
   task_manager.set_contest(SettingsComputer().contest);
+  task_manager.set_contest_background(true);
 
   // Read the topology file(s)
   topology = new TopologyStore();
-  LoadConfiguredTopology(*topology);
+  LoadConfiguredTopology(*topology, file_cache);
 
   // Read the terrain file
   ProgressGlue::Create(_("Loading Terrain File..."));
@@ -345,7 +348,7 @@ XCSoarInterface::Startup(HINSTANCE hInstance)
   terrain = RasterTerrain::OpenTerrain(file_cache);
 
   // Read the waypoint files
-  WayPointGlue::ReadWaypoints(way_points, terrain);
+  WayPointGlue::ReadWaypoints(way_points, terrain, file_cache);
 
   // Read and parse the airfield info file
   ReadAirfieldFile(way_points);
@@ -369,7 +372,7 @@ XCSoarInterface::Startup(HINSTANCE hInstance)
   RASP.ScanAll(Basic().Location);
 
   // Reads the airspace files
-  ReadAirspace(airspace_database, terrain, Basic().pressure);
+  ReadAirspace(airspace_database, terrain, Basic().pressure, file_cache);
 
   const AIRCRAFT_STATE aircraft_state =
     ToAircraftState(device_blackboard.Basic());
@@ -377,7 +380,7 @@ XCSoarInterface::Startup(HINSTANCE hInstance)
   airspace_warning.set_config(XCSoarInterface::SettingsComputer().airspace_warnings);
 
   // Read the FLARM details file
-  FlarmDetails::Load();
+  FlarmDetails::Load(file_cache);
 
 #ifndef DISABLEAUDIOVARIO
   /*
@@ -447,6 +450,9 @@ XCSoarInterface::Startup(HINSTANCE hInstance)
   // Start calculation thread
   calculation_thread->start();
 
+  // Start contest thread
+  contest_thread->start();
+
   // Start instrument thread
   if (instrument_thread != NULL)
     instrument_thread->start();
@@ -502,6 +508,7 @@ XCSoarInterface::Shutdown(void)
   draw_thread->stop();
 #endif
   calculation_thread->stop();
+  contest_thread->stop();
 
   if (instrument_thread != NULL)
     instrument_thread->stop();
@@ -510,6 +517,11 @@ XCSoarInterface::Shutdown(void)
   calculation_thread->join();
   LogStartUp(_T("- calculation thread returned"));
 
+  // Wait for the contest thread to finish
+  contest_thread->join();
+  LogStartUp(_T("- contest thread returned"));
+  delete contest_thread;
+
   //  Wait for the instruments thread to finish
   if (instrument_thread != NULL)
     instrument_thread->join();
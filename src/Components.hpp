@@ -32,6 +32,7 @@ class RasterWeather;
 class GlideComputer;
 class DrawThread;
 class CalculationThread;
+class ContestThread;
 class InstrumentThread;
 class Waypoints;
 class Airspaces;
@@ -57,6 +58,7 @@ extern GlideComputer glide_computer;
 extern DrawThread *draw_thread;
 #endif
 extern CalculationThread *calculation_thread;
+extern ContestThread *contest_thread;
 extern InstrumentThread *instrument_thread;
 
 #ifdef GNAV
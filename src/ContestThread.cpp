@@ -0,0 +1,87 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ContestThread.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "PeriodClock.hpp"
+
+/**
+ * Maximum time (ms) spent solving before the traces are copied
+ * again
+ */
+static const unsigned solve_budget = 1000;
+
+ContestThread::ContestThread(ProtectedTaskManager &_task_manager)
+  :task_manager(_task_manager),
+   handicap(100),
+   reset_serial(0), trace_time(Trace::null_time), searching(false),
+   contest_manager(OLC_Sprint, handicap, result, trace_full, trace_sprint) {}
+
+void
+ContestThread::tick()
+{
+  {
+    ProtectedTaskManager::Lease task(task_manager);
+
+    if (!task->is_contest_active())
+      return;
+
+    const TaskBehaviour &behaviour = task->get_task_behaviour();
+    contest_manager.set_contest(behaviour.contest);
+    handicap = behaviour.contest_handicap;
+
+    const unsigned new_reset_serial = task->get_contest_reset_serial();
+    const unsigned new_trace_time = task->get_trace().get_last_point().time;
+
+    if (new_reset_serial != reset_serial) {
+      /* the task manager was reset: drop the old search */
+      reset_serial = new_reset_serial;
+      result.reset();
+      contest_manager.reset();
+      searching = false;
+    } else if (!searching && new_trace_time == trace_time)
+      /* nothing new to solve */
+      return;
+
+    /* an unfinished search is resumed on the old copies */
+    if (!searching) {
+      task->copy_contest_traces(trace_full, trace_sprint);
+      trace_time = new_trace_time;
+    }
+  }
+
+  PeriodClock clock;
+  clock.update();
+
+  do {
+    contest_manager.update_idle();
+    searching = contest_manager.is_searching();
+  } while (searching && !is_stopped() && !clock.check(solve_budget));
+
+  if (searching)
+    return;
+
+  ProtectedTaskManager::ExclusiveLease task(task_manager);
+  task->set_contest_result(result, contest_manager.get_contest_solution(),
+                           reset_serial);
+}
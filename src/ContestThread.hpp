@@ -0,0 +1,76 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CONTEST_THREAD_HPP
+#define XCSOAR_CONTEST_THREAD_HPP
+
+#include "Thread/WorkerThread.hpp"
+#include "Trace/Trace.hpp"
+#include "Task/TaskStats/ContestResult.hpp"
+#include "Task/Tasks/ContestManager.hpp"
+
+class ProtectedTaskManager;
+
+/**
+ * The ContestThread solves the contest optimisation in the
+ * background, so the time taken by the CalculationThread does not
+ * depend on the complexity of the flight.
+ *
+ * Each run works on copies of the task manager's traces, so the task
+ * manager is only locked while the traces are copied and when the
+ * result is published.  The traces are copied again only when they
+ * have changed and the previous search is complete, or after the task
+ * manager was reset.  A run is limited to a time budget and stops
+ * early when the thread is stopped; an unfinished search is resumed
+ * by the next run.
+ */
+class ContestThread : public WorkerThread {
+  ProtectedTaskManager &task_manager;
+
+  /** Copies of the task manager's traces, which the solvers work on */
+  Trace trace_full;
+  Trace trace_sprint;
+
+  /** Contest handicap, referenced by the solvers */
+  unsigned handicap;
+
+  /** The task manager's reset serial when the traces were copied */
+  unsigned reset_serial;
+
+  /** Time of the last trace point when the traces were copied */
+  unsigned trace_time;
+
+  /** Has the last run left the search unfinished? */
+  bool searching;
+
+  ContestResult result;
+  ContestManager contest_manager;
+
+public:
+  ContestThread(ProtectedTaskManager &_task_manager);
+
+protected:
+  virtual void tick();
+};
+
+#endif
@@ -36,11 +36,14 @@ Copyright_License {
 #include "InputEvents.hpp"
 #include "Compatibility/string.h" /* for _ttoi() */
 #include "Units.hpp"
+#include "Compiler.h"
 
 #include <math.h>
 #include <ctype.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
 
 #include <algorithm>
 
@@ -76,6 +79,21 @@ NMEAParser::Reset(void)
   LastTime = fixed_zero;
 }
 
+/**
+ * Packs the four characters of a sentence name into an integer, for
+ * the switch statement in ParseNMEAString_Internal().
+ */
+#define NMEA_TAG(a, b, c, d) \
+  (((unsigned)(a) << 24) | ((unsigned)(b) << 16) | \
+   ((unsigned)(c) << 8) | (unsigned)(d))
+
+gcc_pure
+static unsigned
+ReadTag(const char *p)
+{
+  return NMEA_TAG(p[0], p[1], p[2], p[3]);
+}
+
 /**
  * Parses a provided NMEA String into a GPS_INFO struct
  * @param String NMEA string
@@ -85,56 +103,90 @@ NMEAParser::Reset(void)
 bool
 NMEAParser::ParseNMEAString_Internal(const char *String, NMEA_INFO *GPS_INFO)
 {
-  if (!NMEAChecksum(String))
+  const char *end = VerifyChecksum(String);
+  if (end == NULL)
     return false;
 
-  NMEAInputLine line(String);
+  NMEAInputLine line(String, end);
 
-  char type[16];
-  line.read(type, 16);
-
-  if (type[0] != '$')
+  /* the sentence name: "$" + talker + 3 letters, or "$P" + 4 letters
+     for proprietary sentences */
+  const char *type = line.rest();
+  if (line.skip() != 6 || type[0] != '$')
     return false;
 
   // if (proprietary sentence) ...
   if (type[1] == 'P') {
+    switch (ReadTag(type + 2)) {
     // Airspeed and vario sentence
-    if (strcmp(type + 1, "PTAS1") == 0)
+    case NMEA_TAG('T', 'A', 'S', '1'):
       return PTAS1(line, GPS_INFO);
 
     // FLARM sentences
-    if (strcmp(type + 1, "PFLAA") == 0)
+    case NMEA_TAG('F', 'L', 'A', 'A'):
       return PFLAA(line, GPS_INFO);
 
-    if (strcmp(type + 1, "PFLAU") == 0)
+    case NMEA_TAG('F', 'L', 'A', 'U'):
       return PFLAU(line, GPS_INFO->flarm);
 
     // Garmin altitude sentence
-    if (strcmp(type + 1, "PGRMZ") == 0)
+    case NMEA_TAG('G', 'R', 'M', 'Z'):
       return RMZ(line, GPS_INFO);
+    }
 
     return false;
   }
 
-  if (strcmp(type + 3, "GSA") == 0)
+  /* ignore the talker id */
+  switch (ReadTag(type + 2) & 0xffffff) {
+  case NMEA_TAG(0, 'G', 'S', 'A'):
     return GSA(line, GPS_INFO);
 
-  if (strcmp(type + 3, "GLL") == 0)
+  case NMEA_TAG(0, 'G', 'L', 'L'):
     //    return GLL(line, GPS_INFO);
     return true;
 
-  if (strcmp(type + 3, "RMB") == 0)
+  case NMEA_TAG(0, 'R', 'M', 'B'):
     return RMB(line, GPS_INFO);
 
-  if (strcmp(type + 3, "RMC") == 0)
+  case NMEA_TAG(0, 'R', 'M', 'C'):
     return RMC(line, GPS_INFO);
 
-  if (strcmp(type + 3, "GGA") == 0)
+  case NMEA_TAG(0, 'G', 'G', 'A'):
     return GGA(line, GPS_INFO);
+  }
 
   return false;
 }
 
+size_t
+NMEAParser::ParseNMEABuffer(const char *buffer, size_t length,
+                            NMEA_INFO *GPS_INFO)
+{
+  const char *p = buffer, *const end = buffer + length;
+
+  while (true) {
+    const char *eol = (const char *)memchr(p, '\n', end - p);
+    if (eol == NULL)
+      /* incomplete line, leave it for the next call */
+      return p - buffer;
+
+    size_t line_length = eol - p;
+    if (line_length > 0 && p[line_length - 1] == '\r')
+      --line_length;
+
+    if (line_length > 0 && line_length < MAX_NMEA_LEN && *p == '$') {
+      char line[MAX_NMEA_LEN];
+      memcpy(line, p, line_length);
+      line[line_length] = 0;
+
+      ParseNMEAString_Internal(line, GPS_INFO);
+    }
+
+    p = eol + 1;
+  }
+}
+
 /*
 static double
 LeftOrRight(double in, char LoR)
@@ -160,27 +212,51 @@ NAVWarn(char c)
 /**
  * Parses an angle in the form "DDDMM.SSS".  Minutes are 0..59, and
  * seconds are 0..999.
+ *
+ * The digits are parsed in place; minutes are collected in an integer
+ * and divided only once, which gives the same result as strtod().
  */
 static bool
 ReadPositiveAngle(NMEAInputLine &line, Angle &a)
 {
-  char buffer[32], *endptr;
-  line.read(buffer, sizeof(buffer));
+  const char *p = line.rest();
+  const char *const end = p + line.skip();
 
-  char *dot = strchr(buffer, '.');
-  if (dot < buffer + 3)
+  const char *dot = (const char *)memchr(p, '.', end - p);
+  if (dot == NULL || dot < p + 3)
     return false;
 
-  double x = strtod(dot - 2, &endptr);
-  if (x < 0 || x >= 60 || *endptr != 0)
+  const char *const minutes = dot - 2;
+
+  long degrees = 0;
+  for (; p < minutes; ++p) {
+    if (!isdigit((unsigned char)*p))
+      return false;
+    degrees = degrees * 10 + (*p - '0');
+  }
+
+  if (!isdigit((unsigned char)minutes[0]) ||
+      !isdigit((unsigned char)minutes[1]))
     return false;
 
-  dot[-2] = 0;
-  long y = strtol(buffer, &endptr, 10);
-  if (y < 0 || endptr == buffer || *endptr != 0)
+  /* more than 13 decimals don't fit in the mantissa of a double */
+  uint64_t mantissa = (minutes[0] - '0') * 10 + (minutes[1] - '0');
+  double divisor = 1;
+  for (p = dot + 1; p < end; ++p) {
+    if (!isdigit((unsigned char)*p))
+      return false;
+
+    if (p - dot <= 13) {
+      mantissa = mantissa * 10 + (*p - '0');
+      divisor *= 10;
+    }
+  }
+
+  const double x = (double)mantissa / divisor;
+  if (x >= 60)
     return false;
 
-  a = Angle::degrees(fixed(y) + fixed(x) / 60);
+  a = Angle::degrees(fixed(degrees) + fixed(x) / 60);
   return true;
 }
 
@@ -752,50 +828,61 @@ NMEAParser::RMA(NMEAInputLine &line, NMEA_INFO *GPS_INFO)
 }
 
 /**
- * Calculates the checksum of the provided NMEA string and
- * compares it to the provided checksum
- * @param String NMEA string
- * @return True if checksum correct
+ * Converts a checksum character to its value.  Invalid characters
+ * count as zero.
  */
-bool
-NMEAParser::NMEAChecksum(const char *String)
+gcc_const
+static unsigned char
+ChecksumDigit(char c)
 {
-  if (ignore_checksum)
-    return true;
+  if (c >= '0' && c <= '9')
+    return (unsigned char)(c - '0');
 
-  unsigned char ReadCheckSum, CalcCheckSum;
-  char c1, c2;
-  unsigned char v1 = 0, v2 = 0;
-  const char *pEnd;
+  if (isalpha((unsigned char)c))
+    return (unsigned char)(c - 'A' + 10);
 
-  pEnd = strchr(String, '*');
-  if(pEnd == NULL)
-    return false;
+  return 0;
+}
 
-  if (strlen(pEnd) < 3)
-    return false;
+const char *
+NMEAParser::VerifyChecksum(const char *String)
+{
+  if (*String == 0)
+    return ignore_checksum ? String : NULL;
+
+  /* calculate the checksum while looking for the asterisk; the first
+     character ('$') is not included */
+  unsigned char CalcCheckSum = 0;
+  const char *pEnd = String + 1;
+  for (; *pEnd != '*'; ++pEnd) {
+    if (*pEnd == 0)
+      return ignore_checksum ? pEnd : NULL;
+
+    CalcCheckSum ^= *pEnd;
+  }
 
-  c1 = pEnd[1], c2 = pEnd[2];
+  if (ignore_checksum)
+    return pEnd;
 
-  // what's this for?
-  // iswdigit('0');
+  if (pEnd[1] == 0 || pEnd[2] == 0)
+    return NULL;
 
-  if (_istdigit(c1))
-    v1 = (unsigned char)(c1 - '0');
-  if (_istdigit(c2))
-    v2 = (unsigned char)(c2 - '0');
-  if (_istalpha(c1))
-    v1 = (unsigned char)(c1 - 'A' + 10);
-  if (_istalpha(c2))
-    v2 = (unsigned char)(c2 - 'A' + 10);
+  const unsigned char ReadCheckSum = (unsigned char)
+    ((ChecksumDigit(pEnd[1]) << 4) + ChecksumDigit(pEnd[2]));
 
-  ReadCheckSum = (unsigned char)((v1 << 4) + v2);
-  CalcCheckSum = ::NMEAChecksum(String + 1, pEnd - String - 1);
+  return CalcCheckSum == ReadCheckSum ? pEnd : NULL;
+}
 
-  if (CalcCheckSum == ReadCheckSum)
-    return true;
-  else
-    return false;
+/**
+ * Calculates the checksum of the provided NMEA string and
+ * compares it to the provided checksum
+ * @param String NMEA string
+ * @return True if checksum correct
+ */
+bool
+NMEAParser::NMEAChecksum(const char *String)
+{
+  return VerifyChecksum(String) != NULL;
 }
 
 /**
@@ -947,18 +1034,19 @@ NMEAParser::PFLAA(NMEAInputLine &line, NMEA_INFO *GPS_INFO)
   traffic.ClimbRate = line.read(fixed_zero);
   traffic.Type = (FLARM_TRAFFIC::AircraftType)line.read(0);
 
+  if (!traffic.ID.defined())
+    // a target without a valid id cannot be tracked
+    return true;
+
   FLARM_TRAFFIC *flarm_slot = flarm.FindTraffic(traffic.ID);
   if (flarm_slot == NULL) {
-    flarm_slot = flarm.AllocateTraffic();
-    if (flarm_slot == NULL)
-      // no more slots available
-      return true;
-
-    flarm_slot->ID = traffic.ID;
+    // evicts the oldest target if all slots are in use
+    flarm_slot = flarm.AllocateTraffic(traffic.ID);
 
     flarm.NewTraffic = true;
     InputEvents::processGlideComputer(GCE_FLARM_NEWTRAFFIC);
-  }
+  } else
+    flarm.TouchTraffic(*flarm_slot);
 
   // set time of fix to current time
   flarm_slot->Time_Fix = GPS_INFO->Time;
@@ -987,9 +1075,10 @@ NMEAParser::PFLAA(NMEAInputLine &line, NMEA_INFO *GPS_INFO)
   // alt
   flarm_slot->Altitude = flarm_slot->RelativeAltitude + GPS_INFO->GPSAltitude;
 
-  flarm_slot->Average30s = flarmCalculations.Average30s(flarm_slot->ID,
-                                                        GPS_INFO->Time,
-                                                        flarm_slot->Altitude);
+  flarm_slot->Average30s =
+    flarmCalculations.Average30s(flarm.TrafficIndex(flarm_slot),
+                                 flarm_slot->ID, GPS_INFO->Time,
+                                 flarm_slot->Altitude);
 
   return true;
 }
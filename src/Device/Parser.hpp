@@ -26,6 +26,8 @@ Copyright_License {
 
 #include "Math/fixed.hpp"
 
+#include <stddef.h>
+
 struct FLARM_STATE;
 struct NMEA_INFO;
 struct BrokenDateTime;
@@ -40,7 +42,25 @@ public:
   NMEAParser();
   void Reset(void);
 
+  /**
+   * The maximum length of a line accepted by ParseNMEABuffer(),
+   * including the null terminator.
+   */
+  static const size_t MAX_NMEA_LEN = 256;
+
   bool ParseNMEAString_Internal(const char *line, NMEA_INFO *GPS_INFO);
+
+  /**
+   * Parses all complete lines in the buffer (terminated by LF or CR
+   * LF), as if each one was passed to ParseNMEAString_Internal().
+   * Lines which don't start with '$' or which are too long are
+   * skipped.  This doesn't allocate memory.
+   *
+   * @return the number of bytes consumed; the rest is an incomplete
+   * line which should be passed again when more data is available
+   */
+  size_t ParseNMEABuffer(const char *buffer, size_t length,
+                         NMEA_INFO *GPS_INFO);
   bool gpsValid;
 
   bool activeGPS;
@@ -61,6 +81,15 @@ public:
   static bool NMEAChecksum(const char *String);
 
 private:
+  /**
+   * Verifies the checksum and finds the end of the data in one pass.
+   *
+   * @return the position of the asterisk (or of the end of the string
+   * if checksums are ignored), or NULL if the checksum is missing or
+   * wrong
+   */
+  static const char *VerifyChecksum(const char *String);
+
   bool GSAAvailable;
   bool GGAAvailable;
   bool RMZAvailable;
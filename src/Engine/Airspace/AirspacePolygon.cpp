@@ -59,11 +59,20 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint>& pts,
   }
 }
 
+AirspacePolygon::AirspacePolygon(const SearchPointVector &border,
+                                 const bool convex)
+  :AbstractAirspace(POLYGON),
+   m_border(border),
+   m_is_convex(convex)
+{
+}
+
 
 void
 AirspacePolygon::project(const TaskProjection &task_projection)
 {
   ::project(m_border, task_projection);
+  m_index.update(m_border);
 }
 
 
@@ -114,10 +123,40 @@ AirspacePolygon::get_bounding_box(const TaskProjection& task_projection)
 bool 
 AirspacePolygon::inside(const GeoPoint &loc) const
 {
-  return PolygonInterior(loc, m_border);
+  if (m_index.empty())
+    return PolygonInterior(loc, m_border);
+
+  /* only edges crossing the latitude of the location can change the
+     winding number, and these are all in its band */
+  const unsigned band =
+    m_index.get_band(m_task_projection->project(loc).Latitude);
+  return PolygonInterior(loc, m_border,
+                         m_index.begin(band), m_index.end(band));
 }
 
 
+static void
+add_intersection(AirspaceIntersectSort &sorter, const FlatRay &ray,
+                 const SearchPoint &a, const SearchPoint &b,
+                 const TaskProjection &task_projection)
+{
+  const FlatGeoPoint &fa = a.get_flatLocation(), &fb = b.get_flatLocation();
+
+  // cheap rejection of edges beside the ray
+  const int lon_end = ray.point.Longitude + ray.vector.Longitude;
+  if (max(fa.Longitude, fb.Longitude) < min(ray.point.Longitude, lon_end) ||
+      min(fa.Longitude, fb.Longitude) > max(ray.point.Longitude, lon_end))
+    return;
+
+  const FlatRay r_seg(fa, fb);
+
+  const fixed t = ray.intersects(r_seg);
+
+  if (t>=fixed_zero) {
+    sorter.add(t, task_projection.unproject(ray.parametric(t)));
+  }
+}
+
 AirspaceIntersectionVector
 AirspacePolygon::intersects(const GeoPoint& start, 
                             const GeoVector &vec) const
@@ -128,16 +167,30 @@ AirspacePolygon::intersects(const GeoPoint& start,
 
   AirspaceIntersectSort sorter(start, end, *this);
 
-  for (SearchPointVector::const_iterator it= m_border.begin();
-       it+1 != m_border.end(); ++it) {
+  if (m_index.empty()) {
+    for (SearchPointVector::const_iterator it= m_border.begin();
+         it+1 != m_border.end(); ++it)
+      add_intersection(sorter, ray, *it, *(it + 1), *m_task_projection);
 
-    const FlatRay r_seg(it->get_flatLocation(), 
-                        (it+1)->get_flatLocation());
+    return sorter.all();
+  }
 
-    const fixed t = ray.intersects(r_seg);
-    
-    if (t>=fixed_zero) {
-      sorter.add(t, m_task_projection->unproject(ray.parametric(t)));
+  // only visit the bands spanned by the ray
+  const int lat_end = ray.point.Latitude + ray.vector.Latitude;
+  const unsigned first =
+    m_index.get_band(min(ray.point.Latitude, lat_end));
+  const unsigned last =
+    m_index.get_band(max(ray.point.Latitude, lat_end));
+
+  for (unsigned band = first; band <= last; ++band) {
+    for (const unsigned *i = m_index.begin(band), *e = m_index.end(band);
+         i != e; ++i) {
+      // an edge spanning several bands is tested only once
+      if (band > first && !m_index.is_first_band(m_border, *i, band))
+        continue;
+
+      add_intersection(sorter, ray, m_border[*i], m_border[*i + 1],
+                       *m_task_projection);
     }
   }
   return sorter.all();
@@ -24,6 +24,7 @@
 
 #include "AbstractAirspace.hpp"
 #include "Navigation/SearchPointVector.hpp"
+#include "Navigation/ConvexHull/PolygonIndex.hpp"
 #include <vector>
 
 #ifdef DO_PRINT
@@ -50,6 +51,17 @@ public:
   AirspacePolygon(const std::vector<GeoPoint>& pts,
     const bool prune = false);
 
+  /**
+   * Constructor for a border which has been checked before, e.g. by
+   * loading it from a snapshot.
+   *
+   * @param border Closed border, as returned by get_points()
+   * @param convex Whether the border is convex, as returned by is_convex_border()
+   *
+   * @return Initialised airspace object
+   */
+  AirspacePolygon(const SearchPointVector &border, const bool convex);
+
   /** 
    * Compute bounding box enclosing the airspace.  Rounds up/down
    * so discretisation ensures bounding box is indeed enclosing.
@@ -100,12 +112,23 @@ public:
     return m_border;
   }
 
+  /**
+   * Accessor for the convexity of the border
+   * @return true if the border is convex
+   */
+  bool is_convex_border() const {
+    return m_is_convex;
+  }
+
 private:
   SearchPointVector m_border;
   bool m_is_convex;
 
+  /** Edge index of the projected border, rebuilt by project() */
+  PolygonIndex m_index;
+
 /** 
- * Project border.
+ * Project border and rebuild the edge index.
  */
   virtual void project(const TaskProjection& tp);
 
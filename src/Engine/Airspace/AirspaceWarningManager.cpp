@@ -28,6 +28,11 @@
 #include "AirspaceWarningVisitor.hpp"
 #include "Task/TaskManager.hpp"
 
+/**
+ * Minimum radius (m) of the neighbourhood set.  The set is re-queried
+ * when the aircraft has travelled about this far.
+ */
+static const fixed NEIGHBOURHOOD_RANGE(20000);
 
 AirspaceWarningManager::AirspaceWarningManager(const Airspaces& airspaces,
                                                const AIRCRAFT_STATE &state,
@@ -41,7 +46,10 @@ AirspaceWarningManager::AirspaceWarningManager(const Airspaces& airspaces,
   m_state_filter(state, prediction_time_filter),
   m_perf_filter(m_state_filter),
   m_task(task_manager),
-  m_glide_polar(task_manager.get_glide_polar())
+  m_glide_polar(task_manager.get_glide_polar()),
+  m_coherent(true),
+  m_neighbourhood_range(0),
+  m_neighbourhood_serial(0)
 {
 }
 
@@ -59,6 +67,8 @@ AirspaceWarningManager::reset(const AIRCRAFT_STATE& state)
 {
   m_warnings.clear();
   m_state_filter.reset(state);
+  m_neighbours.clear();
+  m_neighbourhood_range = 0;
 }
 
 void 
@@ -74,6 +84,83 @@ AirspaceWarningManager::set_prediction_time_filter(const fixed& the_time)
   m_state_filter.design(m_prediction_time_filter); // or multiple of?
 }
 
+void
+AirspaceWarningManager::set_coherent(const bool coherent)
+{
+  m_coherent = coherent;
+  m_neighbours.clear();
+  m_neighbourhood_range = 0;
+}
+
+bool
+AirspaceWarningManager::neighbourhood_covers(const FlatGeoPoint &location) const
+{
+  if (m_neighbourhood_range == 0 ||
+      m_neighbourhood_serial != m_airspaces.get_serial())
+    return false;
+
+  // distance_to() rounds down
+  return location.distance_to(m_neighbourhood_center) + 1 <
+    m_neighbourhood_range;
+}
+
+void
+AirspaceWarningManager::update_neighbourhood(const GeoPoint &location,
+                                             const fixed range)
+{
+  const TaskProjection &projection = m_airspaces.get_task_projection();
+
+  m_neighbours = m_airspaces.scan_range(location, range);
+  m_neighbourhood_center = projection.project(location);
+  m_neighbourhood_range = projection.project_range(location, range);
+  m_neighbourhood_serial = m_airspaces.get_serial();
+}
+
+/**
+ * Visits the airspaces intersected by the vector, like
+ * Airspaces::visit_intersecting(), but takes them from the
+ * neighbourhood set if the vector is within it.  The set is only
+ * re-queried if may_update is set, so long occasional vectors don't
+ * replace it.
+ */
+void
+AirspaceWarningManager::visit_intersecting(const GeoPoint &location,
+                                           const GeoVector &vec,
+                                           AirspaceIntersectionVisitor &visitor,
+                                           const bool may_update)
+{
+  if (!m_coherent) {
+    m_airspaces.visit_intersecting(location, vec, visitor);
+    return;
+  }
+
+  const TaskProjection &projection = m_airspaces.get_task_projection();
+  const FlatGeoPoint start = projection.project(location);
+  const FlatGeoPoint end = projection.project(vec.end_point(location));
+
+  if (!neighbourhood_covers(start) || !neighbourhood_covers(end)) {
+    if (!may_update) {
+      m_airspaces.visit_intersecting(location, vec, visitor);
+      return;
+    }
+
+    update_neighbourhood(location, max(NEIGHBOURHOOD_RANGE, vec.Distance * 2));
+    if (!neighbourhood_covers(end)) {
+      m_airspaces.visit_intersecting(location, vec, visitor);
+      return;
+    }
+  }
+
+  /* the segment lies within the neighbourhood, so every airspace
+     whose bounding box it intersects is in the set */
+  const FlatRay ray(start, end);
+  for (AirspacesInterface::AirspaceVector::const_iterator it =
+         m_neighbours.begin(); it != m_neighbours.end(); ++it)
+    if (it->intersects(ray) &&
+        visitor.set_intersections(it->intersects(location, vec)))
+      visitor.Visit(*it);
+}
+
 AirspaceWarning& 
 AirspaceWarningManager::get_warning(const AbstractAirspace& airspace)
 {
@@ -279,7 +366,8 @@ AirspaceWarningManager::update_predicted(const AIRCRAFT_STATE& state,
                                              ceiling);
 
   GeoVector vector_predicted(state.Location, location_predicted);
-  m_airspaces.visit_intersecting(state.Location, vector_predicted, visitor);
+  visit_intersecting(state.Location, vector_predicted, visitor,
+                     warning_state != AirspaceWarning::WARNING_TASK);
 
   return visitor.found();
 }
@@ -335,7 +423,22 @@ AirspaceWarningManager::update_inside(const AIRCRAFT_STATE& state)
 
   AirspacePredicateAircraftInside condition(state);
 
-  Airspaces::AirspaceVector results = m_airspaces.find_inside(state, condition);
+  Airspaces::AirspaceVector results;
+  if (m_coherent) {
+    const FlatGeoPoint location =
+      m_airspaces.get_task_projection().project(state.Location);
+    if (!neighbourhood_covers(location))
+      update_neighbourhood(state.Location, NEIGHBOURHOOD_RANGE);
+
+    const FlatBoundingBox box(location);
+    for (Airspaces::AirspaceVector::const_iterator it = m_neighbours.begin();
+         it != m_neighbours.end(); ++it)
+      if (it->overlaps(box) && condition(*it->get_airspace()) &&
+          it->inside(state))
+        results.push_back(*it);
+  } else
+    results = m_airspaces.find_inside(state, condition);
+
   for (Airspaces::AirspaceVector::iterator it = results.begin();
        it != results.end(); ++it) {
 
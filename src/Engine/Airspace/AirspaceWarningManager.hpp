@@ -26,6 +26,7 @@
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
 #include "AirspaceAircraftPerformance.hpp"
+#include "AirspacesInterface.hpp"
 #include "Compiler.h"
 
 #include <list>
@@ -33,6 +34,7 @@
 class TaskManager;
 class Airspaces;
 class AirspaceWarningVisitor;
+class AirspaceIntersectionVisitor;
 
 /**
  * Class to detect and track airspace warnings
@@ -43,6 +45,11 @@ class AirspaceWarningVisitor;
  * - Filter (longer range predicted warning based on low pass filtered state)
  * - Task (longer range predicted warning based on current leg of task)
  *
+ * In coherent mode (the default), the airspaces near the aircraft are
+ * cached in a neighbourhood set, and the checks of each fix are run
+ * against this set only.  The set is re-queried from #Airspaces only
+ * when a check reaches beyond it, i.e. when the aircraft leaves the
+ * guard region, or when the airspaces change.
  */
 class AirspaceWarningManager: 
   public NonCopyable
@@ -107,6 +114,14 @@ public:
  */
   void set_prediction_time_filter(const fixed& the_time);
 
+/**
+ * Enable or disable the neighbourhood set.  If disabled, every check
+ * queries the #Airspaces tree.
+ *
+ * @param coherent Whether to use the neighbourhood set
+ */
+  void set_coherent(const bool coherent);
+
 /** 
  * Find corresponding airspace warning item in store for an airspace
  * 
@@ -224,6 +239,23 @@ private:
 
   const GlidePolar& m_glide_polar;
 
+  bool m_coherent;
+  /** Airspaces within #m_neighbourhood_range of #m_neighbourhood_center */
+  AirspacesInterface::AirspaceVector m_neighbours;
+  /** Flat location of the center of the neighbourhood */
+  FlatGeoPoint m_neighbourhood_center;
+  /** Flat radius of the neighbourhood; zero if not valid */
+  unsigned m_neighbourhood_range;
+  /** Airspaces::get_serial() at the time #m_neighbours was filled */
+  unsigned m_neighbourhood_serial;
+
+  gcc_pure
+  bool neighbourhood_covers(const FlatGeoPoint &location) const;
+  void update_neighbourhood(const GeoPoint &location, const fixed range);
+  void visit_intersecting(const GeoPoint &location, const GeoVector &vec,
+                          AirspaceIntersectionVisitor &visitor,
+                          const bool may_update);
+
   bool update_task(const AIRCRAFT_STATE& state);
   bool update_filter(const AIRCRAFT_STATE& state);
   bool update_glide(const AIRCRAFT_STATE& state);
@@ -212,6 +212,7 @@ Airspaces::optimise()
       tmp_as.pop_front();
     }
     airspace_tree.optimise();
+    ++serial;
   }
 }
 
@@ -249,6 +250,7 @@ Airspaces::clear()
 
   // then delete the tree
   airspace_tree.clear();
+  ++serial;
 }
 
 unsigned
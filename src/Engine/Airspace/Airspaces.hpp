@@ -69,7 +69,7 @@ public:
    * 
    * @return empty Airspaces class.
    */
-  Airspaces():m_QNH(0)
+  Airspaces():m_QNH(0), serial(0)
     {
     };
 
@@ -209,12 +209,30 @@ public:
  */
   AirspaceTree::const_iterator end() const;
 
+/**
+ * Returns a number which changes whenever airspaces are added or
+ * removed, or the projection is changed.  Callers caching #Airspace
+ * envelopes must discard them when this changes.
+ */
+  unsigned get_serial() const {
+    return serial;
+  }
+
+/**
+ * Access the projection used for the flat-earth envelopes of all
+ * airspaces in the tree.
+ */
+  const TaskProjection &get_task_projection() const {
+    return task_projection;
+  }
+
   void lock() const {};
   void unlock() const {};
 
 private:
 
   fixed m_QNH;
+  unsigned serial;
 
   AirspaceTree airspace_tree;
   TaskProjection task_projection;
@@ -26,11 +26,14 @@
 void 
 Airspaces::set_ground_levels(const RasterTerrain &terrain)
 {
+  // one lease for all airspaces, instead of one per lookup
+  RasterTerrain::Lease map(terrain);
+
   for (AirspaceTree::iterator v = airspace_tree.begin();
        v != airspace_tree.end(); ++v) {
     FlatGeoPoint c_flat = v->get_center();
     GeoPoint g = task_projection.unproject(c_flat);
-    short h = terrain.GetTerrainHeight(g);
+    short h = map->GetField(g);
     if (!RasterBuffer::is_special(h))
       v->set_ground_level((fixed)h);
   }
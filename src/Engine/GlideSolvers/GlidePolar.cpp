@@ -335,12 +335,59 @@ GlidePolar::speed_to_fly(const AIRCRAFT_STATE &state,
     const fixed stf_sink_rate (block_stf ? fixed_zero : -state.NettoVario);
 
     GlidePolarSpeedToFly gp_stf(*this, stf_sink_rate, head_wind, Vmin, Vmax);
-    V_stf = gp_stf.solve(Vmax);
+    const fixed V_guess = get_VOpt(head_wind, fixed_zero, fixed_one,
+                                   stf_sink_rate);
+    V_stf = gp_stf.solve(positive(V_guess) ? V_guess - head_wind : Vmax);
   }
 
   return max(Vmin, V_stf*g_scaling);
 }
 
+fixed
+GlidePolar::get_VOpt(const fixed head_wind, const fixed cross_wind,
+                     const fixed efficiency, const fixed net_sink_rate) const
+{
+  // minimise (S(V) + mc + net_sink_rate) / Vn(V) with the parabolic
+  // polar S(V) = a*V*V + b*V + c and the speed over ground
+  // Vn(V) = sqrt(efficiency^2*V^2 - cross_wind^2) - head_wind
+
+  const fixed sink_offset = mc + net_sink_rate;
+
+  // without cross wind, Vn(V) is linear and the solution is exact
+  const fixed d = head_wind * head_wind + efficiency *
+    (polar_b * head_wind + efficiency * (polar_c + sink_offset)) / polar_a;
+  if (negative(d))
+    return fixed_zero;
+
+  fixed V = (head_wind + sqrt(d)) / efficiency;
+  if (!positive(fabs(cross_wind)))
+    return V;
+
+  // Newton iterations on S'(V) * Vn(V) - (S(V) + sink_offset) * Vn'(V)
+  const fixed e2 = efficiency * efficiency;
+  const fixed cw2 = cross_wind * cross_wind;
+  for (unsigned i = 0; i < 2; ++i) {
+    const fixed r2 = e2 * V * V - cw2;
+    if (!positive(r2))
+      break;
+
+    const fixed r = sqrt(r2);
+    const fixed vn = r - head_wind;
+    if (!positive(vn))
+      break;
+
+    const fixed s = SinkRate(V) + sink_offset;
+    const fixed f = (fixed_two * polar_a * V + polar_b) * vn - s * e2 * V / r;
+    const fixed df = fixed_two * polar_a * vn + s * e2 * cw2 / (r2 * r);
+    if (!positive(df))
+      break;
+
+    V -= f / df;
+  }
+
+  return V;
+}
+
 fixed
 GlidePolar::get_all_up_weight() const
 {
@@ -404,9 +451,18 @@ GlidePolar::get_ld_over_ground(const AIRCRAFT_STATE &state) const
     return bestLD;
 
   const fixed c_theta = (state.wind.bearing - state.TrackBearing).cos();
+  return get_ld_over_ground(state.wind.norm, c_theta);
+}
+
+fixed
+GlidePolar::get_ld_over_ground(const fixed wind_speed,
+                               const fixed cos_wind_track) const
+{
+  if (!positive(wind_speed))
+    return bestLD;
 
-  Quadratic q(-fixed_two * state.wind.norm * c_theta,
-              state.wind.norm * state.wind.norm - bestLD * bestLD);
+  Quadratic q(-fixed_two * wind_speed * cos_wind_track,
+              wind_speed * wind_speed - bestLD * bestLD);
 
   if (q.check())
     return max(fixed_zero, q.solution_max());
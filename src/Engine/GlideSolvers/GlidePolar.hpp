@@ -357,6 +357,27 @@ public:
   fixed speed_to_fly(const AIRCRAFT_STATE &state, const GlideResult &solution,
       const bool block_stf) const;
 
+  /**
+   * Calculate the airspeed which minimises the MacCready-adjusted
+   * sink per distance over ground.  This is the analytic solution
+   * for the parabolic polar (refined by Newton iterations if there is
+   * cross wind), and is used as initial guess by the speed-to-fly
+   * searches, which accept it without iterating if it is within
+   * their tolerance.
+   *
+   * @param head_wind Head wind component (m/s)
+   * @param cross_wind Cross wind component (m/s)
+   * @param efficiency Ratio of the effective airspeed to the airspeed
+   * @param net_sink_rate Sink rate of the air mass (m/s), positive down
+   *
+   * @return Airspeed (m/s), or zero if there is no solution
+   */
+  gcc_pure
+  fixed get_VOpt(const fixed head_wind,
+                 const fixed cross_wind = fixed_zero,
+                 const fixed efficiency = fixed_one,
+                 const fixed net_sink_rate = fixed_zero) const;
+
   /**
    * Compute MacCready ring setting to adjust speeds to incorporate
    * risk as the aircraft gets low.
@@ -377,6 +398,19 @@ public:
    */
   fixed get_ld_over_ground(const AIRCRAFT_STATE &state) const;
 
+  /**
+   * Find LD relative to ground for a track whose direction is given
+   * by the cosine of its angle to the wind bearing.  This saves the
+   * trigonometry when many tracks are calculated.
+   *
+   * @param wind_speed Wind speed (m/s)
+   * @param cos_wind_track Cosine of (wind bearing - track bearing)
+   *
+   * @return LD ratio (distance travelled per unit height loss)
+   */
+  fixed get_ld_over_ground(const fixed wind_speed,
+                           const fixed cos_wind_track) const;
+
   /**
    * Find speed to produce a specified sink rate
    *
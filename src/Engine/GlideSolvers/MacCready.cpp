@@ -279,7 +279,10 @@ public:
   GlideResult
   result(const fixed &vinit)
   {
-    find_min(vinit);
+    const fixed V = find_min(vinit);
+    if (V != res.VOpt)
+      // the last evaluation was not at the minimum
+      f(V);
     return res;
   }
 
@@ -297,7 +300,11 @@ MacCready::optimise_glide(const GlideState &task, const bool allow_partial) cons
   MacCreadyVopt mcvopt(task, *this, glide_polar.get_Vmin(),
       glide_polar.get_Vmax(), allow_partial);
 
-  return mcvopt.result(glide_polar.get_Vmin());
+  const fixed cross_wind =
+    sqrt(max(fixed_zero, task.wsq_ - task.HeadWind * task.HeadWind));
+  const fixed V_guess = glide_polar.get_VOpt(task.HeadWind, cross_wind,
+                                             cruise_efficiency);
+  return mcvopt.result(positive(V_guess) ? V_guess : glide_polar.get_Vmin());
 }
 
 /*
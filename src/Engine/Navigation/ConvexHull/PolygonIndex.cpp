@@ -0,0 +1,103 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+#include "PolygonIndex.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+/**
+ * Average number of edges per band.  Edges of real airspace polygons
+ * are short compared to the polygon, so the band lists stay close to
+ * this size plus the number of times the border crosses a band.
+ */
+static const unsigned EDGES_PER_BAND = 4;
+
+/** Polygons with fewer edges are not indexed */
+static const unsigned MIN_INDEX_EDGES = 16;
+
+static const unsigned MAX_BANDS = 4096;
+
+void
+PolygonIndex::clear()
+{
+  band_start.clear();
+  edges.clear();
+}
+
+void
+PolygonIndex::update(const SearchPointVector &border)
+{
+  clear();
+
+  if (border.size() <= MIN_INDEX_EDGES)
+    return;
+
+  const unsigned num_edges = border.size() - 1;
+
+  int lat_max = lat_min = border[0].get_flatLocation().Latitude;
+  for (SearchPointVector::const_iterator i = border.begin();
+       i != border.end(); ++i) {
+    lat_min = std::min(lat_min, i->get_flatLocation().Latitude);
+    lat_max = std::max(lat_max, i->get_flatLocation().Latitude);
+  }
+
+  const unsigned height = lat_max - lat_min + 1;
+  unsigned n = std::min(std::max(num_edges / EDGES_PER_BAND, 1u), MAX_BANDS);
+  band_height = (height + n - 1) / n;
+  n = (height + band_height - 1) / band_height;
+
+  /* count the edges per band, then fill them in; this keeps the edges
+     of each band in ascending order */
+  band_start.assign(n + 1, 0);
+  for (unsigned i = 0; i < num_edges; ++i) {
+    const int a = border[i].get_flatLocation().Latitude;
+    const int b = border[i + 1].get_flatLocation().Latitude;
+    const unsigned last = get_band(std::max(a, b));
+    for (unsigned band = get_band(std::min(a, b)); band <= last; ++band)
+      ++band_start[band + 1];
+  }
+
+  for (unsigned band = 0; band < n; ++band)
+    band_start[band + 1] += band_start[band];
+
+  edges.resize(band_start[n]);
+  std::vector<unsigned> fill(band_start.begin(), band_start.end() - 1);
+  for (unsigned i = 0; i < num_edges; ++i) {
+    const int a = border[i].get_flatLocation().Latitude;
+    const int b = border[i + 1].get_flatLocation().Latitude;
+    const unsigned last = get_band(std::max(a, b));
+    for (unsigned band = get_band(std::min(a, b)); band <= last; ++band)
+      edges[fill[band]++] = i;
+  }
+}
+
+unsigned
+PolygonIndex::get_band(int latitude) const
+{
+  assert(!empty());
+
+  if (latitude <= lat_min)
+    return 0;
+
+  const unsigned band = (unsigned)(latitude - lat_min) / band_height;
+  return std::min(band, num_bands() - 1);
+}
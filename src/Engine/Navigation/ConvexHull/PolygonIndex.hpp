@@ -0,0 +1,105 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+#ifndef POLYGON_INDEX_HPP
+#define POLYGON_INDEX_HPP
+
+#include "Navigation/SearchPointVector.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+/**
+ * Edge-bucket index of a closed polygon in flat projected
+ * coordinates.  The latitude range of the polygon is split into
+ * horizontal bands, and each band lists the edges whose latitude
+ * span overlaps it.  A horizontal line through a point can only cross
+ * edges of the band containing the point, so point-in-polygon tests
+ * need to look at these edges only, and segment queries only at the
+ * bands spanned by the segment.
+ *
+ * Since the flat latitude is a monotonic function of the geodetic
+ * latitude, queries using the index give exactly the same results as
+ * a scan of all edges.
+ */
+class PolygonIndex {
+  /** Flat latitude of the bottom of the first band */
+  int lat_min;
+  /** Height of each band (flat units) */
+  unsigned band_height;
+  /** Offset of the first edge of each band in #edges, plus the end */
+  std::vector<unsigned> band_start;
+  /** Edge numbers (the edge from vertex i to i+1), grouped by band */
+  std::vector<unsigned> edges;
+
+public:
+  PolygonIndex():lat_min(0), band_height(1) {}
+
+  /**
+   * Rebuilds the index from the flat locations of a closed polygon
+   * (last vertex equal to the first).  The points must have been
+   * projected.
+   */
+  void update(const SearchPointVector &border);
+
+  void clear();
+
+  /**
+   * Is the index empty?  This is the case before update() and for
+   * degenerate polygons; callers should then scan all edges.
+   */
+  bool empty() const {
+    return band_start.empty();
+  }
+
+  unsigned num_bands() const {
+    return band_start.size() - 1;
+  }
+
+  /**
+   * Returns the band containing the specified flat latitude, clipped
+   * to the range of the polygon.
+   */
+  gcc_pure
+  unsigned get_band(int latitude) const;
+
+  /**
+   * Is this the lowest band listing the specified edge?  When
+   * iterating over several bands, an edge should be processed in the
+   * first band of the query, or else in its own lowest band only.
+   */
+  bool is_first_band(const SearchPointVector &border, unsigned edge,
+                     unsigned band) const {
+    const int bottom = lat_min + (int)(band * band_height);
+    return border[edge].get_flatLocation().Latitude >= bottom &&
+      border[edge + 1].get_flatLocation().Latitude >= bottom;
+  }
+
+  const unsigned *begin(unsigned band) const {
+    return &edges[0] + band_start[band];
+  }
+
+  const unsigned *end(unsigned band) const {
+    return &edges[0] + band_start[band + 1];
+  }
+};
+
+#endif
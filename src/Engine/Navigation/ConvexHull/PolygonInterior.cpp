@@ -45,6 +45,25 @@ isLeft( const GeoPoint &P0, const GeoPoint &P1, const GeoPoint &P2 )
 }
 //===================================================================
 
+/**
+ * Contribution of the edge from P0 to P1 to the winding number of P
+ */
+inline static int
+Winding(const GeoPoint &P0, const GeoPoint &P1, const GeoPoint &P)
+{
+  if (P0.Latitude <= P.Latitude) {         // start y <= P.Latitude
+    if (P1.Latitude > P.Latitude)          // an upward crossing
+      if (isLeft(P0, P1, P) > 0)           // P left of edge
+        return 1;                          // have a valid up intersect
+  }
+  else {                                   // start y > P.Latitude (no test needed)
+    if (P1.Latitude <= P.Latitude)         // a downward crossing
+      if (isLeft(P0, P1, P) < 0)           // P right of edge
+        return -1;                         // have a valid down intersect
+  }
+  return 0;
+}
+
 // PolygonInterior(): winding number interior test for a point in a polygon
 //      Input:   P = a point,
 //               V[] = vertex points of a polygon V[n+1] with V[n]=V[0]
@@ -61,19 +80,22 @@ PolygonInterior( const GeoPoint &P, const std::vector<SearchPoint>& V)
   int    wn = 0;    // the winding number counter
 
   // loop through all edges of the polygon
-  for (int i=0; i<n; i++) {   // edge from V[i] to V[i+1]
-    if (V[i].get_location().Latitude <= P.Latitude) {         // start y <= P.Latitude
-      if (V[i+1].get_location().Latitude > P.Latitude)      // an upward crossing
-        if (isLeft( V[i].get_location(), V[i+1].get_location(), P)>0)  // P left of edge
-          ++wn;            // have a valid up intersect
-    }
-    else {                       // start y > P.Latitude (no test needed)
-      if (V[i+1].get_location().Latitude <= P.Latitude)     // a downward crossing
-        if (isLeft( V[i].get_location(), V[i+1].get_location(), P)<0)  // P right of edge
-          --wn;            // have a valid down intersect
-    }
-  }
+  for (int i=0; i<n; i++)    // edge from V[i] to V[i+1]
+    wn += Winding(V[i].get_location(), V[i+1].get_location(), P);
+
   return wn != 0;
 }
 
+bool
+PolygonInterior(const GeoPoint &P, const std::vector<SearchPoint>& V,
+                const unsigned *edges, const unsigned *edges_end)
+{
+  if (V.size() < 3)
+    return false;
 
+  int wn = 0;
+  for (; edges != edges_end; ++edges)
+    wn += Winding(V[*edges].get_location(), V[*edges + 1].get_location(), P);
+
+  return wn != 0;
+}
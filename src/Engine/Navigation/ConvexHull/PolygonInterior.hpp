@@ -29,4 +29,14 @@
 gcc_pure bool
 PolygonInterior( const GeoPoint &P, const std::vector<SearchPoint>& V);
 
+/**
+ * Winding number interior test which considers only the specified
+ * edges (edge i runs from V[i] to V[i+1]).  The list must contain at
+ * least all edges which cross the latitude of P, e.g. a band of a
+ * #PolygonIndex.
+ */
+gcc_pure bool
+PolygonInterior(const GeoPoint &P, const std::vector<SearchPoint>& V,
+                const unsigned *edges, const unsigned *edges_end);
+
 #endif
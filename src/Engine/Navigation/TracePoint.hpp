@@ -117,7 +117,7 @@ public:
      * 
      * @return True if s1 is earlier than s2
      */
-    bool operator()(const TracePoint& s1, const TracePoint& s2) {
+    bool operator()(const TracePoint& s1, const TracePoint& s2) const {
       return s1.time < s2.time;
     }
   };
@@ -39,6 +39,9 @@ TaskManager::TaskManager(TaskEvents &te,
   contest_manager(task_behaviour.contest, 
                   task_behaviour.contest_handicap,
                   common_stats.olc, trace_full, trace_sprint),
+  contest_background(false),
+  contest_flying(false),
+  contest_reset_serial(0),
   mode(MODE_NULL),
   active_task(NULL) {}
 
@@ -293,18 +296,12 @@ TaskManager::update_idle(const AIRCRAFT_STATE& state)
 {
   bool retval = false;
 
-  if (state.Flying) {
-    // Update the Traces even if contest
-    // optimization is not _currently_ enabled
-    if (task_behaviour.enable_olc || task_behaviour.enable_trace)
-      retval |= trace_full.optimise_if_old();
-
-    if (task_behaviour.enable_olc)
-      retval |= trace_sprint.optimise_if_old();
+  contest_flying = state.Flying;
 
+  if (state.Flying) {
     // If contest optimization is enabled
     // -> Optimize
-    if (task_behaviour.enable_olc)
+    if (task_behaviour.enable_olc && !contest_background)
       retval |= contest_manager.update_idle();
   }
 
@@ -350,12 +347,33 @@ TaskManager::reset()
   task_goto.reset();
   task_abort.reset();
   contest_manager.reset();
+  contest_solution.clear();
+  ++contest_reset_serial;
   common_stats.reset();
   m_glide_polar.set_cruise_efficiency(fixed_one);
   trace_full.clear();
   trace_sprint.clear();
 }
 
+void
+TaskManager::copy_contest_traces(Trace &full, Trace &sprint) const
+{
+  full.assign(trace_full);
+  sprint.assign(trace_sprint);
+}
+
+void
+TaskManager::set_contest_result(const ContestResult &result,
+                                const TracePointVector &solution,
+                                unsigned reset_serial)
+{
+  if (reset_serial != contest_reset_serial)
+    return;
+
+  common_stats.olc = result;
+  contest_solution = solution;
+}
+
 unsigned 
 TaskManager::task_size() const
 {
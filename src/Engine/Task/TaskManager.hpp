@@ -373,6 +373,61 @@ public:
     contest_manager.set_contest(contest);
   }
 
+  /**
+   * Select whether contests are solved by update_idle(), or by an
+   * external solver (e.g. a background thread) which works on copies
+   * of the traces and stores its result with set_contest_result().
+   *
+   * @param background True if contests are solved externally
+   */
+  void set_contest_background(const bool background) {
+    contest_background = background;
+  }
+
+  /**
+   * Should an external solver work on the contest?  Like
+   * update_idle(), this requires contest optimisation to be enabled
+   * and the aircraft to have been flying at the last update_idle().
+   *
+   * @return True if the contest shall be solved
+   */
+  bool is_contest_active() const {
+    return task_behaviour.enable_olc && contest_flying;
+  }
+
+  /**
+   * Retrieve the number of resets of the task manager.  An external
+   * solver remembers this value when copying the traces, and passes
+   * it to set_contest_result().
+   *
+   * @return Reset serial
+   */
+  unsigned get_contest_reset_serial() const {
+    return contest_reset_serial;
+  }
+
+  /**
+   * Copy the traces used for contest solving, for an external solver.
+   *
+   * @param full Trace to receive a copy of the full trace
+   * @param sprint Trace to receive a copy of the sprint trace
+   */
+  void copy_contest_traces(Trace &full, Trace &sprint) const;
+
+  /**
+   * Store the result of an external contest solver.  Results are
+   * ignored if the task manager was reset since the traces they were
+   * found in were copied.
+   *
+   * @param result Contest result
+   * @param solution Trace points of the contest solution
+   * @param reset_serial The value of get_contest_reset_serial() when
+   * the traces were copied
+   */
+  void set_contest_result(const ContestResult &result,
+                          const TracePointVector &solution,
+                          unsigned reset_serial);
+
   /**
    * Retrieve trace vector
    *
@@ -381,6 +436,14 @@ public:
                                      const unsigned mintime,
                                      const fixed resolution) const;
 
+  /**
+   * Accesses the full flight trace, e.g. for copying the points
+   * which were added since a given time.
+   */
+  const Trace &get_trace() const {
+    return trace_full;
+  }
+
   /**
    * Retrieve olc solution vector
    *
@@ -388,6 +451,8 @@ public:
    */
   gcc_pure
   const TracePointVector& get_contest_solution() const {
+    if (contest_background)
+      return contest_solution;
     return contest_manager.get_contest_solution();
   }
 
@@ -592,6 +657,10 @@ public:
     return task_behaviour;
   }
 
+  const TaskBehaviour& get_task_behaviour() const {
+    return task_behaviour;
+  }
+
 private:
   GlidePolar m_glide_polar;
 
@@ -608,6 +677,18 @@ private:
 
   ContestManager contest_manager;
 
+  /** Whether contests are solved externally, see set_contest_background() */
+  bool contest_background;
+
+  /** Was the aircraft flying at the last update_idle()? */
+  bool contest_flying;
+
+  /** Number of resets, see get_contest_reset_serial() */
+  unsigned contest_reset_serial;
+
+  /** Contest solution stored by the external solver */
+  TracePointVector contest_solution;
+
   TaskMode_t mode;
   AbstractTask* active_task;
     
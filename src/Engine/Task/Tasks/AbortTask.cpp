@@ -26,6 +26,10 @@
 #include "Task/Visitors/TaskPointVisitor.hpp"
 #include "TaskSolvers/TaskSolution.hpp"
 #include "Task/TaskEvents.hpp"
+#include "GlideSolvers/GlideState.hpp"
+
+#include <algorithm>
+#include <assert.h>
 
 
 const unsigned AbortTask::max_abort = 10; 
@@ -38,7 +42,8 @@ AbortTask::AbortTask(TaskEvents &te,
   UnorderedTask(ABORT, te, tb, gp),
   active_waypoint(0),
   waypoints(wps),
-  polar_safety(gp)
+  polar_safety(gp),
+  candidate_mc(fixed_zero)
 {
 }
 
@@ -144,38 +149,79 @@ AbortTask::is_reachable(const GlideResult &result,
     (!negative(result.TimeElapsed) && result.glide_reachable(final_glide));
 }
 
+void
+AbortTask::prepare_candidates(const AlternateVector &approx_waypoints)
+{
+  candidate_used.assign(approx_waypoints.size(), false);
+  candidate_solved.assign(approx_waypoints.size(), false);
+  candidate_results.resize(approx_waypoints.size());
+}
+
 bool
 AbortTask::fill_reachable(const AIRCRAFT_STATE &state,
-                          AlternateVector &approx_waypoints,
+                          const AlternateVector &approx_waypoints,
                           const GlidePolar &polar,
                           const bool only_airfield,
                           const bool final_glide)
 {
+  assert(candidate_used.size() == approx_waypoints.size());
+
   if (task_full()) {
     return false;
   }
+
+  // the polars of the passes differ only in the MacCready setting
+  if (polar.get_mc() != candidate_mc) {
+    candidate_mc = polar.get_mc();
+    std::fill(candidate_solved.begin(), candidate_solved.end(), false);
+  }
+
+  // upper bound of the glide ratio over ground in any direction: the
+  // best LD of the polar (at zero MacCready), with all of the wind as
+  // tail wind.  Candidates beyond it can't be reached in final glide,
+  // so the speed-to-fly search is skipped for them in final glide
+  // passes.
+  fixed max_ld = fixed_zero;
+  if (final_glide) {
+    GlidePolar polar_ld = polar;
+    polar_ld.set_mc(fixed_zero);
+    max_ld = polar_ld.get_bestLD() * polar.get_cruise_efficiency()
+      + state.wind.norm / polar.get_Smin();
+  }
+
   bool found_final_glide = false;
   std::priority_queue<Alternate, AlternateVector, AbortRank> q;
-  for (AlternateVector::iterator v = approx_waypoints.begin();
-       v!=approx_waypoints.end(); ) {
-
-    if (only_airfield && !v->first.Flags.Airport) {
-      ++v;
+  for (unsigned i = 0; i < approx_waypoints.size(); ++i) {
+    if (candidate_used[i] ||
+        (only_airfield && !approx_waypoints[i].first.Flags.Airport))
       continue;
+
+    if (!candidate_solved[i]) {
+      // same as TaskSolution::glide_solution_remaining() with an
+      // UnorderedTaskPoint, without constructing one
+      const Waypoint &wp = approx_waypoints[i].first;
+      const GlideState gs(GeoVector(state.Location, wp.Location),
+                          max(fixed_zero,
+                              wp.Altitude + task_behaviour.safety_height_arrival),
+                          state.NavAltitude, state.wind);
+
+      if (final_glide && positive(gs.Vector.Distance) &&
+          gs.Vector.Distance > max(gs.AltitudeDifference, fixed_zero) * max_ld)
+        continue;
+
+      candidate_results[i] = polar.solve(gs);
+      candidate_solved[i] = true;
     }
-    UnorderedTaskPoint t(v->first, task_behaviour);
-    const GlideResult result = TaskSolution::glide_solution_remaining(t, state, polar);
+
+    const GlideResult &result = candidate_results[i];
     if (is_reachable(result, final_glide)) {
-      q.push(std::make_pair(v->first, result));
-      // remove it since it's already in the list now      
-      approx_waypoints.erase(v);
+      q.push(std::make_pair(approx_waypoints[i].first, result));
+      // skip it from now on since it's already in the list now
+      candidate_used[i] = true;
 
       if (is_reachable(result, true)) {
         found_final_glide = true;
       }
-
-    } else {
-      ++v;
     }
   }
   while (!q.empty() && !task_full()) {
@@ -258,6 +304,8 @@ AbortTask::update_sample(const AIRCRAFT_STATE &state,
     return false;
   }
 
+  prepare_candidates(approx_waypoints);
+
   // sort by alt difference
 
   // first try with safety polar, final glide only
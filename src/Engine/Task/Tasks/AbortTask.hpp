@@ -216,13 +216,24 @@ protected:
  */
   void update_polar();
 
+/**
+ * Reset the per-candidate state of fill_reachable() for a new list
+ * of candidate waypoints.
+ *
+ * @param approx_waypoints List of candidate waypoints
+ */
+  void prepare_candidates(const AlternateVector &approx_waypoints);
+
 /** 
  * Fill abort task list with candidate waypoints given a list of
  * waypoints satisfying approximate range queries.  Can be used
- * to add airfields only, or landpoints.
+ * to add airfields only, or landpoints.  Candidates which are added
+ * are skipped by subsequent calls, and glide solutions are reused
+ * by subsequent calls with the same MacCready setting.
  *
  * @param state Aircraft state
- * @param approx_waypoints List of candidate waypoints
+ * @param approx_waypoints List of candidate waypoints (see
+ * prepare_candidates())
  * @param polar Polar used for tests
  * @param only_airfield If true, only add waypoints that are airfields.
  * @param final_glide Whether solution must be glide only or climb allowed
@@ -230,7 +241,7 @@ protected:
  * @return True if a landpoint within final glide was found
  */
   bool fill_reachable(const AIRCRAFT_STATE &state,
-                      AlternateVector &approx_waypoints,
+                      const AlternateVector &approx_waypoints,
                       const GlidePolar &polar,
                       const bool only_airfield,
                       const bool final_glide);
@@ -264,6 +275,15 @@ private:
   GlidePolar polar_safety;
   bool m_landable_reachable;
 
+  /** Whether each candidate waypoint has been added to the list */
+  std::vector<bool> candidate_used;
+  /** Whether #candidate_results is valid for each candidate */
+  std::vector<bool> candidate_solved;
+  /** Glide solution of each candidate, at #candidate_mc */
+  std::vector<GlideResult> candidate_results;
+  /** MacCready setting of the polar #candidate_results was solved with */
+  fixed candidate_mc;
+
 public:
 /** 
  * Accept a const task point visitor; makes the visitor visit
@@ -12,9 +12,11 @@ ContestManager::ContestManager(const Contests _contest,
   result(_result),
   trace_full(trace_full),
   trace_sprint(trace_sprint),
-  olc_sprint(trace_sprint, _handicap),
-  olc_fai(trace_full, _handicap),
-  olc_classic(trace_full, _handicap),
+  candidates_full(trace_full),
+  candidates_sprint(trace_sprint),
+  olc_sprint(candidates_sprint, _handicap),
+  olc_fai(candidates_full, _handicap),
+  olc_classic(candidates_full, _handicap),
   olc_league(trace_sprint, _handicap),
   olc_plus(trace_full, _handicap)
 {
@@ -46,6 +48,15 @@ ContestManager::run_contest(AbstractContest &the_contest,
   return true;
 }
 
+void
+ContestManager::update_candidates(ContestCandidates &candidates,
+                                  const ContestDijkstra &solver)
+{
+  // the classic solver is incremental and never leaves a search open,
+  // so only the other solver of a set needs to be checked
+  if (!solver.is_searching())
+    candidates.update();
+}
 
 bool 
 ContestManager::update_idle()
@@ -53,6 +64,21 @@ ContestManager::update_idle()
   bool retval = false;
   ContestResult dummy_result;
 
+  // only the candidates used by the active contest are maintained
+  switch (contest) {
+  case OLC_Sprint:
+    update_candidates(candidates_sprint, olc_sprint);
+    break;
+  case OLC_FAI:
+  case OLC_Plus:
+    update_candidates(candidates_full, olc_fai);
+    break;
+  case OLC_Classic:
+  case OLC_League:
+    update_candidates(candidates_full, olc_classic);
+    break;
+  };
+
   switch (contest) {
   case OLC_Sprint:
     retval = run_contest(olc_sprint, result, solution);
@@ -78,10 +104,30 @@ ContestManager::update_idle()
   return retval;
 }
 
+bool
+ContestManager::is_searching() const
+{
+  switch (contest) {
+  case OLC_Sprint:
+    return olc_sprint.is_searching();
+  case OLC_FAI:
+    return olc_fai.is_searching();
+  case OLC_Classic:
+  case OLC_League:
+    return olc_classic.is_searching();
+  case OLC_Plus:
+    return olc_classic.is_searching() || olc_fai.is_searching();
+  };
+
+  return false;
+}
+
 void
 ContestManager::reset()
 {
   solution.clear();
+  candidates_full.reset();
+  candidates_sprint.reset();
   olc_sprint.reset();
   olc_fai.reset();
   olc_classic.reset();
@@ -6,6 +6,7 @@
 #include "Navigation/TaskProjection.hpp"
 #include <vector>
 
+#include "PathSolvers/ContestCandidates.hpp"
 #include "PathSolvers/OLCSprint.hpp"
 #include "PathSolvers/OLCFAI.hpp"
 #include "PathSolvers/OLCClassic.hpp"
@@ -53,6 +54,15 @@ public:
    */
   bool update_idle();
 
+  /**
+   * Is a solver of the selected contest part way through a search?
+   * update_idle() must be called again to complete it.
+   *
+   * @return True if a search is in progress
+   */
+  gcc_pure
+  bool is_searching() const;
+
   /** 
    * Reset the task (as if never flown)
    */
@@ -79,6 +89,17 @@ private:
                    ContestResult &contest_result,
                    TracePointVector &contest_solution);
 
+  /**
+   * Update a candidate set, unless a solver is part way through a
+   * search of it
+   */
+  static void update_candidates(ContestCandidates &candidates,
+                                const ContestDijkstra &solver);
+
+  /** Candidate points shared by the solvers, one set per trace */
+  ContestCandidates candidates_full;
+  ContestCandidates candidates_sprint;
+
   OLCSprint olc_sprint;
   OLCFAI olc_fai;
   OLCClassic olc_classic;
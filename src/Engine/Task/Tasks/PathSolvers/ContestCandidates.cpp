@@ -0,0 +1,189 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ContestCandidates.hpp"
+#include "ContestDijkstra.hpp"
+#include "Trace/Trace.hpp"
+
+#include <algorithm>
+#include <limits.h>
+
+const unsigned ContestCandidates::max_points = 300;
+const unsigned ContestCandidates::max_append = 50;
+
+ContestCandidates::ContestCandidates(const Trace &_trace):
+  trace_master(_trace)
+{
+  const unsigned capacity = max_points + max_append;
+  points.reserve(capacity);
+  point_version.reserve(capacity);
+  distances.reserve(row_offset(capacity));
+
+  reset();
+}
+
+void
+ContestCandidates::reset()
+{
+  points.clear();
+  point_version.clear();
+  distances.clear();
+  version = 0;
+  last_point.time = Trace::null_time;
+  min_distance = UINT_MAX;
+  min_delta_t = UINT_MAX;
+  append_distance = 0;
+}
+
+bool
+ContestCandidates::master_is_updated()
+{
+  const bool insufficient = (points.size() < 2);
+  const TracePoint& last_master = trace_master.get_last_point();
+
+  // update trace if time and distance are greater than previous deltas,
+  // or if time is greater than at least 30 seconds greater than previous
+
+  const bool updated = 
+    ((last_master.time >= last_point.time + min_delta_t)
+     && (last_master.approx_sq_dist(last_point) >= min_distance))
+    || (last_master.time >= last_point.time + std::max((unsigned)30, min_delta_t));
+
+  // need an update if there's insufficient data in the buffer, or if
+  // the update was significant
+
+  if (insufficient || updated) {
+    last_point = last_master;
+  }
+  return insufficient || updated;
+}
+
+bool
+ContestCandidates::update()
+{
+  if (!master_is_updated())
+    return false;
+
+  ++version;
+
+  if (points.size() < 2 || !append())
+    rebuild();
+
+  return true;
+}
+
+void
+ContestCandidates::rebuild()
+{
+  points = trace_master.get_trace_points(max_points);
+  point_version.assign(points.size(), version);
+
+  ContestDijkstra::count_olc_trace++;
+
+  distances.resize(row_offset(points.size()));
+  for (unsigned i = 1; i < points.size(); ++i)
+    update_row(i);
+
+  if (points.size() < 2)
+    return;
+
+  // find min distance and time step within this trace
+  min_delta_t = UINT_MAX;
+  min_distance = UINT_MAX;
+  unsigned sum_distance = 0;
+  for (TracePointVector::const_iterator it = points.begin();
+       it+1 != points.end(); ++it) {
+    const TracePoint &p0 = *it;
+    const TracePoint &p1 = *(it+1);
+    min_distance = std::min(p0.approx_sq_dist(p1), min_distance);
+    min_delta_t = std::min(p1.time-p0.time, min_delta_t);
+    sum_distance += p0.approx_dist(p1);
+  }
+
+  // appended points are merged to the mean spacing of this trace
+  const unsigned mean_distance = sum_distance / (points.size() - 1);
+  append_distance = mean_distance * mean_distance;
+}
+
+bool
+ContestCandidates::append()
+{
+  assert(points.size() >= 2);
+
+  // points which have expired from the master trace must be dropped,
+  // which requires a rebuild
+  if (trace_master.empty() ||
+      trace_master.begin()->time > points.front().time)
+    return false;
+
+  const TracePointVector fresh =
+    trace_master.get_trace_points_after(points.back().time);
+
+  for (TracePointVector::const_iterator it = fresh.begin();
+       it != fresh.end(); ++it) {
+    const unsigned n = points.size();
+    TracePoint point = *it;
+
+    // the last point is always the latest, so replace it if it is
+    // too close to its predecessor to be kept
+    if (points[n - 2].approx_sq_dist(points[n - 1]) < append_distance) {
+      point.last_time = points[n - 2].time;
+      points[n - 1] = point;
+      point_version[n - 1] = version;
+      update_row(n - 1);
+      continue;
+    }
+
+    if (n >= max_points + max_append)
+      return false;
+
+    point.last_time = points[n - 1].time;
+    points.push_back(point);
+    point_version.push_back(version);
+    distances.resize(row_offset(n + 1));
+    update_row(n);
+  }
+
+  return true;
+}
+
+void
+ContestCandidates::update_row(const unsigned i)
+{
+  const TracePoint &p = points[i];
+  unsigned short *row = &distances[row_offset(i)];
+  for (unsigned j = 0; j < i; ++j)
+    row[j] = (unsigned short)std::min(p.flat_distance(points[j]),
+                                      (unsigned)USHRT_MAX);
+}
+
+unsigned
+ContestCandidates::first_changed(const unsigned since) const
+{
+  // points only change at the end of the set, or all at once when
+  // rebuilt, so versions are non-decreasing along the set
+
+  unsigned i = points.size();
+  while (i > 0 && point_version[i - 1] > since)
+    --i;
+  return i;
+}
@@ -0,0 +1,172 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#ifndef CONTEST_CANDIDATES_HPP
+#define CONTEST_CANDIDATES_HPP
+
+#include "Navigation/TracePoint.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <assert.h>
+
+class Trace;
+
+/**
+ * Reduced set of candidate trace points shared by all contest
+ * solvers working on the same master trace, together with the flat
+ * distances between all pairs of points.
+ *
+ * The set is rebuilt by thinning the master trace.  Between rebuilds,
+ * new master points are appended (the last point is replaced if it
+ * is too close to its predecessor), so earlier points and their
+ * distances remain valid.  Every change increments the version, and
+ * the version at which each point last changed is recorded so that
+ * solvers can update incrementally.
+ */
+class ContestCandidates:
+  private NonCopyable
+{
+public:
+  /**
+   * Constructor
+   *
+   * @param _trace Master trace to retrieve points from
+   */
+  ContestCandidates(const Trace &_trace);
+
+  /**
+   * Update the set from the master trace, if it has changed
+   * significantly.  This must not be called while a solver is part
+   * way through a search of this set.
+   *
+   * @return True if the set was changed
+   */
+  bool update();
+
+  /**
+   * Clear the set (as if never flown)
+   */
+  void reset();
+
+  /**
+   * Retrieve the master trace
+   */
+  const Trace &get_trace() const {
+    return trace_master;
+  }
+
+  /**
+   * Number of points in the set
+   */
+  unsigned size() const {
+    return points.size();
+  }
+
+  /**
+   * Retrieve point
+   *
+   * @param index Index of point
+   */
+  const TracePoint &get_point(const unsigned index) const {
+    assert(index < points.size());
+    return points[index];
+  }
+
+  /**
+   * Retrieve the flat distance between two points
+   *
+   * @param i Index of first point
+   * @param j Index of second point
+   *
+   * @return Distance (flat), same as TracePoint::flat_distance()
+   */
+  gcc_pure
+  unsigned get_distance(const unsigned i, const unsigned j) const {
+    if (i == j)
+      return 0;
+    return i > j
+      ? distances[row_offset(i) + j]
+      : distances[row_offset(j) + i];
+  }
+
+  /**
+   * Version of the set, incremented with every change
+   */
+  unsigned get_version() const {
+    return version;
+  }
+
+  /**
+   * Find the first point which has changed since the specified
+   * version of the set
+   *
+   * @param since Version the caller last processed
+   *
+   * @return Index of first changed point, or size() if none changed
+   */
+  gcc_pure
+  unsigned first_changed(const unsigned since) const;
+
+private:
+  /** Max number of points in set after thinning */
+  static const unsigned max_points;
+
+  /** Room for appended points before the set is rebuilt */
+  static const unsigned max_append;
+
+  static unsigned row_offset(const unsigned i) {
+    return i * (i - 1) / 2;
+  }
+
+  bool master_is_updated();
+  void rebuild();
+  bool append();
+  void update_row(const unsigned i);
+
+  const Trace &trace_master;
+
+  TracePointVector points;
+
+  /** Version at which each point last changed */
+  std::vector<unsigned> point_version;
+
+  /**
+   * Lower triangle of the distance matrix, row by row.  Distances
+   * are stored as 16 bit flat distances to halve the footprint.
+   */
+  std::vector<unsigned short> distances;
+
+  unsigned version;
+
+  /** Last master point at which the set was updated */
+  TracePoint last_point;
+
+  unsigned min_distance;
+  unsigned min_delta_t;
+
+  /** Smallest squared step (flat) for appended points */
+  unsigned append_distance;
+};
+
+#endif
@@ -32,16 +32,19 @@ unsigned long ContestDijkstra::count_olc_solve = 0;
 unsigned long ContestDijkstra::count_olc_trace = 0;
 unsigned ContestDijkstra::count_olc_size = 0;
 
-const unsigned ContestDijkstra::max_contest_trace = 300;
+static const unsigned null_value = 0 - 1;
 
-ContestDijkstra::ContestDijkstra(const Trace &_trace,
+ContestDijkstra::ContestDijkstra(ContestCandidates &_candidates,
                                  const unsigned &_handicap,
                                  const unsigned n_legs,
-                                 const unsigned finish_alt_diff):
-  AbstractContest(_trace, _handicap, finish_alt_diff),
+                                 const unsigned finish_alt_diff,
+                                 const bool _incremental):
+  AbstractContest(_candidates.get_trace(), _handicap, finish_alt_diff),
   NavDijkstra<TracePoint>(n_legs + 1),
+  candidates(_candidates),
   m_dijkstra(false),
-  solution_found(false)
+  solution_found(false),
+  incremental(_incremental)
 {
   reset();
 }
@@ -69,79 +72,53 @@ ContestDijkstra::score(ContestResult &result)
   return false;
 }
 
-bool
-ContestDijkstra::master_is_updated()
-{
-  assert(num_stages <= MAX_STAGES);
-
-  const bool insufficient = (n_points < num_stages);
-  const TracePoint& last_master = trace_master.get_last_point();
-
-  // update trace if time and distance are greater than previous deltas,
-  // or if time is greater than at least 30 seconds greater than previous
-
-  const bool updated = 
-    ((last_master.time >= last_point.time + min_delta_t_trace)
-     && (last_master.approx_sq_dist(last_point) >= min_distance_trace))
-    || (last_master.time >= last_point.time + max((unsigned)30, min_delta_t_trace));
-
-  // need an update if there's insufficient data in the buffer, or if
-  // the update was significant
-
-  if (insufficient || updated) {
-    last_point = last_master;
-  }
-  return insufficient || updated;
-}
-
-
 void
 ContestDijkstra::clear_trace()
 {
   trace_dirty = true;
-  trace.clear();
+  trace_version = 0;
   n_points = 0;
+  first_dirty = 0;
+  admitted.clear();
+  path_value.clear();
+  path_parent.clear();
 }
 
 
 void
 ContestDijkstra::update_trace()
 {
-  if (!master_is_updated()) 
+  if (trace_version == candidates.get_version())
     return;
 
-  trace = trace_master.get_trace_points(max_contest_trace);
-  n_points = trace.size();
+  first_dirty = min(first_dirty, candidates.first_changed(trace_version));
+  trace_version = candidates.get_version();
+  n_points = candidates.size();
   trace_dirty = true;
-
-  count_olc_trace++;
-
-  if (n_points<2) return;
-
-  // find min distance and time step within this trace
-  min_delta_t_trace = UINT_MAX;
-  min_distance_trace = UINT_MAX;
-  for (TracePointVector::const_iterator it = trace.begin();
-       it+1 != trace.end(); ++it) {
-    const TracePoint &p0 = *it;
-    const TracePoint &p1 = *(it+1);
-    min_distance_trace = min(p0.approx_sq_dist(p1), min_distance_trace);
-    min_delta_t_trace = min(p1.time-p0.time, min_delta_t_trace);
-  }
 }
 
 
 bool
 ContestDijkstra::solve()
 {
+  if (incremental)
+    return solve_incremental();
+
+  if (!m_dijkstra.empty() && trace_version != candidates.get_version())
+    // the candidates changed under this search, so it is abandoned
+    m_dijkstra.clear();
+
   if (m_dijkstra.empty()) {
     set_weightings();
   }
 
   assert(num_stages <= MAX_STAGES);
   if (n_points < num_stages) {
+    // load the trace, and start searching right away if it is long
+    // enough; the caller may not call again before new points arrive
     update_trace();
-    return true;
+    if (n_points < num_stages)
+      return true;
   }
 
   if (m_dijkstra.empty()) {
@@ -176,16 +153,93 @@ ContestDijkstra::solve()
   return !m_dijkstra.empty();
 }
 
+bool
+ContestDijkstra::solve_incremental()
+{
+  assert(num_stages <= MAX_STAGES);
+
+  update_trace();
+  if (n_points < num_stages)
+    return true;
+
+  // don't re-solve unless we have had new data appear
+  if (!trace_dirty)
+    return true;
+  trace_dirty = false;
+
+  set_weightings();
+  count_olc_solve++;
+
+  // a change of the finish may admit or reject start points, which
+  // invalidates the table from the first such point onwards
+  admitted.resize(n_points);
+  const TracePoint &finish = candidates.get_point(n_points - 1);
+  for (unsigned i = 0; i < first_dirty && i < n_points; ++i) {
+    const bool admit = finish_altitude_valid(candidates.get_point(i), finish);
+    if (admit != admitted[i]) {
+      first_dirty = i;
+      break;
+    }
+  }
+
+  path_value.resize(n_points * num_stages);
+  path_parent.resize(n_points * num_stages);
+
+  for (unsigned i = first_dirty; i < n_points; ++i) {
+    admitted[i] = finish_altitude_valid(candidates.get_point(i), finish);
+    solve_column(i);
+  }
+  first_dirty = n_points;
+
+  // the finish is always the last point
+  unsigned index = n_points - 1;
+  if (path_value[index * num_stages + num_stages - 1] == null_value)
+    return true;
+
+  for (unsigned stage = num_stages; stage-- > 0;) {
+    solution[stage] = candidates.get_point(index);
+    index = path_parent[index * num_stages + stage];
+  }
+
+  save_solution();
+  return true;
+}
+
+void
+ContestDijkstra::solve_column(const unsigned index)
+{
+  unsigned *value = &path_value[index * num_stages];
+  unsigned *parent = &path_parent[index * num_stages];
+
+  value[0] = admitted[index] ? 0 : null_value;
+  parent[0] = index;
+  std::fill(value + 1, value + num_stages, null_value);
+
+  // legs may have zero length, so the point itself is a predecessor
+  for (unsigned j = 0; j <= index; ++j) {
+    const unsigned *origin = &path_value[j * num_stages];
+    const unsigned d = candidates.get_distance(j, index);
+
+    for (unsigned stage = 1; stage < num_stages; ++stage) {
+      if (origin[stage - 1] == null_value)
+        continue;
+
+      const unsigned v = origin[stage - 1] + get_weighting(stage - 1) * d;
+      if (value[stage] == null_value || v > value[stage]) {
+        value[stage] = v;
+        parent[stage] = j;
+      }
+    }
+  }
+}
+
 void
 ContestDijkstra::reset()
 {
   solution_found = false;
   m_dijkstra.clear();
   clear_trace();
-  last_point.time = Trace::null_time;
   AbstractContest::reset();
-  min_distance_trace = UINT_MAX;
-  min_delta_t_trace = UINT_MAX;
 
   count_olc_solve = 0;
   count_olc_trace = 0;
@@ -278,7 +332,16 @@ const TracePoint &
 ContestDijkstra::get_point(const ScanTaskPoint &sp) const
 {
   assert(sp.second < n_points);
-  return trace[sp.second];
+  return candidates.get_point(sp.second);
+}
+
+unsigned
+ContestDijkstra::distance(const ScanTaskPoint &s1,
+                          const ScanTaskPoint &s2) const
+{
+  assert(s1.second < n_points);
+  assert(s2.second < n_points);
+  return candidates.get_distance(s1.second, s2.second);
 }
 
 unsigned
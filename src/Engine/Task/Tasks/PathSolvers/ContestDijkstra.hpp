@@ -25,6 +25,9 @@
 
 #include "AbstractContest.hpp"
 #include "NavDijkstra.hpp"
+#include "ContestCandidates.hpp"
+
+#include <vector>
 
 /**
  * Abstract class for contest searches using dijkstra algorithm
@@ -32,7 +35,17 @@
  * These algorithms are designed for online/realtime use, and as such
  * expect solve() to be called during the simulation as time advances.
  *
+ * Points and distances are read from a ContestCandidates set, which
+ * is shared with the other solvers working on the same trace.
  *
+ * In incremental mode the table of best path values per (stage,
+ * point) is kept between updates.  Since the candidate set only grows
+ * at its end between rebuilds and edges only lead forward in time,
+ * an appended point only requires its own column of the table to be
+ * evaluated, so the cost of an update does not depend on the length
+ * of the flight.  This requires the default edge structure (any
+ * start, finish at the last point), so derived classes which override
+ * add_edges() must not enable it.
  */
 class ContestDijkstra:
   public AbstractContest,
@@ -42,14 +55,16 @@ public:
   /**
    * Constructor
    *
-   * @param _trace Trace object reference to use for solving
+   * @param _candidates Candidate points to use for solving
    * @param n_legs Maximum number of legs in Contest task
    * @param finish_alt_diff Maximum height loss from start to finish (m)
+   * @param _incremental Whether to retain the search between updates
    */
-  ContestDijkstra(const Trace &_trace, 
+  ContestDijkstra(ContestCandidates &_candidates,
                   const unsigned &_handicap,
                   const unsigned n_legs,
-                  const unsigned finish_alt_diff = 1000);
+                  const unsigned finish_alt_diff = 1000,
+                  const bool _incremental = false);
 
   bool score(ContestResult &result);
 
@@ -72,19 +87,25 @@ public:
    */
   bool solve();
 
+  /**
+   * Whether a search is in progress, during which the candidate set
+   * must not be updated
+   */
+  bool is_searching() const {
+    return !m_dijkstra.empty();
+  }
+
 protected:
   /** Number of points in current trace set */
   unsigned n_points;
 
-  /** Max number of points in trace set */
-  static const unsigned max_contest_trace;
-
-  /** Update working trace from master --- never to be done during a solution! */
+  /** Update working trace from candidates --- never to be done during a solution! */
   virtual void update_trace();
 
   void clear_trace();
 
-  TracePointVector trace; // working trace for solver
+  /** Shared candidate points for solver */
+  const ContestCandidates &candidates;
 
   /**
    * Determine if a trace point can be added to the search list
@@ -96,6 +117,12 @@ protected:
 
   const TracePoint &get_point(const ScanTaskPoint &sp) const;
 
+  /**
+   * Distance function for edges, from the candidate distance matrix
+   */
+  gcc_pure
+  unsigned distance(const ScanTaskPoint &s1, const ScanTaskPoint &s2) const;
+
 
   virtual void add_edges(DijkstraTaskPoint &dijkstra,
                          const ScanTaskPoint &curNode);
@@ -128,11 +155,30 @@ protected:
 private:
   bool solution_found;
   bool trace_dirty;
-  unsigned min_distance_trace;
-  unsigned min_delta_t_trace;
   virtual void add_start_edges();
-  TracePoint last_point;
-  bool master_is_updated();
+
+  /** Version of the candidate set last retrieved */
+  unsigned trace_version;
+
+  /** Whether the search is retained between updates */
+  const bool incremental;
+
+  bool solve_incremental();
+
+  /** Evaluate one column of the incremental search table */
+  void solve_column(const unsigned index);
+
+  /** Index of the first working trace point changed since last solve */
+  unsigned first_dirty;
+
+  /** Start points admitted for the current finish */
+  std::vector<bool> admitted;
+
+  /** Best weighted path value per (point, stage) */
+  std::vector<unsigned> path_value;
+
+  /** Predecessor point of the best path per (point, stage) */
+  std::vector<unsigned> path_parent;
 
   TracePoint best_solution[MAX_STAGES];
 
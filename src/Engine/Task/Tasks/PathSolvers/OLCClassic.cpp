@@ -22,9 +22,9 @@
 
 #include "OLCClassic.hpp"
 
-OLCClassic::OLCClassic(const Trace &_trace,
+OLCClassic::OLCClassic(ContestCandidates &_candidates,
                        const unsigned &_handicap):
-  ContestDijkstra(_trace, _handicap, 6, 1000) {}
+  ContestDijkstra(_candidates, _handicap, 6, 1000, true) {}
 
 void 
 OLCClassic::set_weightings()
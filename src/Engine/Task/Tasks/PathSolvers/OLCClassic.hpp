@@ -32,7 +32,7 @@ class OLCClassic:
   public ContestDijkstra
 {
 public:
-  OLCClassic(const Trace &_trace,
+  OLCClassic(ContestCandidates &_candidates,
              const unsigned &_handicap);
 
 protected:
@@ -41,9 +41,9 @@
   4: end
 */
 
-OLCFAI::OLCFAI(const Trace &_trace,
+OLCFAI::OLCFAI(ContestCandidates &_candidates,
   const unsigned &_handicap):
-  ContestDijkstra(_trace, _handicap, 3, 1000),
+  ContestDijkstra(_candidates, _handicap, 3, 1000),
   is_closed(false),
   is_complete(false),
   first_tp(0) 
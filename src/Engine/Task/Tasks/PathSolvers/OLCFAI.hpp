@@ -32,7 +32,7 @@ class OLCFAI:
   public ContestDijkstra
 {
 public:
-  OLCFAI(const Trace &_trace,
+  OLCFAI(ContestCandidates &_candidates,
          const unsigned &_handicap);
 
   fixed calc_score() const;
@@ -51,9 +51,9 @@
     potentially implement as circular buffer (emulate as dequeue)
 */
 
-OLCSprint::OLCSprint(const Trace &_trace,
+OLCSprint::OLCSprint(ContestCandidates &_candidates,
                      const unsigned &_handicap):
-  ContestDijkstra(_trace, _handicap, 4, 0) {}
+  ContestDijkstra(_candidates, _handicap, 4, 0) {}
 
 void
 OLCSprint::reset()
@@ -35,7 +35,7 @@ public:
   /**
    * Constructor
    */
-  OLCSprint(const Trace &_trace,
+  OLCSprint(ContestCandidates &_candidates,
             const unsigned &_handicap);
 
   void reset();
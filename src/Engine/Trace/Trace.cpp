@@ -1,18 +1,23 @@
 #include "Trace.hpp"
 #include "Navigation/Aircraft.hpp"
 #include <algorithm>
+#include <bitset>
+#include <assert.h>
 
 const unsigned Trace::null_delta = 0 - 1;
 const unsigned Trace::null_time = 0 - 1;
+const unsigned Trace::null_index = 0 - 1;
 
 Trace::Trace(const unsigned max_time,
              const unsigned recent_time,
              const unsigned max_points) :
-  m_optimise_time(null_time),
   m_recent_time(recent_time),
   m_max_time(max_time),
   m_max_points(max_points)
 {
+  nodes.reserve(max_points + 2);
+  heap.reserve(max_points + 2);
+  clear();
 }
 
 void
@@ -22,7 +27,7 @@ Trace::append(const AIRCRAFT_STATE& state)
     task_projection.reset(state.get_location());
     task_projection.update_fast();
     m_last_point.time = null_time;
-  } else if (trace_tree.size() > 0 && state.Time < fixed(m_last_point.time)) {
+  } else if (state.Time < fixed(m_last_point.time)) {
     clear();
     return;
   }
@@ -33,31 +38,91 @@ Trace::append(const AIRCRAFT_STATE& state)
 
   tp.project(task_projection);
   tp.last_time = m_last_point.time;
-  TraceTree::const_iterator it_this = trace_tree.insert(tp);
   m_last_point = tp;
 
-  // update deltas.  Last point is always high delta
-  delta_map[tp.time].distance = null_delta;
-  delta_map[tp.time].time = null_time;
+  const unsigned index = allocate_node();
+  TraceNode &node = nodes[index];
+  node.point = tp;
+  node.prev = tail;
+  node.next = null_index;
+  node.heap_index = null_index;
+  // last point is always high delta
+  node.delta_distance = null_delta;
+  node.delta_time = null_time;
 
-  TraceTree::const_iterator it_prev = find_prev(tp);
-  if (it_prev != end())
-    update_delta(find_prev(*it_prev), it_prev, it_this);
+  if (tail != null_index)
+    nodes[tail].next = index;
+  else
+    head = index;
+  tail = index;
+
+  if (recent_cursor == null_index)
+    recent_cursor = index;
+
+  bucket_insert(index);
+  ++m_size;
+
+  // previous point now has both neighbours
+  if (node.prev != null_index)
+    update_delta(node.prev);
+
+  // first remove points outside max time range
+  if (m_max_time != null_time)
+    trim_point_time();
+
+  update_candidates();
+
+  // if still too big, remove points based on line simplification
+  while (m_size > m_max_points && !heap.empty())
+    trim_point_delta();
 }
 
-void 
-Trace::update_delta(TraceTree::const_iterator it_prev,
-                    TraceTree::const_iterator it,
-                    TraceTree::const_iterator it_next)
+unsigned
+Trace::allocate_node()
 {
-  if ((it == end()) || (it_prev == end()) || (it_next == end()))
+  if (free_list != null_index) {
+    const unsigned index = free_list;
+    free_list = nodes[index].next;
+    return index;
+  }
+
+  nodes.push_back(TraceNode());
+  return nodes.size() - 1;
+}
+
+void
+Trace::update_delta(unsigned index)
+{
+  TraceNode &node = nodes[index];
+  if (node.prev == null_index || node.next == null_index)
     return;
 
-  const unsigned d_this = it_prev->approx_dist(*it) + it->approx_dist(*it_next);
-  const unsigned d_rem = it_prev->approx_dist(*it_next);
-  const unsigned delta = d_this - d_rem;
-  delta_map[it->time].distance = delta;
-  delta_map[it->time].time = std::max(it->dt(), it_next->dt());
+  const TracePoint &p_prev = nodes[node.prev].point;
+  const TracePoint &p_next = nodes[node.next].point;
+
+  const unsigned d_this = p_prev.approx_dist(node.point) +
+    node.point.approx_dist(p_next);
+  const unsigned d_rem = p_prev.approx_dist(p_next);
+  node.delta_distance = d_this - d_rem;
+  node.delta_time = std::max(node.point.dt(), p_next.dt());
+
+  if (node.heap_index != null_index)
+    heap_update(index);
+}
+
+void
+Trace::update_candidates()
+{
+  // points become candidates for thinning once they age out of the
+  // recent time.  The head and tail are never removed by thinning.
+
+  while (recent_cursor != null_index &&
+         !inside_recent_time(nodes[recent_cursor].point.time)) {
+    if (recent_cursor != head && recent_cursor != tail)
+      heap_push(recent_cursor);
+
+    recent_cursor = nodes[recent_cursor].next;
+  }
 }
 
 bool
@@ -78,301 +143,313 @@ Trace::inside_time_window(unsigned time) const
   return inside_recent_time(time) || (time + m_max_time >= m_last_point.time);
 }
 
-unsigned
-Trace::lowest_delta() const
+void
+Trace::trim_point_time()
 {
-  // note this won't calculate delta for recent
-
-  unsigned lowest = null_delta;
-
-  TraceDeltaMap::const_iterator it = delta_map.begin();
-  for (++it; it != delta_map.end(); ++it) {
-    if (inside_recent_time(it->first))
-      return lowest;
-
-    if (it->second.distance < lowest)
-      lowest = it->second.distance;
-  }
-  return lowest;
+  while (head != null_index &&
+         !inside_time_window(nodes[head].point.time))
+    erase_head();
 }
 
-void 
-Trace::erase_earlier_than(unsigned min_time)
+void
+Trace::trim_point_delta()
 {
-  // note: this is slow but currently kdtree++ doesn't return a valid
-  // iterator after erase() so there's no easier way
-
-  bool found = false;
-  do {
-    found = false;
-    for (TraceTree::const_iterator tr = trace_tree.begin();
-         tr != trace_tree.end(); ++tr) {
-      if (tr->time < min_time) {
-        trace_tree.erase(tr);
-        found = true;
-        break;
-      }
-    }
-  } while (found);
+  // note this won't trim if recent
+
+  // if several points exist with equal deltas, the heap ordering
+  // selects the one with the smallest time step
 
-  delta_map.erase(delta_map.begin(), 
-                  delta_map.lower_bound(min_time));
+  assert(!heap.empty());
+  erase(heap.front());
 }
 
 void
-Trace::trim_point_time()
+Trace::erase_head()
 {
-  for (TraceDeltaMap::const_iterator it = delta_map.begin(); 
-       it != delta_map.end(); ++it) {
-    const unsigned this_time = it->first;
-
-    if (inside_time_window(this_time)) {
-      erase_earlier_than(this_time);
-      delta_map[this_time].distance = null_delta;
-      delta_map[this_time].time = null_time;
-
-      return;
-    }
-  }
+  const unsigned index = head;
+  assert(index != null_index);
+
+  if (recent_cursor == index)
+    recent_cursor = nodes[index].next;
+
+  heap_remove(index);
+  bucket_remove(index);
+
+  head = nodes[index].next;
+  if (head != null_index) {
+    TraceNode &first = nodes[head];
+    first.prev = null_index;
+    // first point is never removed by thinning
+    heap_remove(head);
+    first.delta_distance = null_delta;
+    first.delta_time = null_time;
+  } else
+    tail = null_index;
+
+  nodes[index].next = free_list;
+  free_list = index;
+  --m_size;
 }
 
 void
-Trace::trim_point_delta()
+Trace::erase(unsigned index)
 {
-  // note this won't trim if recent
+  /// @todo merge data for erased point?
+  TraceNode &node = nodes[index];
+  const unsigned i_prev = node.prev;
+  const unsigned i_next = node.next;
 
-  // if several points exist with equal deltas, this will remove the one
-  // with the smallest time step
+  // don't erase if last or first point
+  if (i_prev == null_index || i_next == null_index)
+    return;
 
-  unsigned delta = lowest_delta();
-  unsigned lowest_dt = null_time;
-  TraceTree::const_iterator candidate = trace_tree.end();
+  assert(recent_cursor != index);
 
-#ifndef NDEBUG
-  const unsigned min_time = delta_map.begin()->first;
-#endif
+  heap_remove(index);
+  bucket_remove(index);
 
-  for (TraceTree::const_iterator it = trace_tree.begin();
-       it != trace_tree.end(); ++it) {
-    const unsigned this_time = it->time;
-    assert(this_time >= min_time);
-    const TraceDelta& this_delta = delta_map[this_time];
+  // the next point is merged with this one
+  nodes[i_prev].next = i_next;
+  nodes[i_next].prev = i_prev;
+  nodes[i_next].point.last_time = nodes[i_prev].point.time;
 
-    if (!inside_recent_time(this_time) &&
-        this_delta.distance == delta) {
-      if (this_delta.time < lowest_dt) {
-        lowest_dt = this_delta.time;
-        candidate = it;
-      }
-    }
-  }
+  node.next = free_list;
+  free_list = index;
+  --m_size;
 
-  if (candidate != trace_tree.end())
-    erase(candidate);
+  // recompute data for previous and replacement point
+  update_delta(i_prev);
+  update_delta(i_next);
 }
 
 void
-Trace::optimise()
+Trace::clear()
 {
-  // first remove points outside max time range
-  if (m_max_time != null_time)
-    trim_point_time();
+  nodes.clear();
+  heap.clear();
+  std::fill(buckets, buckets + num_buckets, null_index);
+  head = tail = free_list = recent_cursor = null_index;
+  m_size = 0;
 
-  // if still too big, remove points based on line simplification
-  while (trace_tree.size()> m_max_points)
-    trim_point_delta();
-
-  // re-balance tree 
-  trace_tree.optimize();
-  m_optimise_time = m_last_point.time;
+  m_last_point.time = null_time;
 }
 
-Trace::TraceTree::const_iterator
-Trace::find_prev(const TracePoint& tp) const
+void
+Trace::assign(const Trace &other)
 {
-  for (TraceTree::const_iterator it = trace_tree.begin();
-       it != trace_tree.end(); ++it)
-    if (it->time == tp.last_time)
-      return it;
-
-  return end();
+  m_recent_time = other.m_recent_time;
+  m_max_time = other.m_max_time;
+  m_max_points = other.m_max_points;
+
+  nodes = other.nodes;
+  heap = other.heap;
+  std::copy(other.buckets, other.buckets + num_buckets, buckets);
+  head = other.head;
+  tail = other.tail;
+  free_list = other.free_list;
+  recent_cursor = other.recent_cursor;
+  m_size = other.m_size;
+  task_projection = other.task_projection;
+  m_last_point = other.m_last_point;
 }
 
-Trace::TraceTree::const_iterator
-Trace::find_next(const TracePoint& tp) const
+unsigned
+Trace::bucket_of(int cell_x, int cell_y)
 {
-  for (TraceTree::const_iterator it = trace_tree.begin();
-       it != trace_tree.end(); ++it)
-    if (it->last_time == tp.time)
-      return it;
+  return ((unsigned)cell_x * 73856093u ^ (unsigned)cell_y * 19349663u)
+    & (num_buckets - 1);
+}
 
-  return end();
+unsigned
+Trace::bucket_of(const FlatGeoPoint &flat)
+{
+  return bucket_of(flat.Longitude >> cell_shift, flat.Latitude >> cell_shift);
 }
 
 void
-Trace::erase(TraceTree::const_iterator& rit)
+Trace::bucket_insert(unsigned index)
 {
-  /// @todo merge data for erased point?
-  if (rit == trace_tree.end())
-    return;
-
-  TraceTree::const_iterator it_prev = find_prev(*rit);
-  TraceTree::const_iterator it_next = find_next(*rit);
-
-  // don't erase if last or first point in tree
-  if ((it_prev == trace_tree.end()) || (it_next == trace_tree.end()))
-    return;
-
-  // create new point representing the next point since this is merged with it
-  TracePoint tp_next = *it_next;
-  tp_next.last_time = it_prev->time;
-
-  // remove erased point from the delta map
-  delta_map.erase(rit->time);
+  TraceNode &node = nodes[index];
+  unsigned &first = buckets[bucket_of(node.point.get_flatLocation())];
+
+  node.cell_prev = null_index;
+  node.cell_next = first;
+  if (first != null_index)
+    nodes[first].cell_prev = index;
+  first = index;
+}
 
-  // remove current (deletion), and next (to be replaced)
-  trace_tree.erase(rit);
-  trace_tree.erase(it_next);
+void
+Trace::bucket_remove(unsigned index)
+{
+  TraceNode &node = nodes[index];
 
-  // insert point replacement
-  it_next = trace_tree.insert(tp_next);
+  if (node.cell_prev != null_index)
+    nodes[node.cell_prev].cell_next = node.cell_next;
+  else
+    buckets[bucket_of(node.point.get_flatLocation())] = node.cell_next;
 
-  // recompute data for previous and replacement point
-  update_delta(find_prev(*it_prev), it_prev, it_next);
-  update_delta(it_prev, it_next, find_next(*it_next));
+  if (node.cell_next != null_index)
+    nodes[node.cell_next].cell_prev = node.cell_prev;
 }
 
-void
-Trace::clear()
+bool
+Trace::heap_less(unsigned a, unsigned b) const
 {
-  trace_tree.clear();
-  trace_tree.optimize();
-  m_optimise_time = null_time;
-  m_last_point.time = null_time;
-
-  delta_map.clear();
+  const TraceNode &na = nodes[a];
+  const TraceNode &nb = nodes[b];
+  if (na.delta_distance != nb.delta_distance)
+    return na.delta_distance < nb.delta_distance;
+  return na.delta_time < nb.delta_time;
 }
 
-unsigned
-Trace::size() const
+void
+Trace::heap_set(unsigned position, unsigned index)
 {
-  return trace_tree.size();
+  heap[position] = index;
+  nodes[index].heap_index = position;
 }
 
-bool
-Trace::empty() const
+void
+Trace::heap_sift_up(unsigned position)
 {
-  return trace_tree.empty();
+  const unsigned index = heap[position];
+  while (position > 0) {
+    const unsigned parent = (position - 1) / 2;
+    if (!heap_less(index, heap[parent]))
+      break;
+    heap_set(position, heap[parent]);
+    position = parent;
+  }
+  heap_set(position, index);
 }
 
-Trace::TraceTree::const_iterator
-Trace::begin() const
+void
+Trace::heap_sift_down(unsigned position)
 {
-  return trace_tree.begin();
+  const unsigned index = heap[position];
+  const unsigned n = heap.size();
+  for (;;) {
+    unsigned child = 2 * position + 1;
+    if (child >= n)
+      break;
+    if (child + 1 < n && heap_less(heap[child + 1], heap[child]))
+      ++child;
+    if (!heap_less(heap[child], index))
+      break;
+    heap_set(position, heap[child]);
+    position = child;
+  }
+  heap_set(position, index);
 }
 
-Trace::TraceTree::const_iterator
-Trace::end() const
+void
+Trace::heap_push(unsigned index)
 {
-  return trace_tree.end();
+  assert(nodes[index].heap_index == null_index);
+  heap.push_back(index);
+  heap_sift_up(heap.size() - 1);
 }
 
-/**
- * Utility class to add tracepoints satisfying a time range to a set
- */
-class TracePointSetFilterInserter
+void
+Trace::heap_remove(unsigned index)
 {
-public:
-  /** 
-   * Constructor
-   * 
-   * @param the_set Set to add to
-   * @param _min_time Min time (before which to ignore samples), (s)
-   */
-  TracePointSetFilterInserter(TracePointSet& the_set, 
-                              const unsigned _min_time = 0) :
-    m_set(&the_set), min_time(_min_time) {}
-
-  /** 
-   * Set operator; adds point to set if time satisfied
-   *
-   * @return Reference to this
-   */
-  TracePointSetFilterInserter& operator=(const TracePoint& val) {
-    if (val.time>=min_time)
-      m_set->insert(val);
-
-    return *this;
-  }
+  const unsigned position = nodes[index].heap_index;
+  if (position == null_index)
+    return;
 
-  /** 
-   * Dummy dereference operator
-   *
-   * @return Reference to this
-   */
-  TracePointSetFilterInserter& operator*() {
-    return *this;
-  }
+  nodes[index].heap_index = null_index;
 
-  /** 
-   * Dummy increment operator
-   * 
-   * @param x N to increment
-   * 
-   * @return Reference to this
-   */
-  TracePointSetFilterInserter& operator++(const int x) {
-    return *this;
-  }
+  const unsigned last = heap.back();
+  heap.pop_back();
+  if (position == heap.size())
+    return;
+
+  heap_set(position, last);
+  heap_update(last);
+}
+
+void
+Trace::heap_update(unsigned index)
+{
+  const unsigned position = nodes[index].heap_index;
+  assert(position != null_index);
 
-private:
-  TracePointSet* m_set;
-  unsigned min_time;
-};
+  if (position > 0 && heap_less(index, heap[(position - 1) / 2]))
+    heap_sift_up(position);
+  else
+    heap_sift_down(position);
+}
 
 TracePointVector
 Trace::find_within_range(const GeoPoint &loc, const fixed range,
                          const unsigned mintime, const fixed resolution) const
 {
-  if (empty()) 
+  if (empty())
     return TracePointVector();
-  
+
   TracePoint bb_target(loc);
   bb_target.project(task_projection);
-  const unsigned mrange = task_projection.project_range(loc, range);
-
-  // TracePointVector vectors;
-  TracePointSet tset;
-  TracePointSetFilterInserter filter(tset, mintime);
-  trace_tree.find_within_range(bb_target, mrange, filter);
-
-  /*
-  // std::inserter(tset, tset.begin()));
-  if (mintime>0) {
-    TracePointSet::iterator tit = tset.lower_bound(bb_target);
-    tset.erase(tset.begin(), tit);
+  const int mrange = task_projection.project_range(loc, range);
+
+  const FlatGeoPoint &center = bb_target.get_flatLocation();
+  const int x_min = center.Longitude - mrange;
+  const int x_max = center.Longitude + mrange;
+  const int y_min = center.Latitude - mrange;
+  const int y_max = center.Latitude + mrange;
+
+  const int cx_min = x_min >> cell_shift, cx_max = x_max >> cell_shift;
+  const int cy_min = y_min >> cell_shift, cy_max = y_max >> cell_shift;
+  const unsigned num_x = cx_max - cx_min + 1;
+  const unsigned num_y = cy_max - cy_min + 1;
+
+  TracePointVector vec;
+
+  if (num_x >= num_buckets || num_y >= num_buckets ||
+      num_x * num_y >= num_buckets || num_x * num_y >= m_size) {
+    // the range covers most of the grid; a scan in time order is cheaper
+    for (unsigned i = head; i != null_index; i = nodes[i].next) {
+      const TracePoint &tp = nodes[i].point;
+      const FlatGeoPoint &f = tp.get_flatLocation();
+      if (tp.time >= mintime &&
+          f.Longitude >= x_min && f.Longitude <= x_max &&
+          f.Latitude >= y_min && f.Latitude <= y_max)
+        vec.push_back(tp);
+    }
+  } else {
+    // several cells may share a bucket, visit each bucket only once
+    std::bitset<num_buckets> visited;
+
+    for (int cx = cx_min; cx <= cx_max; ++cx) {
+      for (int cy = cy_min; cy <= cy_max; ++cy) {
+        const unsigned bucket = bucket_of(cx, cy);
+        if (visited[bucket])
+          continue;
+        visited[bucket] = true;
+
+        for (unsigned i = buckets[bucket]; i != null_index;
+             i = nodes[i].cell_next) {
+          const TracePoint &tp = nodes[i].point;
+          const FlatGeoPoint &f = tp.get_flatLocation();
+          if (tp.time >= mintime &&
+              f.Longitude >= x_min && f.Longitude <= x_max &&
+              f.Latitude >= y_min && f.Latitude <= y_max)
+            vec.push_back(tp);
+        }
+      }
+    }
+
+    std::sort(vec.begin(), vec.end(), TracePoint::time_sort());
   }
-  */
 
   if (positive(resolution)) {
     const unsigned rrange = task_projection.project_range(loc, resolution);
-    TracePointList tlist(tset.begin(), tset.end());
+    TracePointList tlist(vec.begin(), vec.end());
     thin_trace(tlist, rrange * rrange);
     return TracePointVector(tlist.begin(), tlist.end());
   } else {
-    return TracePointVector(tset.begin(), tset.end());
-  }
-}
-
-bool
-Trace::optimise_if_old()
-{
-  if (m_last_point.time > m_optimise_time + 60) {
-    optimise();
-    return true;
+    return vec;
   }
-
-  return false;
 }
 
 static void
@@ -383,7 +460,7 @@ adjust_links(const TracePoint& previous, const TracePoint& obj,
     next.last_time = previous.time;
 }
 
-void 
+void
 Trace::thin_trace(TracePointList& tlist, const unsigned mrange_sq)
 {
   if (tlist.size() < 2)
@@ -413,17 +490,15 @@ TracePointVector
 Trace::get_trace_points(const unsigned max_points) const
 {
   if (max_points == 2) {
-    if (trace_tree.size()<2) {
+    if (m_size < 2) {
       return TracePointVector();
     }
-    // special case - just look for points within time range
+    // special case - just look for the earliest point within time range
     TracePoint p;
-    unsigned tmin = (unsigned)-1;
-    for (TraceTree::const_iterator tr = trace_tree.begin();
-         tr != trace_tree.end(); ++tr) {
-      if (inside_time_window(tr->time) && (tr->time< tmin)) {
-        p = *tr;
-        tmin = tr->time;
+    for (unsigned i = head; i != null_index; i = nodes[i].next) {
+      if (inside_time_window(nodes[i].point.time)) {
+        p = nodes[i].point;
+        break;
       }
     }
     TracePointVector v;
@@ -432,12 +507,11 @@ Trace::get_trace_points(const unsigned max_points) const
     return v;
   }
 
-  TracePointSet tset(begin(), end());
-
-  if (tset.empty())
+  if (empty())
     return TracePointVector();
 
-  TracePointList tlist(tset.begin(), tset.end());
+  // points are stored in time order already
+  TracePointList tlist(begin(), end());
 
   unsigned mrange = 3;
 
@@ -449,6 +523,20 @@ Trace::get_trace_points(const unsigned max_points) const
   return TracePointVector(tlist.begin(), tlist.end());
 }
 
+TracePointVector
+Trace::get_trace_points_after(const unsigned min_time) const
+{
+  unsigned first = null_index;
+  for (unsigned i = tail; i != null_index && nodes[i].point.time > min_time;
+       i = nodes[i].prev)
+    first = i;
+
+  TracePointVector v;
+  for (unsigned i = first; i != null_index; i = nodes[i].next)
+    v.push_back(nodes[i].point);
+  return v;
+}
+
 bool
 Trace::is_null(const TracePoint& tp)
 {
@@ -23,14 +23,14 @@
 #define TRACE_HPP
 
 #include "Util/NonCopyable.hpp"
-#include <kdtree++/kdtree.hpp>
 #include "Navigation/TracePoint.hpp"
 #include "Navigation/TaskProjection.hpp"
 #include "Compiler.h"
 
 #include <set>
 #include <list>
-#include <map>
+#include <vector>
+#include <iterator>
 
 struct AIRCRAFT_STATE;
 
@@ -38,14 +38,48 @@ typedef std::set<TracePoint, TracePoint::time_sort> TracePointSet;
 typedef std::list<TracePoint> TracePointList;
 
 /**
- * Container for traces using kd-tree representation internally for fast 
- * geospatial lookups.
+ * Container for traces, stored in time order in a contiguous node pool.
  *
- * This also uses a smart thinning algorithm to limit the number of items
- * in the store.
+ * Points are linked into a doubly-linked list in time order, which is
+ * also the list from which points are removed when thinning.  Thinning
+ * candidates are kept in a binary heap ordered by the distance error
+ * introduced by removing the point, so the store is trimmed
+ * incrementally on each append() rather than by periodic rebuilds.
+ *
+ * Geospatial lookups are served by a hashed grid over the flat
+ * projected coordinates, which is updated as points are added and
+ * removed.
  */
 class Trace: private NonCopyable 
 {
+  /** Index value used to mark the end of a list or an unused link */
+  static const unsigned null_index;
+
+  /** Number of buckets in the spatial hash grid (power of two) */
+  static const unsigned num_buckets = 256;
+
+  /** log2 of the spatial grid cell size in flat projected units */
+  static const unsigned cell_shift = 4;
+
+  struct TraceNode {
+    TracePoint point;
+
+    /** Neighbours in the time-ordered list */
+    unsigned prev, next;
+
+    /** Neighbours in the spatial bucket chain */
+    unsigned cell_prev, cell_next;
+
+    /** Position in the thinning heap, or null_index if not a candidate */
+    unsigned heap_index;
+
+    /** Distance error (flat units) introduced by removing this point */
+    unsigned delta_distance;
+
+    /** Time span (s) which would be merged by removing this point */
+    unsigned delta_time;
+  };
+
 public:
   friend class PrintHelper;
 
@@ -61,64 +95,108 @@ public:
         const unsigned max_points = 1000);
 
   /**
-   * Add trace to internal store.  Call optimise() periodically
-   * to balance tree for faster queries
+   * Add trace to internal store.  Points outside the time window are
+   * dropped, and the store is thinned back to its maximum size, so
+   * no periodic maintenance is required.
    *
    * @param state Aircraft state to log point for
    */
   void append(const AIRCRAFT_STATE& state);
 
   /**
-   * Optimise the internal search tree after adding/removing elements.
+   * Clear the trace store
+   *
    */
-  void optimise();
+  void clear();
 
   /**
-   * Clear the trace store
+   * Replace the contents of this store with a copy of another one,
+   * including its parameters, e.g. to work on a snapshot in another
+   * thread.  Storage is reused, so repeated copies do not allocate
+   * once the store has reached its maximum size.
    *
+   * @param other Trace to copy
    */
-  void clear();
+  void assign(const Trace &other);
 
   /**
-   * Size of traces (in tree, not in temporary store) ---
-   * must call optimise() before this for it to be accurate.
+   * Size of traces
    *
-   * @return Number of traces in tree
+   * @return Number of traces in store
    */
-  unsigned size() const;
+  gcc_pure
+  unsigned size() const {
+    return m_size;
+  }
 
   /**
    * Whether traces store is empty
    *
    * @return True if no traces stored
    */
-  bool empty() const;
+  gcc_pure
+  bool empty() const {
+    return m_size == 0;
+  }
 
   /**
-   * Type of KD-tree data structure for trace container
+   * Iterator over the stored points in time order
    */
-  typedef KDTree::KDTree<2, TracePoint, TracePoint::kd_get_location> TraceTree;
+  class const_iterator {
+    friend class Trace;
+
+    const std::vector<TraceNode> *nodes;
+    unsigned index;
+
+    const_iterator(const std::vector<TraceNode> &_nodes, unsigned _index)
+      :nodes(&_nodes), index(_index) {}
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef TracePoint value_type;
+    typedef const TracePoint *pointer;
+    typedef const TracePoint &reference;
+    typedef ptrdiff_t difference_type;
+
+    const TracePoint &operator*() const {
+      return (*nodes)[index].point;
+    }
+
+    const TracePoint *operator->() const {
+      return &(*nodes)[index].point;
+    }
+
+    const_iterator &operator++() {
+      index = (*nodes)[index].next;
+      return *this;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return index == other.index;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return index != other.index;
+    }
+  };
 
   /**
-   * Access first trace in store, for use in iterators.
+   * Access first (earliest) trace in store, for use in iterators.
    *
    * @return First trace in store
    */
-  TraceTree::const_iterator begin() const;
+  const_iterator begin() const {
+    return const_iterator(nodes, head);
+  }
 
   /**
    * Access end trace in store, for use in iterators as end point.
    *
    * @return End trace in store
    */
-  TraceTree::const_iterator end() const;
-
-  /**
-   * Re-balance kd-tree periodically 
-   *
-   * @return True if trace store was optimised
-   */
-  bool optimise_if_old();
+  const_iterator end() const {
+    return const_iterator(nodes, null_index);
+  }
 
   /**
    * Find traces within approximate range (square range box)
@@ -129,7 +207,7 @@ public:
    * @param mintime Minimum time to match (recency)
    * @param resolution Thin data to achieve minimum step size in (m) (if positive)
    *
-   * @return Vector of trace points within square range
+   * @return Vector of trace points within square range, in time order
    */
   gcc_pure
   TracePointVector
@@ -147,60 +225,85 @@ public:
   gcc_pure
   TracePointVector get_trace_points(const unsigned max_points) const;
 
-private:
-  struct TraceDelta {
-    unsigned time;
-    unsigned distance;
-  };
-  typedef std::map<unsigned, TraceDelta> TraceDeltaMap;
+  /**
+   * Retrieve the points stored after the specified time, without
+   * thinning.  Cost is proportional to the number of points returned.
+   *
+   * @param min_time Time (s) after which points are returned
+   *
+   * @return Vector of trace points, in time order
+   */
+  gcc_pure
+  TracePointVector get_trace_points_after(const unsigned min_time) const;
 
+private:
   static void thin_trace(TracePointList& vec, const unsigned range_sq);
+
   void trim_point_delta();
   void trim_point_time();
 
-  gcc_pure
-  unsigned lowest_delta() const;
-
   gcc_pure
   bool inside_recent_time(unsigned time) const;
 
   gcc_pure
   bool inside_time_window(unsigned time) const;
 
-  TraceTree trace_tree;
-  TraceDeltaMap delta_map;
+  unsigned allocate_node();
+  void erase(unsigned index);
+  void erase_head();
 
-  TaskProjection task_projection;
+  void update_delta(unsigned index);
+  void update_candidates();
 
-  TracePoint m_last_point;
-  unsigned m_optimise_time;
+  gcc_pure
+  static unsigned bucket_of(int cell_x, int cell_y);
 
-  const unsigned m_recent_time;
-  const unsigned m_max_time;
-  const unsigned m_max_points;
+  gcc_pure
+  static unsigned bucket_of(const FlatGeoPoint &flat);
 
-  void erase(TraceTree::const_iterator& it);
-  void erase_earlier_than(unsigned time);
+  void bucket_insert(unsigned index);
+  void bucket_remove(unsigned index);
 
-  /**
-   * Find item which precedes this item
-   *
-   * @return Iterator to item
-   */
   gcc_pure
-  TraceTree::const_iterator find_prev(const TracePoint& tp) const;
+  bool heap_less(unsigned a, unsigned b) const;
+
+  void heap_set(unsigned position, unsigned index);
+  void heap_push(unsigned index);
+  void heap_remove(unsigned index);
+  void heap_update(unsigned index);
+  void heap_sift_up(unsigned position);
+  void heap_sift_down(unsigned position);
+
+  /** Node pool; unused nodes are chained through TraceNode::next */
+  std::vector<TraceNode> nodes;
+
+  /** Heap of thinning candidates (node indices), lowest delta first */
+  std::vector<unsigned> heap;
+
+  /** First node of each spatial bucket chain */
+  unsigned buckets[num_buckets];
+
+  /** Earliest and latest points in the time-ordered list */
+  unsigned head, tail;
+
+  /** First node of the free list */
+  unsigned free_list;
 
   /**
-   * Find item which follows this item
-   *
-   * @return Iterator to item
+   * First node which has not yet been considered for thinning; all
+   * points from here to the tail are within the recent time
    */
-  gcc_pure
-  TraceTree::const_iterator find_next(const TracePoint& tp) const;
+  unsigned recent_cursor;
+
+  unsigned m_size;
+
+  TaskProjection task_projection;
+
+  TracePoint m_last_point;
 
-  void update_delta(TraceTree::const_iterator it_prev,
-                    TraceTree::const_iterator it,
-                    TraceTree::const_iterator it_next);
+  unsigned m_recent_time;
+  unsigned m_max_time;
+  unsigned m_max_points;
 
   static const unsigned null_delta;
 
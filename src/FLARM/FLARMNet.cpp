@@ -25,14 +25,61 @@ Copyright_License {
 #include "Util/StringUtil.hpp"
 #include "IO/LineReader.hpp"
 #include "IO/FileLineReader.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
+#include "Compiler.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-FLARMNetDatabase::~FLARMNetDatabase()
+static const TCHAR cache_name[] = _T("flarmnet");
+
+/** marks an empty slot in the hash tables */
+static const unsigned EMPTY = (unsigned)-1;
+
+struct FLARMNetSnapshotHeader {
+  static const unsigned VERSION = 1;
+
+  unsigned version;
+
+  /** sizeof(TCHAR) of the writer */
+  unsigned char_size;
+
+  /** sizeof(FLARMNetRecord) of the writer */
+  unsigned record_size;
+
+  unsigned num_records;
+};
+
+template<unsigned size>
+static inline void
+Terminate(TCHAR (&field)[size])
+{
+  field[size - 1] = _T('\0');
+}
+
+static void
+TerminateRecord(FLARMNetRecord &record)
 {
-  for (iterator i = begin(); i != end(); ++i)
-    delete i->second;
+  Terminate(record.id);
+  Terminate(record.name);
+  Terminate(record.airfield);
+  Terminate(record.type);
+  Terminate(record.reg);
+  Terminate(record.cn);
+  Terminate(record.freq);
+}
+
+/** FNV-1a hash of a callsign */
+gcc_pure
+static unsigned
+HashCallsign(const TCHAR *cn)
+{
+  unsigned h = 2166136261u;
+  for (; *cn != 0; ++cn)
+    h = (h ^ (unsigned)*cn) * 16777619u;
+  return h;
 }
 
 /**
@@ -70,11 +117,11 @@ LoadString(const char *bytes, int charCount, TCHAR *res)
  * @param file File handle
  * @param record Pointer to the FLARMNetRecord to be filled
  */
-static void
+static bool
 LoadRecord(const char *line, FLARMNetRecord *record)
 {
   if (strlen(line) < 172)
-    return;
+    return false;
 
   LoadString(line, 6, record->id);
   LoadString(line + 12, 21, record->name);
@@ -92,6 +139,85 @@ LoadRecord(const char *line, FLARMNetRecord *record)
 
     i++;
   }
+
+  return true;
+}
+
+/**
+ * Rebuilds both hash tables with the given number of slots, which
+ * must be a power of two larger than the number of records
+ */
+void
+FLARMNetDatabase::Rehash(unsigned capacity)
+{
+  id_table.assign(capacity, EMPTY);
+  cn_table.assign(capacity, EMPTY);
+
+  const unsigned mask = capacity - 1;
+  for (unsigned index = 0; index < records.size(); ++index) {
+    unsigned slot = ids[index].hash() & mask;
+    while (id_table[slot] != EMPTY)
+      slot = (slot + 1) & mask;
+    id_table[slot] = index;
+
+    InsertCallsign(index);
+  }
+}
+
+void
+FLARMNetDatabase::Reserve(unsigned n)
+{
+  /* keep the load factor at or below one half */
+  unsigned capacity = id_table.empty() ? 64 : id_table.size();
+  while (capacity < 2 * n)
+    capacity *= 2;
+
+  if (capacity != id_table.size())
+    Rehash(capacity);
+}
+
+void
+FLARMNetDatabase::InsertCallsign(unsigned index)
+{
+  const unsigned mask = cn_table.size() - 1;
+  const TCHAR *cn = records[index].cn;
+
+  unsigned slot = HashCallsign(cn) & mask;
+  for (; cn_table[slot] != EMPTY; slot = (slot + 1) & mask) {
+    unsigned &other = cn_table[slot];
+    if (_tcscmp(records[other].cn, cn) == 0) {
+      /* the old linear search returned the lowest id */
+      if (ids[index] < ids[other])
+        other = index;
+      return;
+    }
+  }
+
+  cn_table[slot] = index;
+}
+
+/**
+ * Adds a record, unless another one with the same id exists already
+ *
+ * @return true if the record was added
+ */
+bool
+FLARMNetDatabase::Add(const FLARMNetRecord &record, FlarmId id)
+{
+  Reserve(records.size() + 1);
+
+  const unsigned mask = id_table.size() - 1;
+  unsigned slot = id.hash() & mask;
+  for (; id_table[slot] != EMPTY; slot = (slot + 1) & mask)
+    if (ids[id_table[slot]] == id)
+      return false;
+
+  const unsigned index = records.size();
+  records.push_back(record);
+  ids.push_back(id);
+  id_table[slot] = index;
+  InsertCallsign(index);
+  return true;
 }
 
 unsigned
@@ -103,33 +229,114 @@ FLARMNetDatabase::LoadFile(NLineReader &reader)
     return 0;
 
   int itemCount = 0;
+  FLARMNetRecord record;
   while ((line = reader.read()) != NULL) {
-    FLARMNetRecord *record = new FLARMNetRecord;
+    if (LoadRecord(line, &record) && Add(record, record.GetId()))
+      itemCount++;
+  };
 
-    LoadRecord(line, record);
+  return itemCount;
+}
 
-    insert(value_type(record->GetId(), record));
+bool
+FLARMNetDatabase::SaveSnapshot(FILE *file) const
+{
+  FLARMNetSnapshotHeader header;
+  header.version = FLARMNetSnapshotHeader::VERSION;
+  header.char_size = sizeof(TCHAR);
+  header.record_size = sizeof(FLARMNetRecord);
+  header.num_records = records.size();
 
-    itemCount++;
-  };
+  return fwrite(&header, sizeof(header), 1, file) == 1 &&
+    (records.empty() ||
+     (fwrite(&ids[0], sizeof(ids[0]), ids.size(), file) == ids.size() &&
+      fwrite(&records[0], sizeof(records[0]), records.size(),
+             file) == records.size()));
+}
 
-  return itemCount;
+bool
+FLARMNetDatabase::LoadSnapshot(const FileMapping &mapping, size_t offset)
+{
+  if (mapping.size() < offset + sizeof(FLARMNetSnapshotHeader))
+    return false;
+
+  FLARMNetSnapshotHeader header;
+  memcpy(&header, mapping.at(offset), sizeof(header));
+  offset += sizeof(header);
+
+  /* divide instead of multiplying the count from the file, which
+     could overflow on 32 bit machines */
+  if (header.version != FLARMNetSnapshotHeader::VERSION ||
+      header.char_size != sizeof(TCHAR) ||
+      header.record_size != sizeof(FLARMNetRecord) ||
+      header.num_records > (mapping.size() - offset) /
+      (sizeof(FlarmId) + sizeof(FLARMNetRecord)))
+    return false;
+
+  const size_t records_offset = offset + header.num_records * sizeof(FlarmId);
+  records.resize(header.num_records);
+  ids.resize(header.num_records);
+  if (header.num_records > 0) {
+    memcpy(&ids[0], mapping.at(offset),
+           header.num_records * sizeof(FlarmId));
+    memcpy(&records[0], mapping.at(records_offset),
+           header.num_records * sizeof(FLARMNetRecord));
+  }
+
+  /* don't trust the file to contain valid strings */
+  for (std::vector<FLARMNetRecord>::iterator i = records.begin();
+       i != records.end(); ++i)
+    TerminateRecord(*i);
+
+  /* the writer rejected duplicate ids, so the tables can be built
+     without checking */
+  id_table.clear();
+  Reserve(header.num_records);
+  return true;
 }
 
-/**
- * Reads the FLARMnet.org file and fills the map
- *
- * @param path the path of the file
- * @return the number of records read from the file
- */
 unsigned
-FLARMNetDatabase::LoadFile(const TCHAR *path)
+FLARMNetDatabase::LoadFile(const TCHAR *path, FileCache *cache)
 {
+  /* the snapshot replaces the whole database */
+  if (!empty())
+    cache = NULL;
+
+  if (cache != NULL) {
+    size_t offset;
+    FileMapping *mapping = cache->map(cache_name, path, offset);
+    if (mapping != NULL) {
+      bool success = LoadSnapshot(*mapping, offset);
+      delete mapping;
+
+      if (success)
+        return size();
+
+      records.clear();
+      ids.clear();
+      id_table.clear();
+      cn_table.clear();
+      cache->flush(cache_name);
+    }
+  }
+
   FileLineReaderA file(path);
   if (file.error())
     return 0;
 
-  return LoadFile(file);
+  unsigned num_records = LoadFile(file);
+
+  if (cache != NULL) {
+    FILE *cache_file = cache->save(cache_name, path);
+    if (cache_file != NULL) {
+      if (SaveSnapshot(cache_file))
+        cache->commit(cache_name, cache_file);
+      else
+        cache->cancel(cache_name, cache_file);
+    }
+  }
+
+  return num_records;
 }
 
 /**
@@ -140,9 +347,14 @@ FLARMNetDatabase::LoadFile(const TCHAR *path)
 const FLARMNetRecord *
 FLARMNetDatabase::Find(FlarmId id) const
 {
-  const_iterator i = find(id);
-  if (i != end())
-    return i->second;
+  if (id_table.empty())
+    return NULL;
+
+  const unsigned mask = id_table.size() - 1;
+  for (unsigned slot = id.hash() & mask; id_table[slot] != EMPTY;
+       slot = (slot + 1) & mask)
+    if (ids[id_table[slot]] == id)
+      return &records[id_table[slot]];
 
   return NULL;
 }
@@ -155,13 +367,15 @@ FLARMNetDatabase::Find(FlarmId id) const
 const FLARMNetRecord *
 FLARMNetDatabase::Find(const TCHAR *cn) const
 {
-  const_iterator i = begin();
-  while (i != end()) {
-    const FLARMNetRecord *record = (const FLARMNetRecord *)(i->second);
-    if (_tcscmp(record->cn, cn) == 0)
-      return record;
+  if (cn_table.empty())
+    return NULL;
 
-    i++;
+  const unsigned mask = cn_table.size() - 1;
+  for (unsigned slot = HashCallsign(cn) & mask; cn_table[slot] != EMPTY;
+       slot = (slot + 1) & mask) {
+    const FLARMNetRecord &record = records[cn_table[slot]];
+    if (_tcscmp(record.cn, cn) == 0)
+      return &record;
   }
 
   return NULL;
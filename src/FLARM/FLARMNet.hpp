@@ -25,11 +25,15 @@ Copyright_License {
 #define XCSOAR_FLARM_NET_HPP
 
 #include "FLARM/Traffic.hpp"
+#include "Util/NonCopyable.hpp"
 
-#include <map>
+#include <vector>
+#include <stdio.h>
 #include <tchar.h>
 
 class NLineReader;
+class FileCache;
+class FileMapping;
 
 /**
  * FLARMnet.org file entry
@@ -50,18 +54,59 @@ public:
 
 /**
  * Handles the FLARMnet.org file
+ *
+ * The records are stored in one flat array, which is indexed by two
+ * open addressing hash tables: one on the FLARM id and one on the
+ * callsign.  The parsed array can be saved to and loaded from a
+ * #FileCache, which skips parsing the text file on later runs.
  */
-class FLARMNetDatabase
-  : protected std::map<FlarmId, FLARMNetRecord*>
+class FLARMNetDatabase : private NonCopyable
 {
-public:
-  ~FLARMNetDatabase();
+  std::vector<FLARMNetRecord> records;
+
+  /** the parsed id of each element of #records */
+  std::vector<FlarmId> ids;
+
+  /** indices into #records, hashed by id; the size is a power of two */
+  std::vector<unsigned> id_table;
 
+  /**
+   * Indices into #records, hashed by callsign.  Of all records
+   * sharing a callsign, only the one with the lowest id is listed.
+   */
+  std::vector<unsigned> cn_table;
+
+public:
   unsigned LoadFile(NLineReader &reader);
-  unsigned LoadFile(const TCHAR *path);
+
+  /**
+   * Reads the FLARMnet.org file.  If a cache is given and the
+   * database is empty, a binary snapshot is loaded from (or saved
+   * to) the cache.
+   *
+   * @return the number of records added
+   */
+  unsigned LoadFile(const TCHAR *path, FileCache *cache = NULL);
+
+  bool empty() const {
+    return records.empty();
+  }
+
+  unsigned size() const {
+    return records.size();
+  }
 
   const FLARMNetRecord *Find(FlarmId id) const;
   const FLARMNetRecord *Find(const TCHAR *cn) const;
+
+private:
+  void Rehash(unsigned capacity);
+  void Reserve(unsigned n);
+  void InsertCallsign(unsigned index);
+  bool Add(const FLARMNetRecord &record, FlarmId id);
+
+  bool SaveSnapshot(FILE *file) const;
+  bool LoadSnapshot(const FileMapping &mapping, size_t offset);
 };
 
 #endif
@@ -22,27 +22,26 @@ Copyright_License {
 */
 
 #include "FLARM/FlarmCalculations.h"
-#include "FLARM/State.hpp"
 
-FlarmCalculations::~FlarmCalculations()
+#include <assert.h>
+
+FlarmCalculations::FlarmCalculations()
 {
-  for (AverageCalculatorMap::iterator i = averageCalculatorMap.begin();
-       i != averageCalculatorMap.end(); ++i)
-    delete i->second;
+  for (unsigned i = 0; i < FLARM_STATE::FLARM_MAX_TRAFFIC; ++i)
+    ids[i].clear();
 }
 
 fixed
-FlarmCalculations::Average30s(FlarmId flarmId, fixed curTime, fixed curAltitude)
+FlarmCalculations::Average30s(unsigned slot, FlarmId flarmId,
+                              fixed curTime, fixed curAltitude)
 {
-  ClimbAverageCalculator *itemTemp = NULL;
-  AverageCalculatorMap::iterator iterFind = averageCalculatorMap.find(flarmId);
-
-  if (iterFind != averageCalculatorMap.end()) {
-    itemTemp = averageCalculatorMap[flarmId];
-  } else {
-    itemTemp = new ClimbAverageCalculator();
-    averageCalculatorMap[flarmId] = itemTemp;
+  assert(slot < FLARM_STATE::FLARM_MAX_TRAFFIC);
+
+  ClimbAverageCalculator &calculator = averageCalculators[slot];
+  if (!(ids[slot] == flarmId)) {
+    ids[slot] = flarmId;
+    calculator.Reset();
   }
 
-  return itemTemp->GetAverage(curTime, curAltitude, fixed(30));
+  return calculator.GetAverage(curTime, curAltitude, fixed(30));
 }
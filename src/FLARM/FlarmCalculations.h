@@ -24,24 +24,32 @@ Copyright_License {
 #ifndef FLARMCALCULATIONS_H
 #define FLARMCALCULATIONS_H
 
-#include "FLARM/FlarmId.hpp"
+#include "FLARM/State.hpp"
 #include "ClimbAverageCalculator.hpp"
 
-#include <map>
 #include <tchar.h>
 
-struct FLARM_STATE;
-
+/**
+ * Keeps the altitude history of each FLARM target.  The histories
+ * are parallel to the slots of #FLARM_STATE, so that they can be
+ * looked up without searching and without allocating memory.
+ */
 class FlarmCalculations
 {
 public:
-  ~FlarmCalculations();
+  FlarmCalculations();
 
-  fixed Average30s(FlarmId flarmId, fixed curTime, fixed curAltitude);
+  /**
+   * @param slot the index of the target in FLARM_STATE::FLARM_Traffic
+   * @param flarmId the id of the target; if it differs from the
+   * previous occupant of the slot, the history is reset
+   */
+  fixed Average30s(unsigned slot, FlarmId flarmId,
+                   fixed curTime, fixed curAltitude);
 
 private:
-  typedef std::map<FlarmId, ClimbAverageCalculator*> AverageCalculatorMap;
-  AverageCalculatorMap averageCalculatorMap;
+  FlarmId ids[FLARM_STATE::FLARM_MAX_TRAFFIC];
+  ClimbAverageCalculator averageCalculators[FLARM_STATE::FLARM_MAX_TRAFFIC];
 };
 
 #endif
@@ -31,6 +31,7 @@ Copyright_License {
 #include "IO/TextWriter.hpp"
 
 #include <stdlib.h>
+#include <windef.h> // for MAX_PATH
 
 static FLARMNetDatabase flarm_net;
 
@@ -46,23 +47,21 @@ typedef struct {
 static FLARM_Names_t FLARM_Names[MAXFLARMNAMES];
 
 void
-FlarmDetails::Load()
+FlarmDetails::Load(FileCache *cache)
 {
   LogStartUp(_T("FlarmDetails::Load"));
 
   LoadSecondary();
-  LoadFLARMnet();
+  LoadFLARMnet(cache);
 }
 
 void
-FlarmDetails::LoadFLARMnet()
+FlarmDetails::LoadFLARMnet(FileCache *cache)
 {
-  NLineReader *reader = OpenDataTextFileA(_T("data.fln"));
-  if (reader == NULL)
-    return;
+  TCHAR path[MAX_PATH];
+  LocalPath(path, _T("data.fln"));
 
-  unsigned num_records = flarm_net.LoadFile(*reader);
-  delete reader;
+  unsigned num_records = flarm_net.LoadFile(path, cache);
 
   if (num_records > 0)
     LogStartUp(_T("%u FLARMnet ids found"), num_records);
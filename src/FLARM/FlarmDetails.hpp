@@ -27,20 +27,25 @@ Copyright_License {
 
 class FlarmId;
 class FLARMNetRecord;
+class FileCache;
 
 namespace FlarmDetails
 {
   /**
    * Loads XCSoar's own FLARM details file and the FLARMnet file
+   *
+   * @param cache an optional cache for the parsed FLARMnet file
    */
   void
-  Load();
+  Load(FileCache *cache = NULL);
 
   /**
    * Loads the FLARMnet file
+   *
+   * @param cache an optional cache for the parsed FLARMnet file
    */
   void
-  LoadFLARMnet();
+  LoadFLARMnet(FileCache *cache = NULL);
 
   /**
    * Opens XCSoars own FLARM details file, parses it and
@@ -54,6 +54,16 @@ public:
     return value < other.value;
   }
 
+  /**
+   * Returns a well distributed hash of the id, for hash tables.
+   */
+  unsigned hash() const {
+    /* multiplicative hashing; fold the well mixed upper bits down
+       so that masking the low bits is good enough */
+    const uint32_t h = value * 2654435761u;
+    return h ^ (h >> 16);
+  }
+
   void parse(const char *input, char **endptr_r);
 #ifdef _UNICODE
   void parse(const TCHAR *input, TCHAR **endptr_r);
@@ -23,6 +23,161 @@ Copyright_License {
 
 #include "FLARM/State.hpp"
 
+#include <assert.h>
+
+static const unsigned TRAFFIC_HASH_MASK = FLARM_STATE::TRAFFIC_HASH_SIZE - 1;
+
+/**
+ * Returns the bucket at which the probe sequence for the id starts.
+ */
+static unsigned
+HomeBucket(FlarmId id)
+{
+  return id.hash() & TRAFFIC_HASH_MASK;
+}
+
+/**
+ * Returns the bucket which references the given id, or the empty
+ * bucket which terminates its probe sequence.
+ */
+unsigned
+FLARM_STATE::FindTrafficBucket(FlarmId id) const
+{
+  unsigned bucket = HomeBucket(id);
+  while (traffic_hash[bucket] != 0 &&
+         !(FLARM_Traffic[traffic_hash[bucket] - 1].ID == id))
+    bucket = (bucket + 1) & TRAFFIC_HASH_MASK;
+
+  return bucket;
+}
+
+const FLARM_TRAFFIC *
+FLARM_STATE::FindTraffic(FlarmId id) const
+{
+  if (!id.defined())
+    return NULL;
+
+  const unsigned bucket = FindTrafficBucket(id);
+  return traffic_hash[bucket] != 0
+    ? &FLARM_Traffic[traffic_hash[bucket] - 1]
+    : NULL;
+}
+
+void
+FLARM_STATE::LinkNewestTraffic(unsigned slot)
+{
+  older_traffic[slot] = newest_traffic;
+  newer_traffic[slot] = 0;
+
+  if (newest_traffic != 0)
+    newer_traffic[newest_traffic - 1] = slot + 1;
+  else
+    oldest_traffic = slot + 1;
+
+  newest_traffic = slot + 1;
+}
+
+void
+FLARM_STATE::UnlinkTraffic(unsigned slot)
+{
+  const unsigned older = older_traffic[slot], newer = newer_traffic[slot];
+
+  if (older != 0)
+    newer_traffic[older - 1] = newer;
+  else
+    oldest_traffic = newer;
+
+  if (newer != 0)
+    older_traffic[newer - 1] = older;
+  else
+    newest_traffic = older;
+}
+
+void
+FLARM_STATE::RemoveTraffic(unsigned slot)
+{
+  FLARM_TRAFFIC &traffic = FLARM_Traffic[slot];
+  assert(traffic.defined());
+
+  unsigned bucket = FindTrafficBucket(traffic.ID);
+  assert(traffic_hash[bucket] == slot + 1);
+
+  /* delete the bucket by shifting the following buckets of the
+     cluster back, unless that would move them before their home
+     bucket; this keeps the probe sequences intact without
+     tombstones */
+  unsigned next = bucket;
+  while (true) {
+    next = (next + 1) & TRAFFIC_HASH_MASK;
+    if (traffic_hash[next] == 0)
+      break;
+
+    const unsigned home =
+      HomeBucket(FLARM_Traffic[traffic_hash[next] - 1].ID);
+    if (((next - home) & TRAFFIC_HASH_MASK) >=
+        ((next - bucket) & TRAFFIC_HASH_MASK)) {
+      traffic_hash[bucket] = traffic_hash[next];
+      bucket = next;
+    }
+  }
+
+  traffic_hash[bucket] = 0;
+
+  UnlinkTraffic(slot);
+  traffic.Clear();
+  --traffic_count;
+}
+
+FLARM_TRAFFIC *
+FLARM_STATE::AllocateTraffic(FlarmId id)
+{
+  assert(id.defined());
+  assert(FindTraffic(id) == NULL);
+
+  unsigned slot;
+  if (traffic_count < FLARM_MAX_TRAFFIC) {
+    for (slot = 0; FLARM_Traffic[slot].defined(); ++slot)
+      assert(slot + 1 < FLARM_MAX_TRAFFIC);
+  } else {
+    /* the list is full: evict the item which has not been updated
+       for the longest time */
+    slot = oldest_traffic - 1;
+    RemoveTraffic(slot);
+  }
+
+  FLARM_TRAFFIC &traffic = FLARM_Traffic[slot];
+  traffic.ID = id;
+  traffic.Name[0] = 0;
+
+  traffic_hash[FindTrafficBucket(id)] = slot + 1;
+  LinkNewestTraffic(slot);
+  ++traffic_count;
+
+  return &traffic;
+}
+
+void
+FLARM_STATE::Refresh(fixed Time)
+{
+  bool present = false;
+
+  if (FLARM_Available) {
+    for (unsigned i = 0; i < FLARM_MAX_TRAFFIC; i++) {
+      const FLARM_TRAFFIC &traffic = FLARM_Traffic[i];
+      if (!traffic.defined())
+        continue;
+
+      if (traffic.IsExpired(Time))
+        RemoveTraffic(i);
+      else
+        present = true;
+    }
+  }
+
+  FLARMTraffic = present;
+  NewTraffic = false;
+}
+
 const FLARM_TRAFFIC *
 FLARM_STATE::FindMaximumAlert() const
 {
@@ -25,6 +25,9 @@ Copyright_License {
 #define XCSOAR_FLARM_STATE_HPP
 
 #include "FLARM/Traffic.hpp"
+#include "Compiler.h"
+
+#include <stdint.h>
 
 /**
  * Received FLARM data, cached
@@ -32,7 +35,18 @@ Copyright_License {
 struct FLARM_STATE
 {
   enum {
-    FLARM_MAX_TRAFFIC = 15,
+    /**
+     * The capacity of the traffic table.  This is a compile time
+     * constant, because FLARM_STATE is copied by value between the
+     * blackboards.
+     */
+    FLARM_MAX_TRAFFIC = 50,
+
+    /**
+     * The number of buckets of the id hash table.  This must be a
+     * power of two, and at least twice #FLARM_MAX_TRAFFIC.
+     */
+    TRAFFIC_HASH_SIZE = 128,
   };
 
   /** Number of received FLARM devices */
@@ -59,6 +73,30 @@ struct FLARM_STATE
   bool NewTraffic;
 
 protected:
+  /** Number of defined items in #FLARM_Traffic */
+  unsigned short traffic_count;
+
+  /**
+   * Hash table on the ids of #FLARM_Traffic (linear probing).  Each
+   * bucket holds the slot number plus one, zero marks an empty
+   * bucket; this way, a zero-initialised object is valid and empty.
+   */
+  uint8_t traffic_hash[TRAFFIC_HASH_SIZE];
+
+  /**
+   * The defined slots, ordered by the time of their last update: a
+   * doubly linked list of slot numbers plus one, zero terminates.
+   */
+  uint8_t oldest_traffic, newest_traffic;
+  uint8_t older_traffic[FLARM_MAX_TRAFFIC], newer_traffic[FLARM_MAX_TRAFFIC];
+
+  gcc_pure
+  unsigned FindTrafficBucket(FlarmId id) const;
+
+  void LinkNewestTraffic(unsigned slot);
+  void UnlinkTraffic(unsigned slot);
+  void RemoveTraffic(unsigned slot);
+
   const FLARM_TRAFFIC *FirstTrafficSlot() const {
     return &FLARM_Traffic[0];
   }
@@ -79,13 +117,7 @@ public:
   }
 
   unsigned GetActiveTrafficCount() const {
-    unsigned count = 0;
-
-    for (unsigned i = 0; i < FLARM_MAX_TRAFFIC; i++)
-      if (FLARM_Traffic[i].defined())
-        ++count;
-
-    return count;
+    return traffic_count;
   }
 
   /**
@@ -94,13 +126,8 @@ public:
    * @param id FLARM id
    * @return the FLARM_TRAFFIC pointer, NULL if not found
    */
-  FLARM_TRAFFIC *FindTraffic(FlarmId id) {
-    for (unsigned i = 0; i < FLARM_MAX_TRAFFIC; i++)
-      if (FLARM_Traffic[i].ID == id)
-        return &FLARM_Traffic[i];
-
-    return NULL;
-  }
+  gcc_pure
+  const FLARM_TRAFFIC *FindTraffic(FlarmId id) const;
 
   /**
    * Looks up an item in the traffic list.
@@ -108,12 +135,9 @@ public:
    * @param id FLARM id
    * @return the FLARM_TRAFFIC pointer, NULL if not found
    */
-  const FLARM_TRAFFIC *FindTraffic(FlarmId id) const {
-    for (unsigned i = 0; i < FLARM_MAX_TRAFFIC; i++)
-      if (FLARM_Traffic[i].ID == id)
-        return &FLARM_Traffic[i];
-
-    return NULL;
+  FLARM_TRAFFIC *FindTraffic(FlarmId id) {
+    const FLARM_STATE &c = *this;
+    return const_cast<FLARM_TRAFFIC *>(c.FindTraffic(id));
   }
 
   /**
@@ -147,16 +171,26 @@ public:
   }
 
   /**
-   * Allocates a new FLARM_TRAFFIC object from the array.
+   * Allocates a new FLARM_TRAFFIC object from the array.  If the
+   * array is full, the item which has not been updated for the
+   * longest time is evicted.
    *
-   * @return the FLARM_TRAFFIC pointer, NULL if the array is full
+   * @param id the FLARM id of the new item, which must be defined
+   * and not be in the list yet
+   * @return the FLARM_TRAFFIC pointer, with only the id set
    */
-  FLARM_TRAFFIC *AllocateTraffic() {
-    for (unsigned i = 0; i < FLARM_MAX_TRAFFIC; i++)
-      if (!FLARM_Traffic[i].defined())
-        return &FLARM_Traffic[i];
+  FLARM_TRAFFIC *AllocateTraffic(FlarmId id);
 
-    return NULL;
+  /**
+   * Marks an item as just updated, which protects it from eviction
+   * for the longest time.
+   */
+  void TouchTraffic(const FLARM_TRAFFIC &traffic) {
+    const unsigned slot = TrafficIndex(&traffic);
+    if (newest_traffic != slot + 1) {
+      UnlinkTraffic(slot);
+      LinkNewestTraffic(slot);
+    }
   }
 
   /**
@@ -207,19 +241,10 @@ public:
     return traffic - FirstTrafficSlot();
   }
 
-  void Refresh(fixed Time) {
-    bool present = false;
-
-    if (FLARM_Available) {
-      for (unsigned i = 0; i < FLARM_MAX_TRAFFIC; i++) {
-        if (FLARM_Traffic[i].Refresh(Time))
-          present = true;
-      }
-    }
-
-    FLARMTraffic = present;
-    NewTraffic = false;
-  }
+  /**
+   * Removes the expired items from the traffic list.
+   */
+  void Refresh(fixed Time);
 };
 
 #endif
@@ -115,24 +115,13 @@ struct FLARM_TRAFFIC {
   }
 
   /**
-   * Clear this object if its data has expired.
+   * Has the data of this object expired?
    *
-   * @return true if the object is still valid
+   * @return true if the target is too old (2 seconds), or if time
+   * has gone backwards (due to replay)
    */
-  bool Refresh(fixed Time) {
-    if (!defined())
-      return false;
-
-    // if (FLARM target is too old or time has gone backwards)
-    if (Time > fixed(Time_Fix) + fixed_two || Time < fixed(Time_Fix)) {
-      // clear this slot if it is too old (2 seconds), or if
-      // time has gone backwards (due to replay)
-      Clear();
-      return false;
-    } else {
-      // FLARM data is present
-      return true;
-    }
+  bool IsExpired(fixed Time) const {
+    return Time > Time_Fix + fixed_two || Time < Time_Fix;
   }
 
   static const TCHAR* GetTypeString(AircraftType type);
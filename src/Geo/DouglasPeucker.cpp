@@ -0,0 +1,167 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/DouglasPeucker.hpp"
+#include "Navigation/GeoPoint.hpp"
+#include "Util/AllocatedArray.hpp"
+
+#include <math.h>
+#include <assert.h>
+
+/**
+ * The exponent of the tolerance of level 1, see
+ * DouglasPeuckerLevels().  2^-32 radians are about 1.5 mm.
+ */
+static const int LEVEL_EXPONENT = 32;
+
+struct DPPoint {
+  double x, y;
+};
+
+struct DPRange {
+  unsigned first, last;
+
+  /** the deviation of the point which split the parent range */
+  double deviation;
+};
+
+/**
+ * Converts a deviation (radians) to a level.
+ */
+gcc_const
+static unsigned char
+ToLevel(double deviation)
+{
+  if (deviation <= 0)
+    return 0;
+
+  int exponent;
+  frexp(deviation, &exponent);
+  exponent += LEVEL_EXPONENT;
+
+  if (exponent < 1)
+    return 1;
+  if (exponent >= LEVEL_ALWAYS)
+    return LEVEL_ALWAYS - 1;
+  return (unsigned char)exponent;
+}
+
+/**
+ * Returns the distance of p from the segment a-b.
+ */
+gcc_pure
+static double
+SegmentDistance(const DPPoint &p, const DPPoint &a, const DPPoint &b)
+{
+  const double dx = b.x - a.x, dy = b.y - a.y;
+  const double px = p.x - a.x, py = p.y - a.y;
+  const double length2 = dx * dx + dy * dy;
+
+  const double t = length2 > 0 ? (px * dx + py * dy) / length2 : 0;
+  if (t <= 0)
+    return hypot(px, py);
+  if (t >= 1)
+    return hypot(p.x - b.x, p.y - b.y);
+
+  return fabs(px * dy - py * dx) / sqrt(length2);
+}
+
+void
+DouglasPeuckerLevels(const GeoPoint *points, unsigned n,
+                     unsigned char *levels)
+{
+  if (n == 0)
+    return;
+
+  levels[0] = levels[n - 1] = LEVEL_ALWAYS;
+  if (n < 3)
+    return;
+
+  /* project to a plane which is roughly isotropic near the first
+     point */
+  const double cos_latitude = cos((double)points[0].Latitude.value_radians());
+
+  AllocatedArray<DPPoint> flat(n);
+  for (unsigned i = 0; i < n; ++i) {
+    flat[i].x = (double)points[i].Longitude.value_radians() * cos_latitude;
+    flat[i].y = (double)points[i].Latitude.value_radians();
+  }
+
+  /* each split pushes at most two ranges and pops one, and there are
+     no more than n-2 splits */
+  AllocatedArray<DPRange> stack(n);
+  unsigned stack_size = 0;
+
+  DPRange &root = stack[stack_size++];
+  root.first = 0;
+  root.last = n - 1;
+  root.deviation = HUGE_VAL;
+
+  while (stack_size > 0) {
+    const DPRange range = stack[--stack_size];
+    assert(range.last > range.first + 1);
+
+    unsigned split = range.first + 1;
+    double deviation = -1;
+    for (unsigned i = range.first + 1; i < range.last; ++i) {
+      const double d = SegmentDistance(flat[i], flat[range.first],
+                                       flat[range.last]);
+      if (d > deviation) {
+        deviation = d;
+        split = i;
+      }
+    }
+
+    /* a point must never outlive the point which split its range,
+       or the levels would not be nested */
+    if (deviation > range.deviation)
+      deviation = range.deviation;
+
+    levels[split] = ToLevel(deviation);
+
+    if (split > range.first + 1) {
+      assert(stack_size < stack.size());
+      DPRange &left = stack[stack_size++];
+      left.first = range.first;
+      left.last = split;
+      left.deviation = deviation;
+    }
+
+    if (range.last > split + 1) {
+      assert(stack_size < stack.size());
+      DPRange &right = stack[stack_size++];
+      right.first = split;
+      right.last = range.last;
+      right.deviation = deviation;
+    }
+  }
+}
+
+unsigned char
+DouglasPeuckerMinLevel(fixed tolerance)
+{
+  /* points whose deviation is slightly below the tolerance, but
+     within the same power of two, are kept; this errs on the side
+     of accuracy */
+  return ToLevel((double)tolerance);
+}
@@ -0,0 +1,67 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_DOUGLAS_PEUCKER_HPP
+#define XCSOAR_GEO_DOUGLAS_PEUCKER_HPP
+
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+struct GeoPoint;
+
+/**
+ * The level of detail of points which must always be drawn, i.e. the
+ * end points of a line.
+ */
+static const unsigned char LEVEL_ALWAYS = 0xff;
+
+/**
+ * Calculates the level of detail of each point of a line with the
+ * Douglas-Peucker algorithm.  The level of a point describes the
+ * largest tolerance at which it is still needed: a point of level L
+ * is dropped by the simplification when the tolerance is at least
+ * 2^(L-32) radians.  Levels are nested, i.e. the points which pass
+ * DouglasPeuckerMinLevel() for a certain tolerance always form a
+ * valid simplification of the line.
+ *
+ * This is meant to be called once when a shape is loaded.
+ *
+ * @param points the points of the line
+ * @param n the number of points
+ * @param levels an array of n elements which receives the levels
+ */
+void
+DouglasPeuckerLevels(const GeoPoint *points, unsigned n,
+                     unsigned char *levels);
+
+/**
+ * Returns the minimum level of the points which are needed to draw a
+ * line with the specified tolerance.
+ *
+ * @param tolerance the maximum deviation in radians
+ */
+gcc_const
+unsigned char
+DouglasPeuckerMinLevel(fixed tolerance);
+
+#endif
@@ -0,0 +1,236 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/GeoClip.hpp"
+
+#include <assert.h>
+
+void
+GeoClip::set_bounds(const GeoBounds &bounds)
+{
+  const GeoPoint center = bounds.center();
+  center_longitude = center.Longitude;
+  center_latitude = center.Latitude;
+
+  half_width = (bounds.east - bounds.west).as_bearing().value_native() / 2;
+  half_height = (bounds.north - bounds.south).value_native() / 2;
+}
+
+GeoPoint
+GeoClip::to_relative(const GeoPoint &pt) const
+{
+  return GeoPoint((pt.Longitude - center_longitude).as_delta(),
+                  pt.Latitude - center_latitude);
+}
+
+GeoPoint
+GeoClip::to_absolute(const GeoPoint &pt) const
+{
+  return GeoPoint(pt.Longitude + center_longitude,
+                  pt.Latitude + center_latitude);
+}
+
+/**
+ * Clips the parameter range [t0, t1] of a line a+t*d against the
+ * half plane p*t <= q (Liang-Barsky).
+ *
+ * @return false if nothing is left
+ */
+static bool
+ClipT(const fixed p, const fixed q, fixed &t0, fixed &t1)
+{
+  if (!positive(p) && !negative(p))
+    return !negative(q);
+
+  const fixed r = q / p;
+  if (negative(p)) {
+    if (r > t1)
+      return false;
+    if (r > t0)
+      t0 = r;
+  } else {
+    if (r < t0)
+      return false;
+    if (r < t1)
+      t1 = r;
+  }
+
+  return true;
+}
+
+bool
+GeoClip::clip_line(GeoPoint &a, GeoPoint &b) const
+{
+  const GeoPoint ra = to_relative(a), rb = to_relative(b);
+  const fixed xa = ra.Longitude.value_native();
+  const fixed ya = ra.Latitude.value_native();
+  const fixed dx = rb.Longitude.value_native() - xa;
+  const fixed dy = rb.Latitude.value_native() - ya;
+
+  fixed t0 = fixed_zero, t1 = fixed_one;
+  if (!ClipT(-dx, xa + half_width, t0, t1) ||
+      !ClipT(dx, half_width - xa, t0, t1) ||
+      !ClipT(-dy, ya + half_height, t0, t1) ||
+      !ClipT(dy, half_height - ya, t0, t1))
+    return false;
+
+  if (t1 < fixed_one)
+    b = to_absolute(GeoPoint(Angle::native(xa + t1 * dx),
+                             Angle::native(ya + t1 * dy)));
+
+  if (positive(t0))
+    a = to_absolute(GeoPoint(Angle::native(xa + t0 * dx),
+                             Angle::native(ya + t0 * dy)));
+
+  return true;
+}
+
+/**
+ * One edge of the clipping rectangle, in relative coordinates.  A
+ * point is inside if its coordinate on the given axis (negated if
+ * #reverse is set) does not exceed the limit.
+ */
+struct GeoClipEdge {
+  bool latitude, reverse;
+  fixed limit;
+
+  fixed value(const GeoPoint &pt) const {
+    const fixed v = latitude
+      ? pt.Latitude.value_native()
+      : pt.Longitude.value_native();
+    return reverse ? -v : v;
+  }
+
+  bool inside(const GeoPoint &pt) const {
+    return value(pt) <= limit;
+  }
+
+  /**
+   * Returns the intersection of this edge with the segment a-b,
+   * which must cross it.
+   */
+  GeoPoint intersect(const GeoPoint &a, const GeoPoint &b) const {
+    const fixed va = value(a), vb = value(b);
+    assert(va != vb);
+
+    const fixed t = (limit - va) / (vb - va);
+    const fixed border = reverse ? -limit : limit;
+
+    const fixed x = latitude
+      ? a.Longitude.value_native() +
+        t * (b.Longitude.value_native() - a.Longitude.value_native())
+      : border;
+    const fixed y = latitude
+      ? border
+      : a.Latitude.value_native() +
+        t * (b.Latitude.value_native() - a.Latitude.value_native());
+
+    return GeoPoint(Angle::native(x), Angle::native(y));
+  }
+};
+
+/**
+ * Clips a polygon against one edge.  The destination must have room
+ * for n+n/2 points: each point emits at most two, but only if its
+ * predecessor was outside.
+ *
+ * @return the number of points written to dest
+ */
+static unsigned
+ClipEdge(GeoPoint *dest, const GeoPoint *src, unsigned n,
+         const GeoClipEdge &edge)
+{
+  unsigned m = 0;
+
+  const GeoPoint *s = &src[n - 1];
+  bool s_inside = edge.inside(*s);
+
+  for (const GeoPoint *p = src, *end = src + n; p != end; s = p++) {
+    const bool p_inside = edge.inside(*p);
+
+    if (p_inside != s_inside)
+      dest[m++] = edge.intersect(*s, *p);
+    if (p_inside)
+      dest[m++] = *p;
+
+    s_inside = p_inside;
+  }
+
+  return m;
+}
+
+const GeoPoint *
+GeoClip::clip_polygon(const GeoPoint *src, unsigned &n)
+{
+  if (n < 3)
+    return src;
+
+  const GeoClipEdge edges[4] = {
+    { false, true, half_width },
+    { false, false, half_width },
+    { true, true, half_height },
+    { true, false, half_height },
+  };
+
+  /* first pass: convert to relative coordinates, and check whether
+     clipping is needed at all */
+  GeoPoint *relative = buffers[0].get(n);
+  unsigned outside_any = 0, outside_all = 0xf;
+  for (unsigned i = 0; i < n; ++i) {
+    relative[i] = to_relative(src[i]);
+
+    unsigned outside = 0;
+    for (unsigned j = 0; j < 4; ++j)
+      if (!edges[j].inside(relative[i]))
+        outside |= 1 << j;
+
+    outside_any |= outside;
+    outside_all &= outside;
+  }
+
+  if (outside_any == 0)
+    /* completely inside */
+    return src;
+
+  if (outside_all != 0) {
+    /* completely beyond one edge */
+    n = 0;
+    return src;
+  }
+
+  const GeoPoint *in = relative;
+  GeoPoint *out = relative;
+  for (unsigned j = 0; j < 4; ++j) {
+    out = buffers[(j + 1) % 2].get(n + n / 2 + 1);
+    n = ClipEdge(out, in, n, edges[j]);
+    if (n < 3)
+      return out;
+
+    in = out;
+  }
+
+  for (unsigned i = 0; i < n; ++i)
+    out[i] = to_absolute(out[i]);
+
+  return out;
+}
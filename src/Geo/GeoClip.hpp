@@ -0,0 +1,85 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_CLIP_HPP
+#define XCSOAR_GEO_CLIP_HPP
+
+#include "Geo/GeoBounds.hpp"
+#include "Util/ReusableArray.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+/**
+ * Clips geographic lines and polygons against a #GeoBounds, before
+ * they are projected to the screen.  The coordinates are handled
+ * relative to the center of the rectangle, so it may span the date
+ * line.
+ */
+class GeoClip : private NonCopyable {
+  Angle center_longitude, center_latitude;
+
+  /** half the width and the height of the rectangle (native units) */
+  fixed half_width, half_height;
+
+  /** the output buffers of the polygon clipping stages */
+  ReusableArray<GeoPoint> buffers[2];
+
+public:
+  GeoClip() {}
+
+  explicit GeoClip(const GeoBounds &bounds) {
+    set_bounds(bounds);
+  }
+
+  void set_bounds(const GeoBounds &bounds);
+
+  /**
+   * Clips a line segment.  End points which are inside the rectangle
+   * are not modified.
+   *
+   * @return false if the segment is completely outside
+   */
+  bool clip_line(GeoPoint &a, GeoPoint &b) const;
+
+  /**
+   * Clips a polygon with the Sutherland-Hodgman algorithm.  Where the
+   * polygon leaves the rectangle, the result follows its border, so
+   * the caller should add a margin to the visible area to keep these
+   * edges off the screen.
+   *
+   * @param src the points of the polygon
+   * @param n the number of points; receives the number of points of
+   * the result, which is less than 3 if the polygon is not visible
+   * @return the clipped polygon, which is valid until the next call
+   */
+  const GeoPoint *clip_polygon(const GeoPoint *src, unsigned &n);
+
+private:
+  gcc_pure
+  GeoPoint to_relative(const GeoPoint &pt) const;
+
+  gcc_pure
+  GeoPoint to_absolute(const GeoPoint &pt) const;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "GeoShapeBuffer.hpp"
+#include "Projection.hpp"
+#include "Math/Earth.hpp"
+#include "Screen/OpenGL/Point.hpp"
+#include "Screen/OpenGL/Triangulate.hpp"
+#include "Util/AllocatedArray.hpp"
+
+#include <math.h>
+
+GeoShapeBuffer::GeoShapeBuffer(const GeoPoint *points, unsigned n,
+                               bool _polygon)
+  :num_vertices(n), num_indices(0), polygon(_polygon)
+{
+  if (n == 0)
+    return;
+
+  reference = points[0];
+
+  AllocatedArray<GLfloat> v(n * 3);
+  AllocatedArray<FloatPoint> flat(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const double lat = (double)points[i].Latitude.value_radians();
+    const double lon = (double)points[i].Longitude.value_radians();
+    const double cos_lat = cos(lat);
+    const double x = (lon - (double)reference.Longitude.value_radians())
+      * cos_lat;
+    const double y = lat - (double)reference.Latitude.value_radians();
+
+    v[i * 3] = (GLfloat)cos_lat;
+    v[i * 3 + 1] = (GLfloat)x;
+    v[i * 3 + 2] = (GLfloat)y;
+
+    flat[i].x = (GLfloat)x;
+    flat[i].y = (GLfloat)y;
+  }
+
+  vertices.load(n * 3 * sizeof(GLfloat), v.begin());
+
+  if (polygon && n >= 3 && n < 0x10000) {
+    AllocatedArray<GLushort> t(3 * (n - 2));
+    num_indices = PolygonToTriangles(flat.begin(), n, t.begin());
+    if (num_indices > 0)
+      triangles.load(num_indices * sizeof(GLushort), t.begin());
+  }
+}
+
+void
+GeoShapeBuffer::begin(const Projection &projection) const
+{
+  /* GeoToScreen() calculates, with d = location - point:
+
+     rx = k * d.lon * cos(point.lat)
+     ry = k * d.lat
+     screen.x = origin.x - (rx * cos(angle) - ry * sin(angle))
+     screen.y = origin.y + (ry * cos(angle) + rx * sin(angle))
+
+     With the vertex (u, w, y) = (cos(lat), (lon - lon0) * cos(lat),
+     lat - lat0), rx = k * (a * u - w) and ry = k * (b - y), where a and
+     b are the distances between the location and the reference
+     point. */
+
+  const GeoPoint &location = projection.GetGeoLocation();
+  const double a =
+    (double)(location.Longitude - reference.Longitude).value_radians();
+  const double b =
+    (double)(location.Latitude - reference.Latitude).value_radians();
+
+  /* pixels per radian, like Projection::DrawScale */
+  const double k = (double)fixed_earth_r * (double)projection.GetScale();
+
+  const Angle angle = projection.GetScreenAngle();
+  const double c = (double)angle.fastcosine() * k;
+  const double s = (double)angle.fastsine() * k;
+
+  const RasterPoint &origin = projection.GetScreenOrigin();
+
+  /* column major */
+  const GLfloat matrix[16] = {
+    (GLfloat)(-c * a), (GLfloat)(s * a), 0, 0,
+    (GLfloat)c, (GLfloat)-s, 0, 0,
+    (GLfloat)-s, (GLfloat)-c, 0, 0,
+    (GLfloat)(origin.x + s * b), (GLfloat)(origin.y + c * b), 0, 1,
+  };
+
+  glPushMatrix();
+  glMultMatrixf(matrix);
+
+  vertices.bind();
+  glVertexPointer(3, GL_FLOAT, 0, NULL);
+}
+
+void
+GeoShapeBuffer::end() const
+{
+  GLArrayBuffer::unbind();
+  glPopMatrix();
+}
+
+void
+GeoShapeBuffer::fill(const Projection &projection) const
+{
+  if (num_indices == 0)
+    return;
+
+  begin(projection);
+
+  triangles.bind();
+  glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, NULL);
+  GLElementArrayBuffer::unbind();
+
+  end();
+}
+
+void
+GeoShapeBuffer::outline(const Projection &projection) const
+{
+  if (num_vertices == 0)
+    return;
+
+  begin(projection);
+  glDrawArrays(polygon ? GL_LINE_LOOP : GL_LINE_STRIP, 0, num_vertices);
+  end();
+}
@@ -0,0 +1,92 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_SHAPE_BUFFER_HPP
+#define XCSOAR_GEO_SHAPE_BUFFER_HPP
+
+#include "Navigation/GeoPoint.hpp"
+#include "Screen/OpenGL/Buffer.hpp"
+#include "Util/NonCopyable.hpp"
+
+class Projection;
+
+/**
+ * A polygon or polyline in OpenGL buffer objects, for shapes which
+ * are drawn again in every frame (airspaces, topology).
+ *
+ * The vertices are stored once, in a form which
+ * Projection::GeoToScreen() maps linearly to the screen: (cos(lat),
+ * (lon - lon0) * cos(lat), lat - lat0) relative to a reference
+ * point.  Each frame only sets up a model-view matrix for the current
+ * location, scale and rotation; no vertex is projected on the CPU.
+ * Polygons are triangulated when the buffer is created, which allows
+ * filling concave shapes.
+ */
+class GeoShapeBuffer : private NonCopyable {
+  GeoPoint reference;
+
+  GLArrayBuffer vertices;
+  GLElementArrayBuffer triangles;
+
+  unsigned num_vertices, num_indices;
+
+  bool polygon;
+
+public:
+  /**
+   * @param points the vertices (may be empty)
+   * @param n the number of vertices
+   * @param polygon true for a closed shape which may be filled
+   */
+  GeoShapeBuffer(const GeoPoint *points, unsigned n, bool polygon);
+
+  /**
+   * Can the shape be filled?  This fails for lines, degenerate
+   * polygons and polygons with more than 65535 vertices.
+   */
+  bool can_fill() const {
+    return num_indices > 0;
+  }
+
+  /**
+   * Fills the polygon with the current color.
+   */
+  void fill(const Projection &projection) const;
+
+  /**
+   * Draws the outline with the current color: a line loop for a
+   * polygon, a line strip for a line.
+   */
+  void outline(const Projection &projection) const;
+
+private:
+  /**
+   * Pushes the model-view matrix which maps the vertices to the
+   * screen, and binds the vertex buffer.
+   */
+  void begin(const Projection &projection) const;
+
+  void end() const;
+};
+
+#endif
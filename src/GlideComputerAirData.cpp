@@ -522,19 +522,10 @@ GlideComputerAirData::TerrainFootprint(fixed screen_range)
   GlideTerrain g_terrain(SettingsComputer(), *terrain);
 
   g_terrain.set_max_range(max(fixed(20000), screen_range));
-  
-  const fixed d_bearing = fixed_360 / TERRAIN_ALT_INFO::NUMTERRAINSWEEPS;
-
-  unsigned i = 0;
-  AIRCRAFT_STATE state = ToAircraftState(Basic());
-  for (fixed ang = fixed_zero; i < TERRAIN_ALT_INFO::NUMTERRAINSWEEPS;
-       ang += d_bearing, i++) {
-    state.TrackBearing = Angle::degrees(ang);
-
-    TerrainIntersection its = g_terrain.find_intersection(state, glide_polar);
-    
-    SetCalculated().GlideFootPrint[i] = its.location;
-  } 
+
+  g_terrain.find_footprint(ToAircraftState(Basic()), glide_polar,
+                           SetCalculated().GlideFootPrint,
+                           TERRAIN_ALT_INFO::NUMTERRAINSWEEPS);
 
   SetCalculated().TerrainBase = g_terrain.get_terrain_base();
   SetCalculated().Experimental = Calculated().TerrainBase;
@@ -92,7 +92,7 @@ GlideComputerBlackboard::ResetFlight(const bool full)
   }
 
   calculated_info.Circling = false;
-  for (int i = 0; i <= TERRAIN_ALT_INFO::NUMTERRAINSWEEPS; i++) {
+  for (unsigned i = 0; i < TERRAIN_ALT_INFO::NUMTERRAINSWEEPS; i++) {
     calculated_info.GlideFootPrint[i].Longitude = Angle::native(fixed_zero);
     calculated_info.GlideFootPrint[i].Latitude = Angle::native(fixed_zero);
   }
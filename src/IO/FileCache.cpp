@@ -24,6 +24,7 @@ Copyright_License {
 #include "FileCache.hpp"
 #include "OS/FileUtil.hpp"
 #include "OS/PathName.hpp"
+#include "OS/FileMapping.hpp"
 #include "Compatibility/path.h"
 #include "Compiler.h"
 
@@ -152,6 +153,30 @@ FileCache::load(const TCHAR *name, const TCHAR *original_path)
   return file;
 }
 
+FileMapping *
+FileCache::map(const TCHAR *name, const TCHAR *original_path,
+               size_t &offset_r)
+{
+  FILE *file = load(name, original_path);
+  if (file == NULL)
+    return NULL;
+
+  long offset = ftell(file);
+  fclose(file);
+  if (offset <= 0)
+    return NULL;
+
+  TCHAR path[path_buffer_size(name)];
+  FileMapping *mapping = new FileMapping(make_cache_path(path, name));
+  if (mapping->error() || mapping->size() < (size_t)offset) {
+    delete mapping;
+    return NULL;
+  }
+
+  offset_r = offset;
+  return mapping;
+}
+
 FILE *
 FileCache::save(const TCHAR *name, const TCHAR *original_path)
 {
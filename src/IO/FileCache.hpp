@@ -27,6 +27,8 @@ Copyright_License {
 #include <stdio.h>
 #include <tchar.h>
 
+class FileMapping;
+
 class FileCache {
   TCHAR *cache_path;
   size_t cache_path_length;
@@ -43,6 +45,18 @@ public:
   void flush(const TCHAR *name);
   FILE *load(const TCHAR *name, const TCHAR *original_path);
 
+  /**
+   * Like load(), but maps the whole cache file into memory instead
+   * of opening it as a stream.
+   *
+   * @param offset_r receives the position of the first byte after
+   * the cache header
+   * @return the mapping (to be freed by the caller) or NULL if there
+   * is no valid cache file
+   */
+  FileMapping *map(const TCHAR *name, const TCHAR *original_path,
+                   size_t &offset_r);
+
   FILE *save(const TCHAR *name, const TCHAR *original_path);
   bool commit(const TCHAR *name, FILE *file);
   void cancel(const TCHAR *name, FILE *file);
@@ -55,6 +55,14 @@ MapCanvas::project(const SearchPointVector &points, RasterPoint *screen) const
     *screen++ = projection.GeoToScreen(it->get_location());
 }
 
+void
+MapCanvas::project(const GeoPoint *points, unsigned num_points,
+                   RasterPoint *screen) const
+{
+  for (const GeoPoint *end = points + num_points; points != end;)
+    *screen++ = projection.GeoToScreen(*points++);
+}
+
 static void
 update_bounds(RECT &bounds, const RasterPoint &pt)
 {
@@ -97,3 +105,16 @@ MapCanvas::draw(const SearchPointVector &points)
   if (visible(pts, num_points))
     canvas.autoclip_polygon(pts, num_points);
 }
+
+void
+MapCanvas::draw(const GeoPoint *points, unsigned num_points)
+{
+  if (num_points < 3)
+    return;
+
+  RasterPoint pts[num_points];
+  project(points, num_points, pts);
+
+  if (visible(pts, num_points))
+    canvas.autoclip_polygon(pts, num_points);
+}
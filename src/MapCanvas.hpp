@@ -56,6 +56,12 @@ public:
    */
   void project(const SearchPointVector &points, RasterPoint *screen) const;
 
+  /**
+   * Projects an array of points to screen coordinates.
+   */
+  void project(const GeoPoint *points, unsigned num_points,
+               RasterPoint *screen) const;
+
   /**
    * Determines whether the polygon is visible, or off-screen.
    *
@@ -67,6 +73,11 @@ public:
   bool visible(const RasterPoint *screen, unsigned num);
 
   void draw(const SearchPointVector &points);
+
+  /**
+   * Draws a polygon, e.g. one which has been clipped by #GeoClip.
+   */
+  void draw(const GeoPoint *points, unsigned num_points);
 };
 
 #endif
@@ -67,26 +67,24 @@ MapDrawHelper::MapDrawHelper(MapDrawHelper &_that):
 {
 }
 
-void 
-MapDrawHelper::draw_search_point_vector(Canvas& the_canvas, 
-                                        const SearchPointVector& points) 
+void
+MapDrawHelper::draw_polygon(Canvas &the_canvas,
+                            const GeoPoint *points, unsigned num_points)
 {
-  const size_t size = points.size();
-  if (size<3) {
+  if (num_points < 3)
     return;
-  }
 
   MapCanvas map_canvas(the_canvas, m_proj);
-  RasterPoint screen[size];
-  map_canvas.project(points, screen);
+  RasterPoint screen[num_points];
+  map_canvas.project(points, num_points, screen);
 
-  if (!map_canvas.visible(screen, size))
+  if (!map_canvas.visible(screen, num_points))
     return;
 
-  the_canvas.polygon(&screen[0], size);
+  the_canvas.polygon(&screen[0], num_points);
 #ifndef ENABLE_OPENGL
   if (m_use_stencil) {
-    m_stencil.polygon(&screen[0], size);
+    m_stencil.polygon(&screen[0], num_points);
   }
 #endif
 }
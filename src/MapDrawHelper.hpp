@@ -28,6 +28,7 @@ Copyright_License {
 
 class Canvas;
 class Projection;
+struct GeoPoint;
 struct SETTINGS_MAP;
 
 /**
@@ -61,7 +62,8 @@ public:
 
 protected:
 
-  void draw_search_point_vector(Canvas& the_canvas, const SearchPointVector& points);
+  void draw_polygon(Canvas &the_canvas,
+                    const GeoPoint *points, unsigned num_points);
 
   void draw_circle(Canvas &the_canvas,
                    const RasterPoint &center, unsigned radius);
@@ -32,6 +32,7 @@ Copyright_License {
 #include "Units.hpp"
 
 #include <tchar.h>
+#include <assert.h>
 
 /**
  * Constructor of the MapWindow class
@@ -98,7 +99,43 @@ void
 MapWindow::UpdateTopology()
 {
   if (topology != NULL && SettingsMap().EnableTopology)
-    topology->ScanVisibility(visible_projection);
+    topology->RequestScan(visible_projection);
+}
+
+/**
+ * Collect the locations where terrain will probably be needed soon:
+ * ahead on the current track, and along the leg to the active task
+ * point.
+ *
+ * @return the number of locations written to the buffer, at most
+ * RasterMap::MAX_PREFETCH
+ */
+static unsigned
+GetTerrainPrefetch(const NMEA_INFO &basic, const ProtectedTaskManager *task,
+                   GeoPoint *prefetch)
+{
+  unsigned n = 0;
+
+  if (basic.GroundSpeed > fixed(5)) {
+    /* seconds ahead */
+    static const unsigned times[] = { 120, 300, 600 };
+    for (unsigned i = 0; i < sizeof(times) / sizeof(times[0]); ++i)
+      prefetch[n++] = FindLatitudeLongitude(basic.Location, basic.TrackBearing,
+                                            basic.GroundSpeed * fixed(times[i]));
+  }
+
+  if (task != NULL) {
+    ProtectedTaskManager::Lease task_manager(*task);
+    const TaskPoint *tp = task_manager->getActiveTaskPoint();
+    if (tp != NULL) {
+      const GeoPoint &target = tp->get_location_remaining();
+      prefetch[n++] = basic.Location.interpolate(target, fixed_half);
+      prefetch[n++] = target;
+    }
+  }
+
+  assert(n <= RasterMap::MAX_PREFETCH);
+  return n;
 }
 
 void
@@ -109,9 +146,12 @@ MapWindow::UpdateTerrain()
     return;
 
   // always service terrain even if it's not used by the map,
-  // because it's used by other calculations
-  RasterTerrain::ExclusiveLease lease(*terrain);
-  lease->SetViewCenter(visible_projection.GetGeoLocation());
+  // because it's used by other calculations; the tiles are loaded
+  // by a background thread, and the overview is used until then
+  GeoPoint prefetch[RasterMap::MAX_PREFETCH];
+  const unsigned num_prefetch = GetTerrainPrefetch(Basic(), task, prefetch);
+  terrain->RequestTiles(visible_projection.GetGeoLocation(),
+                        prefetch, num_prefetch);
   terrain_center = visible_projection.GetGeoLocation();
 }
 
@@ -31,6 +31,8 @@ Copyright_License {
 #ifndef ENABLE_OPENGL
 #include "Screen/BufferCanvas.hpp"
 #endif
+#include "AirspaceShapeCache.hpp"
+#include "TrailRenderer.hpp"
 #include "Screen/LabelBlock.hpp"
 #include "MapWindowBlackboard.hpp"
 #include "NMEA/Derived.hpp"
@@ -96,6 +98,12 @@ protected:
   ProtectedAirspaceWarningManager *airspace_warnings;
   ProtectedTaskManager *task;
 
+  /** the level of detail and OpenGL buffers of the airspace polygons */
+  AirspaceShapeCache airspace_shapes;
+
+  /** the projected snail trail; updated while drawing */
+  mutable TrailRenderer trail_renderer;
+
   Marks *marks;
 
 #ifndef ENABLE_OPENGL
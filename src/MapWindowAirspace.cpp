@@ -36,6 +36,12 @@ Copyright_License {
 #include "Screen/Graphics.hpp"
 #include "Screen/Icon.hpp"
 
+#include "AirspaceShapeCache.hpp"
+
+#ifdef ENABLE_OPENGL
+#include "GeoShapeBuffer.hpp"
+#endif
+
 class AirspaceWarningCopy: 
   public AirspaceWarningVisitor
 {
@@ -115,8 +121,10 @@ class AirspaceVisitorMap:
 {
 public:
   AirspaceVisitorMap(MapDrawHelper &_helper,
+                     AirspaceShapeCache &shapes,
                      const AirspaceWarningCopy& warnings):
     MapDrawHelper(_helper),
+    m_shapes(shapes),
     m_warnings(warnings),
     pen_thick(Pen::SOLID, IBLSCALE(10), Color(0x00, 0x00, 0x00)),
     pen_medium(Pen::SOLID, IBLSCALE(3), Color(0x00, 0x00, 0x00)) {
@@ -143,7 +151,19 @@ public:
 
     buffer_render_start();
     set_buffer_pens(airspace);
-    draw_search_point_vector(m_buffer, airspace.get_points());
+
+#ifdef ENABLE_OPENGL
+    const GeoShapeBuffer &buffer = m_shapes.get(airspace);
+    if (buffer.can_fill()) {
+      get_fill_color(airspace).set();
+      buffer.fill(m_proj);
+      return;
+    }
+#endif
+
+    unsigned num_points;
+    const GeoPoint *points = m_shapes.clip(airspace, num_points);
+    draw_polygon(m_buffer, points, num_points);
   }
 
   void draw_intercepts() {
@@ -164,10 +184,16 @@ private:
                  light_color(c.blue()));
   }
 
-  void set_buffer_pens(const AbstractAirspace &airspace) {
 #ifdef ENABLE_OPENGL
+  Color get_fill_color(const AbstractAirspace &airspace) const {
     Color color = Graphics::Colours[m_settings_map.iAirspaceColour[airspace.get_type()]];
-    m_buffer.select(Brush(color.with_alpha(48)));
+    return color.with_alpha(48);
+  }
+#endif
+
+  void set_buffer_pens(const AbstractAirspace &airspace) {
+#ifdef ENABLE_OPENGL
+    m_buffer.select(Brush(get_fill_color(airspace)));
     m_buffer.null_pen();
 #else /* !OPENGL */
 
@@ -191,18 +217,23 @@ private:
 
   }
 
+  AirspaceShapeCache &m_shapes;
   const AirspaceWarningCopy& m_warnings;
   Pen pen_thick;
   Pen pen_medium;
 };
 
 class AirspaceOutlineRenderer : public AirspaceVisitor, protected MapCanvas {
+  AirspaceShapeCache &shapes;
   bool black;
 
 public:
   AirspaceOutlineRenderer(Canvas &_canvas, const Projection &_projection,
+                          AirspaceShapeCache &_shapes,
                           bool _black)
-    :MapCanvas(_canvas, _projection), black(_black) {
+    :MapCanvas(_canvas, _projection),
+     shapes(_shapes),
+     black(_black) {
     if (black)
       canvas.black_pen();
     canvas.hollow_brush();
@@ -222,7 +253,19 @@ public:
 
   void Visit(const AirspacePolygon& airspace) {
     setup_canvas(airspace);
-    draw(airspace.get_points());
+
+#ifdef ENABLE_OPENGL
+    if (black)
+      Color::BLACK.set();
+    else
+      Graphics::hAirspacePens[airspace.get_type()].get_color().set();
+
+    shapes.get(airspace).outline(projection);
+#else
+    unsigned num_points;
+    const GeoPoint *points = shapes.clip(airspace, num_points);
+    draw(points, num_points);
+#endif
   }
 };
 
@@ -257,7 +300,10 @@ MapWindow::DrawAirspace(Canvas &canvas)
 #endif
                        render_projection,
                         SettingsMap());
-  AirspaceVisitorMap v(helper, awc);
+  airspace_shapes.validate(*airspace_database);
+  airspace_shapes.set_projection(render_projection);
+
+  AirspaceVisitorMap v(helper, airspace_shapes, awc);
   const AirspaceMapVisible visible(SettingsComputer(),
                                    ToAircraftState(Basic()),
                                    false, awc);
@@ -281,6 +327,7 @@ MapWindow::DrawAirspace(Canvas &canvas)
   v.draw_intercepts();
 
   AirspaceOutlineRenderer outline_renderer(canvas, render_projection,
+                                           airspace_shapes,
                                            SettingsMap().bAirspaceBlackOutline);
   airspace_database->visit_within_range(render_projection.GetGeoLocation(),
                                         render_projection.GetScreenDistanceMeters(),
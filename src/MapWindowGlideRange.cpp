@@ -58,9 +58,13 @@ MapWindow::DrawTerrainAbove(Canvas &canvas)
 
   glEnable(GL_STENCIL_TEST);
   glStencilFunc(GL_ALWAYS, 1, 1);
-  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+  glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
 
-  canvas.polygon(Groundline, TERRAIN_ALT_INFO::NUMTERRAINSWEEPS);
+  /* the inverted triangle fan sets the stencil bit inside the
+     (possibly concave) ground line; Canvas::polygon() can't be used
+     here, because it needs the stencil buffer itself */
+  glVertexPointer(2, GL_VALUE, 0, Groundline);
+  glDrawArrays(GL_TRIANGLE_FAN, 0, TERRAIN_ALT_INFO::NUMTERRAINSWEEPS);
 
   glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
   glStencilFunc(GL_NOTEQUAL, 1, 1);
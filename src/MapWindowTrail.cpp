@@ -23,30 +23,11 @@ Copyright_License {
 
 #include "MapWindow.hpp"
 #include "Math/Earth.hpp"
-#include "Screen/Layout.hpp"
-#include "Screen/Util.hpp"
-#include "Screen/Graphics.hpp"
-#include "Task/ProtectedTaskManager.hpp"
 
 #include <algorithm>
 
-using std::min;
 using std::max;
 
-/**
- * This function returns the corresponding SnailTrail
- * color array index to the input
- * @param cv Input value between -1.0 and 1.0
- * @return SnailTrail color array index
- */
-gcc_const
-static int
-GetSnailColorIndex(fixed cv)
-{
-  return max((short)0, min((short)(NUMSNAILCOLORS - 1),
-                           (short)((cv + fixed_one) / 2 * NUMSNAILCOLORS)));
-}
-
 void
 MapWindow::RenderTrail(Canvas &canvas, const RasterPoint aircraft_pos) const
 {
@@ -61,16 +42,6 @@ MapWindow::DrawTrail(Canvas &canvas, const RasterPoint aircraft_pos,
   if (!SettingsMap().TrailActive || task == NULL)
     return;
 
-  const MapWindowProjection &projection = render_projection;
-
-  TracePointVector trace =
-    task->find_trace_points(projection.GetGeoLocation(),
-                            projection.GetScreenDistanceMeters(),
-                            min_time, projection.DistancePixelsToMeters(3));
-
-  if (trace.empty())
-    return;
-
   GeoPoint traildrift(Angle::native(fixed_zero), Angle::native(fixed_zero));
   if (enable_traildrift) {
     GeoPoint tp1 = FindLatitudeLongitude(Basic().Location, Basic().wind.bearing,
@@ -78,54 +49,8 @@ MapWindow::DrawTrail(Canvas &canvas, const RasterPoint aircraft_pos,
     traildrift = Basic().Location - tp1;
   }
 
-  fixed value_max, value_min;
-
-  if (settings_map.SnailType == stAltitude) {
-    value_max = fixed(1000);
-    value_min = fixed(500);
-    for (TracePointVector::const_iterator it = trace.begin();
-         it != trace.end(); ++it) {
-      value_max = max(it->NavAltitude, value_max);
-      value_min = min(it->NavAltitude, value_min);
-    }
-  } else {
-    value_max = fixed(0.75);
-    value_min = fixed(-2.0);
-    for (TracePointVector::const_iterator it = trace.begin();
-         it != trace.end(); ++it) {
-      value_max = max(it->NettoVario, value_max);
-      value_min = min(it->NettoVario, value_min);
-    }
-    value_max = min(fixed(7.5), value_max);
-    value_min = max(fixed(-5.0), value_min);
-  }
-
-  unsigned last_time = 0;
-  RasterPoint last_point;
-  for (TracePointVector::const_iterator it = trace.begin();
-       it != trace.end(); ++it) {
-    const fixed dt = Basic().Time - fixed(it->time);
-    RasterPoint pt = projection.GeoToScreen(it->get_location().
-        parametric(traildrift, dt * it->drift_factor));
-
-    if (it->last_time == last_time) {
-      if (settings_map.SnailType == stAltitude) {
-        int index = (it->NavAltitude - value_min) / (value_max - value_min) *
-                    (NUMSNAILCOLORS - 1);
-        index = max(0, min(NUMSNAILCOLORS - 1, index));
-        canvas.select(Graphics::hpSnailVario[index]);
-      } else {
-        const fixed colour_vario = negative(it->NettoVario) ?
-                                   - it->NettoVario / value_min :
-                                   it->NettoVario / value_max ;
-
-        canvas.select(Graphics::hpSnailVario[GetSnailColorIndex(colour_vario)]);
-      }
-      canvas.line(last_point, pt);
-    }
-    last_time = it->time;
-    last_point = pt;
-  }
-
-  canvas.line(last_point, aircraft_pos);
+  trail_renderer.Draw(canvas, *task, render_projection,
+                      settings_map.SnailType, min_time,
+                      enable_traildrift ? &traildrift : NULL,
+                      Basic().Time, aircraft_pos);
 }
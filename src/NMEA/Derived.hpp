@@ -176,7 +176,7 @@ struct TERRAIN_ALT_INFO
 {
   enum {
     /** number of radials to do range footprint calculation on */
-    NUMTERRAINSWEEPS = 20,
+    NUMTERRAINSWEEPS = 64,
   };
 
   /** Terrain altitude */
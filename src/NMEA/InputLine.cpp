@@ -25,6 +25,10 @@ Copyright_License {
 
 #include <assert.h>
 #include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <limits>
 
 static const char *
 end_of_line(const char *line)
@@ -39,6 +43,11 @@ NMEAInputLine::NMEAInputLine(const char *line)
   :data(line), end(end_of_line(line)) {
 }
 
+NMEAInputLine::NMEAInputLine(const char *line, const char *_end)
+  :data(line), end(_end) {
+  assert(_end == end_of_line(line));
+}
+
 size_t
 NMEAInputLine::skip()
 {
@@ -87,11 +96,84 @@ is_end_of_line(char ch)
   return ch == '\0' || ch == '*';
 }
 
+static bool
+is_digit(char ch)
+{
+  return ch >= '0' && ch <= '9';
+}
+
+/**
+ * A replacement for strtol(..., 10) which handles the plain
+ * "[+-]digits" numbers found in NMEA sentences without the locale
+ * overhead, and leaves everything else to strtol().
+ */
+static long
+parse_long(const char *p, char **endptr_r)
+{
+  const char *start = p;
+  bool negative = *p == '-';
+  if (negative || *p == '+')
+    ++p;
+
+  const char *digits = p;
+  unsigned long value = 0;
+  for (; is_digit(*p); ++p)
+    /* this may wrap; the result is discarded then */
+    value = value * 10 + (*p - '0');
+
+  /* up to digits10 digits always fit into a long (9 if it has 32
+     bits); longer numbers may wrap, so let strtol() clamp them */
+  if (p == digits || p - digits > std::numeric_limits<long>::digits10)
+    /* no number or possibly out of range */
+    return strtol(start, endptr_r, 10);
+
+  *endptr_r = const_cast<char *>(p);
+  return negative ? -(long)value : (long)value;
+}
+
+/**
+ * A replacement for strtod() which handles the plain
+ * "[+-]digits[.digits]" numbers found in NMEA sentences.  The digits
+ * are collected in an integer, and the result is rounded only once
+ * by the final division, which makes it identical to strtod()'s.
+ * Everything else (exponents, too many digits) is left to strtod().
+ */
+static double
+parse_double(const char *p, char **endptr_r)
+{
+  const char *start = p;
+  bool negative = *p == '-';
+  if (negative || *p == '+')
+    ++p;
+
+  uint64_t mantissa = 0;
+  unsigned num_digits = 0, num_decimals = 0;
+  for (; is_digit(*p); ++p, ++num_digits)
+    mantissa = mantissa * 10 + (*p - '0');
+
+  if (*p == '.')
+    for (++p; is_digit(*p); ++p, ++num_digits, ++num_decimals)
+      mantissa = mantissa * 10 + (*p - '0');
+
+  if (num_digits == 0 || num_digits > 15 ||
+      *p == 'e' || *p == 'E' || *p == 'x' || *p == 'X')
+    return strtod(start, endptr_r);
+
+  /* powers of ten up to 10^15 are exact in a double */
+  double divisor = 1;
+  for (unsigned i = 0; i < num_decimals; ++i)
+    divisor *= 10;
+
+  *endptr_r = const_cast<char *>(p);
+  const double value = (double)mantissa / divisor;
+  return negative ? -value : value;
+}
+
 long
 NMEAInputLine::read(long default_value)
 {
   char *endptr;
-  long value = strtol(data, &endptr, 10);
+  long value = parse_long(data, &endptr);
   assert(endptr >= data && endptr <= end);
   if (is_end_of_line(*endptr)) {
     data = "";
@@ -129,7 +211,7 @@ double
 NMEAInputLine::read(double default_value)
 {
   char *endptr;
-  double value = strtod(data, &endptr);
+  double value = parse_double(data, &endptr);
   assert(endptr >= data && endptr <= end);
   if (is_end_of_line(*endptr)) {
     data = "";
@@ -148,7 +230,7 @@ bool
 NMEAInputLine::read_checked(double &value_r)
 {
   char *endptr;
-  double value = strtod(data, &endptr);
+  double value = parse_double(data, &endptr);
   assert(endptr >= data && endptr <= end);
 
   bool success = endptr > data;
@@ -195,7 +277,7 @@ bool
 NMEAInputLine::read_checked(int &value_r)
 {
   char *endptr;
-  long value = strtol(data, &endptr, 10);
+  long value = parse_long(data, &endptr);
   assert(endptr >= data && endptr <= end);
 
   bool success = endptr > data;
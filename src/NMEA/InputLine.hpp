@@ -35,6 +35,12 @@ class NMEAInputLine {
 public:
   NMEAInputLine(const char *line);
 
+  /**
+   * Construct with a known end of the data, i.e. the position of the
+   * asterisk or the end of the string.
+   */
+  NMEAInputLine(const char *line, const char *_end);
+
   const char *rest() const {
     return data;
   }
@@ -30,6 +30,7 @@ Copyright_License {
 #include "Components.hpp"
 #include "GlideComputer.hpp"
 #include "CalculationThread.hpp"
+#include "ContestThread.hpp"
 #include "InstrumentThread.hpp"
 #include "DrawThread.hpp"
 
@@ -84,6 +85,9 @@ void CreateCalculationThread(void) {
 
   // Create a read thread for performing calculations
   calculation_thread = new CalculationThread(glide_computer);
+
+  // Create a thread for solving the contest in the background
+  contest_thread = new ContestThread(protected_task_manager);
 }
 
 void
@@ -93,12 +97,14 @@ SuspendAllThreads()
   draw_thread->suspend();
 #endif
   calculation_thread->suspend();
+  contest_thread->suspend();
 }
 
 void
 ResumeAllThreads()
 {
   calculation_thread->resume();
+  contest_thread->resume();
 #ifndef ENABLE_OPENGL
   draw_thread->resume();
 #endif
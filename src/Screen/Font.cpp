@@ -23,6 +23,10 @@ Copyright_License {
 
 #include "Screen/Font.hpp"
 
+#ifdef ENABLE_OPENGL
+#include "Screen/OpenGL/Cache.hpp"
+#endif
+
 #ifdef ENABLE_SDL
 
 bool
@@ -90,6 +94,10 @@ void
 Font::reset()
 {
   if (font != NULL) {
+#ifdef ENABLE_OPENGL
+    TextCache::forget(font);
+#endif
+
     TTF_CloseFont(font);
     font = NULL;
   }
@@ -0,0 +1,80 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_SCREEN_OPENGL_BUFFER_HPP
+#define XCSOAR_SCREEN_OPENGL_BUFFER_HPP
+
+#include "Util/NonCopyable.hpp"
+
+#ifdef ANDROID
+#include <GLES/gl.h>
+#else
+#include <SDL_opengl.h>
+#endif
+
+#include <stddef.h>
+
+/**
+ * An OpenGL buffer object, which keeps vertex or index data in video
+ * memory, so it does not need to be uploaded for each draw call.
+ *
+ * While a buffer is bound, the pointer arguments of
+ * glVertexPointer() and glDrawElements() are offsets into the
+ * buffer.  Call unbind() afterwards, because all other code passes
+ * client-side arrays.
+ */
+template<GLenum target>
+class GLBuffer : private NonCopyable {
+  GLuint id;
+
+public:
+  GLBuffer() {
+    glGenBuffers(1, &id);
+  }
+
+  ~GLBuffer() {
+    glDeleteBuffers(1, &id);
+  }
+
+  void bind() const {
+    glBindBuffer(target, id);
+  }
+
+  static void unbind() {
+    glBindBuffer(target, 0);
+  }
+
+  /**
+   * Replaces the contents of the buffer.
+   */
+  void load(size_t size, const void *data) {
+    bind();
+    glBufferData(target, size, data, GL_STATIC_DRAW);
+    unbind();
+  }
+};
+
+typedef GLBuffer<GL_ARRAY_BUFFER> GLArrayBuffer;
+typedef GLBuffer<GL_ELEMENT_ARRAY_BUFFER> GLElementArrayBuffer;
+
+#endif
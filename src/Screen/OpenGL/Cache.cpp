@@ -22,108 +22,61 @@ Copyright_License {
 */
 
 #include "Screen/OpenGL/Cache.hpp"
-#include "Screen/OpenGL/Texture.hpp"
-#include "Screen/Color.hpp"
+#include "Screen/OpenGL/GlyphAtlas.hpp"
 
 #include <map>
-#include <string>
 #include <assert.h>
 
-struct ListHead {
-  ListHead *prev, *next;
-};
+typedef std::map<TTF_Font *, GlyphAtlas *> AtlasMap;
 
-struct RenderedText : public ListHead {
-  std::string key;
-  GLTexture texture;
+static AtlasMap atlases;
 
-  RenderedText(const char *_key, SDL_Surface *surface)
-    :key(_key), texture(surface) {}
-};
+/** the font of the last lookup, which is usually the next one */
+static TTF_Font *last_font;
+static GlyphAtlas *last_atlas;
 
-static std::map<std::string,RenderedText*> text_cache_map;
-static ListHead text_cache_head = { &text_cache_head, &text_cache_head };
-static unsigned text_cache_size = 0;
-
-GLTexture *
-TextCache::get(TTF_Font *font, Color background_color, Color text_color,
-               const char *text)
+GlyphAtlas &
+TextCache::get(TTF_Font *font)
 {
   assert(font != NULL);
-  assert(text != NULL);
-
-  char key[4096];
-  snprintf(key, sizeof(key), "%s_%s_%u_%02x%02x%02x_%02x%02x%02x_%s",
-           TTF_FontFaceFamilyName(font),
-           TTF_FontFaceStyleName(font),
-           TTF_FontHeight(font),
-           background_color.red(),
-           background_color.green(),
-           background_color.blue(),
-           text_color.red(),
-           text_color.green(),
-           text_color.blue(),
-           text);
-
-  /* look it up */
-
-  std::map<std::string,RenderedText*>::const_iterator i =
-    text_cache_map.find(key);
-  if (i != text_cache_map.end())
-    /* found in the cache */
-    return &i->second->texture;
-
-  /* remove old entries from cache */
-
-  if (text_cache_size >= 256) {
-    RenderedText *rt = (RenderedText *)text_cache_head.prev;
-    printf("remove '%s'\n", rt->key.c_str());
-    text_cache_map.erase(rt->key);
-    rt->next->prev = rt->prev;
-    rt->prev->next = rt->next;
-    delete rt;
-    --text_cache_size;
-  }
-
-  /* render the text into a OpenGL texture */
 
-  SDL_Surface *surface = ::TTF_RenderUTF8_Solid(font, text, Color::BLACK);
-  if (surface == NULL)
-    return NULL;
+  if (font == last_font)
+    return *last_atlas;
 
-  surface->flags &= ~SDL_SRCCOLORKEY;
-  if (surface->format->palette != NULL &&
-      surface->format->palette->ncolors >= 2) {
-    surface->format->palette->colors[0] = background_color;
-    surface->format->palette->colors[1] = text_color;
+  AtlasMap::const_iterator i = atlases.find(font);
+  GlyphAtlas *atlas;
+  if (i != atlases.end())
+    atlas = i->second;
+  else {
+    atlas = new GlyphAtlas(font);
+    atlases.insert(std::make_pair(font, atlas));
   }
 
-  /* insert into cache */
-
-  RenderedText *rt = new RenderedText(key, surface);
-  SDL_FreeSurface(surface);
-
-  rt->next = text_cache_head.next;
-  rt->next->prev = rt;
-  rt->prev = &text_cache_head;
-  text_cache_head.next = rt;
-
-  text_cache_map.insert(std::make_pair(key, rt));
+  last_font = font;
+  last_atlas = atlas;
+  return *atlas;
+}
 
-  ++text_cache_size;
+void
+TextCache::forget(TTF_Font *font)
+{
+  AtlasMap::iterator i = atlases.find(font);
+  if (i == atlases.end())
+    return;
 
-  /* done */
+  delete i->second;
+  atlases.erase(i);
 
-  return &rt->texture;
+  if (font == last_font)
+    last_font = NULL;
 }
 
 void
 TextCache::flush()
 {
-  for (RenderedText *rt = (RenderedText *)text_cache_head.next;
-       rt != &text_cache_head;) {
-    RenderedText *next = (RenderedText *)rt->next;
-    delete rt;
-    rt = next;
-  }
+  for (AtlasMap::iterator i = atlases.begin(); i != atlases.end(); ++i)
+    delete i->second;
+
+  atlases.clear();
+  last_font = NULL;
 }
@@ -24,24 +24,20 @@ Copyright_License {
 #ifndef XCSOAR_SCREEN_OPENGL_CACHE_HPP
 #define XCSOAR_SCREEN_OPENGL_CACHE_HPP
 
-#include "Compiler.h"
-
-#ifdef ANDROID
-#include <GLES/gl.h>
-#else
-#include <SDL_opengl.h>
-#endif
-
 #include <SDL_ttf.h>
 
-class GLTexture;
-class Font;
-struct Color;
+class GlyphAtlas;
 
 namespace TextCache {
-  gcc_pure
-  GLTexture *get(TTF_Font *font, Color background_color, Color text_color,
-                 const char *text);
+  /**
+   * Returns the glyph atlas of a font, creating it on the first call.
+   */
+  GlyphAtlas &get(TTF_Font *font);
+
+  /**
+   * Deletes the glyph atlas of a font, which is about to be closed.
+   */
+  void forget(TTF_Font *font);
 
   void flush();
 };
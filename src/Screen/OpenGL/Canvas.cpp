@@ -26,6 +26,7 @@ Copyright_License {
 #include "Screen/OpenGL/Texture.hpp"
 #include "Screen/OpenGL/Scope.hpp"
 #include "Screen/OpenGL/Cache.hpp"
+#include "Screen/OpenGL/GlyphAtlas.hpp"
 #include "Screen/OpenGL/VertexArray.hpp"
 #include "Screen/OpenGL/Draw.hpp"
 #include "Screen/Util.hpp"
@@ -55,18 +56,16 @@ Canvas::polygon(const RasterPoint *lppt, unsigned cPoints)
   if (brush.is_hollow() && !pen.defined())
     return;
 
-  glVertexPointer(2, GL_VALUE, 0, lppt);
-
   if (!brush.is_hollow()) {
+    /* GL_POLYGON is only defined for convex polygons (and not
+       available on OpenGL/ES); triangulating on every call would be
+       too expensive, therefore fill with the stencil buffer */
     brush.get_color().set();
-#ifdef ANDROID
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, cPoints);
-#else
-    glDrawArrays(GL_POLYGON, 0, cPoints);
-#endif
+    GLFillPolygon(lppt, cPoints);
   }
 
   if (pen_over_brush()) {
+    glVertexPointer(2, GL_VALUE, 0, lppt);
     pen.get_color().set();
     glDrawArrays(GL_LINE_LOOP, 0, cPoints);
   }
@@ -128,31 +127,36 @@ Canvas::text(int x, int y, const TCHAR *text)
   if (font == NULL)
     return;
 
-  GLTexture *texture = TextCache::get(font, Color::BLACK, Color::WHITE, text);
-  if (texture == NULL)
-    return;
+  GlyphAtlas &atlas = TextCache::get(font);
+  unsigned width;
+  const unsigned num_vertices = atlas.layout(x, y, text, width);
 
   if (background_mode == OPAQUE)
     /* draw the opaque background */
-    fill_rectangle(x, y, x + texture->get_width(), y + texture->get_height(),
+    fill_rectangle(x, y, x + width, y + atlas.get_height(),
                    background_color);
 
+  if (num_vertices == 0)
+    return;
+
   GLEnable scope(GL_TEXTURE_2D);
-  texture->bind();
+  atlas.bind();
   GLLogicOp logic_op(GL_AND_INVERTED);
 
   if (background_mode != OPAQUE || background_color != Color::BLACK) {
     /* cut out the shape in black */
     glColor4f(1.0, 1.0, 1.0, 1.0);
-    texture->draw(x, y);
+    atlas.draw(num_vertices);
   }
 
   if (text_color != Color::BLACK) {
     /* draw the text color on top */
     logic_op.set(GL_OR);
     text_color.set();
-    texture->draw(x, y);
+    atlas.draw(num_vertices);
   }
+
+  atlas.unbind();
 }
 
 void
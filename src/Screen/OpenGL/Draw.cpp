@@ -23,6 +23,9 @@ Copyright_License {
 
 #include "Screen/OpenGL/Draw.hpp"
 #include "Screen/OpenGL/VertexArray.hpp"
+#include "Screen/OpenGL/Globals.hpp"
+#include "Screen/OpenGL/Triangulate.hpp"
+#include "Util/ReusableArray.hpp"
 
 void
 GLFillRectangle(GLvalue left, GLvalue top, GLvalue right, GLvalue bottom)
@@ -37,3 +40,53 @@ GLFillRectangle(GLvalue left, GLvalue top, GLvalue right, GLvalue bottom)
   glRecti(left, top, right, bottom);
 #endif
 }
+
+void
+GLFillPolygon(const RasterPoint *points, unsigned num_points)
+{
+  if (num_points < 3)
+    return;
+
+  glVertexPointer(2, GL_VALUE, 0, points);
+
+  if (!OpenGL::stencil_available) {
+    /* without a stencil buffer, fall back to the (slower)
+       triangulation; only the OpenGL thread draws, so the index
+       buffer can be shared */
+    static ReusableArray<GLushort> triangle_buffer;
+
+    if (num_points >= 0x10000) {
+      /* too many for GLushort indices; correct only if convex */
+      glDrawArrays(GL_TRIANGLE_FAN, 0, num_points);
+      return;
+    }
+
+    GLushort *triangles = triangle_buffer.get(3 * (num_points - 2));
+    const unsigned num_indices =
+      PolygonToTriangles(points, num_points, triangles);
+    if (num_indices > 0)
+      glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT,
+                     triangles);
+    return;
+  }
+
+  glEnable(GL_STENCIL_TEST);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glStencilFunc(GL_ALWAYS, 0, 1);
+
+  /* clear the stencil bit under the triangle fan, then invert it once
+     for each triangle covering a pixel: the bit is set exactly in the
+     inside of the polygon */
+  glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+  glDrawArrays(GL_TRIANGLE_FAN, 0, num_points);
+  glStencilOp(GL_INVERT, GL_INVERT, GL_INVERT);
+  glDrawArrays(GL_TRIANGLE_FAN, 0, num_points);
+
+  /* fill where the bit is set, and clear it again */
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glStencilFunc(GL_EQUAL, 1, 1);
+  glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+  glDrawArrays(GL_TRIANGLE_FAN, 0, num_points);
+
+  glDisable(GL_STENCIL_TEST);
+}
@@ -32,4 +32,14 @@ Copyright_License {
 void
 GLFillRectangle(GLvalue left, GLvalue top, GLvalue right, GLvalue bottom);
 
+/**
+ * Fills a polygon (convex, concave or self-intersecting, with the
+ * even-odd rule) with the current color.  It is rendered in O(n) with
+ * the help of the stencil buffer, which is left cleared in the area
+ * covered by the polygon.  Without a stencil buffer, the polygon is
+ * triangulated with PolygonToTriangles() instead.
+ */
+void
+GLFillPolygon(const RasterPoint *points, unsigned num_points);
+
 #endif
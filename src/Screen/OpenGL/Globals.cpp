@@ -26,6 +26,8 @@ Copyright_License {
 namespace OpenGL {
   unsigned screen_width, screen_height;
 
+  bool stencil_available;
+
 #ifdef ANDROID
   int translate_x, translate_y;
 #endif
@@ -37,6 +37,12 @@ namespace OpenGL {
    */
   extern unsigned screen_width, screen_height;
 
+  /**
+   * Does the frame buffer have a stencil buffer?  Some Android
+   * devices don't provide one.
+   */
+  extern bool stencil_available;
+
 #ifdef ANDROID
   /**
    * The current SubCanvas translation in pixels.  Only needed for
@@ -0,0 +1,288 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Screen/OpenGL/GlyphAtlas.hpp"
+#include "Screen/OpenGL/Texture.hpp"
+#include "Screen/Color.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <assert.h>
+#include <string.h>
+
+/**
+ * Decodes the UTF-8 sequence at the beginning of the string.  An
+ * invalid byte is a sequence of its own, with a code beyond the
+ * Unicode range.
+ *
+ * @return the length of the sequence
+ */
+static unsigned
+DecodeUTF8(const char *p, unsigned &code)
+{
+  const unsigned char *q = (const unsigned char *)p;
+
+  unsigned length;
+  if (q[0] < 0x80) {
+    code = q[0];
+    return 1;
+  } else if ((q[0] & 0xe0) == 0xc0) {
+    code = q[0] & 0x1f;
+    length = 2;
+  } else if ((q[0] & 0xf0) == 0xe0) {
+    code = q[0] & 0x0f;
+    length = 3;
+  } else if ((q[0] & 0xf8) == 0xf0) {
+    code = q[0] & 0x07;
+    length = 4;
+  } else {
+    code = 0x110000 + q[0];
+    return 1;
+  }
+
+  for (unsigned i = 1; i < length; ++i) {
+    if ((q[i] & 0xc0) != 0x80) {
+      code = 0x110000 + q[0];
+      return 1;
+    }
+
+    code = (code << 6) | (q[i] & 0x3f);
+  }
+
+  return length;
+}
+
+GlyphAtlas::GlyphAtlas(TTF_Font *_font)
+  :font(_font), height(TTF_FontHeight(_font)), size(256)
+{
+  /* room for at least 16 rows */
+  while (size < 16 * (height + 1) && size < 1024)
+    size <<= 1;
+
+  const std::vector<GLubyte> black(size * size, 0);
+  texture = new GLTexture(GL_LUMINANCE, size, size, &black[0]);
+
+  clear();
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+  delete texture;
+}
+
+void
+GlyphAtlas::clear()
+{
+  next_x = next_y = 0;
+  num_glyphs = 0;
+
+  for (unsigned i = 0; i < TABLE_SIZE; ++i)
+    table[i].code = 0;
+}
+
+const GlyphAtlas::Glyph *
+GlyphAtlas::get(const char *p, unsigned length, unsigned code)
+{
+  assert(code != 0);
+
+  unsigned i = code % TABLE_SIZE;
+  while (table[i].code != 0) {
+    if (table[i].code == code)
+      return &glyphs[table[i].glyph];
+
+    i = (i + 1) % TABLE_SIZE;
+  }
+
+  /* not found; the table is never more than 3/4 full, so there is an
+     empty slot */
+
+  if (num_glyphs >= MAX_GLYPHS)
+    return NULL;
+
+  Glyph &glyph = glyphs[num_glyphs];
+  if (!add(p, length, glyph))
+    return NULL;
+
+  table[i].code = code;
+  table[i].glyph = num_glyphs++;
+  return &glyph;
+}
+
+bool
+GlyphAtlas::add(const char *p, unsigned length, Glyph &glyph)
+{
+  char buffer[8];
+  memcpy(buffer, p, length);
+  buffer[length] = 0;
+
+  glyph.x = glyph.y = 0;
+  glyph.width = 0;
+  glyph.blank = true;
+
+  SDL_Surface *surface = ::TTF_RenderUTF8_Solid(font, buffer, Color::WHITE);
+  if (surface == NULL)
+    /* zero width, or not available in this font */
+    return true;
+
+  const unsigned width = surface->w;
+  if (next_x + width > size) {
+    /* next row */
+    next_x = 0;
+    next_y += height + 1;
+  }
+
+  if (width > size || next_y + height > size) {
+    SDL_FreeSurface(surface);
+    return false;
+  }
+
+  /* convert the glyph to luminance, with a black border at the right
+     and at the bottom which separates it from its neighbours */
+
+  const unsigned cell_width = std::min(width + 1, size - next_x);
+  const unsigned cell_height = std::min(height + 1, size - next_y);
+  pixels.grow_discard(cell_width * cell_height);
+  GLubyte *dest = pixels.begin();
+  std::fill(dest, dest + cell_width * cell_height, 0);
+
+  if (surface->format->BytesPerPixel == 1) {
+    /* the text colour has palette index 1, the background 0 */
+    const unsigned rows = std::min(height, (unsigned)surface->h);
+    for (unsigned row = 0; row < rows; ++row) {
+      const Uint8 *src = (const Uint8 *)surface->pixels + row * surface->pitch;
+      for (unsigned column = 0; column < width; ++column) {
+        if (src[column] != 0) {
+          dest[row * cell_width + column] = 0xff;
+          glyph.blank = false;
+        }
+      }
+    }
+  }
+
+  SDL_FreeSurface(surface);
+
+  glyph.width = width;
+  if (glyph.blank)
+    /* no need to occupy space in the texture */
+    return true;
+
+  glyph.x = next_x;
+  glyph.y = next_y;
+
+  texture->bind();
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, next_x, next_y, cell_width, cell_height,
+                  GL_LUMINANCE, GL_UNSIGNED_BYTE, dest);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  next_x += width + 1;
+  return true;
+}
+
+unsigned
+GlyphAtlas::layout(int x, int y, const char *text, unsigned &width)
+{
+  const unsigned max_vertices = strlen(text) * 6;
+  vertices.grow_discard(max_vertices);
+  coords.grow_discard(max_vertices);
+
+  const GLfloat scale = 1.0f / size;
+
+  bool cleared = false;
+  unsigned n;
+  int pen;
+
+  while (true) {
+    RasterPoint *v = vertices.begin();
+    FloatPoint *c = coords.begin();
+    n = 0;
+    pen = x;
+
+    bool full = false;
+    for (const char *p = text; *p != 0;) {
+      unsigned code;
+      const unsigned length = DecodeUTF8(p, code);
+      const Glyph *glyph = get(p, length, code);
+      p += length;
+
+      if (glyph == NULL) {
+        if (!cleared) {
+          full = true;
+          break;
+        }
+
+        /* doesn't fit even into an empty texture */
+        continue;
+      }
+
+      if (!glyph->blank) {
+        const GLvalue x0 = pen, y0 = y;
+        const GLvalue x1 = pen + glyph->width, y1 = y + height;
+        const GLfloat u0 = glyph->x * scale, v0 = glyph->y * scale;
+        const GLfloat u1 = (glyph->x + glyph->width) * scale;
+        const GLfloat v1 = (glyph->y + height) * scale;
+
+        v[n].x = x0; v[n].y = y0; c[n].x = u0; c[n].y = v0; ++n;
+        v[n].x = x1; v[n].y = y0; c[n].x = u1; c[n].y = v0; ++n;
+        v[n].x = x0; v[n].y = y1; c[n].x = u0; c[n].y = v1; ++n;
+        v[n].x = x1; v[n].y = y0; c[n].x = u1; c[n].y = v0; ++n;
+        v[n].x = x1; v[n].y = y1; c[n].x = u1; c[n].y = v1; ++n;
+        v[n].x = x0; v[n].y = y1; c[n].x = u0; c[n].y = v1; ++n;
+      }
+
+      pen += glyph->width;
+    }
+
+    if (!full)
+      break;
+
+    /* the texture is full: start over with an empty one */
+    clear();
+    cleared = true;
+  }
+
+  width = pen - x;
+  return n;
+}
+
+void
+GlyphAtlas::bind()
+{
+  texture->bind();
+
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_VALUE, 0, vertices.begin());
+  glTexCoordPointer(2, GL_FLOAT, 0, coords.begin());
+}
+
+void
+GlyphAtlas::unbind()
+{
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+void
+GlyphAtlas::draw(unsigned num_vertices) const
+{
+  glDrawArrays(GL_TRIANGLES, 0, num_vertices);
+}
@@ -0,0 +1,132 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_SCREEN_OPENGL_GLYPH_ATLAS_HPP
+#define XCSOAR_SCREEN_OPENGL_GLYPH_ATLAS_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "Screen/OpenGL/Point.hpp"
+
+#include <SDL_ttf.h>
+
+class GLTexture;
+
+/**
+ * A texture which contains the glyphs of one font, rendered white on
+ * black.  Glyphs are added when they are drawn for the first time;
+ * when the texture is full, it is cleared and filled again.
+ *
+ * A string is drawn as one batch of textured triangles, two per
+ * glyph.
+ */
+class GlyphAtlas : private NonCopyable {
+  struct Glyph {
+    /** the position in the texture */
+    unsigned short x, y;
+
+    /** the advance width, which is also the width of the cell */
+    unsigned short width;
+
+    /** does this glyph have no pixels (e.g. a space)? */
+    bool blank;
+  };
+
+  /** an entry of the open addressing hash table */
+  struct Slot {
+    /** the code point; 0 if this slot is empty */
+    unsigned code;
+
+    unsigned glyph;
+  };
+
+  static const unsigned TABLE_SIZE = 1024;
+  static const unsigned MAX_GLYPHS = TABLE_SIZE * 3 / 4;
+
+  TTF_Font *font;
+
+  /** the height of the font, which is the height of all cells */
+  unsigned height;
+
+  /** the width and the height of the texture */
+  unsigned size;
+
+  GLTexture *texture;
+
+  /** the position of the next cell */
+  unsigned next_x, next_y;
+
+  Glyph glyphs[MAX_GLYPHS];
+  unsigned num_glyphs;
+
+  Slot table[TABLE_SIZE];
+
+  /** the triangles prepared by layout() */
+  AllocatedArray<RasterPoint> vertices;
+  AllocatedArray<FloatPoint> coords;
+
+  /** a buffer for uploading one glyph to the texture */
+  AllocatedArray<GLubyte> pixels;
+
+public:
+  GlyphAtlas(TTF_Font *font);
+  ~GlyphAtlas();
+
+  unsigned get_height() const {
+    return height;
+  }
+
+  /**
+   * Prepares the triangles for drawing a string.
+   *
+   * @param text an UTF-8 string
+   * @param width receives the width of the string
+   * @return the number of vertices, to be passed to draw()
+   */
+  unsigned layout(int x, int y, const char *text, unsigned &width);
+
+  /**
+   * Binds the texture and the arrays prepared by layout().  Call
+   * unbind() when done.
+   */
+  void bind();
+  void unbind();
+
+  void draw(unsigned num_vertices) const;
+
+private:
+  void clear();
+
+  /**
+   * Returns the glyph of a character, adding it to the texture if
+   * necessary.
+   *
+   * @param p the UTF-8 sequence of the character
+   * @return NULL if the texture is full
+   */
+  const Glyph *get(const char *p, unsigned length, unsigned code);
+
+  bool add(const char *p, unsigned length, Glyph &glyph);
+};
+
+#endif
@@ -30,4 +30,8 @@ struct RasterPoint {
   GLvalue x, y;
 };
 
+struct FloatPoint {
+  GLfloat x, y;
+};
+
 #endif
@@ -143,6 +143,21 @@ GLTexture::GLTexture(unsigned _width, unsigned _height)
                0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
 }
 
+GLTexture::GLTexture(GLint format, unsigned _width, unsigned _height,
+                     const GLvoid *pixels)
+  :width(_width), height(_height)
+{
+  assert(validate_texture_size(width) == (GLsizei)width);
+  assert(validate_texture_size(height) == (GLsizei)height);
+
+  init();
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0,
+               format, GL_UNSIGNED_BYTE, pixels);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
 void
 GLTexture::load(SDL_Surface *src)
 {
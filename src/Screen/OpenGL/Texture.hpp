@@ -47,6 +47,15 @@ public:
    */
   GLTexture(unsigned _width, unsigned _height);
 
+  /**
+   * Create a texture with the specified format, which is used both
+   * as internal format and as the format of #pixels (one
+   * GL_UNSIGNED_BYTE per component, rows not padded).  The size
+   * must be a power of two.
+   */
+  GLTexture(GLint format, unsigned _width, unsigned _height,
+            const GLvoid *pixels);
+
   GLTexture(SDL_Surface *surface) {
     init();
     load(surface);
@@ -0,0 +1,151 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Screen/OpenGL/Triangulate.hpp"
+#include "Util/AllocatedArray.hpp"
+
+#include <assert.h>
+
+template<typename PT>
+static inline double
+Cross(const PT &a, const PT &b, const PT &c)
+{
+  return ((double)b.x - a.x) * ((double)c.y - a.y) -
+    ((double)b.y - a.y) * ((double)c.x - a.x);
+}
+
+template<typename PT>
+static inline bool
+Equals(const PT &a, const PT &b)
+{
+  return a.x == b.x && a.y == b.y;
+}
+
+/**
+ * Is the point inside the triangle (a, b, c) or on its border?
+ *
+ * @param sign the orientation of the polygon (1 for counter-clockwise)
+ */
+template<typename PT>
+static bool
+InsideTriangle(const PT &p, const PT &a, const PT &b, const PT &c,
+               double sign)
+{
+  return Cross(a, b, p) * sign >= 0 && Cross(b, c, p) * sign >= 0 &&
+    Cross(c, a, p) * sign >= 0;
+}
+
+/**
+ * Checks whether the vertex #i is an "ear", i.e. whether the triangle
+ * it forms with its neighbours is inside the polygon.
+ */
+template<typename PT>
+static bool
+IsEar(const PT *points, const GLushort *next, unsigned a, unsigned i,
+      unsigned c, double sign)
+{
+  const PT &pa = points[a], &pi = points[i], &pc = points[c];
+
+  if (Cross(pa, pi, pc) * sign <= 0)
+    /* reflex or degenerate */
+    return false;
+
+  for (unsigned j = next[c]; j != a; j = next[j]) {
+    const PT &p = points[j];
+    if (!Equals(p, pa) && !Equals(p, pi) && !Equals(p, pc) &&
+        InsideTriangle(p, pa, pi, pc, sign))
+      return false;
+  }
+
+  return true;
+}
+
+template<typename PT>
+unsigned
+PolygonToTriangles(const PT *points, unsigned num_points,
+                   GLushort *triangles)
+{
+  assert(num_points < 0x10000);
+
+  if (num_points < 3)
+    return 0;
+
+  double area = 0;
+  for (unsigned i = 2; i < num_points; ++i)
+    area += Cross(points[0], points[i - 1], points[i]);
+
+  if (area == 0)
+    return 0;
+
+  const double sign = area > 0 ? 1 : -1;
+
+  /* the remaining vertices as a doubly linked ring */
+  AllocatedArray<GLushort> links(2 * num_points);
+  GLushort *const next = links.begin(), *const prev = next + num_points;
+  for (unsigned i = 0; i < num_points; ++i) {
+    next[i] = i + 1 < num_points ? i + 1 : 0;
+    prev[i] = i > 0 ? i - 1 : num_points - 1;
+  }
+
+  GLushort *t = triangles;
+  unsigned remaining = num_points, misses = 0;
+  unsigned i = 0;
+  while (remaining > 3) {
+    const unsigned a = prev[i], c = next[i];
+
+    /* if no ear was found during a full round, the polygon is
+       self-intersecting; cut the vertex anyway to make progress */
+    if (misses < remaining && !IsEar(points, next, a, i, c, sign)) {
+      ++misses;
+      i = c;
+      continue;
+    }
+
+    *t++ = a;
+    *t++ = i;
+    *t++ = c;
+
+    next[a] = c;
+    prev[c] = a;
+    --remaining;
+    misses = 0;
+
+    /* continue with the previous vertex, which may have become an
+       ear */
+    i = a;
+  }
+
+  *t++ = prev[i];
+  *t++ = i;
+  *t++ = next[i];
+
+  return t - triangles;
+}
+
+template unsigned
+PolygonToTriangles(const RasterPoint *points, unsigned num_points,
+                   GLushort *triangles);
+
+template unsigned
+PolygonToTriangles(const FloatPoint *points, unsigned num_points,
+                   GLushort *triangles);
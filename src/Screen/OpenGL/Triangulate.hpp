@@ -0,0 +1,49 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_SCREEN_OPENGL_TRIANGULATE_HPP
+#define XCSOAR_SCREEN_OPENGL_TRIANGULATE_HPP
+
+#include "Screen/OpenGL/Point.hpp"
+
+/**
+ * Splits a simple polygon (convex or concave) into triangles, which
+ * can be drawn with GL_TRIANGLES.  Self-intersecting polygons are
+ * split, too, but the result may overlap.
+ *
+ * This takes O(n^2) time, so it is meant for shapes whose triangles
+ * are cached; see GLFillPolygon() for drawing a polygon once.
+ *
+ * @param points the polygon's vertices
+ * @param num_points the number of vertices; must be less than 65536
+ * @param triangles an index buffer with room for 3 * (num_points - 2)
+ * entries
+ * @return the number of indices written to the buffer (0 if the
+ * polygon is degenerate)
+ */
+template<typename PT>
+unsigned
+PolygonToTriangles(const PT *points, unsigned num_points,
+                   GLushort *triangles);
+
+#endif
@@ -111,6 +111,10 @@ TopCanvas::set()
   glDisable(GL_DITHER);
 
   glEnableClientState(GL_VERTEX_ARRAY);
+
+  GLint stencil_bits;
+  glGetIntegerv(GL_STENCIL_BITS, &stencil_bits);
+  OpenGL::stencil_available = stencil_bits > 0;
 #endif
 }
 
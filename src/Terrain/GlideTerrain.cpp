@@ -35,6 +35,8 @@ Copyright_License {
 #include "Navigation/Geometry/GeoVector.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
 #include "GlideSolvers/GlideResult.hpp"
+#include "Math/Earth.hpp"
+#include "Compiler.h"
 
 TerrainIntersection::TerrainIntersection(const GeoPoint& start):
   location(start),
@@ -67,6 +69,115 @@ GlideTerrain::get_terrain_base() const
 TerrainIntersection 
 GlideTerrain::find_intersection(const AIRCRAFT_STATE &state,
                                 const GlidePolar& polar) 
+{
+  RasterTerrain::Lease map(m_terrain);
+  return glide_intersection(map, state, polar, h_terrain(map, state.Location));
+}
+
+/**
+ * Returns the location at the specified distance from the origin, in
+ * the direction given by the sine and cosine of the bearing.  This
+ * uses the mid-latitude approximation (with the cosine of the mid
+ * latitude developed to first order), which needs no trigonometric
+ * function calls and is accurate enough within the glide range.
+ */
+gcc_pure
+static GeoPoint
+MidLatitudeOffset(const GeoPoint &origin,
+                  const fixed sin_latitude, const fixed cos_latitude,
+                  const fixed sin_bearing, const fixed cos_bearing,
+                  const fixed distance)
+{
+  const fixed angle = distance / fixed_earth_r;
+  const fixed d_latitude = angle * cos_bearing;
+  const fixed cos_mid_latitude =
+    cos_latitude - sin_latitude * d_latitude * fixed_half;
+  return GeoPoint(origin.Longitude +
+                  Angle::radians(angle * sin_bearing / cos_mid_latitude),
+                  origin.Latitude + Angle::radians(d_latitude));
+}
+
+void
+GlideTerrain::find_footprint(const AIRCRAFT_STATE &basic,
+                             const GlidePolar &polar,
+                             GeoPoint *locations, unsigned n)
+{
+  RasterTerrain::Lease map(m_terrain);
+
+  const fixed h_origin = h_terrain(map, basic.Location);
+
+  if (negative(basic.NavAltitude - h_origin)) {
+    // below the terrain: each bearing is sampled until it clears it
+    AIRCRAFT_STATE state = basic;
+    for (unsigned i = 0; i < n; ++i) {
+      state.TrackBearing = Angle::degrees(fixed_360 * fixed(i) / fixed(n));
+      locations[i] = glide_intersection(map, state, polar, h_origin).location;
+    }
+
+    return;
+  }
+
+  // all glides are straight lines from the same origin; instead of
+  // calling trigonometric functions for each bearing, its unit
+  // vector is rotated from one bearing to the next
+
+  const GeoPoint &origin = basic.Location;
+  const int start_altitude = (int)(basic.NavAltitude - safety_height_terrain);
+
+  fixed sin_latitude, cos_latitude;
+  origin.Latitude.sin_cos(sin_latitude, cos_latitude);
+
+  fixed sin_wind, cos_wind;
+  basic.wind.bearing.sin_cos(sin_wind, cos_wind);
+
+  fixed sin_step, cos_step;
+  Angle::degrees(fixed_360 / fixed(n)).sin_cos(sin_step, cos_step);
+
+  fixed sin_bearing = fixed_zero, cos_bearing = fixed_one;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const fixed glide_max_range = basic.NavAltitude *
+      polar.get_ld_over_ground(basic.wind.norm,
+                               cos_wind * cos_bearing +
+                               sin_wind * sin_bearing);
+
+    if (!positive(glide_max_range)) {
+      // can't make progress in this direction at the current windspeed/mc
+      locations[i] = origin;
+    } else {
+      const fixed range = positive(max_range)
+        ? min(max_range, glide_max_range)
+        : glide_max_range;
+      const GeoPoint end =
+        MidLatitudeOffset(origin, sin_latitude, cos_latitude,
+                          sin_bearing, cos_bearing, range);
+      const fixed end_altitude =
+        basic.NavAltitude * (fixed_one - range / glide_max_range);
+
+      short h;
+      const fixed f =
+        map->FirstIntersection(origin, start_altitude, end,
+                               (int)(end_altitude - safety_height_terrain),
+                               h);
+
+      locations[i] = negative(f)
+        ? MidLatitudeOffset(origin, sin_latitude, cos_latitude,
+                            sin_bearing, cos_bearing,
+                            max(glide_max_range, max_range) * fixed_two)
+        : origin.interpolate(end, f);
+    }
+
+    const fixed next_sin = sin_bearing * cos_step + cos_bearing * sin_step;
+    cos_bearing = cos_bearing * cos_step - sin_bearing * sin_step;
+    sin_bearing = next_sin;
+  }
+}
+
+TerrainIntersection
+GlideTerrain::glide_intersection(const RasterMap &map,
+                                 const AIRCRAFT_STATE &state,
+                                 const GlidePolar &polar,
+                                 const fixed h_origin)
 {
   TerrainIntersection retval(state.Location);
   
@@ -77,15 +188,27 @@ GlideTerrain::find_intersection(const AIRCRAFT_STATE &state,
     return retval;
   }
   
-  RasterTerrain::Lease map(m_terrain);
-
   GeoPoint loc= state.Location, last_loc = loc;
   fixed altitude = state.NavAltitude;
-  fixed h = h_terrain(map, loc);
+  fixed h = h_origin;
   fixed dh = altitude - h;
   fixed last_dh = dh;
   bool start_under = negative(dh);
-  
+
+  if (!start_under) {
+    // the glide is a straight line through the terrain
+    const fixed range = positive(max_range)
+      ? min(max_range, glide_max_range)
+      : glide_max_range;
+    const GeoVector vec(range, state.TrackBearing);
+    const fixed end_altitude =
+      state.NavAltitude * (fixed_one - range / glide_max_range);
+    return intersect_line(map, state, vec.end_point(state.Location),
+                          end_altitude,
+                          max(glide_max_range, max_range) * fixed_two);
+  }
+
+  // below the terrain: sample the track until it clears the terrain
   fixed f_scale = fixed_one/NUMFINALGLIDETERRAIN;
   if (positive(max_range) && (max_range<glide_max_range)) {
     f_scale *= max_range/glide_max_range;
@@ -171,6 +294,36 @@ GlideTerrain::h_terrain(const RasterMap &map, const GeoPoint& loc)
     +safety_height_terrain;
 }
 
+TerrainIntersection
+GlideTerrain::intersect_line(const RasterMap &map,
+                             const AIRCRAFT_STATE &state,
+                             const GeoPoint &end,
+                             const fixed end_altitude,
+                             const fixed long_distance)
+{
+  TerrainIntersection retval(state.Location);
+
+  // the safety height is taken off the line instead of added to the
+  // terrain
+  short h;
+  const fixed f =
+    map.FirstIntersection(state.Location,
+                          (int)(state.NavAltitude - safety_height_terrain),
+                          end, (int)(end_altitude - safety_height_terrain),
+                          h);
+  if (negative(f)) {
+    retval.out_of_range = true;
+    GeoVector long_vec(long_distance, state.TrackBearing);
+    retval.location = long_vec.end_point(state.Location);
+    return retval;
+  }
+
+  retval.location = state.Location.interpolate(end, f);
+  retval.range = retval.location.distance(state.Location);
+  retval.altitude = fixed(h) + safety_height_terrain;
+  return retval;
+}
+
 
 TerrainIntersection 
 GlideTerrain::find_intersection(const AIRCRAFT_STATE &state) 
@@ -185,68 +338,13 @@ GlideTerrain::find_intersection(const AIRCRAFT_STATE &state)
 
   RasterTerrain::Lease map(m_terrain);
 
-  GeoPoint loc= state.Location, last_loc = loc;
-  const fixed altitude = state.NavAltitude;
-  fixed h = h_terrain(map, loc);
-  fixed dh = altitude - h;
-  fixed last_dh = dh;
-
-  if (!positive(dh)) {
+  if (!positive(state.NavAltitude - h_terrain(map, state.Location))) {
     return retval;
   }
-  
-  fixed f_scale = fixed_one/NUMFINALGLIDETERRAIN;
-  
-  // find grid
-  const GeoVector vec(max_range*f_scale, state.TrackBearing);
-  const GeoPoint delta_ll = vec.end_point(state.Location)-state.Location;
-  
-  for (int i=1; i<=NUMFINALGLIDETERRAIN; ++i) {
-    fixed f;
-    const fixed fi = i*f_scale;
-    // fraction of glide_max_range
-    
-    if (fi>=fixed_one) {
-      // early exit
-      retval.out_of_range = true;
-      return retval;
-    }
-    
-    // find lat, lon of point of interest
-    loc += delta_ll;
-    
-    // find height over terrain
-    h = h_terrain(map, loc);
-    dh = altitude - h;
-    
-    if (positive(dh) && positive(h)) {
-      TerrainBase = min(TerrainBase, h);
-    }
-    
-    bool solution_found = false;
-    
-    if (!positive(dh)) {
-      if ((dh<last_dh) && positive(last_dh)) {
-        f = max(fixed_zero,min(fixed_one,(-last_dh)/(dh-last_dh)));
-      } else {
-        f = fixed_zero;
-      }
-      solution_found = true;
-    }
-    if (solution_found) {
-      retval.location = last_loc.interpolate(loc, f);
-      retval.range = retval.location.distance(state.Location);
-      retval.altitude = h; // approximation
-      return retval;
-    }
-    last_dh = dh;
-    last_loc = loc;
-  }
-    
-  retval.out_of_range = true;
-  GeoVector long_vec(max_range*fixed_two, state.TrackBearing);
-  retval.location = long_vec.end_point(state.Location);
-  return retval;
+
+  const GeoVector vec(max_range, state.TrackBearing);
+  return intersect_line(map, state, vec.end_point(state.Location),
+                        state.NavAltitude, max_range * fixed_two);
 }
 
 
@@ -68,6 +68,19 @@ public:
   TerrainIntersection find_intersection(const AIRCRAFT_STATE &basic,
                                         const GlidePolar& polar);
 
+  /**
+   * Find the glide intersections in evenly spaced bearings, starting
+   * north and going clockwise.  All bearings share one terrain lease
+   * and the terrain height at the origin.
+   *
+   * @param basic State of aircraft at origin
+   * @param polar Glide polar for descent
+   * @param locations Receives the intersection of each bearing
+   * @param n Number of bearings
+   */
+  void find_footprint(const AIRCRAFT_STATE &basic, const GlidePolar &polar,
+                      GeoPoint *locations, unsigned n);
+
   /** 
    * Find intersection for cruise (no height loss)
    * 
@@ -93,6 +106,33 @@ public:
 private:
   fixed h_terrain(const RasterMap &map, const GeoPoint& loc);
 
+  /**
+   * Find intersection for pure glide
+   *
+   * @param h_origin Terrain height (plus safety height) at the origin
+   */
+  TerrainIntersection glide_intersection(const RasterMap &map,
+                                         const AIRCRAFT_STATE &state,
+                                         const GlidePolar &polar,
+                                         const fixed h_origin);
+
+  /**
+   * Find intersection of a straight line with the terrain; the
+   * aircraft must be above the terrain.
+   *
+   * @param end End of the line
+   * @param end_altitude Altitude of the line at its end
+   * @param long_distance Distance of the location returned when the
+   * line doesn't touch the terrain
+   *
+   * @return Intersection
+   */
+  TerrainIntersection intersect_line(const RasterMap &map,
+                                     const AIRCRAFT_STATE &state,
+                                     const GeoPoint &end,
+                                     const fixed end_altitude,
+                                     const fixed long_distance);
+
   RasterTerrain &m_terrain;
   const fixed safety_height_terrain;
   fixed TerrainBase;
@@ -53,6 +53,37 @@ HeightMatrix::SetSize(unsigned width, unsigned height,
           (height + quantisation_pixels - 1) / quantisation_pixels);
 }
 
+/**
+ * Number of samples between two points which are projected exactly.
+ * The raster coordinates of the samples in between are interpolated
+ * linearly.
+ */
+static const unsigned scan_segment = 16;
+
+/**
+ * Convert a screen position to a geographic location, using the row
+ * rotation of the current matrix row.
+ */
+static GeoPoint
+RowToGeo(const WindowProjection &projection, const FastRowRotation &rotation,
+         int x, int y)
+{
+#ifndef SLOW_TERRAIN_STUFF
+  const FastRowRotation::Pair r =
+    rotation.Rotate(x - projection.GetScreenOrigin().x);
+
+  GeoPoint gp;
+  gp.Latitude = projection.GetGeoLocation().Latitude
+    - projection.PixelsToAngle(r.second);
+  gp.Longitude = projection.GetGeoLocation().Longitude
+    + projection.PixelsToAngle(r.first)
+    * gp.Latitude.invfastcosine();
+  return gp;
+#else
+  return projection.ScreenToGeo(x, y);
+#endif
+}
+
 void
 HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
                    unsigned quantisation_pixels, bool interpolate)
@@ -70,34 +101,31 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
     const FastRowRotation rotation =
       projection.GetScreenAngleRotation(y - projection.GetScreenOrigin().y);
 
-    short *p = data.begin() + y * width / quantisation_pixels;
+    short *const row = data.begin() + y * width / quantisation_pixels;
 
-    for (unsigned x = 0; x < screen_width; x += quantisation_pixels) {
-#ifndef SLOW_TERRAIN_STUFF
-      const FastRowRotation::Pair r =
-        rotation.Rotate(x - projection.GetScreenOrigin().x);
-
-      GeoPoint gp;
-       gp.Latitude = projection.GetGeoLocation().Latitude
-         - projection.PixelsToAngle(r.second);
-       gp.Longitude = projection.GetGeoLocation().Longitude
-         + projection.PixelsToAngle(r.first)
-        * gp.Latitude.invfastcosine();
-#else
-      GeoPoint gp = projection.ScreenToGeo(x, y);
-#endif
+    /* project the ends of each segment of the row, and sample the
+       raster along the straight line in between */
+    int x = 0;
+    GeoPoint start = RowToGeo(projection, rotation, x, y);
+    for (short *p = row, *end = row + width; p < end;) {
+      const unsigned n = std::min(scan_segment, (unsigned)(end - p));
+      x += n * quantisation_pixels;
 
-      short h = interpolate ? map.GetFieldInterpolated(gp) : map.GetField(gp);
+      const GeoPoint next = RowToGeo(projection, rotation, x, y);
+      map.ScanLine(start, next, p, n, interpolate);
+
+      p += n;
+      start = next;
+    }
+
+    for (const short *p = row, *end = row + width; p != end; ++p) {
+      const short h = *p;
       if (!RasterBuffer::is_special(h)) {
         if (h < minimum)
           minimum = h;
         if (h > maximum)
           maximum = h;
       }
-
-      *p++ = h;
     }
-
-    assert(p <= data.end());
   }
 }
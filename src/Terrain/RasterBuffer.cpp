@@ -32,10 +32,10 @@ RasterBuffer::resize(unsigned _width, unsigned _height)
 {
   assert(_width > 0 && _height > 0);
 
-  if (_width == width && _height == height)
+  if (_width == width && _height == height && !external)
     return;
 
-  delete[] data;
+  reset();
 
   width = _width;
   height = _height;
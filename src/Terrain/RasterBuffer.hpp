@@ -53,15 +53,22 @@ private:
   unsigned width, height;
   short *data;
 
+  /**
+   * Does #data point to memory owned by somebody else (see
+   * attach())?
+   */
+  bool external;
+
 public:
-  RasterBuffer():width(0), height(0), data(NULL) {}
+  RasterBuffer():width(0), height(0), data(NULL), external(false) {}
   RasterBuffer(unsigned _width, unsigned _height)
-    :width(0), height(0), data(NULL) {
+    :width(0), height(0), data(NULL), external(false) {
     resize(_width, _height);
   }
 
   ~RasterBuffer() {
-    delete[] data;
+    if (!external)
+      delete[] data;
   }
 
   bool defined() const {
@@ -89,9 +96,24 @@ public:
   }
 
   void reset() {
-    delete[] data;
+    if (!external)
+      delete[] data;
     data = NULL;
     width = height = 0;
+    external = false;
+  }
+
+  /**
+   * Use a block of memory owned by somebody else (e.g. a file
+   * mapping) instead of allocating one.  The caller must keep it
+   * valid until reset() is called, and it must not be modified.
+   */
+  void attach(const short *_data, unsigned _width, unsigned _height) {
+    reset();
+    data = const_cast<short *>(_data);
+    width = _width;
+    height = _height;
+    external = true;
   }
 
   void resize(unsigned _width, unsigned _height);
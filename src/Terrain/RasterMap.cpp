@@ -25,13 +25,15 @@ Copyright_License {
 #include "Math/Earth.hpp"
 #include "OS/PathName.hpp"
 #include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
 
 #include <assert.h>
 #include <string.h>
 
 RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
                      FileCache *cache)
-  :path(strdup(NarrowPathName(_path)))
+  :path(strdup(NarrowPathName(_path))),
+   tile_cache(NULL), tile_cache_file(NULL), tile_cache_path(NULL)
 {
   bool cache_loaded = false;
   if (cache != NULL) {
@@ -59,12 +61,96 @@ RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
     }
   }
 
+  if (cache != NULL && raster_tile_cache.GetInitialised())
+    LoadTileCache(*cache, _path);
+
   projection.set(raster_tile_cache.GetBounds(),
                  raster_tile_cache.GetWidth() * 256,
                  raster_tile_cache.GetHeight() * 256);
 }
 
+void
+RasterMap::LoadTileCache(FileCache &cache, const TCHAR *_path)
+{
+  size_t offset;
+  FileMapping *mapping = cache.map(_T("terrain-tiles"), _path, offset);
+  if (mapping != NULL) {
+    if (raster_tile_cache.LoadTileCache(mapping, offset))
+      return;
+
+    delete mapping;
+    cache.flush(_T("terrain-tiles"));
+  }
+
+  /* no tile cache yet: write the header now, the tiles are decoded
+     by the loader thread while it is idle */
+  FILE *file = cache.save(_T("terrain-tiles"), _path);
+  if (file == NULL)
+    return;
+
+  if (!raster_tile_cache.BeginTileCache(file)) {
+    cache.cancel(_T("terrain-tiles"), file);
+    return;
+  }
+
+  tile_cache = &cache;
+  tile_cache_file = file;
+  tile_cache_path = _tcsdup(_path);
+}
+
+bool
+RasterMap::SaveNextTiles()
+{
+  if (tile_cache_file == NULL)
+    return false;
+
+  if (!raster_tile_cache.SaveNextTiles(path, tile_cache_file)) {
+    CancelTileCache();
+    return false;
+  }
+
+  return !raster_tile_cache.IsTileCacheComplete();
+}
+
+void
+RasterMap::FinishTileCache()
+{
+  if (tile_cache_file == NULL || !raster_tile_cache.IsTileCacheComplete())
+    return;
+
+  FileCache &cache = *tile_cache;
+  const bool committed = cache.commit(_T("terrain-tiles"), tile_cache_file);
+  tile_cache_file = NULL;
+
+  if (committed) {
+    size_t offset;
+    FileMapping *mapping = cache.map(_T("terrain-tiles"), tile_cache_path,
+                                     offset);
+    if (mapping != NULL &&
+        !raster_tile_cache.LoadTileCache(mapping, offset)) {
+      delete mapping;
+      cache.flush(_T("terrain-tiles"));
+    }
+  }
+
+  free(tile_cache_path);
+  tile_cache_path = NULL;
+}
+
+void
+RasterMap::CancelTileCache()
+{
+  if (tile_cache_file == NULL)
+    return;
+
+  tile_cache->cancel(_T("terrain-tiles"), tile_cache_file);
+  tile_cache_file = NULL;
+  free(tile_cache_path);
+  tile_cache_path = NULL;
+}
+
 RasterMap::~RasterMap() {
+  CancelTileCache();
   free(path);
 }
 
@@ -74,21 +160,44 @@ angle_to_pixel(Angle value, Angle start, Angle end, unsigned width)
   return (value - start).value_native() * width / (end - start).value_native();
 }
 
+RasterTileCache::Point
+RasterMap::GetRasterPoint(const GeoPoint &location) const
+{
+  const GeoBounds &bounds = raster_tile_cache.GetBounds();
+
+  RasterTileCache::Point point;
+  point.x = angle_to_pixel(location.Longitude, bounds.west, bounds.east,
+                           raster_tile_cache.GetWidth());
+  point.y = angle_to_pixel(location.Latitude, bounds.north, bounds.south,
+                           raster_tile_cache.GetHeight());
+  return point;
+}
+
 void
 RasterMap::SetViewCenter(const GeoPoint &location)
 {
   if (!raster_tile_cache.GetInitialised())
     return;
 
-  const GeoBounds &bounds = raster_tile_cache.GetBounds();
+  const RasterTileCache::Point center = GetRasterPoint(location);
+  raster_tile_cache.UpdateTiles(path, center.x, center.y);
+}
 
-  int x = angle_to_pixel(location.Longitude, bounds.west, bounds.east,
-                         raster_tile_cache.GetWidth());
+bool
+RasterMap::PollTiles(const GeoPoint &center,
+                     const GeoPoint *prefetch, unsigned num_prefetch)
+{
+  assert(num_prefetch <= MAX_PREFETCH);
 
-  int y = angle_to_pixel(location.Latitude, bounds.north, bounds.south,
-                         raster_tile_cache.GetHeight());
+  if (!raster_tile_cache.GetInitialised())
+    return false;
+
+  RasterTileCache::Point points[MAX_PREFETCH];
+  for (unsigned i = 0; i < num_prefetch; ++i)
+    points[i] = GetRasterPoint(prefetch[i]);
 
-  raster_tile_cache.UpdateTiles(path, x, y);
+  const RasterTileCache::Point c = GetRasterPoint(center);
+  return raster_tile_cache.PollTiles(c.x, c.y, points, num_prefetch);
 }
 
 short
@@ -104,3 +213,29 @@ RasterMap::GetFieldInterpolated(const GeoPoint &location) const
   std::pair<unsigned, unsigned> xy = projection.project(location);
   return raster_tile_cache.GetFieldInterpolated(xy.first, xy.second);
 }
+
+void
+RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
+                    short *buffer, unsigned size, bool interpolate) const
+{
+  const std::pair<unsigned, unsigned> a = projection.project(start);
+  const std::pair<unsigned, unsigned> b = projection.project(end);
+  raster_tile_cache.ScanLine(a.first, a.second, b.first, b.second,
+                             buffer, size, interpolate);
+}
+
+fixed
+RasterMap::FirstIntersection(const GeoPoint &start, int start_alt,
+                             const GeoPoint &end, int end_alt,
+                             short &h_r) const
+{
+  const std::pair<unsigned, unsigned> a = projection.project(start);
+  const std::pair<unsigned, unsigned> b = projection.project(end);
+  const int t =
+    raster_tile_cache.FirstIntersection(a.first, a.second, start_alt,
+                                        b.first, b.second, end_alt, h_r);
+  if (t < 0)
+    return -fixed_one;
+
+  return fixed(t) / (1 << 16);
+}
@@ -30,15 +30,43 @@ Copyright_License {
 #include "Util/NonCopyable.hpp"
 #include "Compiler.h"
 
+#include <stdio.h>
 #include <tchar.h>
 
 class FileCache;
 
 class RasterMap : private NonCopyable {
+public:
+  /**
+   * The maximum number of prefetch locations passed to PollTiles().
+   */
+  static const unsigned MAX_PREFETCH = 8;
+
+private:
   char *path;
   RasterTileCache raster_tile_cache;
   RasterProjection projection;
 
+  /**
+   * The cache which receives the tile cache file being written by
+   * SaveNextTiles(), the open file (NULL if none) and the path of the
+   * terrain file.
+   */
+  FileCache *tile_cache;
+  FILE *tile_cache_file;
+  TCHAR *tile_cache_path;
+
+  /**
+   * Map the file with pre-decoded tiles.  If it does not exist yet,
+   * start writing it; see SaveNextTiles().
+   */
+  void LoadTileCache(FileCache &cache, const TCHAR *path);
+
+  void CancelTileCache();
+
+  gcc_pure
+  RasterTileCache::Point GetRasterPoint(const GeoPoint &location) const;
+
 public:
   RasterMap(const TCHAR *path, const TCHAR *world_file, FileCache *cache);
   ~RasterMap();
@@ -59,6 +87,40 @@ public:
 
   void SetViewCenter(const GeoPoint &location);
 
+  /**
+   * Select the tiles needed for the specified view centre and
+   * prefetch locations, without loading them.
+   *
+   * @see RasterTileCache::PollTiles()
+   */
+  bool PollTiles(const GeoPoint &center,
+                 const GeoPoint *prefetch, unsigned num_prefetch);
+
+  /**
+   * Load the tiles selected by PollTiles().
+   *
+   * @see RasterTileCache::LoadTiles()
+   */
+  void LoadTiles() {
+    raster_tile_cache.LoadTiles(path);
+  }
+
+  /**
+   * Write the next few tiles of the tile cache file, if one is being
+   * written.  Same locking rules as LoadTiles().
+   *
+   * @return true if there are more tiles to be written
+   * @see RasterTileCache::SaveNextTiles()
+   */
+  bool SaveNextTiles();
+
+  /**
+   * Commit the tile cache file after SaveNextTiles() has written the
+   * last tile, and switch the tiles over to it.  Requires an
+   * exclusive lock.
+   */
+  void FinishTileCache();
+
   /**
    * @see RasterProjection::pixel_distance()
    */
@@ -74,6 +136,32 @@ public:
 
   gcc_pure
   short GetFieldInterpolated(const GeoPoint &location) const;
+
+  /**
+   * Sample the heights at size points along the straight line (in
+   * raster coordinates) from start towards end.  The end point itself
+   * is not sampled, so adjacent lines can share their end points.
+   *
+   * @param buffer Receives the heights
+   * @param interpolate True enables interpolation of sub-pixel values
+   */
+  void ScanLine(const GeoPoint &start, const GeoPoint &end,
+                short *buffer, unsigned size, bool interpolate) const;
+
+  /**
+   * Find the first location on the straight line (in raster
+   * coordinates) from start to end where the terrain reaches the
+   * line.  The altitude of the line changes linearly from start_alt
+   * to end_alt.
+   *
+   * @see RasterTileCache::FirstIntersection()
+   * @param h_r Receives the terrain height at the intersection
+   * @return The location of the intersection as a fraction of the
+   * line, or a negative value if the line is clear of the terrain
+   */
+  fixed FirstIntersection(const GeoPoint &start, int start_alt,
+                          const GeoPoint &end, int end_alt,
+                          short &h_r) const;
 };
 
 
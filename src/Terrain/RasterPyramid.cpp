@@ -0,0 +1,164 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "RasterPyramid.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+using std::min;
+using std::max;
+
+void
+RasterPyramid::Reset()
+{
+  for (unsigned i = 0; i < num_levels; ++i)
+    levels[i].reset();
+
+  num_levels = 0;
+}
+
+/**
+ * Calculate a cell of the next level from the 2x2 cells below it.
+ */
+gcc_pure
+static short
+MaxOfChildren(const RasterBuffer &child, unsigned x, unsigned y)
+{
+  const unsigned x0 = x * 2, y0 = y * 2;
+  const unsigned x1 = min(x0 + 1, child.get_width() - 1);
+  const unsigned y1 = min(y0 + 1, child.get_height() - 1);
+
+  return max(max(child.get(x0, y0), child.get(x1, y0)),
+             max(child.get(x0, y1), child.get(x1, y1)));
+}
+
+void
+RasterPyramid::Build(const RasterBuffer &overview,
+                     unsigned width, unsigned height)
+{
+  Reset();
+
+  if (!overview.defined() || width == 0 || height == 0)
+    return;
+
+  const unsigned last_x = overview.get_width() - 1;
+  const unsigned last_y = overview.get_height() - 1;
+
+  RasterBuffer &base = levels[0];
+  base.resize(width, height);
+  for (unsigned y = 0; y < height; ++y) {
+    const unsigned y0 = min(y, last_y), y1 = min(y + 1, last_y);
+    short *row = base.get_data() + y * width;
+
+    for (unsigned x = 0; x < width; ++x) {
+      const unsigned x0 = min(x, last_x), x1 = min(x + 1, last_x);
+      row[x] = max(max(overview.get(x0, y0), overview.get(x1, y0)),
+                   max(overview.get(x0, y1), overview.get(x1, y1)));
+    }
+  }
+
+  num_levels = 1;
+  while ((width > 1 || height > 1) && num_levels < MAX_LEVELS) {
+    const RasterBuffer &child = levels[num_levels - 1];
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+
+    RasterBuffer &level = levels[num_levels++];
+    level.resize(width, height);
+    for (unsigned y = 0; y < height; ++y)
+      for (unsigned x = 0; x < width; ++x)
+        level.get_data()[y * width + x] = MaxOfChildren(child, x, y);
+  }
+}
+
+void
+RasterPyramid::Raise(unsigned x, unsigned y, const RasterBuffer &maxima)
+{
+  if (!defined() || !maxima.defined())
+    return;
+
+  RasterBuffer &base = levels[0];
+  if (x >= base.get_width() || y >= base.get_height())
+    return;
+
+  unsigned x1 = min(x + maxima.get_width(), base.get_width());
+  unsigned y1 = min(y + maxima.get_height(), base.get_height());
+
+  bool modified = false;
+  for (unsigned cy = y; cy < y1; ++cy) {
+    short *cell = base.get_data() + cy * base.get_width() + x;
+    for (unsigned cx = x; cx < x1; ++cx, ++cell) {
+      const short h = maxima.get(cx - x, cy - y);
+      if (h > *cell) {
+        *cell = h;
+        modified = true;
+      }
+    }
+  }
+
+  if (!modified)
+    return;
+
+  /* propagate to the upper levels; the rectangle end is exclusive */
+  for (unsigned i = 1; i < num_levels; ++i) {
+    x /= 2;
+    y /= 2;
+    x1 = (x1 + 1) / 2;
+    y1 = (y1 + 1) / 2;
+
+    RasterBuffer &level = levels[i];
+    for (unsigned cy = y; cy < y1; ++cy) {
+      short *cell = level.get_data() + cy * level.get_width() + x;
+      for (unsigned cx = x; cx < x1; ++cx, ++cell)
+        *cell = max(*cell, MaxOfChildren(levels[i - 1], cx, cy));
+    }
+  }
+}
+
+short
+RasterPyramid::GetMax(unsigned level, int x0, int y0, int x1, int y1) const
+{
+  assert(level < num_levels);
+  assert(x0 <= x1 && y0 <= y1);
+
+  const RasterBuffer &buffer = levels[level];
+  const int width = buffer.get_width(), height = buffer.get_height();
+
+  if (x1 < 0 || y1 < 0 || x0 >= width || y0 >= height)
+    return 0;
+
+  x0 = max(x0, 0);
+  y0 = max(y0, 0);
+  x1 = min(x1, width - 1);
+  y1 = min(y1, height - 1);
+
+  short result = 0;
+  for (int y = y0; y <= y1; ++y) {
+    const short *row = buffer.get_data_at(0, y);
+    for (int x = x0; x <= x1; ++x)
+      result = max(result, row[x]);
+  }
+
+  return result;
+}
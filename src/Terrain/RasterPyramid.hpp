@@ -0,0 +1,92 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_RASTER_PYRAMID_HPP
+#define XCSOAR_TERRAIN_RASTER_PYRAMID_HPP
+
+#include "RasterBuffer.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+/**
+ * A hierarchy of terrain height maxima.  Each cell of level 0 covers
+ * one pixel of the overview (i.e. a square block of raster pixels),
+ * and each cell of the next level covers 2x2 cells of the previous
+ * one, up to a single cell.
+ *
+ * A cell is never lower than any height the tile cache may return
+ * for a raster pixel inside it.  A line which passes above a cell
+ * therefore can't touch the terrain there, which lets
+ * RasterTileCache::FirstIntersection() skip large areas at once.
+ */
+class RasterPyramid : private NonCopyable {
+  static const unsigned MAX_LEVELS = 24;
+
+  RasterBuffer levels[MAX_LEVELS];
+  unsigned num_levels;
+
+public:
+  RasterPyramid():num_levels(0) {}
+
+  bool defined() const {
+    return num_levels > 0;
+  }
+
+  unsigned GetNumLevels() const {
+    return num_levels;
+  }
+
+  void Reset();
+
+  /**
+   * Build the pyramid from the overview.  A level 0 cell receives the
+   * maximum of the four overview pixels the interpolation inside it
+   * may use.
+   *
+   * @param width, height the size of level 0 in cells; this may
+   * exceed the size of the overview by one at the right and bottom
+   * edges
+   */
+  void Build(const RasterBuffer &overview, unsigned width, unsigned height);
+
+  /**
+   * Raise level 0 cells (and the cells above them) to the specified
+   * heights where they are higher.  Called with the block maxima of a
+   * tile after it has been loaded.
+   *
+   * @param x, y the level 0 cell corresponding to the top left
+   * element of the buffer
+   */
+  void Raise(unsigned x, unsigned y, const RasterBuffer &maxima);
+
+  /**
+   * Determine the maximum of a rectangle of cells (inclusive) on the
+   * specified level.  The rectangle is clipped; cells outside the
+   * raster have no terrain.  The result is never negative, because
+   * the glide calculations treat water and invalid heights as zero.
+   */
+  gcc_pure
+  short GetMax(unsigned level, int x0, int y0, int x1, int y1) const;
+};
+
+#endif
@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/SlopeShading.hpp"
 #include "Math/Earth.hpp"
 #include "Math/FastMath.h"
 #include "Screen/Ramp.hpp"
@@ -173,102 +174,49 @@ RasterRenderer::GenerateSlopeImage(bool is_terrain, unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz)
 {
-  RECT border;
-  border.left = quantisation_effective;
-  border.top = quantisation_effective;
-  border.right = height_matrix.get_width() - quantisation_effective;
-  border.bottom = height_matrix.get_height() - quantisation_effective;
+  const unsigned width = height_matrix.get_width();
+  const unsigned height = height_matrix.get_height();
 
   const unsigned height_slope_factor = max(1, (int)pixel_size);
+  const SlopeShading shading(sx, sy, sz, contrast, height_slope_factor);
 
   const int min_height = is_terrain
     ? min(1000, (int)height_matrix.get_minimum()) : 0;
   const int height_factor = is_terrain
     ? max(2000, (int)height_matrix.get_maximum()) - min_height : 0;
 
+  slope_buffer.grow_discard(width);
+  signed char *const sindex = slope_buffer.begin();
+
   const short *src = height_matrix.GetData();
   const BGRColor *oColorBuf = color_table + 64 * 256;
   BGRColor *dest = image->GetTopRow();
 
-  for (unsigned y = 0; y < height_matrix.get_height(); ++y) {
-    const unsigned row_plus_index = y < (unsigned)border.bottom
+  for (unsigned y = 0; y < height; ++y, src += width) {
+    const unsigned row_plus_index = y + quantisation_effective < height
       ? quantisation_effective
-      : height_matrix.get_height() - 1 - y;
-    const unsigned row_plus_offset = height_matrix.get_width() * row_plus_index;
-
+      : height - 1 - y;
     const unsigned row_minus_index = y >= quantisation_effective
       ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.get_width() * row_minus_index;
 
-    const unsigned p31 = row_plus_index + row_minus_index;
+    const short *above = src - width * row_minus_index;
+    const short *below = src + width * row_plus_index;
+    assert(above >= height_matrix.GetData());
+    assert(below < height_matrix.GetDataEnd());
+
+    shading.ShadeRow(src, above, below, width, quantisation_effective,
+                     row_plus_index + row_minus_index, sindex);
 
     BGRColor *p = dest;
     dest = image->GetNextRow(dest);
 
-    for (unsigned x = 0; x < height_matrix.get_width(); ++x, ++src) {
-      short h = *src;
+    for (unsigned x = 0; x < width; ++x) {
+      short h = src[x];
       if (gcc_likely(!RasterBuffer::is_special(h))) {
         h = height_factor > 0
           ? (h - min_height) * 254 / height_factor
           : min(254, h >> height_scale);
-
-        // no need to calculate slope if undefined height or sea level
-
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
-
-        // X direction
-
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.get_width() - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
-
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
-
-        short h_above = src[-(int)row_minus_offset];
-        short h_below = src[row_plus_offset];
-        short h_left = src[-(int)column_minus_index];
-        short h_right = src[column_plus_index];
-
-        if (gcc_unlikely(RasterBuffer::is_special(h_above) ||
-                         RasterBuffer::is_special(h_below) ||
-                         RasterBuffer::is_special(h_left) ||
-                         RasterBuffer::is_special(h_right))) {
-          /* some "special" terrain value surrounding us (water or
-             invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
-          continue;
-        }
-
-        const int p32 = h_above - h_below;
-        const int p22 = h_right - h_left;
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * p31;
-        const int dd1 = p20 * p32;
-        const int dd2 = p20 * p31 * height_slope_factor;
-        const int mag = (dd0 * dd0 + dd1 * dd1 + dd2 * dd2);
-        const int num = (dd2 * sz + dd0 * sx + dd1 * sy);
-#ifdef FIXED_MATH
-        const int sval = num / (int)isqrt4(mag);
-#else
-        const int sval = num / (int)sqrt((fixed)mag);
-#endif
-        int sindex = (sval - sz) * contrast / 128;
-        if (gcc_unlikely(sindex < -64))
-          sindex = -64;
-        if (gcc_unlikely(sindex > 63))
-          sindex = 63;
-        *p++ = oColorBuf[h + 256*sindex];
+        *p++ = oColorBuf[h + 256 * sindex[x]];
       } else if (RasterBuffer::is_water(h)) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
@@ -27,6 +27,7 @@ Copyright_License {
 #include "Terrain/HeightMatrix.hpp"
 #include "Screen/RawBitmap.hpp"
 #include "Util/NonCopyable.hpp"
+#include "Util/AllocatedArray.hpp"
 
 #define NUM_COLOR_RAMP_LEVELS 13
 
@@ -49,6 +50,9 @@ class RasterRenderer : private NonCopyable {
 
   BGRColor color_table[256 * 128];
 
+  /** shading index of one row, see SlopeShading */
+  AllocatedArray<signed char> slope_buffer;
+
 public:
   RasterRenderer();
   ~RasterRenderer();
@@ -53,5 +53,51 @@ RasterTerrain::OpenTerrain(FileCache *cache)
     return NULL;
   }
 
+  rt->loader.start();
   return rt;
 }
+
+RasterTerrain::~RasterTerrain()
+{
+  if (loader.defined()) {
+    loader.stop();
+    loader.join();
+  }
+}
+
+bool
+RasterTerrain::PollTiles(const GeoPoint &center,
+                         const GeoPoint *prefetch, unsigned num_prefetch)
+{
+  ExclusiveLease lease(*this);
+  return lease->PollTiles(center, prefetch, num_prefetch);
+}
+
+void
+RasterTerrain::LoadTiles()
+{
+  /* a shared lease is enough: the new tiles are not active yet, so
+     readers don't see them until the next PollTiles() call, and only
+     the loader thread changes them */
+  Lease lease(*this);
+  map.LoadTiles();
+}
+
+bool
+RasterTerrain::SaveNextTiles()
+{
+  bool more;
+
+  {
+    /* same as LoadTiles(): the decoded tiles are not active */
+    Lease lease(*this);
+    more = map.SaveNextTiles();
+  }
+
+  if (!more) {
+    ExclusiveLease lease(*this);
+    map.FinishTileCache();
+  }
+
+  return more;
+}
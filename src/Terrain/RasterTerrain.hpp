@@ -25,6 +25,7 @@ Copyright_License {
 #define XCSOAR_TERRAIN_RASTER_TERRAIN_HPP
 
 #include "RasterMap.hpp"
+#include "TerrainLoader.hpp"
 #include "Navigation/GeoPoint.hpp"
 #include "Thread/Guard.hpp"
 #include "Compiler.h"
@@ -46,6 +47,8 @@ public:
 protected:
   RasterMap map;
 
+  TerrainLoader loader;
+
 public:
 
 /** 
@@ -53,7 +56,9 @@ public:
  * 
  */
   RasterTerrain(const TCHAR *path, const TCHAR *world_file, FileCache *cache)
-    :Guard<RasterMap>(map), map(path, world_file, cache) {}
+    :Guard<RasterMap>(map), map(path, world_file, cache), loader(*this) {}
+
+  ~RasterTerrain();
 
 /** 
  * Load the terrain.  Determines the file to load from profile settings.
@@ -70,6 +75,39 @@ public:
   GeoPoint GetTerrainCenter() const {
     return map.GetMapCenter();
   }
+
+  /**
+   * Ask the loader thread to load the tiles around the view centre,
+   * and then around the prefetch locations (most important first).
+   * Returns immediately.
+   */
+  void RequestTiles(const GeoPoint &center,
+                    const GeoPoint *prefetch, unsigned num_prefetch) {
+    loader.Request(center, prefetch, num_prefetch);
+  }
+
+  /**
+   * Select the tiles to be loaded.  This holds the exclusive lock,
+   * but doesn't decode anything.  Called by the loader thread.
+   *
+   * @return true if LoadTiles() has work to do
+   */
+  bool PollTiles(const GeoPoint &center,
+                 const GeoPoint *prefetch, unsigned num_prefetch);
+
+  /**
+   * Load the tiles selected by PollTiles().  Called by the loader
+   * thread.
+   */
+  void LoadTiles();
+
+  /**
+   * Continue writing the tile cache file, if one is being written.
+   * Called by the loader thread while it has nothing else to do.
+   *
+   * @return true if there is more work
+   */
+  bool SaveNextTiles();
 };
 
 #endif
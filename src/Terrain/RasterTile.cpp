@@ -26,8 +26,12 @@ Copyright_License {
 #include "Math/Angle.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "ProgressGlue.hpp"
+#include "OS/FileMapping.hpp"
+#include "Thread/Mutex.hpp"
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
 #include <algorithm>
 
 using std::min;
@@ -62,6 +66,8 @@ RasterTile::Enable()
 {
   if (!width || !height) {
     Disable();
+  } else if (cached_data != NULL) {
+    buffer.attach(cached_data, width, height);
   } else {
     buffer.resize(width, height);
   }
@@ -108,18 +114,54 @@ RasterTile::GetFieldInterpolated(unsigned lx, unsigned ly,
   return buffer.get_interpolated(lx, ly, ix, iy);
 }
 
+void
+RasterTile::CalculateMaxima(unsigned block)
+{
+  assert(IsEnabled());
+
+  if (maxima.defined())
+    return;
+
+  const unsigned bx = xstart / block, by = ystart / block;
+  maxima.resize((xend - 1) / block - bx + 1, (yend - 1) / block - by + 1);
+  std::fill(maxima.get_data(),
+            maxima.get_data() + maxima.get_width() * maxima.get_height(),
+            RasterBuffer::TERRAIN_INVALID);
+
+  for (unsigned y = 0; y < height; ++y) {
+    short *dest = maxima.get_data() +
+      ((ystart + y) / block - by) * maxima.get_width();
+    const short *src = buffer.get_data_at(0, y);
+
+    for (unsigned x = 0; x < width;) {
+      const unsigned cell = (xstart + x) / block;
+      const unsigned end = min(width, (cell + 1) * block - xstart);
+
+      short &m = dest[cell - bx];
+      m = max(m, *std::max_element(src + x, src + end));
+      x = end;
+    }
+  }
+}
+
+void
+RasterTile::MergeMaxima(RasterPyramid &pyramid, unsigned block)
+{
+  pyramid.Raise(xstart / block, ystart / block, maxima);
+  maxima.reset();
+  maxima_merged = true;
+}
+
 bool
-RasterTile::CheckTileVisibility(const int view_x, const int view_y)
+RasterTile::IsVisible(int view_x, int view_y) const
 {
-  if (!width || !height) {
-    Disable();
+  if (!defined())
     return false;
-  }
 
-  const unsigned int dx1 = abs(view_x - xstart);
-  const unsigned int dx2 = abs(xend - view_x);
-  const unsigned int dy1 = abs(view_y - ystart);
-  const unsigned int dy2 = abs(yend - view_y);
+  const unsigned int dx1 = abs(view_x - (int)xstart);
+  const unsigned int dx2 = abs((int)xend - view_x);
+  const unsigned int dy1 = abs(view_y - (int)ystart);
+  const unsigned int dy2 = abs((int)yend - view_y);
 
   if (min(dx1, dx2) * 2 < width * 3) {
     if (min(dy1, dy2) < height)
@@ -129,19 +171,31 @@ RasterTile::CheckTileVisibility(const int view_x, const int view_y)
     if (min(dx1, dx2) < width)
       return true;
   }
-  if (IsEnabled()) {
-    if ((max(dx1, dx2) > width * 2) || (max(dy1, dy2) > height * 2))
-      Disable();
-  }
+
   return false;
 }
 
 bool
-RasterTile::VisibilityChanged(int view_x, int view_y)
+RasterTile::IsFar(int view_x, int view_y) const
 {
-  request = CheckTileVisibility(view_x, view_y) && IsDisabled();
-  // JMW note: order of these is important!
-  return request;
+  const unsigned int dx1 = abs(view_x - (int)xstart);
+  const unsigned int dx2 = abs((int)xend - view_x);
+  const unsigned int dy1 = abs(view_y - (int)ystart);
+  const unsigned int dy2 = abs((int)yend - view_y);
+
+  return max(dx1, dx2) > width * 2 || max(dy1, dy2) > height * 2;
+}
+
+bool
+RasterTile::IsNear(int x, int y) const
+{
+  if (!defined())
+    return false;
+
+  return x >= (int)xstart - (int)width / 2 &&
+    x < (int)xend + (int)width / 2 &&
+    y >= (int)ystart - (int)height / 2 &&
+    y < (int)yend + (int)height / 2;
 }
 
 short*
@@ -157,7 +211,9 @@ void
 RasterTileCache::SetTile(unsigned index,
                          int xstart, int ystart, int xend, int yend)
 {
-  if (index >= MAX_RTC_TILES)
+  if (index >= MAX_RTC_TILES || !scan_overview)
+    /* the tile layout is known after the overview has been scanned;
+       don't touch the active tiles while decoding in background */
     return;
 
   if (!segments.empty() && segments.last().tile < 0)
@@ -168,25 +224,95 @@ RasterTileCache::SetTile(unsigned index,
 }
 
 bool
-RasterTileCache::PollTiles(int x, int y)
+RasterTileCache::PollTiles(int x, int y,
+                           const Point *prefetch, unsigned num_prefetch)
 {
-  bool retval = false;
-  int i;
-
   if (scan_overview)
     return false;
 
+  /* tiles loaded since the last call are about to become visible to
+     readers; the pyramid must cover them first */
+  MergeMaxima();
+
+  /* rank the tiles: 0 if visible around the view centre, 1+n if
+     near prefetch location n */
+  static const unsigned char NOT_WANTED = 0xff;
+  unsigned char rank[MAX_RTC_TILES];
+  std::fill(rank, rank + MAX_RTC_TILES, NOT_WANTED);
+
+  num_prefetch = min(num_prefetch, (unsigned)NOT_WANTED - 1);
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i) {
+    if (!tiles[i].defined())
+      continue;
+
+    if (tiles[i].IsVisible(x, y)) {
+      rank[i] = 0;
+      continue;
+    }
+
+    for (unsigned p = 0; p < num_prefetch; ++p) {
+      if (tiles[i].IsNear(prefetch[p].x, prefetch[p].y)) {
+        rank[i] = 1 + p;
+        break;
+      }
+    }
+  }
+
+  /* collect the wanted tiles, most important first */
+  StaticArray<unsigned, MAX_ACTIVE_TILES> wanted;
+  bool is_wanted[MAX_RTC_TILES];
+  std::fill(is_wanted, is_wanted + MAX_RTC_TILES, false);
+
+  for (unsigned r = 0; r <= num_prefetch && !wanted.full(); ++r) {
+    for (unsigned i = 0; i < MAX_RTC_TILES && !wanted.full(); ++i) {
+      if (rank[i] == r) {
+        is_wanted[i] = true;
+        wanted.append(i);
+      }
+    }
+  }
+
+  unsigned num_missing = 0;
+  for (const unsigned *i = wanted.begin(); i != wanted.end(); ++i)
+    if (tiles[*i].IsDisabled())
+      ++num_missing;
+
+  /* unload tiles which are far away; the others are kept, unless
+     their slot is needed for a wanted tile */
+  unsigned num_enabled = 0;
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i) {
+    if (!tiles[i].IsEnabled())
+      continue;
+
+    if (!is_wanted[i] && tiles[i].IsFar(x, y))
+      tiles[i].Disable();
+    else
+      ++num_enabled;
+  }
+
+  for (unsigned i = 0; i < MAX_RTC_TILES &&
+         num_enabled + num_missing > MAX_ACTIVE_TILES; ++i) {
+    if (tiles[i].IsEnabled() && !is_wanted[i]) {
+      tiles[i].Disable();
+      --num_enabled;
+    }
+  }
+
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i)
+    tiles[i].set_requested(is_wanted[i] && tiles[i].IsDisabled());
+
+  /* rebuild the active list, wanted tiles first */
   ActiveTiles.clear();
 
-  for (i = MAX_RTC_TILES - 1; --i >= 0;) {
-    if (tiles[i].VisibilityChanged(x, y))
-      retval = true;
+  for (const unsigned *i = wanted.begin(); i != wanted.end(); ++i)
+    if (tiles[*i].IsEnabled())
+      ActiveTiles.append(tiles[*i]);
 
-    if (tiles[i].IsEnabled() && !ActiveTiles.full())
+  for (unsigned i = 0; i < MAX_RTC_TILES && !ActiveTiles.full(); ++i)
+    if (tiles[i].IsEnabled() && !is_wanted[i])
       ActiveTiles.append(tiles[i]);
-  }
 
-  return retval;
+  return num_missing > 0;
 }
 
 bool
@@ -206,7 +332,7 @@ RasterTileCache::TileRequest(unsigned index)
     if (tiles[i].IsEnabled())
       num_used++;
 
-  if (num_used < MAX_ACTIVE_TILES) {
+  if (num_used < MAX_ACTIVE_TILES + extra_tiles) {
     tiles[index].Enable();
     return true; // want to load this one!
   }
@@ -225,10 +351,8 @@ RasterTileCache::GetField(unsigned int lx, unsigned int ly) const
 
   for (unsigned i = 0; i < ActiveTiles.length(); ++i) {
     short h = ActiveTiles[i].GetField(px, py);
-    if (!RasterBuffer::is_invalid(h)) {
-      ActiveTiles.move_to_front(i);
+    if (!RasterBuffer::is_invalid(h))
       return h;
-    }
   }
   // still not found, so go to overview
   return Overview.get_interpolated(lx / RTC_SUBSAMPLING, ly / RTC_SUBSAMPLING);
@@ -247,18 +371,169 @@ RasterTileCache::GetFieldInterpolated(unsigned int lx, unsigned int ly) const
 
   for (unsigned i = 0; i < ActiveTiles.length(); ++i) {
     short h = ActiveTiles[i].GetFieldInterpolated(px, py, ix, iy);
-    if (!RasterBuffer::is_invalid(h)) {
-      ActiveTiles.move_to_front(i);
+    if (!RasterBuffer::is_invalid(h))
       return h;
-    }
   }
   // still not found, so go to overview
   return Overview.get_interpolated(lx / RTC_SUBSAMPLING, ly / RTC_SUBSAMPLING);
 }
 
+const RasterTile *
+RasterTileCache::FindTile(unsigned px, unsigned py) const
+{
+  for (unsigned i = 0; i < ActiveTiles.length(); ++i)
+    if (ActiveTiles[i].IsInside(px, py))
+      return &ActiveTiles[i];
+
+  return NULL;
+}
+
+void
+RasterTileCache::ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
+                          short *buffer, unsigned size,
+                          bool interpolate) const
+{
+  assert(size > 0);
+
+  /* 16 bit fraction, so the steps don't accumulate rounding errors
+     over long lines */
+  const int64_t dx = (((int64_t)(int)bx - (int)ax) << 16) / (int)size;
+  const int64_t dy = (((int64_t)(int)by - (int)ay) << 16) / (int)size;
+  int64_t x = (int64_t)(int)ax << 16;
+  int64_t y = (int64_t)(int)ay << 16;
+
+  const RasterTile *tile = NULL;
+
+  for (short *end = buffer + size; buffer != end; ++buffer, x += dx, y += dy) {
+    const unsigned lx = (unsigned)(int)(x >> 16);
+    const unsigned ly = (unsigned)(int)(y >> 16);
+
+    if ((lx >= overview_width_fine) || (ly >= overview_height_fine)) {
+      // outside overall bounds
+      *buffer = RasterBuffer::TERRAIN_INVALID;
+      continue;
+    }
+
+    const unsigned px = lx >> 8, py = ly >> 8;
+    if (tile == NULL || !tile->IsInside(px, py))
+      tile = FindTile(px, py);
+
+    short h = RasterBuffer::TERRAIN_INVALID;
+    if (tile != NULL)
+      h = interpolate
+        ? tile->GetFieldInterpolated(px, py, lx & 0xff, ly & 0xff)
+        : tile->GetField(px, py);
+
+    if (RasterBuffer::is_invalid(h))
+      // not found, so go to overview
+      h = Overview.get_interpolated(lx / RTC_SUBSAMPLING,
+                                    ly / RTC_SUBSAMPLING);
+
+    *buffer = h;
+  }
+}
+
+int
+RasterTileCache::FirstIntersection(int ax, int ay, int a_alt,
+                                   int bx, int by, int b_alt,
+                                   short &h_r) const
+{
+  IntersectionLine line;
+  line.ax = ax;
+  line.ay = ay;
+  line.a_alt = a_alt;
+  line.dx = (int64_t)bx - ax;
+  line.dy = (int64_t)by - ay;
+  line.d_alt = (int64_t)b_alt - a_alt;
+
+  return FirstIntersection(line, 0, 1 << 16, h_r);
+}
+
+int
+RasterTileCache::FirstIntersection(const IntersectionLine &line,
+                                   int t0, int t1, short &h_r) const
+{
+  if (!pyramid.defined())
+    return ScanIntersection(line, t0, t1, h_r);
+
+  /* the level 0 cells around this part of the line */
+  const int x0 = line.X(t0) >> 8, y0 = line.Y(t0) >> 8;
+  const int x1 = line.X(t1) >> 8, y1 = line.Y(t1) >> 8;
+  const int cx0 = min(x0, x1) / (int)RTC_SUBSAMPLING;
+  const int cy0 = min(y0, y1) / (int)RTC_SUBSAMPLING;
+  const int cx1 = max(x0, x1) / (int)RTC_SUBSAMPLING;
+  const int cy1 = max(y0, y1) / (int)RTC_SUBSAMPLING;
+
+  /* the lowest level where they fit into 2x2 cells */
+  unsigned level = 0;
+  while (level + 1 < pyramid.GetNumLevels() &&
+         ((cx1 >> level) - (cx0 >> level) > 1 ||
+          (cy1 >> level) - (cy0 >> level) > 1))
+    ++level;
+
+  const int altitude = min(line.Altitude(t0), line.Altitude(t1));
+  if (altitude > pyramid.GetMax(level, cx0 >> level, cy0 >> level,
+                                cx1 >> level, cy1 >> level))
+    /* clear of the terrain */
+    return -1;
+
+  if (level == 0 || t1 - t0 < 2)
+    return ScanIntersection(line, t0, t1, h_r);
+
+  const int middle = (t0 + t1) / 2;
+  const int t = FirstIntersection(line, t0, middle, h_r);
+  return t >= 0 ? t : FirstIntersection(line, middle, t1, h_r);
+}
+
+int
+RasterTileCache::ScanIntersection(const IntersectionLine &line,
+                                  int t0, int t1, short &h_r) const
+{
+  static const unsigned MAX_SAMPLES = 64;
+
+  const int x0 = line.X(t0), y0 = line.Y(t0);
+  const int x1 = line.X(t1), y1 = line.Y(t1);
+
+  /* about one sample per raster pixel; the end is sampled, too, so
+     the first sample of the next part can't be the first hit, which
+     would leave nothing to interpolate with */
+  const unsigned size =
+    min((unsigned)max(abs(x1 - x0), abs(y1 - y0)) / 256 + 1, MAX_SAMPLES);
+
+  short heights[MAX_SAMPLES + 1];
+  ScanLine(x0, y0, x1 + (x1 - x0) / (int)size, y1 + (y1 - y0) / (int)size,
+           heights, size + 1, false);
+
+  int last_t = t0, last_dh = 0;
+  for (unsigned i = 0; i <= size; ++i) {
+    const int t = t0 + (int)((int64_t)(t1 - t0) * i / size);
+    const short h = max(heights[i], (short)0);
+    const int dh = line.Altitude(t) - h;
+
+    if (dh <= 0) {
+      h_r = h;
+
+      if (i == 0)
+        return t;
+
+      /* interpolate between this sample and the previous one */
+      return last_t + (int)((int64_t)(t - last_t) * last_dh / (last_dh - dh));
+    }
+
+    last_t = t;
+    last_dh = dh;
+  }
+
+  return -1;
+}
+
 void
 RasterTileCache::SetSize(unsigned _width, unsigned _height)
 {
+  if (!scan_overview)
+    /* libjasper reports the size again on each decoder run */
+    return;
+
   width = _width;
   height = _height;
 
@@ -271,6 +546,8 @@ void
 RasterTileCache::SetLatLonBounds(double _lon_min, double _lon_max,
                                  double _lat_min, double _lat_max)
 {
+  if (!scan_overview)
+    return;
 
   bounds.west = Angle::degrees(fixed(min(_lon_min, _lon_max)));
   bounds.east = Angle::degrees(fixed(max(_lon_min, _lon_max)));
@@ -288,11 +565,23 @@ RasterTileCache::Reset()
   scan_overview = true;
 
   Overview.reset();
+  pyramid.Reset();
 
   for (unsigned i = 0; i < MAX_RTC_TILES; i++)
-    tiles[i].Disable();
+    tiles[i].SetCachedData(NULL);
 
   ActiveTiles.clear();
+
+  delete tile_mapping;
+  tile_mapping = NULL;
+}
+
+RasterTileCache::~RasterTileCache()
+{
+  for (unsigned i = 0; i < MAX_RTC_TILES; i++)
+    tiles[i].SetCachedData(NULL);
+
+  delete tile_mapping;
 }
 
 gcc_pure
@@ -352,23 +641,32 @@ RasterTileCache::MarkerSegment(long file_offset, unsigned id)
 
 extern RasterTileCache *raster_tile_current;
 
-void
+/**
+ * Protects #raster_tile_current: terrain and weather maps may be
+ * decoded by different threads.
+ */
+static Mutex jasper_mutex;
+
+bool
 RasterTileCache::LoadJPG2000(const char *jp2_filename)
 {
   jas_stream_t *in;
 
+  ScopeLock protect(jasper_mutex);
   raster_tile_current = this;
 
   in = jas_stream_fopen(jp2_filename, "rb");
   if (!in) {
-    Reset();
-    return;
+    if (scan_overview)
+      Reset();
+    return false;
   }
 
   ProgressGlue::SetRange(jas_stream_length(in) / 65536);
 
   jp2_decode(in, scan_overview ? "xcsoar=2" : "xcsoar=1");
   jas_stream_close(in);
+  return true;
 }
 
 bool
@@ -447,19 +745,63 @@ RasterTileCache::LoadOverview(const char *path, const TCHAR *world_file)
 
   if (!initialised)
     Reset();
+  else
+    BuildPyramid();
 
   return initialised;
 }
 
+void
+RasterTileCache::BuildPyramid()
+{
+  pyramid.Build(Overview,
+                (width + RTC_SUBSAMPLING - 1) / RTC_SUBSAMPLING,
+                (height + RTC_SUBSAMPLING - 1) / RTC_SUBSAMPLING);
+}
+
+void
+RasterTileCache::MergeMaxima()
+{
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i) {
+    if (tiles[i].NeedsMaxima()) {
+      tiles[i].CalculateMaxima(RTC_SUBSAMPLING);
+      tiles[i].MergeMaxima(pyramid, RTC_SUBSAMPLING);
+    }
+  }
+}
+
 void
 RasterTileCache::UpdateTiles(const char *path, int x, int y)
 {
   if (PollTiles(x, y)) {
-    LoadJPG2000(path);
+    LoadTiles(path);
     PollTiles(x, y);
   }
 }
 
+void
+RasterTileCache::LoadTiles(const char *path)
+{
+  if (tile_mapping != NULL)
+    LoadCachedTiles();
+  else
+    LoadJPG2000(path);
+
+  /* do the expensive part of MergeMaxima() here, outside of the
+     exclusive lock */
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i)
+    if (tiles[i].is_requested() && tiles[i].NeedsMaxima())
+      tiles[i].CalculateMaxima(RTC_SUBSAMPLING);
+}
+
+void
+RasterTileCache::LoadCachedTiles()
+{
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i)
+    if (tiles[i].is_requested())
+      TileRequest(i);
+}
+
 bool
 RasterTileCache::SaveCache(FILE *file) const
 {
@@ -551,5 +893,203 @@ RasterTileCache::LoadCache(FILE *file)
 
   initialised = true;
   scan_overview = false;
+  BuildPyramid();
+  return true;
+}
+
+static unsigned
+AlignTileOffset(unsigned offset, unsigned alignment)
+{
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+static bool
+WritePadding(FILE *file, unsigned size)
+{
+  static const char zero[256] = { 0 };
+
+  while (size > 0) {
+    unsigned n = min(size, (unsigned)sizeof(zero));
+    if (fwrite(zero, 1, n, file) != n)
+      return false;
+    size -= n;
+  }
+
+  return true;
+}
+
+bool
+RasterTileCache::BeginTileCache(FILE *file)
+{
+  if (!initialised || tile_mapping != NULL)
+    return false;
+
+  long base = ftell(file);
+  if (base < 0)
+    return false;
+
+  TileCacheHeader header;
+  header.version = TileCacheHeader::VERSION;
+  header.width = width;
+  header.height = height;
+  header.num_tiles = 0;
+
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i)
+    if (tiles[i].defined())
+      ++header.num_tiles;
+
+  if (header.num_tiles == 0)
+    return false;
+
+  /* lay out the file, and refuse if it gets too large */
+  const unsigned first_offset =
+    AlignTileOffset(base + sizeof(header) +
+                    header.num_tiles * sizeof(TileCacheEntry),
+                    TILE_CACHE_ALIGNMENT);
+
+  size_t end = first_offset;
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i) {
+    if (!tiles[i].defined())
+      continue;
+
+    end += tiles[i].GetWidth() * tiles[i].GetHeight() * sizeof(short);
+    end = AlignTileOffset(end, TILE_CACHE_ALIGNMENT);
+    if (end > MAX_TILE_CACHE_SIZE)
+      return false;
+  }
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1)
+    return false;
+
+  unsigned offset = first_offset;
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i) {
+    if (!tiles[i].defined())
+      continue;
+
+    TileCacheEntry entry;
+    entry.index = i;
+    entry.width = tiles[i].GetWidth();
+    entry.height = tiles[i].GetHeight();
+    entry.offset = offset;
+    if (fwrite(&entry, sizeof(entry), 1, file) != 1)
+      return false;
+
+    offset = AlignTileOffset(offset + entry.width * entry.height *
+                             sizeof(short), TILE_CACHE_ALIGNMENT);
+  }
+
+  tile_cache_next = 0;
+  tile_cache_position = base + sizeof(header) +
+    header.num_tiles * sizeof(TileCacheEntry);
+  return true;
+}
+
+bool
+RasterTileCache::SaveNextTiles(const char *path, FILE *file)
+{
+  if (!initialised || tile_mapping != NULL)
+    return false;
+
+  /* the tiles are written in index order; select the ones up to the
+     end of the batch, and request the ones which are not loaded */
+  unsigned end = tile_cache_next, num_decode = 0;
+  for (; end < MAX_RTC_TILES; ++end) {
+    RasterTile &tile = tiles[end];
+    if (!tile.defined() || tile.IsEnabled())
+      continue;
+
+    if (num_decode == TILE_CACHE_BATCH)
+      break;
+
+    tile.set_requested(true);
+    ++num_decode;
+  }
+
+  if (num_decode > 0) {
+    /* the batch is decoded on top of the active tiles, and is
+       unloaded right after it has been written */
+    extra_tiles = num_decode;
+    LoadJPG2000(path);
+    extra_tiles = 0;
+  }
+
+  bool success = true;
+  for (unsigned i = tile_cache_next; i < end; ++i) {
+    RasterTile &tile = tiles[i];
+    if (!tile.defined())
+      continue;
+
+    if (success && tile.IsEnabled()) {
+      const unsigned aligned = AlignTileOffset(tile_cache_position,
+                                               TILE_CACHE_ALIGNMENT);
+      const unsigned size = tile.GetWidth() * tile.GetHeight();
+      success = WritePadding(file, aligned - tile_cache_position) &&
+        fwrite(tile.GetImageBuffer(), sizeof(short), size, file) == size;
+      tile_cache_position = aligned + size * sizeof(short);
+    } else
+      success = false;
+
+    if (tile.is_requested()) {
+      /* decoded for the tile cache only, not in the active list */
+      tile.set_requested(false);
+      tile.Disable();
+    }
+  }
+
+  tile_cache_next = end;
+  return success;
+}
+
+bool
+RasterTileCache::LoadTileCache(FileMapping *mapping, size_t offset)
+{
+  if (!initialised || offset % sizeof(unsigned) != 0 ||
+      mapping->size() < offset + sizeof(TileCacheHeader))
+    return false;
+
+  const TileCacheHeader &header =
+    *(const TileCacheHeader *)mapping->at(offset);
+  if (header.version != TileCacheHeader::VERSION ||
+      header.width != width || header.height != height ||
+      header.num_tiles == 0 || header.num_tiles > MAX_RTC_TILES ||
+      mapping->size() < offset + sizeof(header) +
+      header.num_tiles * sizeof(TileCacheEntry))
+    return false;
+
+  unsigned num_defined = 0;
+  for (unsigned i = 0; i < MAX_RTC_TILES; ++i)
+    if (tiles[i].defined())
+      ++num_defined;
+
+  if (header.num_tiles != num_defined)
+    return false;
+
+  const TileCacheEntry *entries = (const TileCacheEntry *)(&header + 1);
+  for (unsigned i = 0; i < header.num_tiles; ++i) {
+    const TileCacheEntry &entry = entries[i];
+    if (entry.index >= MAX_RTC_TILES ||
+        (i > 0 && entry.index <= entries[i - 1].index))
+      return false;
+
+    const RasterTile &tile = tiles[entry.index];
+    if (entry.width != tile.GetWidth() || entry.height != tile.GetHeight() ||
+        entry.offset % TILE_CACHE_ALIGNMENT != 0 ||
+        entry.offset > mapping->size() ||
+        mapping->size() - entry.offset <
+        (size_t)entry.width * entry.height * sizeof(short))
+      return false;
+  }
+
+  /* the file is good; point the tiles at it */
+  for (unsigned i = 0; i < header.num_tiles; ++i) {
+    RasterTile &tile = tiles[entries[i].index];
+    const bool enabled = tile.IsEnabled();
+    tile.SetCachedData((const short *)mapping->at(entries[i].offset));
+    if (enabled)
+      tile.Enable();
+  }
+
+  delete tile_mapping;
+  tile_mapping = mapping;
   return true;
 }
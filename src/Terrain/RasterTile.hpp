@@ -2,6 +2,7 @@
 #define XCSOAR_RASTERTILE_HPP
 
 #include "Terrain/RasterBuffer.hpp"
+#include "Terrain/RasterPyramid.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "Util/NonCopyable.hpp"
 #include "Util/ActiveList.hpp"
@@ -10,6 +11,9 @@
 #include <tchar.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdint.h>
+
+class FileMapping;
 
 class RasterTile : private NonCopyable {
   struct MetaData {
@@ -20,12 +24,32 @@ class RasterTile : private NonCopyable {
   unsigned int width, height;
   bool request;
 
+  /**
+   * Pre-decoded heights of this tile inside the tile cache file, or
+   * NULL if the tile has to be decoded by libjasper.
+   */
+  const short *cached_data;
+
   RasterBuffer buffer;
 
+  /**
+   * The maximum height of each block of this tile, calculated by
+   * CalculateMaxima() until they have been merged into the
+   * #RasterPyramid.
+   */
+  RasterBuffer maxima;
+
+  /**
+   * Have the maxima of this tile been merged into the
+   * #RasterPyramid?  This is only done once per tile layout.
+   */
+  bool maxima_merged;
+
 public:
   RasterTile()
     :xstart(0), ystart(0), xend(0), yend(0),
-     width(0), height(0) {}
+     width(0), height(0), request(false), cached_data(NULL),
+     maxima_merged(false) {}
   ~RasterTile() {
     Disable();
   }
@@ -38,20 +62,63 @@ public:
     yend = _yend;
     width = xend - xstart;
     height = yend - ystart;
+    maxima.reset();
+    maxima_merged = false;
   }
 
   bool defined() const {
     return width > 0 && height > 0;
   }
 
+  unsigned GetWidth() const {
+    return width;
+  }
+
+  unsigned GetHeight() const {
+    return height;
+  }
+
   bool is_requested() const {
     return request;
   }
 
+  void set_requested(bool _request) {
+    request = _request;
+  }
+
+  /**
+   * Use pre-decoded heights from the tile cache file for this tile.
+   * Enable() will then point the buffer at them instead of waiting
+   * for libjasper to fill it.
+   */
+  void SetCachedData(const short *data) {
+    Disable();
+    cached_data = data;
+  }
+
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
-  bool CheckTileVisibility(const int view_x, const int view_y);
+  /**
+   * Is this tile needed for a view centred at the specified raster
+   * pixel?
+   */
+  gcc_pure
+  bool IsVisible(int view_x, int view_y) const;
+
+  /**
+   * Is this tile so far away from the specified view centre that it
+   * should be unloaded?
+   */
+  gcc_pure
+  bool IsFar(int view_x, int view_y) const;
+
+  /**
+   * Is the specified raster pixel inside this tile, or within half a
+   * tile of it?  Used to select tiles for prefetch locations.
+   */
+  gcc_pure
+  bool IsNear(int x, int y) const;
 
   void Disable() {
     buffer.reset();
@@ -65,6 +132,15 @@ public:
     return !buffer.defined();
   }
 
+  /**
+   * Is the specified raster pixel inside this tile, and is the tile
+   * loaded?
+   */
+  gcc_pure
+  bool IsInside(unsigned x, unsigned y) const {
+    return IsEnabled() && x - xstart < width && y - ystart < height;
+  }
+
   gcc_pure
   short GetField(unsigned x, unsigned y) const;
 
@@ -76,15 +152,46 @@ public:
     return buffer.get_data();
   }
 
-  bool VisibilityChanged(int view_x, int view_y);
+  bool NeedsMaxima() const {
+    return IsEnabled() && !maxima_merged;
+  }
+
+  /**
+   * Calculate the maximum height of each block of the specified size
+   * (in raster pixels, aligned to the raster, not to the tile).  The
+   * tile must be loaded.
+   */
+  void CalculateMaxima(unsigned block);
+
+  /**
+   * Raise the pyramid with the maxima calculated by
+   * CalculateMaxima(), and free them.
+   */
+  void MergeMaxima(RasterPyramid &pyramid, unsigned block);
 };
 
-#define MAX_ACTIVE_TILES 16
+#define MAX_ACTIVE_TILES 32
 
 class RasterTileCache : private NonCopyable {
   static const unsigned MAX_RTC_TILES = 4096;
   static const unsigned RTC_SUBSAMPLING = 16;
 
+  /**
+   * Tiles in the tile cache file start at a multiple of this, so
+   * each one begins on a page boundary of the mapping.
+   */
+  static const unsigned TILE_CACHE_ALIGNMENT = 4096;
+
+  /**
+   * Don't create tile cache files larger than this.
+   */
+  static const size_t MAX_TILE_CACHE_SIZE = 256 * 1024 * 1024;
+
+  /**
+   * The maximum number of tiles decoded by one SaveNextTiles() call.
+   */
+  static const unsigned TILE_CACHE_BATCH = 4;
+
   struct MarkerSegmentInfo {
     MarkerSegmentInfo() {}
     MarkerSegmentInfo(long _file_offset, int _tile=-1)
@@ -108,19 +215,71 @@ class RasterTileCache : private NonCopyable {
     GeoBounds bounds;
   };
 
+  /**
+   * The tile cache file starts with this header, followed by one
+   * #TileCacheEntry per defined tile (sorted by index), followed by
+   * the decoded tiles in native byte order.
+   */
+  struct TileCacheHeader {
+    enum { VERSION = 0x1 };
+    unsigned version, width, height, num_tiles;
+  };
+
+  struct TileCacheEntry {
+    unsigned index, width, height;
+
+    /**
+     * The position of the heights within the file, a multiple of
+     * #TILE_CACHE_ALIGNMENT.
+     */
+    unsigned offset;
+  };
+
   StaticArray<MarkerSegmentInfo, 8192> segments;
 
+  /**
+   * The mapped tile cache file, or NULL if tiles are decoded by
+   * libjasper.
+   */
+  FileMapping *tile_mapping;
+
+  /**
+   * The next tile to be written by SaveNextTiles(), and the position
+   * of the tile cache file.
+   */
+  unsigned tile_cache_next, tile_cache_position;
+
+  /**
+   * The number of tiles TileRequest() may enable beyond
+   * #MAX_ACTIVE_TILES while SaveNextTiles() decodes.
+   */
+  unsigned extra_tiles;
+
 public:
   RasterTileCache()
-    :scan_overview(true) {
+    :tile_mapping(NULL), tile_cache_next(MAX_RTC_TILES),
+     tile_cache_position(0), extra_tiles(0), scan_overview(true) {
     Reset();
   }
 
+  ~RasterTileCache();
+
 private:
   bool initialised;
   RasterTile tiles[MAX_RTC_TILES];
-  mutable ActiveList<const RasterTile, MAX_ACTIVE_TILES> ActiveTiles;
+  /**
+   * The loaded tiles, most important first.  Only PollTiles() may
+   * modify this list: readers share the terrain lease.
+   */
+  ActiveList<const RasterTile, MAX_ACTIVE_TILES> ActiveTiles;
   RasterBuffer Overview;
+
+  /**
+   * Height maxima for FirstIntersection(), built from the overview
+   * and raised whenever a tile is loaded.
+   */
+  RasterPyramid pyramid;
+
   bool scan_overview;
   unsigned int width, height;
   GeoBounds bounds;
@@ -133,8 +292,96 @@ public:
   short GetFieldInterpolated(unsigned int lx,
                              unsigned int ly) const;
 
+  /**
+   * Sample the heights along a straight line.  The coordinates are
+   * in 1/256 raster pixels, as used by GetField().  The line is
+   * stepped in fixed point, and the tile is only looked up when a
+   * sample leaves the tile of the previous one.
+   *
+   * @param ax, ay Start of the line (first sample)
+   * @param bx, by End of the line (not sampled)
+   * @param buffer Receives the heights
+   * @param size Number of samples
+   * @param interpolate True enables interpolation of sub-pixel values
+   */
+  void ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
+                short *buffer, unsigned size, bool interpolate) const;
+
+  /**
+   * Find the first location on a straight line where the terrain (as
+   * returned by GetField(), with water and invalid heights counting
+   * as zero) reaches the line.  The altitude of the line changes
+   * linearly from start to end.  Areas where the line passes above
+   * the #RasterPyramid maxima are skipped without sampling.
+   *
+   * @param ax, ay Start of the line in 1/256 raster pixels; the
+   * terrain must be below it
+   * @param bx, by End of the line
+   * @param a_alt, b_alt The altitude of the line at the start and at
+   * the end
+   * @param h_r Receives the terrain height at the intersection
+   * @return The location of the intersection in 1/65536 of the
+   * line, or -1 if the line doesn't touch the terrain
+   */
+  int FirstIntersection(int ax, int ay, int a_alt,
+                        int bx, int by, int b_alt, short &h_r) const;
+
+private:
+  /**
+   * A straight line with a linearly changing altitude, parametrised
+   * in 1/65536 of its length.
+   */
+  struct IntersectionLine {
+    int ax, ay, a_alt;
+    int64_t dx, dy, d_alt;
+
+    int X(int t) const {
+      return ax + (int)((dx * t) >> 16);
+    }
+
+    int Y(int t) const {
+      return ay + (int)((dy * t) >> 16);
+    }
+
+    int Altitude(int t) const {
+      return a_alt + (int)((d_alt * t) >> 16);
+    }
+  };
+
+  int FirstIntersection(const IntersectionLine &line, int t0, int t1,
+                        short &h_r) const;
+
+  /**
+   * Sample a part of the line pixel by pixel.
+   */
+  int ScanIntersection(const IntersectionLine &line, int t0, int t1,
+                       short &h_r) const;
+
+  /**
+   * Build the pyramid after the overview has been loaded.
+   */
+  void BuildPyramid();
+
+  /**
+   * Merge the maxima of newly loaded tiles into the pyramid.
+   */
+  void MergeMaxima();
+
+  /**
+   * Find the loaded tile containing the specified raster pixel.
+   *
+   * @return The tile, or NULL if the overview must be used
+   */
+  gcc_pure
+  const RasterTile *FindTile(unsigned px, unsigned py) const;
+
 protected:
-  void LoadJPG2000(const char *path);
+  /**
+   * Run libjasper on the file.  While scanning the overview, this
+   * loads the overview and the tile layout; after that it decodes
+   * the requested tiles.
+   */
+  bool LoadJPG2000(const char *path);
 
   /**
    * Load a world file (*.tfw or *.j2w).
@@ -147,6 +394,84 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+  /**
+   * Start writing a tile cache file: write the header and the tile
+   * index.  The tiles are then written by SaveNextTiles().
+   *
+   * @param file the tile cache file, positioned after the FileCache
+   * header
+   * @return false on error, or if the file would be too large
+   */
+  bool BeginTileCache(FILE *file);
+
+  /**
+   * Write the next few tiles to the tile cache file.  Tiles which are
+   * loaded already are copied, up to #TILE_CACHE_BATCH others are
+   * decoded with libjasper.  Those don't become active, so the
+   * caller needs only a shared lock, but it must be the thread which
+   * loads tiles.
+   *
+   * @param path the JPEG2000 file
+   * @return false on error
+   */
+  bool SaveNextTiles(const char *path, FILE *file);
+
+  /**
+   * Have all tiles been written by SaveNextTiles()?
+   */
+  bool IsTileCacheComplete() const {
+    return tile_cache_next >= MAX_RTC_TILES;
+  }
+
+  /**
+   * Use the mapped tile cache file from now on; tiles are then
+   * enabled without decoding.  Loaded tiles are switched over to the
+   * mapping, which requires an exclusive lock.  On success, this
+   * object takes over the mapping.
+   *
+   * @param offset the position of the tile cache header within the
+   * mapping
+   */
+  bool LoadTileCache(FileMapping *mapping, size_t offset);
+
+  /**
+   * A location in raster pixels.
+   */
+  struct Point {
+    int x, y;
+  };
+
+  /**
+   * Select the tiles to be loaded: first the ones visible around the
+   * view centre, then the ones near each prefetch location, in order,
+   * as long as there are free slots.  Loaded tiles which are not
+   * needed anymore are unloaded, and the list of active tiles is
+   * rebuilt from the loaded ones.
+   *
+   * This must not run concurrently with any other access to this
+   * object.
+   *
+   * @return true if tiles have been requested, i.e. LoadTiles() has
+   * work to do
+   */
+  bool PollTiles(int x, int y,
+                 const Point *prefetch = NULL, unsigned num_prefetch = 0);
+
+  /**
+   * Load the tiles requested by PollTiles(), from the tile cache file
+   * if there is one, or else with libjasper.  The new tiles become
+   * visible to readers only after the next PollTiles() call.
+   *
+   * This only touches tiles which are not active, so it may run
+   * concurrently with GetField() and friends, but not with another
+   * PollTiles() or LoadTiles() call.
+   */
+  void LoadTiles(const char *path);
+
+  /**
+   * Synchronously load the tiles for a view centred at the specified
+   * raster pixel.
+   */
   void UpdateTiles(const char *path, int x, int y);
 
   bool GetInitialised() const {
@@ -187,7 +512,10 @@ public:
   }
 
 protected:
-  bool PollTiles(int x, int y);
+  /**
+   * Enable the requested tiles from the tile cache file.
+   */
+  void LoadCachedTiles();
 
 public:
   short GetMaxElevation() const {
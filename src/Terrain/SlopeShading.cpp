@@ -0,0 +1,400 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/SlopeShading.hpp"
+#include "Terrain/RasterBuffer.hpp"
+#include "Math/FastMath.h"
+#include "Math/fixed.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SLOPE_SHADING_NEON
+#endif
+
+inline signed char
+SlopeShading::Shade(int p22, int p32, int column_span, int row_span) const
+{
+  const int dd0 = p22 * row_span;
+  const int dd1 = column_span * p32;
+  const int dd2 = column_span * row_span * height_slope_factor;
+  const int mag = (dd0 * dd0 + dd1 * dd1 + dd2 * dd2);
+  const int num = (dd2 * sz + dd0 * sx + dd1 * sy);
+#ifdef FIXED_MATH
+  const int sval = num / (int)isqrt4(mag);
+#else
+  const int sval = num / (int)sqrt((fixed)mag);
+#endif
+  int sindex = (sval - sz) * contrast / 128;
+  if (gcc_unlikely(sindex < -64))
+    sindex = -64;
+  if (gcc_unlikely(sindex > 63))
+    sindex = 63;
+  return (signed char)sindex;
+}
+
+void
+SlopeShading::ShadeBorders(const short *row, const short *above,
+                           const short *below,
+                           unsigned width, unsigned step, unsigned row_span,
+                           signed char *dest) const
+{
+  /* near the left and right borders, the nearest column inside the
+     matrix is used as neighbour */
+  const unsigned left = std::min(step, width);
+  const unsigned right = width > step ? std::max(width - step, left) : left;
+
+  for (unsigned x = 0; x < width; ++x) {
+    if (x == left)
+      x = right;
+    if (x >= width)
+      break;
+
+    const unsigned column_plus_index = x + step < width
+      ? step : width - 1 - x;
+    const unsigned column_minus_index = x >= step ? step : x;
+
+    const short h = row[x];
+    const short h_above = above[x];
+    const short h_below = below[x];
+    const short h_left = row[x - column_minus_index];
+    const short h_right = row[x + column_plus_index];
+
+    if (RasterBuffer::is_special(h) ||
+        RasterBuffer::is_special(h_above) ||
+        RasterBuffer::is_special(h_below) ||
+        RasterBuffer::is_special(h_left) ||
+        RasterBuffer::is_special(h_right)) {
+      dest[x] = 0;
+      continue;
+    }
+
+    dest[x] = Shade(h_right - h_left, h_above - h_below,
+                    column_plus_index + column_minus_index, row_span);
+  }
+}
+
+void
+SlopeShading::ShadeInteriorScalar(const short *row, const short *above,
+                                  const short *below, unsigned width,
+                                  unsigned step, unsigned row_span,
+                                  signed char *dest) const
+{
+  const int column_span = 2 * step;
+
+  for (unsigned x = step; x + step < width; ++x) {
+    const short h = row[x];
+    const short h_above = above[x];
+    const short h_below = below[x];
+    const short h_left = row[x - step];
+    const short h_right = row[x + step];
+
+    if (gcc_unlikely(RasterBuffer::is_special(h) ||
+                     RasterBuffer::is_special(h_above) ||
+                     RasterBuffer::is_special(h_below) ||
+                     RasterBuffer::is_special(h_left) ||
+                     RasterBuffer::is_special(h_right))) {
+      dest[x] = 0;
+      continue;
+    }
+
+    dest[x] = Shade(h_right - h_left, h_above - h_below,
+                    column_span, row_span);
+  }
+}
+
+#if defined(__SSE2__)
+
+/**
+ * Calculate the shading index of four pixels from their height
+ * differences.
+ */
+static inline __m128i
+ShadeSSE2(__m128i p22, __m128i p32,
+          __m128 row_span, __m128 column_span, __m128 dd2_squared,
+          __m128 num0, __m128 sx, __m128 sy, __m128i sz, __m128 contrast)
+{
+  const __m128 dd0 = _mm_mul_ps(_mm_cvtepi32_ps(p22), row_span);
+  const __m128 dd1 = _mm_mul_ps(_mm_cvtepi32_ps(p32), column_span);
+  const __m128 mag = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dd0, dd0),
+                                           _mm_mul_ps(dd1, dd1)),
+                                dd2_squared);
+  const __m128 num = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dd0, sx),
+                                           _mm_mul_ps(dd1, sy)),
+                                num0);
+
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  /* reciprocal square root, refined by one Newton-Raphson step */
+  __m128 r = _mm_rsqrt_ps(mag);
+  r = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r),
+                 _mm_sub_ps(_mm_set1_ps(3.0f),
+                            _mm_mul_ps(_mm_mul_ps(mag, r), r)));
+
+  /* the reference divides by the truncated square root; correct the
+     estimate where it is off by one */
+  __m128 root = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(mag, r)));
+  const __m128 root_plus = _mm_add_ps(root, one);
+  root = _mm_add_ps(root, _mm_and_ps(_mm_cmple_ps(_mm_mul_ps(root_plus,
+                                                             root_plus),
+                                                  mag), one));
+  root = _mm_sub_ps(root, _mm_and_ps(_mm_cmpgt_ps(_mm_mul_ps(root, root),
+                                                  mag), one));
+
+  /* divide with a refined reciprocal, and correct the truncated
+     quotient where it is off by one (e.g. for exact quotients) */
+  __m128 inverse = _mm_rcp_ps(root);
+  inverse = _mm_mul_ps(inverse,
+                       _mm_sub_ps(_mm_set1_ps(2.0f),
+                                  _mm_mul_ps(root, inverse)));
+
+  const __m128 sign = _mm_and_ps(num, _mm_set1_ps(-0.0f));
+  const __m128 dividend = _mm_xor_ps(num, sign);
+  __m128 quotient =
+    _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(dividend, inverse)));
+  const __m128 remainder = _mm_sub_ps(dividend, _mm_mul_ps(quotient, root));
+  quotient = _mm_add_ps(quotient,
+                        _mm_and_ps(_mm_cmpge_ps(remainder, root), one));
+  quotient = _mm_sub_ps(quotient,
+                        _mm_and_ps(_mm_cmplt_ps(remainder,
+                                                _mm_setzero_ps()), one));
+
+  const __m128i sval = _mm_cvttps_epi32(_mm_xor_ps(quotient, sign));
+  return _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(sval, sz)),
+                                     contrast));
+}
+
+/**
+ * Sign-extend the lower four 16 bit values to 32 bit.
+ */
+static inline __m128i
+WidenLowSSE2(__m128i x)
+{
+  return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+/**
+ * Sign-extend the upper four 16 bit values to 32 bit.
+ */
+static inline __m128i
+WidenHighSSE2(__m128i x)
+{
+  return _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
+
+#elif defined(SLOPE_SHADING_NEON)
+
+/**
+ * Calculate the shading index of four pixels from their height
+ * differences.
+ */
+static inline int32x4_t
+ShadeNEON(int32x4_t p22, int32x4_t p32,
+          float32x4_t row_span, float32x4_t column_span,
+          float32x4_t dd2_squared, float32x4_t num0,
+          float32x4_t sx, float32x4_t sy, int32x4_t sz, float32x4_t contrast)
+{
+  const float32x4_t dd0 = vmulq_f32(vcvtq_f32_s32(p22), row_span);
+  const float32x4_t dd1 = vmulq_f32(vcvtq_f32_s32(p32), column_span);
+  const float32x4_t mag = vmlaq_f32(vmlaq_f32(dd2_squared, dd0, dd0),
+                                    dd1, dd1);
+  const float32x4_t num = vmlaq_f32(vmlaq_f32(num0, dd0, sx), dd1, sy);
+
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+
+  /* reciprocal square root estimate, refined by two Newton-Raphson
+     steps */
+  float32x4_t r = vrsqrteq_f32(mag);
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(mag, r), r));
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(mag, r), r));
+
+  /* the reference divides by the truncated square root; correct the
+     estimate where it is off by one */
+  float32x4_t root = vcvtq_f32_s32(vcvtq_s32_f32(vmulq_f32(mag, r)));
+  const float32x4_t root_plus = vaddq_f32(root, one);
+  root = vbslq_f32(vcleq_f32(vmulq_f32(root_plus, root_plus), mag),
+                   root_plus, root);
+  root = vbslq_f32(vcgtq_f32(vmulq_f32(root, root), mag),
+                   vsubq_f32(root, one), root);
+
+  /* divide with a refined reciprocal, and correct the truncated
+     quotient where it is off by one (e.g. for exact quotients) */
+  float32x4_t inverse = vrecpeq_f32(root);
+  inverse = vmulq_f32(inverse, vrecpsq_f32(root, inverse));
+  inverse = vmulq_f32(inverse, vrecpsq_f32(root, inverse));
+
+  const uint32x4_t negative = vcltq_f32(num, zero);
+  const float32x4_t dividend = vabsq_f32(num);
+  float32x4_t quotient =
+    vcvtq_f32_s32(vcvtq_s32_f32(vmulq_f32(dividend, inverse)));
+  const float32x4_t remainder = vmlsq_f32(dividend, quotient, root);
+  quotient = vbslq_f32(vcgeq_f32(remainder, root),
+                       vaddq_f32(quotient, one), quotient);
+  quotient = vbslq_f32(vcltq_f32(remainder, zero),
+                       vsubq_f32(quotient, one), quotient);
+
+  const int32x4_t sval =
+    vcvtq_s32_f32(vbslq_f32(negative, vnegq_f32(quotient), quotient));
+  return vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vsubq_s32(sval, sz)),
+                                 contrast));
+}
+
+#endif
+
+void
+SlopeShading::ShadeInteriorVector(const short *row, const short *above,
+                                  const short *below, unsigned width,
+                                  unsigned step, unsigned row_span,
+                                  signed char *dest) const
+{
+  unsigned x = step;
+
+#if defined(__SSE2__) || defined(SLOPE_SHADING_NEON)
+  const float column_span_f = 2 * step;
+  const float dd2 = column_span_f * row_span * height_slope_factor;
+#endif
+
+#if defined(__SSE2__)
+  const __m128 v_row_span = _mm_set1_ps((float)row_span);
+  const __m128 v_column_span = _mm_set1_ps(column_span_f);
+  const __m128 v_dd2_squared = _mm_set1_ps(dd2 * dd2);
+  const __m128 v_num0 = _mm_set1_ps(dd2 * sz);
+  const __m128 v_sx = _mm_set1_ps((float)sx);
+  const __m128 v_sy = _mm_set1_ps((float)sy);
+  const __m128i v_sz = _mm_set1_epi32(sz);
+  const __m128 v_contrast = _mm_set1_ps(contrast / 128.0f);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i min_index = _mm_set1_epi16(-64);
+  const __m128i max_index = _mm_set1_epi16(63);
+
+  for (; x + step + 8 <= width; x += 8) {
+    const __m128i h = _mm_loadu_si128((const __m128i *)(row + x));
+    const __m128i h_above = _mm_loadu_si128((const __m128i *)(above + x));
+    const __m128i h_below = _mm_loadu_si128((const __m128i *)(below + x));
+    const __m128i h_left = _mm_loadu_si128((const __m128i *)(row + x - step));
+    const __m128i h_right =
+      _mm_loadu_si128((const __m128i *)(row + x + step));
+
+    /* special values are <= 0, see RasterBuffer::is_special() */
+    const __m128i lowest =
+      _mm_min_epi16(_mm_min_epi16(_mm_min_epi16(h, h_above),
+                                  _mm_min_epi16(h_below, h_left)),
+                    h_right);
+    const __m128i valid = _mm_cmpgt_epi16(lowest, zero);
+
+    const __m128i p22 = _mm_sub_epi16(h_right, h_left);
+    const __m128i p32 = _mm_sub_epi16(h_above, h_below);
+
+    const __m128i low = ShadeSSE2(WidenLowSSE2(p22), WidenLowSSE2(p32),
+                                  v_row_span, v_column_span, v_dd2_squared,
+                                  v_num0, v_sx, v_sy, v_sz, v_contrast);
+    const __m128i high = ShadeSSE2(WidenHighSSE2(p22), WidenHighSSE2(p32),
+                                   v_row_span, v_column_span, v_dd2_squared,
+                                   v_num0, v_sx, v_sy, v_sz, v_contrast);
+
+    __m128i sindex = _mm_packs_epi32(low, high);
+    sindex = _mm_max_epi16(_mm_min_epi16(sindex, max_index), min_index);
+    sindex = _mm_and_si128(sindex, valid);
+
+    _mm_storel_epi64((__m128i *)(dest + x), _mm_packs_epi16(sindex, sindex));
+  }
+#elif defined(SLOPE_SHADING_NEON)
+  const float32x4_t v_row_span = vdupq_n_f32((float)row_span);
+  const float32x4_t v_column_span = vdupq_n_f32(column_span_f);
+  const float32x4_t v_dd2_squared = vdupq_n_f32(dd2 * dd2);
+  const float32x4_t v_num0 = vdupq_n_f32(dd2 * sz);
+  const float32x4_t v_sx = vdupq_n_f32((float)sx);
+  const float32x4_t v_sy = vdupq_n_f32((float)sy);
+  const int32x4_t v_sz = vdupq_n_s32(sz);
+  const float32x4_t v_contrast = vdupq_n_f32(contrast / 128.0f);
+  const int16x8_t zero = vdupq_n_s16(0);
+  const int16x8_t min_index = vdupq_n_s16(-64);
+  const int16x8_t max_index = vdupq_n_s16(63);
+
+  for (; x + step + 8 <= width; x += 8) {
+    const int16x8_t h = vld1q_s16(row + x);
+    const int16x8_t h_above = vld1q_s16(above + x);
+    const int16x8_t h_below = vld1q_s16(below + x);
+    const int16x8_t h_left = vld1q_s16(row + x - step);
+    const int16x8_t h_right = vld1q_s16(row + x + step);
+
+    /* special values are <= 0, see RasterBuffer::is_special() */
+    const int16x8_t lowest =
+      vminq_s16(vminq_s16(vminq_s16(h, h_above), vminq_s16(h_below, h_left)),
+                h_right);
+    const int16x8_t valid = vreinterpretq_s16_u16(vcgtq_s16(lowest, zero));
+
+    const int16x8_t p22 = vsubq_s16(h_right, h_left);
+    const int16x8_t p32 = vsubq_s16(h_above, h_below);
+
+    const int32x4_t low =
+      ShadeNEON(vmovl_s16(vget_low_s16(p22)), vmovl_s16(vget_low_s16(p32)),
+                v_row_span, v_column_span, v_dd2_squared,
+                v_num0, v_sx, v_sy, v_sz, v_contrast);
+    const int32x4_t high =
+      ShadeNEON(vmovl_s16(vget_high_s16(p22)), vmovl_s16(vget_high_s16(p32)),
+                v_row_span, v_column_span, v_dd2_squared,
+                v_num0, v_sx, v_sy, v_sz, v_contrast);
+
+    int16x8_t sindex = vcombine_s16(vqmovn_s32(low), vqmovn_s32(high));
+    sindex = vmaxq_s16(vminq_s16(sindex, max_index), min_index);
+    sindex = vandq_s16(sindex, valid);
+
+    vst1_s8(dest + x, vmovn_s16(sindex));
+  }
+#endif
+
+  /* the remaining pixels, which don't fill a vector */
+  const unsigned done = x - step;
+  ShadeInteriorScalar(row + done, above + done, below + done, width - done,
+                      step, row_span, dest + done);
+}
+
+void
+SlopeShading::ShadeRow(const short *row, const short *above,
+                       const short *below,
+                       unsigned width, unsigned step, unsigned row_span,
+                       signed char *dest) const
+{
+  assert(step > 0);
+
+  ShadeBorders(row, above, below, width, step, row_span, dest);
+  ShadeInteriorVector(row, above, below, width, step, row_span, dest);
+}
+
+void
+SlopeShading::ShadeRowScalar(const short *row, const short *above,
+                             const short *below,
+                             unsigned width, unsigned step, unsigned row_span,
+                             signed char *dest) const
+{
+  assert(step > 0);
+
+  ShadeBorders(row, above, below, width, step, row_span, dest);
+  ShadeInteriorScalar(row, above, below, width, step, row_span, dest);
+}
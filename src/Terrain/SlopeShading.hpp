@@ -0,0 +1,103 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+#define XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+
+#include "Compiler.h"
+
+/**
+ * Calculates the slope shading index of the pixels of a height
+ * matrix, i.e. the brightness of the terrain surface under the sun
+ * in the range -64 (shadow) to 63 (highlight).
+ *
+ * The rows are processed with a SIMD kernel (SSE2 or NEON) where
+ * available, which normalises with a reciprocal square root instead
+ * of an integer square root and a division.  Its results may differ
+ * from the scalar reference by one step in rare cases.
+ */
+class SlopeShading {
+  int sx, sy, sz;
+  int contrast;
+  int height_slope_factor;
+
+public:
+  /**
+   * @param _sx X component of the sun vector (scaled to 255)
+   * @param _sy Y component of the sun vector (scaled to 255)
+   * @param _sz Z component of the sun vector (scaled to 255)
+   * @param _contrast Contrast (128 is neutral)
+   * @param _height_slope_factor Horizontal size of a matrix cell in
+   * the unit of the height values
+   */
+  SlopeShading(int _sx, int _sy, int _sz, int _contrast,
+               int _height_slope_factor)
+    :sx(_sx), sy(_sy), sz(_sz), contrast(_contrast),
+     height_slope_factor(_height_slope_factor) {}
+
+  /**
+   * Calculate the shading index of one row.  Pixels for which the
+   * pixel itself or one of its neighbours is special (water or
+   * invalid) get index 0.
+   *
+   * @param row The row of the height matrix
+   * @param above The row step rows above (or the nearest row)
+   * @param below The row step rows below (or the nearest row)
+   * @param width Number of pixels in the row
+   * @param step Distance of the neighbours used for the slope
+   * @param row_span Distance between the rows above and below
+   * @param dest Receives one index per pixel
+   */
+  void ShadeRow(const short *row, const short *above, const short *below,
+                unsigned width, unsigned step, unsigned row_span,
+                signed char *dest) const;
+
+  /**
+   * Same as ShadeRow(), but always uses the scalar reference
+   * implementation.
+   */
+  void ShadeRowScalar(const short *row, const short *above,
+                      const short *below,
+                      unsigned width, unsigned step, unsigned row_span,
+                      signed char *dest) const;
+
+private:
+  gcc_pure
+  signed char Shade(int p22, int p32, int column_span, int row_span) const;
+
+  void ShadeBorders(const short *row, const short *above, const short *below,
+                    unsigned width, unsigned step, unsigned row_span,
+                    signed char *dest) const;
+
+  void ShadeInteriorScalar(const short *row, const short *above,
+                           const short *below, unsigned width,
+                           unsigned step, unsigned row_span,
+                           signed char *dest) const;
+
+  void ShadeInteriorVector(const short *row, const short *above,
+                           const short *below, unsigned width,
+                           unsigned step, unsigned row_span,
+                           signed char *dest) const;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/TerrainLoader.hpp"
+#include "Terrain/RasterTerrain.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+/**
+ * The maximum number of decoder runs per request.  A second run is
+ * needed when tiles had to be unloaded before the next ones fit.
+ */
+static const unsigned max_passes = 2;
+
+void
+TerrainLoader::Request(const GeoPoint &_center,
+                       const GeoPoint *_prefetch, unsigned _num_prefetch)
+{
+  assert(_num_prefetch <= RasterMap::MAX_PREFETCH);
+
+  mutex.Lock();
+  center = _center;
+  std::copy(_prefetch, _prefetch + _num_prefetch, prefetch);
+  num_prefetch = _num_prefetch;
+  pending = true;
+  mutex.Unlock();
+
+  trigger();
+}
+
+void
+TerrainLoader::tick()
+{
+  GeoPoint _center, _prefetch[RasterMap::MAX_PREFETCH];
+  unsigned _num_prefetch;
+
+  mutex.Lock();
+  const bool has_request = pending;
+  pending = false;
+  _center = center;
+  std::copy(prefetch, prefetch + num_prefetch, _prefetch);
+  _num_prefetch = num_prefetch;
+  mutex.Unlock();
+
+  bool missing = false;
+  if (has_request) {
+    missing = terrain.PollTiles(_center, _prefetch, _num_prefetch);
+    for (unsigned i = 0; missing && i < max_passes && !is_stopped(); ++i) {
+      terrain.LoadTiles();
+
+      /* publish the new tiles, and request the ones which did not fit */
+      missing = terrain.PollTiles(_center, _prefetch, _num_prefetch);
+    }
+  }
+
+  /* when idle, build the tile cache file a few tiles at a time; the
+     next request is served before the next batch */
+  if (!missing && !is_stopped() && terrain.SaveNextTiles())
+    trigger();
+}
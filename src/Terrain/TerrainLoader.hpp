@@ -0,0 +1,73 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_LOADER_HPP
+#define XCSOAR_TERRAIN_LOADER_HPP
+
+#include "Thread/WorkerThread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Navigation/GeoPoint.hpp"
+
+class RasterTerrain;
+
+/**
+ * Loads terrain tiles in background, so the threads which read the
+ * terrain never wait for the decoder.  Until a tile is loaded, its
+ * heights are taken from the overview.
+ *
+ * The most recent request wins: it names the view centre (whose
+ * tiles are loaded first) and a list of prefetch locations in order
+ * of decreasing priority, e.g. along the aircraft's track and the
+ * task route.
+ *
+ * While there is no request, the thread writes the tile cache file
+ * (if the terrain has none yet), a few tiles per run.
+ */
+class TerrainLoader : public WorkerThread {
+  RasterTerrain &terrain;
+
+  /** protects the request attributes below */
+  Mutex mutex;
+
+  bool pending;
+  GeoPoint center;
+  GeoPoint prefetch[RasterMap::MAX_PREFETCH];
+  unsigned num_prefetch;
+
+public:
+  TerrainLoader(RasterTerrain &_terrain)
+    :terrain(_terrain), pending(false), num_prefetch(0) {}
+
+  /**
+   * Replaces the current request and wakes up the thread.  Returns
+   * immediately.
+   */
+  void Request(const GeoPoint &_center,
+               const GeoPoint *_prefetch, unsigned _num_prefetch);
+
+protected:
+  virtual void tick();
+};
+
+#endif
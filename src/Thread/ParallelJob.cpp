@@ -0,0 +1,117 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/ParallelJob.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+/** never start more threads than this */
+static const unsigned MAX_THREADS = 16;
+
+unsigned
+ParallelJob::get_concurrency()
+{
+#ifdef HAVE_POSIX
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  long n = info.dwNumberOfProcessors;
+#endif
+
+  if (n < 1)
+    return 1;
+  if (n > (long)MAX_THREADS)
+    return MAX_THREADS;
+  return n;
+}
+
+/**
+ * The item counter shared by all threads of one execute() call.
+ */
+class ParallelJobQueue {
+  ParallelJob &job;
+  const unsigned n;
+
+  Mutex mutex;
+  unsigned next;
+
+public:
+  ParallelJobQueue(ParallelJob &_job, unsigned _n)
+    :job(_job), n(_n), next(0) {}
+
+  void run() {
+    while (true) {
+      mutex.Lock();
+      const unsigned i = next++;
+      mutex.Unlock();
+
+      if (i >= n)
+        break;
+
+      job.run_item(i);
+    }
+  }
+};
+
+class ParallelJobThread : public Thread {
+  ParallelJobQueue *queue;
+
+public:
+  void start(ParallelJobQueue &_queue) {
+    queue = &_queue;
+    Thread::start();
+  }
+
+protected:
+  virtual void run() {
+    queue->run();
+  }
+};
+
+void
+ParallelJob::execute(unsigned n)
+{
+  ParallelJobQueue queue(*this, n);
+
+  unsigned num_threads = get_concurrency();
+  if (num_threads > n)
+    num_threads = n;
+
+  /* the calling thread is one of the workers */
+  ParallelJobThread threads[MAX_THREADS - 1];
+  for (unsigned i = 0; i + 1 < num_threads; ++i)
+    threads[i].start(queue);
+
+  queue.run();
+
+  for (unsigned i = 0; i + 1 < num_threads; ++i)
+    if (threads[i].defined())
+      threads[i].join();
+}
@@ -0,0 +1,58 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_PARALLEL_JOB_HPP
+#define XCSOAR_THREAD_PARALLEL_JOB_HPP
+
+/**
+ * A batch of independent work items, which are distributed over one
+ * short-lived thread per processor.  Implement run_item() and call
+ * execute().
+ *
+ * On single-processor systems, or if no thread can be created, all
+ * items are processed by the calling thread.
+ */
+class ParallelJob {
+public:
+  virtual ~ParallelJob() {}
+
+  /**
+   * Process one item.  This is called concurrently from several
+   * threads, but exactly once for each item.
+   */
+  virtual void run_item(unsigned i) = 0;
+
+  /**
+   * Process the items 0..n-1 and return when all of them are done.
+   * Items are handed out in ascending order, but may finish in any
+   * order.
+   */
+  void execute(unsigned n);
+
+  /**
+   * Returns the number of threads execute() uses at most.
+   */
+  static unsigned get_concurrency();
+};
+
+#endif
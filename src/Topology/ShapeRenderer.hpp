@@ -30,6 +30,8 @@ Copyright_License {
 #include "Util/AllocatedArray.hpp"
 
 #ifdef ENABLE_OPENGL
+#include "Screen/OpenGL/Draw.hpp"
+
 class Canvas;
 class Brush;
 #else
@@ -107,13 +109,7 @@ public:
 
   void finish_polygon(Canvas &canvas) {
 #ifdef ENABLE_OPENGL
-    glVertexPointer(2, GL_VALUE, 0, &points[0].x);
-#ifdef ANDROID
-    // XXX
-    glDrawArrays(GL_TRIANGLES, 0, num_points / 3);
-#else
-    glDrawArrays(GL_POLYGON, 0, num_points);
-#endif
+    GLFillPolygon(points.begin(), num_points);
 #else
     if (mode != SOLID) {
       canvas.null_pen();
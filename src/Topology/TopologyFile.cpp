@@ -22,125 +22,207 @@ Copyright_License {
 */
 
 #include "Topology/TopologyFile.hpp"
-#include "Topology/XShape.hpp"
-#include "Screen/Util.hpp"
 #include "WindowProjection.hpp"
-#include "Screen/Graphics.hpp"
-#include "Screen/LabelBlock.hpp"
-#include "SettingsMap.hpp"
-#include "Navigation/GeoPoint.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
+#include "OS/PathName.hpp"
 #include "shapelib/map.h"
 
-#include <zzip/lib.h>
-
 #include <algorithm>
-#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <tchar.h>
 #include <ctype.h> // needed for Wine
 
-TopologyFile::TopologyFile(struct zzip_dir *_dir, const char *filename,
+/**
+ * Builds the name of the snapshot in the cache from the base name
+ * of the shapefile.
+ */
+static void
+MakeCacheName(TCHAR *buffer, size_t size, const char *shpname)
+{
+  const char *base = strrchr(shpname, '/');
+  if (base == NULL)
+    base = strrchr(shpname, '\\');
+  base = base != NULL ? base + 1 : shpname;
+
+  const size_t prefix_length = _tcslen(_T("topology-"));
+  _tcscpy(buffer, _T("topology-"));
+
+  TCHAR *p = buffer + prefix_length;
+  for (; *base != 0 && *base != '.' &&
+         p < buffer + size - 1; ++base, ++p)
+    *p = isalnum((unsigned char)*base) || *base == '-'
+      ? (TCHAR)*base : _T('_');
+  *p = 0;
+}
+
+TopologyFile::TopologyFile(struct zzip_dir *dir, const char *filename,
                            fixed _threshold,
                            const Color thecolor,
-                           int _label_field, int _icon)
-  :dir(_dir), label_field(_label_field), icon(_icon),
+                           int _label_field, int _icon,
+                           FileCache *cache, const char *original_path)
+  :mapping(NULL),
+   back(0), pending(1), front(2), fresh(false),
+   label_field(_label_field), icon(_icon),
    color(thecolor),
-   scaleThreshold(_threshold),
-  shapefileopen(false)
+   scaleThreshold(_threshold)
 {
-  if (msSHPOpenFile(&shpfile, "rb", dir, filename) == -1)
-    return;
-
-  shpCache.resize_discard(shpfile.numshapes);
+  cache_bounds.west = cache_bounds.east =
+    cache_bounds.south = cache_bounds.north = Angle::native(fixed_zero);
 
-  shapefileopen = true;
+  TCHAR cache_name[64];
+  if (cache != NULL && original_path != NULL) {
+    MakeCacheName(cache_name, sizeof(cache_name) / sizeof(cache_name[0]),
+                  filename);
+    load_snapshot(*cache, cache_name, PathName(original_path));
+  }
 
-  if (dir != NULL)
-    ++dir->refcount;
+  if (mapping == NULL) {
+    if (!build_snapshot(dir, filename))
+      return;
+
+    if (cache != NULL && original_path != NULL) {
+      FILE *file = cache->save(cache_name, PathName(original_path));
+      if (file != NULL) {
+        if (snapshot.save(file))
+          cache->commit(cache_name, file);
+        else
+          cache->cancel(cache_name, file);
+      }
+    }
+  }
 
-  cache_bounds.west = cache_bounds.east =
-    cache_bounds.south = cache_bounds.north = Angle::native(fixed_zero);
+  shapes.resize_discard(snapshot.size());
+  lines.resize_discard(snapshot.get_num_lines());
+  for (unsigned i = 0; i < snapshot.size(); ++i)
+    shapes[i].set(snapshot, i, lines.begin());
 
-  std::fill(shpCache.begin(), shpCache.end(), (XShape *)NULL);
+  for (unsigned i = 0; i < 3; ++i) {
+    shape_sets[i].resize_discard(snapshot.size());
+    std::fill(shape_sets[i].begin(), shape_sets[i].end(),
+              (const XShape *)NULL);
+  }
 }
 
 TopologyFile::~TopologyFile()
 {
-  if (!shapefileopen)
-    return;
-
-  ClearCache();
-  msSHPCloseFile(&shpfile);
+  delete mapping;
+}
 
-  if (dir != NULL) {
-    --dir->refcount;
-    zzip_dir_free(dir);
+bool
+TopologyFile::load_snapshot(FileCache &cache, const TCHAR *cache_name,
+                            const TCHAR *original_path)
+{
+  size_t offset;
+  mapping = cache.map(cache_name, original_path, offset);
+  if (mapping == NULL)
+    return false;
+
+  if (!snapshot.load(*mapping, offset, label_field)) {
+    delete mapping;
+    mapping = NULL;
+    cache.flush(cache_name);
+    return false;
   }
+
+  return true;
 }
 
-void
-TopologyFile::ClearCache()
+bool
+TopologyFile::build_snapshot(struct zzip_dir *dir, const char *filename)
 {
-  for (unsigned i = 0; i < shpCache.size(); i++) {
-    delete shpCache[i];
-    shpCache[i] = NULL;
+  shapefileObj shpfile;
+  if (msSHPOpenFile(&shpfile, "rb", dir, filename) == -1)
+    return false;
+
+  for (int i = 0; i < shpfile.numshapes; ++i) {
+    shapeObj shape;
+    msInitShape(&shape);
+    msSHPReadShape(shpfile.hSHP, i, &shape);
+
+    const char *label = label_field >= 0
+      ? msDBFReadStringAttribute(shpfile.hDBF, i, label_field)
+      : NULL;
+
+    snapshot.add(shape, label);
+    msFreeShape(&shape);
   }
+
+  msSHPCloseFile(&shpfile);
+
+  snapshot.finish(label_field);
+  return true;
 }
 
 rectObj
 TopologyFile::ConvertRect(const GeoBounds &br)
 {
   rectObj dest;
-  dest.minx = br.west.value_degrees();
-  dest.maxx = br.east.value_degrees();
-  dest.miny = br.south.value_degrees();
-  dest.maxy = br.north.value_degrees();
+  dest.minx = br.west.value_native();
+  dest.maxx = br.east.value_native();
+  dest.miny = br.south.value_native();
+  dest.maxy = br.north.value_native();
   return dest;
 }
 
+/**
+ * Enters the shapes found in the snapshot into a shape set.
+ */
+struct TopologyCacheVisitor {
+  AllocatedArray<const XShape *> &set;
+  const XShape *shapes;
+
+  TopologyCacheVisitor(AllocatedArray<const XShape *> &_set,
+                       const XShape *_shapes)
+    :set(_set), shapes(_shapes) {}
+
+  void operator()(unsigned i) {
+    set[i] = &shapes[i];
+  }
+};
+
 void
 TopologyFile::updateCache(const WindowProjection &map_projection)
 {
-  if (!shapefileopen)
+  if (snapshot.size() == 0)
     return;
 
   if (map_projection.GetMapScale() > scaleThreshold)
     /* not visible, don't update cache now */
     return;
 
+  /* refresh before the screen reaches the edge of the cache, so the
+     renderer finds the new set published when it gets there */
   const GeoBounds screenRect =
     map_projection.GetScreenBounds();
-  if (cache_bounds.inside(screenRect))
+  if (cache_bounds.inside(screenRect.scale(fixed(1.5))))
     /* the cache is still fresh */
     return;
 
-  cache_bounds = map_projection.GetScreenBounds().scale(fixed_two);
+  cache_bounds = screenRect.scale(fixed_two);
 
-  rectObj deg_bounds = ConvertRect(cache_bounds);
+  AllocatedArray<const XShape *> &set = shape_sets[back];
+  std::fill(set.begin(), set.end(), (const XShape *)NULL);
 
-  // Test which shapes are inside the given bounds and save the
-  // status to shpfile.status
-  msSHPWhichShapes(&shpfile, dir, deg_bounds, 0);
+  TopologyCacheVisitor visitor(set, shapes.begin());
+  snapshot.visit(ConvertRect(cache_bounds), visitor);
 
-  // If not a single shape is inside the bounds
-  if (!shpfile.status) {
-    // ... clear the whole buffer
-    ClearCache();
-    return;
-  }
+  mutex.Lock();
+  std::swap(back, pending);
+  fresh = true;
+  mutex.Unlock();
+}
 
-  // Iterate through the shapefile entries
-  for (int i = 0; i < shpfile.numshapes; i++) {
-    if (!msGetBit(shpfile.status, i)) {
-      // If the shape is outside the bounds
-      // delete the shape from the cache
-      delete shpCache[i];
-      shpCache[i] = NULL;
-    } else if (shpCache[i] == NULL) {
-      // If the shape is inside the bounds and if the
-      // shape isn't cached yet -> cache the shape
-      shpCache[i] = new XShape(&shpfile, i, label_field);
-    }
+void
+TopologyFile::acquire_cache() const
+{
+  mutex.Lock();
+  if (fresh) {
+    std::swap(front, pending);
+    fresh = false;
   }
+  mutex.Unlock();
 }
 
 unsigned
@@ -25,12 +25,17 @@ Copyright_License {
 #ifndef TOPOLOGY_H
 #define TOPOLOGY_H
 
+#include "Topology/TopologySnapshot.hpp"
+#include "Topology/XShape.hpp"
 #include "shapelib/mapshape.h"
 #include "Geo/GeoBounds.hpp"
 #include "Util/NonCopyable.hpp"
 #include "Util/AllocatedArray.hpp"
 #include "Math/fixed.hpp"
 #include "Screen/Color.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <tchar.h>
 
 struct GeoPoint;
 class Canvas;
@@ -38,13 +43,40 @@ class WindowProjection;
 struct GeoBounds;
 class LabelBlock;
 struct SETTINGS_MAP;
-class XShape;
 struct zzip_dir;
+class FileCache;
+class FileMapping;
 
 class TopologyFile : private NonCopyable {
-  struct zzip_dir *dir;
+  /** the cache file which contains the snapshot, or NULL */
+  FileMapping *mapping;
+
+  TopologySnapshot snapshot;
+
+  /** views on all shapes of the snapshot */
+  AllocatedArray<XShape> shapes;
+
+  /** the #lineObj array which is shared by all #shapes */
+  AllocatedArray<lineObj> lines;
+
+  /**
+   * Three sets of the shapes inside #cache_bounds, indexed like the
+   * snapshot (NULL for shapes outside).  updateCache() fills the
+   * #back set and publishes it as the #pending one; the renderer
+   * takes it over as the #front set in acquire_cache().  Each set is
+   * only accessed by one thread at a time, and #mutex is held only
+   * while the indices are swapped.
+   */
+  AllocatedArray<const XShape *> shape_sets[3];
+
+  unsigned back;
+  mutable unsigned pending, front;
 
-  AllocatedArray<XShape *> shpCache;
+  /** has #pending been published since the last acquire_cache()? */
+  mutable bool fresh;
+
+  /** protects #pending, #front and #fresh */
+  mutable Mutex mutex;
 
   int label_field, icon;
 
@@ -52,21 +84,25 @@ class TopologyFile : private NonCopyable {
 
 public:
   /**
-   * The constructor opens the given shapefile and clears the cache
+   * The constructor loads the snapshot of the given shapefile from
+   * the cache, or converts the shapefile and stores the new snapshot
+   * in the cache.  The shapefile is not kept open.
    * @param shpname The shapefile to open (*.shp)
    * @param threshold the zoom threshold for displaying this object
    * @param thecolor The color to use for drawing
    * @param label_field The field in which the labels should be searched
    * @param icon the resource id of the icon, 0 for no icon
+   * @param cache the cache for the snapshot, or NULL
+   * @param original_path the full path of the shapefile for the
+   * cache; inside a ZIP file, the path of the ZIP file followed by
+   * shpname
    * @return
    */
   TopologyFile(struct zzip_dir *dir, const char *shpname,
                fixed threshold, const Color color,
-               int label_field=-1, int icon=0);
+               int label_field=-1, int icon=0,
+               FileCache *cache=NULL, const char *original_path=NULL);
 
-  /**
-   * The destructor clears the cache and closes the shapefile
-   */
   ~TopologyFile();
 
   bool is_visible(fixed map_scale) const {
@@ -86,20 +122,36 @@ public:
   }
 
   bool empty() const {
-    return shpCache.size() == 0;
+    return snapshot.size() == 0;
   }
 
   unsigned size() const {
-    return shpCache.size();
+    return snapshot.size();
   }
 
+  /**
+   * Returns a shape of the set selected by the last acquire_cache()
+   * call, or NULL if it is not in the cache.
+   */
   const XShape *operator[](unsigned i) const {
-    return shpCache[i];
+    return shape_sets[front][i];
   }
 
+  /**
+   * Makes the shape set which was last published by updateCache()
+   * available to operator[].  Called by the renderer.
+   */
+  void acquire_cache() const;
+
   gcc_pure
   unsigned GetSkipSteps(fixed map_scale) const;
 
+  /**
+   * Determines the shapes around the projection's screen, and
+   * publishes them for acquire_cache().  This is meant to be called
+   * by a background thread; it must not be called concurrently with
+   * itself.
+   */
   void updateCache(const WindowProjection &map_projection);
 
   /**
@@ -117,11 +169,9 @@ private:
 
   static rectObj ConvertRect(const GeoBounds &br);
 
-protected:
-  void ClearCache();
-
-  shapefileObj shpfile;
-  bool shapefileopen;
+  bool load_snapshot(FileCache &cache, const TCHAR *cache_name,
+                     const TCHAR *original_path);
+  bool build_snapshot(struct zzip_dir *dir, const char *shpname);
 };
 
 #endif
@@ -42,7 +42,7 @@ Copyright_License {
  * directory.
  */
 static bool
-LoadConfiguredTopologyFile(TopologyStore &store)
+LoadConfiguredTopologyFile(TopologyStore &store, FileCache *cache)
 {
   TCHAR file[MAX_PATH];
   if (!Profile::GetPath(szProfileTopologyFile, file))
@@ -59,7 +59,7 @@ LoadConfiguredTopologyFile(TopologyStore &store)
   if (directory == NULL)
     return false;
 
-  store.Load(reader, directory);
+  store.Load(reader, directory, NULL, cache);
   return true;
 }
 
@@ -68,7 +68,7 @@ LoadConfiguredTopologyFile(TopologyStore &store)
  * the same ZIP file.
  */
 static bool
-LoadConfiguredTopologyZip(TopologyStore &store)
+LoadConfiguredTopologyZip(TopologyStore &store, FileCache *cache)
 {
   TCHAR path[MAX_PATH];
   if (!Profile::GetPath(szProfileMapFile, path))
@@ -84,17 +84,17 @@ LoadConfiguredTopologyZip(TopologyStore &store)
     return false;
   }
 
-  store.Load(reader, NULL, dir);
+  store.Load(reader, path, dir, cache);
   zzip_dir_close(dir);
   return true;
 }
 
 bool
-LoadConfiguredTopology(TopologyStore &store)
+LoadConfiguredTopology(TopologyStore &store, FileCache *cache)
 {
   LogStartUp(_T("Loading Topology File..."));
   ProgressGlue::Create(_("Loading Topology File..."));
 
-  return LoadConfiguredTopologyFile(store) ||
-    LoadConfiguredTopologyZip(store);
+  return LoadConfiguredTopologyFile(store, cache) ||
+    LoadConfiguredTopologyZip(store, cache);
 }
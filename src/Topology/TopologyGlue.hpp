@@ -25,8 +25,14 @@ Copyright_License {
 #define TOPOLOGY_GLUE_H
 
 class TopologyStore;
+class FileCache;
 
+/**
+ * Loads the configured topology.
+ *
+ * @param cache the cache for the converted shapefiles, or NULL
+ */
 bool
-LoadConfiguredTopology(TopologyStore &store);
+LoadConfiguredTopology(TopologyStore &store, FileCache *cache);
 
 #endif
@@ -24,6 +24,7 @@ Copyright_License {
 #include "Topology/TopologyRenderer.hpp"
 #include "Topology/TopologyFile.hpp"
 #include "Topology/XShape.hpp"
+#include "Geo/DouglasPeucker.hpp"
 #include "WindowProjection.hpp"
 #include "SettingsMap.hpp"
 #include "resource.h"
@@ -32,15 +33,49 @@ Copyright_License {
 #include "Screen/LabelBlock.hpp"
 #include "shapelib/map.h"
 
+#ifdef ENABLE_OPENGL
+#include "GeoShapeBuffer.hpp"
+#include "Util/AllocatedArray.hpp"
+#endif
+
 #include <algorithm>
+#include <assert.h>
 
 TopologyFileRenderer::TopologyFileRenderer(const TopologyFile &_file)
   :file(_file), pen(1, file.get_color()), brush(file.get_color())
+#ifdef ENABLE_OPENGL
+  , buffers(file.size())
+#endif
 {
   if (file.get_icon() == IDB_TOWN)
     icon.load_big(IDB_TOWN, IDB_TOWN_HD);
 }
 
+#ifdef ENABLE_OPENGL
+
+TopologyFileRenderer::~TopologyFileRenderer()
+{
+  for (unsigned i = 0; i < buffers.size(); ++i)
+    free_buffers(i);
+}
+
+void
+TopologyFileRenderer::free_buffers(unsigned i) const
+{
+  ShapeBuffers &b = buffers[i];
+  if (b.lines == NULL)
+    return;
+
+  for (unsigned j = 0; j < b.num_lines; ++j)
+    delete b.lines[j];
+  delete[] b.lines;
+
+  b.lines = NULL;
+  b.num_lines = 0;
+}
+
+#endif
+
 gcc_pure
 static GeoPoint
 point2GeoPoint(const pointObj& p)
@@ -53,10 +88,10 @@ static rectObj
 ConvertRect(const GeoBounds br)
 {
   rectObj dest;
-  dest.minx = br.west.value_degrees();
-  dest.maxx = br.east.value_degrees();
-  dest.miny = br.south.value_degrees();
-  dest.maxy = br.north.value_degrees();
+  dest.minx = br.west.value_native();
+  dest.maxx = br.east.value_native();
+  dest.miny = br.south.value_native();
+  dest.maxy = br.north.value_native();
   return dest;
 }
 
@@ -64,6 +99,10 @@ void
 TopologyFileRenderer::Paint(Canvas &canvas,
                             const WindowProjection &projection) const
 {
+  /* pick up the shapes which were published by the
+     TopologyUpdater thread */
+  file.acquire_cache();
+
   fixed map_scale = projection.GetMapScale();
   if (!file.is_visible(map_scale))
     return;
@@ -77,13 +116,20 @@ TopologyFileRenderer::Paint(Canvas &canvas,
 
   // get drawing info
 
-  int iskip = file.GetSkipSteps(map_scale);
+  const GeoBounds screen_bounds = projection.GetScreenBounds();
+  clip.set_bounds(screen_bounds.scale(fixed(1.1)));
 
-  const rectObj screenRect =
-    ConvertRect(projection.GetScreenBounds());
+  const unsigned char min_level =
+    DouglasPeuckerMinLevel(projection.PixelsToAngle(1).value_radians());
+
+  const rectObj screenRect = ConvertRect(screen_bounds);
 
   for (unsigned i = 0; i < file.size(); ++i) {
     const XShape *cshape = file[i];
+#ifdef ENABLE_OPENGL
+    if (cshape == NULL)
+      free_buffers(i);
+#endif
     if (!cshape || !cshape->is_visible(file.get_label_field()))
       continue;
 
@@ -110,45 +156,161 @@ TopologyFileRenderer::Paint(Canvas &canvas,
       }
       break;
 
-    case MS_SHAPE_LINE:
+    case MS_SHAPE_LINE: {
+      const unsigned char *levels = cshape->get_levels();
+
       for (int tt = 0; tt < shape.numlines; ++tt) {
         const lineObj &line = shape.line[tt];
-        unsigned msize = line.numpoints;
 
-        shape_renderer.begin_shape(msize);
+#ifdef ENABLE_OPENGL
+        get_buffer(i, *cshape, tt).outline(projection);
+#else
+        paint_line(canvas, projection, line, levels, min_level);
+#endif
 
-        for (unsigned i = 0; i < msize; ++i) {
-          GeoPoint g = point2GeoPoint(line.point[i]);
-          shape_renderer.add_point_if_distant(projection.GeoToScreen(g));
-        }
-
-        shape_renderer.finish_polyline(canvas);
+        levels += line.numpoints;
       }
       break;
+    }
+
+    case MS_SHAPE_POLYGON: {
+      const unsigned char *levels = cshape->get_levels();
 
-    case MS_SHAPE_POLYGON:
       for (int tt = 0; tt < shape.numlines; ++tt) {
         const lineObj &line = shape.line[tt];
-        unsigned msize = line.numpoints / iskip;
-
-        shape_renderer.begin_shape(msize);
-
-        const pointObj *in = line.point;
-        for (unsigned i = 0; i < msize; ++i) {
-          GeoPoint g = point2GeoPoint(*in);
-          in += iskip;
-          shape_renderer.add_point_if_distant(projection.GeoToScreen(g));
+        const unsigned char *line_levels = levels;
+        levels += line.numpoints;
+
+#ifdef ENABLE_OPENGL
+        const GeoShapeBuffer &buffer = get_buffer(i, *cshape, tt);
+        if (buffer.can_fill()) {
+          buffer.fill(projection);
+          continue;
         }
+#endif
 
-        shape_renderer.finish_polygon(canvas);
+        paint_polygon(canvas, projection, line, line_levels, min_level);
       }
       break;
     }
+    }
   }
 
   shape_renderer.commit();
 }
 
+void
+TopologyFileRenderer::paint_line(Canvas &canvas,
+                                 const WindowProjection &projection,
+                                 const lineObj &line,
+                                 const unsigned char *levels,
+                                 unsigned char min_level) const
+{
+  const unsigned n = line.numpoints;
+
+  /* the line is split into runs of visible segments; each run is
+     drawn as a separate polyline */
+  bool drawing = false;
+  GeoPoint previous;
+
+  for (unsigned j = 0; j < n; ++j) {
+    if (levels[j] < min_level)
+      continue;
+
+    const GeoPoint current = point2GeoPoint(line.point[j]);
+    if (j == 0) {
+      previous = current;
+      continue;
+    }
+
+    GeoPoint a = previous, b = current;
+    previous = current;
+
+    if (!clip.clip_line(a, b)) {
+      if (drawing) {
+        shape_renderer.finish_polyline(canvas);
+        drawing = false;
+      }
+
+      continue;
+    }
+
+    if (!drawing) {
+      shape_renderer.begin_shape(n - j + 1);
+      shape_renderer.add_point(projection.GeoToScreen(a));
+      drawing = true;
+    }
+
+    shape_renderer.add_point_if_distant(projection.GeoToScreen(b));
+
+    if (b.Longitude != current.Longitude || b.Latitude != current.Latitude) {
+      /* the line leaves the visible area */
+      shape_renderer.finish_polyline(canvas);
+      drawing = false;
+    }
+  }
+
+  if (drawing)
+    shape_renderer.finish_polyline(canvas);
+}
+
+void
+TopologyFileRenderer::paint_polygon(Canvas &canvas,
+                                    const WindowProjection &projection,
+                                    const lineObj &line,
+                                    const unsigned char *levels,
+                                    unsigned char min_level) const
+{
+  GeoPoint *points = geo_points.get(line.numpoints);
+  unsigned n = 0;
+  for (int j = 0; j < line.numpoints; ++j)
+    if (levels[j] >= min_level)
+      points[n++] = point2GeoPoint(line.point[j]);
+
+  const GeoPoint *clipped = clip.clip_polygon(points, n);
+  if (n < 3)
+    return;
+
+  shape_renderer.begin_shape(n);
+
+  for (unsigned j = 0; j < n; ++j)
+    shape_renderer.add_point_if_distant(projection.GeoToScreen(clipped[j]));
+
+  shape_renderer.finish_polygon(canvas);
+}
+
+#ifdef ENABLE_OPENGL
+
+const GeoShapeBuffer &
+TopologyFileRenderer::get_buffer(unsigned i, const XShape &cshape,
+                                 unsigned line) const
+{
+  const shapeObj &shape = cshape.shape;
+
+  ShapeBuffers &b = buffers[i];
+  if (b.lines == NULL) {
+    b.num_lines = shape.numlines;
+    b.lines = new GeoShapeBuffer *[b.num_lines];
+    std::fill(b.lines, b.lines + b.num_lines, (GeoShapeBuffer *)NULL);
+  }
+
+  assert(line < b.num_lines);
+
+  if (b.lines[line] == NULL) {
+    const lineObj &l = shape.line[line];
+    AllocatedArray<GeoPoint> points(l.numpoints);
+    for (int j = 0; j < l.numpoints; ++j)
+      points[j] = point2GeoPoint(l.point[j]);
+
+    b.lines[line] = new GeoShapeBuffer(points.begin(), l.numpoints,
+                                       shape.type == MS_SHAPE_POLYGON);
+  }
+
+  return *b.lines[line];
+}
+
+#endif
+
 void
 TopologyFileRenderer::PaintLabels(Canvas &canvas,
                                   const WindowProjection &projection,
@@ -184,7 +346,10 @@ TopologyFileRenderer::PaintLabels(Canvas &canvas,
       continue;
 
 
-    const TCHAR *label = cshape->get_label();
+    TCHAR label_buffer[64];
+    const TCHAR *label =
+      cshape->get_label(label_buffer,
+                        sizeof(label_buffer) / sizeof(label_buffer[0]));
     if (label == NULL)
       continue;
 
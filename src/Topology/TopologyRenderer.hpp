@@ -26,11 +26,20 @@ Copyright_License {
 
 #include "Topology/TopologyStore.hpp"
 #include "Topology/ShapeRenderer.hpp"
+#include "Geo/GeoClip.hpp"
+#include "shapelib/mapshape.h"
 #include "Screen/Pen.hpp"
 #include "Screen/Brush.hpp"
 #include "Screen/Icon.hpp"
 #include "Util/NonCopyable.hpp"
 
+#ifdef ENABLE_OPENGL
+#include <vector>
+
+class GeoShapeBuffer;
+class XShape;
+#endif
+
 class Canvas;
 class WindowProjection;
 class LabelBlock;
@@ -44,14 +53,41 @@ class TopologyFileRenderer : private NonCopyable {
 
   mutable ShapeRenderer shape_renderer;
 
+  /** clips lines and polygons to the screen before projection */
+  mutable GeoClip clip;
+
+  /** the points of a polygon which are needed at the current scale */
+  mutable ReusableArray<GeoPoint> geo_points;
+
   Pen pen;
   Brush brush;
 
   MaskedIcon icon;
 
+#ifdef ENABLE_OPENGL
+  /**
+   * The OpenGL buffers of one shape, one for each line.
+   */
+  struct ShapeBuffers {
+    unsigned num_lines;
+    GeoShapeBuffer **lines;
+  };
+
+  /**
+   * The buffers of all shapes, indexed like the #TopologyFile.  They
+   * are created when a shape is drawn for the first time, and freed
+   * after the #TopologyFile has unloaded the shape.
+   */
+  mutable std::vector<ShapeBuffers> buffers;
+#endif
+
 public:
   TopologyFileRenderer(const TopologyFile &file);
 
+#ifdef ENABLE_OPENGL
+  ~TopologyFileRenderer();
+#endif
+
   /**
    * Paints the polygons, lines and points/icons in the TopologyFile
    * @param canvas The canvas to paint on
@@ -70,6 +106,25 @@ public:
   void PaintLabels(Canvas &canvas,
                    const WindowProjection &projection, LabelBlock &label_block,
                    const SETTINGS_MAP &settings_map) const;
+
+private:
+  /**
+   * Draws the visible parts of a line, with the level of detail
+   * selected by min_level.
+   */
+  void paint_line(Canvas &canvas, const WindowProjection &projection,
+                  const lineObj &line, const unsigned char *levels,
+                  unsigned char min_level) const;
+
+  void paint_polygon(Canvas &canvas, const WindowProjection &projection,
+                     const lineObj &line, const unsigned char *levels,
+                     unsigned char min_level) const;
+
+#ifdef ENABLE_OPENGL
+  const GeoShapeBuffer &get_buffer(unsigned i, const XShape &shape,
+                                   unsigned line) const;
+  void free_buffers(unsigned i) const;
+#endif
 };
 
 /**
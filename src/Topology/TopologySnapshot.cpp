@@ -0,0 +1,412 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Topology/TopologySnapshot.hpp"
+#include "Geo/DouglasPeucker.hpp"
+#include "Navigation/GeoPoint.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "OS/FileMapping.hpp"
+#include "Math/Constants.h"
+#include "shapelib/map.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+struct TopologySnapshotHeader {
+  static const unsigned VERSION = 1;
+
+  unsigned version;
+
+  /** sizeof(pointObj) of the writer */
+  unsigned point_size;
+
+  /** are the coordinates in radians (or in degrees)? */
+  unsigned radians;
+
+  int label_field;
+
+  unsigned num_shapes, num_lines, num_points, num_strings;
+  unsigned num_nodes, num_leaves, num_order;
+
+  unsigned reserved;
+};
+
+const unsigned TopologySnapshot::FANOUT;
+const unsigned TopologySnapshot::NO_LABEL;
+
+/** tables in the snapshot are aligned to this number of bytes */
+static const unsigned SNAPSHOT_ALIGNMENT = 8;
+
+static size_t
+AlignSnapshotOffset(size_t offset)
+{
+  return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT
+    * SNAPSHOT_ALIGNMENT;
+}
+
+static double
+ToNative(double degrees)
+{
+#ifdef RADIANS
+  return degrees * DEG_TO_RAD;
+#else
+  return degrees;
+#endif
+}
+
+static bool
+IsIgnoredLabel(const char *label)
+{
+  return label == NULL || strcmp(label, "UNK") == 0 ||
+    strcmp(label, "RAILWAY STATION") == 0 ||
+    strcmp(label, "RAILROAD STATION") == 0;
+}
+
+TopologySnapshot::TopologySnapshot()
+  :shapes(NULL), lines(NULL), points(NULL), levels(NULL), strings(NULL),
+   nodes(NULL), order(NULL),
+   num_shapes(0), num_lines(0), num_points(0), num_strings(0),
+   num_nodes(0), num_leaves(0), num_order(0),
+   label_field(-1) {}
+
+void
+TopologySnapshot::add(const shapeObj &src, const char *label)
+{
+  Shape shape;
+  shape.bounds.minx = ToNative(src.bounds.minx);
+  shape.bounds.miny = ToNative(src.bounds.miny);
+  shape.bounds.maxx = ToNative(src.bounds.maxx);
+  shape.bounds.maxy = ToNative(src.bounds.maxy);
+  shape.type = src.type;
+  shape.first_line = new_lines.size();
+  shape.num_lines = src.numlines;
+
+  if (IsIgnoredLabel(label))
+    shape.label = NO_LABEL;
+  else {
+    shape.label = new_strings.size();
+    new_strings.insert(new_strings.end(), label, label + strlen(label) + 1);
+  }
+
+  new_shapes.push_back(shape);
+
+  AllocatedArray<GeoPoint> geo_points;
+  for (int i = 0; i < src.numlines; ++i) {
+    const lineObj &src_line = src.line[i];
+
+    Line line;
+    line.first_point = new_points.size();
+    line.num_points = src_line.numpoints;
+    new_lines.push_back(line);
+
+    geo_points.grow_discard(line.num_points);
+    for (unsigned j = 0; j < line.num_points; ++j) {
+      pointObj point;
+      memset(&point, 0, sizeof(point));
+      point.x = ToNative(src_line.point[j].x);
+      point.y = ToNative(src_line.point[j].y);
+      new_points.push_back(point);
+
+      geo_points[j] = GeoPoint(Angle::native(fixed(point.x)),
+                               Angle::native(fixed(point.y)));
+    }
+
+    new_levels.resize(new_points.size());
+    unsigned char *dest = &new_levels[line.first_point];
+    if (shape.type == MS_SHAPE_LINE || shape.type == MS_SHAPE_POLYGON)
+      DouglasPeuckerLevels(geo_points.begin(), line.num_points, dest);
+    else
+      std::fill(dest, dest + line.num_points, LEVEL_ALWAYS);
+  }
+}
+
+static void
+Include(rectObj &a, const rectObj &b)
+{
+  a.minx = std::min(a.minx, b.minx);
+  a.miny = std::min(a.miny, b.miny);
+  a.maxx = std::max(a.maxx, b.maxx);
+  a.maxy = std::max(a.maxy, b.maxy);
+}
+
+/**
+ * Orders shapes by the horizontal (or vertical) center of their
+ * bounds.
+ */
+class CompareShapeCenter {
+  const std::vector<TopologySnapshot::Shape> &shapes;
+  bool vertical;
+
+public:
+  CompareShapeCenter(const std::vector<TopologySnapshot::Shape> &_shapes,
+                     bool _vertical)
+    :shapes(_shapes), vertical(_vertical) {}
+
+  bool operator()(unsigned a, unsigned b) const {
+    const rectObj &ra = shapes[a].bounds, &rb = shapes[b].bounds;
+    return vertical
+      ? ra.miny + ra.maxy < rb.miny + rb.maxy
+      : ra.minx + ra.maxx < rb.minx + rb.maxx;
+  }
+};
+
+void
+TopologySnapshot::finish(int _label_field)
+{
+  label_field = _label_field;
+
+  /* sort-tile-recursive packing: the shapes are sorted into vertical
+     slices, and within each slice from south to north; each run of
+     FANOUT shapes becomes a leaf */
+
+  new_order.clear();
+  for (unsigned i = 0; i < new_shapes.size(); ++i)
+    if (new_shapes[i].type != MS_SHAPE_NULL && new_shapes[i].num_lines > 0)
+      new_order.push_back(i);
+
+  const unsigned n = new_order.size();
+  std::sort(new_order.begin(), new_order.end(),
+            CompareShapeCenter(new_shapes, false));
+
+  const unsigned n_leaves = (n + FANOUT - 1) / FANOUT;
+  const unsigned n_slices = (unsigned)ceil(sqrt((double)n_leaves));
+  const unsigned slice_size = std::max(n_slices, 1u) * FANOUT;
+  for (unsigned i = 0; i < n; i += slice_size)
+    std::sort(new_order.begin() + i,
+              new_order.begin() + std::min(i + slice_size, n),
+              CompareShapeCenter(new_shapes, true));
+
+  new_nodes.clear();
+  for (unsigned i = 0; i < n; i += FANOUT) {
+    Node node;
+    node.first = i;
+    node.count = std::min(FANOUT, n - i);
+    node.bounds = new_shapes[new_order[i]].bounds;
+    for (unsigned j = i + 1; j < i + node.count; ++j)
+      Include(node.bounds, new_shapes[new_order[j]].bounds);
+    new_nodes.push_back(node);
+  }
+
+  /* the upper levels group consecutive nodes, which are already
+     close to each other */
+  unsigned level_begin = 0, level_end = new_nodes.size();
+  while (level_end - level_begin > 1) {
+    for (unsigned i = level_begin; i < level_end; i += FANOUT) {
+      Node node;
+      node.first = i;
+      node.count = std::min(FANOUT, level_end - i);
+      node.bounds = new_nodes[i].bounds;
+      for (unsigned j = i + 1; j < i + node.count; ++j)
+        Include(node.bounds, new_nodes[j].bounds);
+      new_nodes.push_back(node);
+    }
+
+    level_begin = level_end;
+    level_end = new_nodes.size();
+  }
+
+  shapes = new_shapes.empty() ? NULL : &new_shapes[0];
+  lines = new_lines.empty() ? NULL : &new_lines[0];
+  points = new_points.empty() ? NULL : &new_points[0];
+  levels = new_levels.empty() ? NULL : &new_levels[0];
+  strings = new_strings.empty() ? NULL : &new_strings[0];
+  nodes = new_nodes.empty() ? NULL : &new_nodes[0];
+  order = new_order.empty() ? NULL : &new_order[0];
+
+  num_shapes = new_shapes.size();
+  num_lines = new_lines.size();
+  num_points = new_points.size();
+  num_strings = new_strings.size();
+  num_nodes = new_nodes.size();
+  num_leaves = n_leaves;
+  num_order = n;
+}
+
+/**
+ * Writes a table, followed by padding up to the next aligned
+ * offset.
+ */
+static bool
+WriteTable(FILE *file, const void *data, size_t size)
+{
+  static const char zero[SNAPSHOT_ALIGNMENT] = { 0 };
+  const size_t padding = AlignSnapshotOffset(size) - size;
+
+  return (size == 0 || fwrite(data, 1, size, file) == size) &&
+    (padding == 0 || fwrite(zero, 1, padding, file) == padding);
+}
+
+bool
+TopologySnapshot::save(FILE *file) const
+{
+  long base = ftell(file);
+  if (base < 0)
+    return false;
+
+  static const char zero[SNAPSHOT_ALIGNMENT] = { 0 };
+  const size_t padding = AlignSnapshotOffset(base) - base;
+  if (padding > 0 && fwrite(zero, 1, padding, file) != padding)
+    return false;
+
+  TopologySnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  header.version = TopologySnapshotHeader::VERSION;
+  header.point_size = sizeof(pointObj);
+#ifdef RADIANS
+  header.radians = 1;
+#endif
+  header.label_field = label_field;
+  header.num_shapes = num_shapes;
+  header.num_lines = num_lines;
+  header.num_points = num_points;
+  header.num_strings = num_strings;
+  header.num_nodes = num_nodes;
+  header.num_leaves = num_leaves;
+  header.num_order = num_order;
+
+  return WriteTable(file, &header, sizeof(header)) &&
+    WriteTable(file, shapes, num_shapes * sizeof(*shapes)) &&
+    WriteTable(file, lines, num_lines * sizeof(*lines)) &&
+    WriteTable(file, points, num_points * sizeof(*points)) &&
+    WriteTable(file, nodes, num_nodes * sizeof(*nodes)) &&
+    WriteTable(file, order, num_order * sizeof(*order)) &&
+    WriteTable(file, levels, num_points * sizeof(*levels)) &&
+    WriteTable(file, strings, num_strings * sizeof(*strings));
+}
+
+/**
+ * Returns the next table of a mapped snapshot, or NULL if the
+ * mapping is too small.
+ *
+ * @param count the number of elements, as read from the file
+ * @param element_size the size of one element in bytes
+ */
+static const void *
+ReadTable(const FileMapping &mapping, size_t &offset,
+          unsigned count, size_t element_size)
+{
+  /* divide instead of multiplying the count from the file, which
+     could overflow on 32 bit machines */
+  if (mapping.size() < offset ||
+      count > (mapping.size() - offset) / element_size)
+    return NULL;
+
+  const void *table = mapping.at(offset);
+  offset += AlignSnapshotOffset(count * element_size);
+  return table;
+}
+
+static bool
+CheckRange(unsigned first, unsigned count, unsigned size)
+{
+  return first <= size && count <= size - first;
+}
+
+bool
+TopologySnapshot::load(const FileMapping &mapping, size_t offset,
+                       int _label_field)
+{
+  offset = AlignSnapshotOffset(offset);
+
+  const TopologySnapshotHeader *header = (const TopologySnapshotHeader *)
+    ReadTable(mapping, offset, 1, sizeof(TopologySnapshotHeader));
+  if (header == NULL ||
+      header->version != TopologySnapshotHeader::VERSION ||
+      header->point_size != sizeof(pointObj) ||
+#ifdef RADIANS
+      header->radians != 1 ||
+#else
+      header->radians != 0 ||
+#endif
+      header->label_field != _label_field ||
+      header->num_leaves > header->num_nodes ||
+      (header->num_nodes > 0) != (header->num_leaves > 0))
+    return false;
+
+  const Shape *_shapes = (const Shape *)
+    ReadTable(mapping, offset, header->num_shapes, sizeof(Shape));
+  const Line *_lines = (const Line *)
+    ReadTable(mapping, offset, header->num_lines, sizeof(Line));
+  const pointObj *_points = (const pointObj *)
+    ReadTable(mapping, offset, header->num_points, sizeof(pointObj));
+  const Node *_nodes = (const Node *)
+    ReadTable(mapping, offset, header->num_nodes, sizeof(Node));
+  const unsigned *_order = (const unsigned *)
+    ReadTable(mapping, offset, header->num_order, sizeof(unsigned));
+  const unsigned char *_levels = (const unsigned char *)
+    ReadTable(mapping, offset, header->num_points, 1);
+  const char *_strings = (const char *)
+    ReadTable(mapping, offset, header->num_strings, 1);
+  if (_shapes == NULL || _lines == NULL || _points == NULL ||
+      _nodes == NULL || _order == NULL || _levels == NULL ||
+      _strings == NULL)
+    return false;
+
+  if (header->num_strings > 0 && _strings[header->num_strings - 1] != 0)
+    return false;
+
+  for (unsigned i = 0; i < header->num_shapes; ++i) {
+    const Shape &shape = _shapes[i];
+    if (!CheckRange(shape.first_line, shape.num_lines, header->num_lines) ||
+        (shape.label != NO_LABEL && shape.label >= header->num_strings))
+      return false;
+  }
+
+  for (unsigned i = 0; i < header->num_lines; ++i)
+    if (!CheckRange(_lines[i].first_point, _lines[i].num_points,
+                    header->num_points))
+      return false;
+
+  for (unsigned i = 0; i < header->num_order; ++i)
+    if (_order[i] >= header->num_shapes)
+      return false;
+
+  /* children must precede their parent, so a query always ends */
+  for (unsigned i = 0; i < header->num_nodes; ++i) {
+    const Node &node = _nodes[i];
+    if (node.count > FANOUT ||
+        (i < header->num_leaves
+         ? !CheckRange(node.first, node.count, header->num_order)
+         : !CheckRange(node.first, node.count, i)))
+      return false;
+  }
+
+  shapes = _shapes;
+  lines = _lines;
+  points = _points;
+  levels = _levels;
+  strings = _strings;
+  nodes = _nodes;
+  order = _order;
+
+  num_shapes = header->num_shapes;
+  num_lines = header->num_lines;
+  num_points = header->num_points;
+  num_strings = header->num_strings;
+  num_nodes = header->num_nodes;
+  num_leaves = header->num_leaves;
+  num_order = header->num_order;
+  label_field = header->label_field;
+  return true;
+}
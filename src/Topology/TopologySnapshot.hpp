@@ -0,0 +1,214 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TOPOLOGY_SNAPSHOT_HPP
+#define XCSOAR_TOPOLOGY_SNAPSHOT_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "shapelib/mapshape.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+class FileMapping;
+
+/**
+ * All shapes of one shapefile, packed into a few contiguous tables:
+ * the coordinates of all shapes are in one point array (in native
+ * angle units), together with their levels of detail and labels.  A
+ * static R-tree over the shape bounds answers visibility queries
+ * without touching the shapefile.
+ *
+ * A snapshot is built once from the shapefile with add() and
+ * finish(), and can be written into the #FileCache.  Later, it is
+ * loaded from the memory mapped cache file without any conversion.
+ */
+class TopologySnapshot : private NonCopyable {
+public:
+  /** the maximum number of children of an R-tree node */
+  static const unsigned FANOUT = 16;
+
+  /** the label offset of a shape without a label */
+  static const unsigned NO_LABEL = 0xffffffff;
+
+  struct Shape {
+    /** the bounds, in native angle units */
+    rectObj bounds;
+
+    int type;
+
+    /** the lines in the line table */
+    unsigned first_line, num_lines;
+
+    /** the label in the string table, or NO_LABEL */
+    unsigned label;
+  };
+
+  struct Line {
+    /** the points in the point table */
+    unsigned first_point, num_points;
+  };
+
+  /**
+   * A node of the R-tree.  The first #num_leaves nodes are leaves,
+   * which refer to a range of the shape order table; all others
+   * refer to a range of child nodes.  The root is the last node.
+   */
+  struct Node {
+    rectObj bounds;
+    unsigned first, count;
+  };
+
+private:
+  /** tables of a new snapshot */
+  std::vector<Shape> new_shapes;
+  std::vector<Line> new_lines;
+  std::vector<pointObj> new_points;
+  std::vector<unsigned char> new_levels;
+  std::vector<char> new_strings;
+  std::vector<Node> new_nodes;
+  std::vector<unsigned> new_order;
+
+  /** tables of the finished or loaded snapshot */
+  const Shape *shapes;
+  const Line *lines;
+  const pointObj *points;
+  const unsigned char *levels;
+  const char *strings;
+  const Node *nodes;
+  const unsigned *order;
+
+  unsigned num_shapes, num_lines, num_points, num_strings;
+  unsigned num_nodes, num_leaves, num_order;
+
+  int label_field;
+
+public:
+  TopologySnapshot();
+
+  /**
+   * Adds a shape to a new snapshot.
+   *
+   * @param shape the shape as read from the shapefile, in degrees
+   * @param label the label as read from the DBF file, or NULL
+   */
+  void add(const shapeObj &shape, const char *label);
+
+  /**
+   * Builds the R-tree of a new snapshot, and makes the tables
+   * available to the accessor methods.
+   *
+   * @param label_field the DBF field of the labels
+   */
+  void finish(int label_field);
+
+  /**
+   * Writes the finished snapshot to the specified file, which is
+   * positioned after the FileCache header.
+   */
+  bool save(FILE *file) const;
+
+  /**
+   * Checks a snapshot in the specified mapping, and makes its tables
+   * available to the accessor methods.  The mapping must remain valid
+   * while the snapshot is used.
+   *
+   * @param offset the position of the snapshot in the mapping
+   * @param label_field the DBF field of the labels; a snapshot
+   * created for another field is rejected
+   * @return false if the snapshot is malformed
+   */
+  bool load(const FileMapping &mapping, size_t offset, int label_field);
+
+  unsigned size() const {
+    return num_shapes;
+  }
+
+  unsigned get_num_lines() const {
+    return num_lines;
+  }
+
+  const Shape &get_shape(unsigned i) const {
+    return shapes[i];
+  }
+
+  const Line &get_line(unsigned i) const {
+    return lines[i];
+  }
+
+  const pointObj *get_points(const Line &line) const {
+    return points + line.first_point;
+  }
+
+  const unsigned char *get_levels(const Line &line) const {
+    return levels + line.first_point;
+  }
+
+  /**
+   * Returns the label of a shape in the character set of the
+   * shapefile, or NULL if the shape has no label.
+   */
+  const char *get_label(const Shape &shape) const {
+    return shape.label != NO_LABEL ? strings + shape.label : NULL;
+  }
+
+  static bool overlaps(const rectObj &a, const rectObj &b) {
+    return a.minx <= b.maxx && a.maxx >= b.minx &&
+      a.miny <= b.maxy && a.maxy >= b.miny;
+  }
+
+  /**
+   * Calls visitor(i) for the index of each shape whose bounds overlap
+   * the specified rectangle (in native angle units).  This does not
+   * allocate memory.
+   */
+  template<class V>
+  void visit(const rectObj &rect, V &visitor) const {
+    if (num_nodes == 0)
+      return;
+
+    unsigned stack[FANOUT * 8];
+    unsigned top = 0;
+    stack[top++] = num_nodes - 1;
+
+    while (top > 0) {
+      const unsigned index = stack[--top];
+      const Node &node = nodes[index];
+      if (!overlaps(node.bounds, rect))
+        continue;
+
+      const unsigned end = node.first + node.count;
+      if (index < num_leaves) {
+        for (unsigned i = node.first; i < end; ++i)
+          if (overlaps(shapes[order[i]].bounds, rect))
+            visitor(order[i]);
+      } else {
+        for (unsigned i = node.first; i < end && top < FANOUT * 8; ++i)
+          stack[top++] = i;
+      }
+    }
+  }
+};
+
+#endif
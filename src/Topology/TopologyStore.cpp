@@ -38,19 +38,35 @@ TopologyStore::ScanVisibility(const WindowProjection &m_projection)
 
   // we will make sure we update at least one cache per call
   // to make sure eventually everything gets refreshed
+  ScopeLock protect(mutex);
   for (unsigned i = 0; i < files.size(); ++i)
     files[i]->updateCache(m_projection);
 }
 
+void
+TopologyStore::RequestScan(const WindowProjection &m_projection)
+{
+  if (!updater.defined())
+    updater.start();
+
+  updater.Request(m_projection);
+}
+
 TopologyStore::~TopologyStore()
 {
+  if (updater.defined()) {
+    updater.stop();
+    updater.join();
+  }
+
   Reset();
 }
 
 void
 TopologyStore::Load(NLineReader &reader, const TCHAR *Directory,
-                    struct zzip_dir *zdir)
+                    struct zzip_dir *zdir, FileCache *cache)
 {
+  ScopeLock protect(mutex);
   Reset();
 
   double ShapeRange;
@@ -119,16 +135,22 @@ TopologyStore::Load(NLineReader &reader, const TCHAR *Directory,
       blue = 255;
     }
 
-    files.append(new TopologyFile(zdir, ShapeFilename,
+    // inside the ZIP file, the shapefile is opened without the
+    // directory, but the cache needs the full path
+    files.append(new TopologyFile(zdir,
+                                  zdir != NULL
+                                  ? ShapeFilenameEnd : ShapeFilename,
                                   fixed(ShapeRange) * 1000,
                                   Color(red, green, blue),
-                                  ShapeField, ShapeIcon));
+                                  ShapeField, ShapeIcon, cache,
+                                  Directory != NULL ? ShapeFilename : NULL));
   }
 }
 
 void
 TopologyStore::Reset()
 {
+  ScopeLock protect(mutex);
   for (unsigned i = 0; i < files.size(); ++i)
     delete files[i];
 
@@ -24,14 +24,17 @@ Copyright_License {
 #ifndef TOPOLOGY_STORE_H
 #define TOPOLOGY_STORE_H
 
+#include "Topology/TopologyUpdater.hpp"
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hpp"
+#include "Thread/Mutex.hpp"
 
 #include <tchar.h>
 
 class WindowProjection;
 class TopologyFile;
 class NLineReader;
+class FileCache;
 struct zzip_dir;
 
 /**
@@ -47,7 +50,14 @@ public:
 private:
   StaticArray<TopologyFile *, MAXTOPOLOGY> files;
 
+  /** protects #files against ScanVisibility() in the #updater */
+  Mutex mutex;
+
+  /** started by the first RequestScan() call */
+  TopologyUpdater updater;
+
 public:
+  TopologyStore():updater(*this) {}
   ~TopologyStore();
 
   unsigned size() const {
@@ -58,10 +68,28 @@ public:
     return *files[i];
   }
 
+  /**
+   * Updates the shape caches of all files synchronously.
+   */
   void ScanVisibility(const WindowProjection &m_projection);
 
+  /**
+   * Asks the background thread to call ScanVisibility().  Returns
+   * immediately.
+   */
+  void RequestScan(const WindowProjection &m_projection);
+
+  /**
+   * Loads the shapefiles listed in a topology (*.tpl) file.
+   *
+   * @param Directory the directory containing the shapefiles, or the
+   * path of the ZIP file if zdir is not NULL; may be NULL if there is
+   * no cache
+   * @param zdir the ZIP file containing the shapefiles, or NULL
+   * @param cache the cache for the converted shapefiles, or NULL
+   */
   void Load(NLineReader &reader, const TCHAR *Directory,
-            struct zzip_dir *zdir=NULL);
+            struct zzip_dir *zdir=NULL, FileCache *cache=NULL);
   void Reset();
 };
 
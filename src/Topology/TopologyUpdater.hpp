@@ -0,0 +1,63 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TOPOLOGY_UPDATER_HPP
+#define XCSOAR_TOPOLOGY_UPDATER_HPP
+
+#include "Thread/WorkerThread.hpp"
+#include "Thread/Mutex.hpp"
+#include "WindowProjection.hpp"
+
+class TopologyStore;
+
+/**
+ * Maintains the shape caches of a #TopologyStore in background, so
+ * the draw thread never waits for them.  The renderer picks up the
+ * new shape sets with TopologyFile::acquire_cache().
+ *
+ * The most recent request wins.
+ */
+class TopologyUpdater : public WorkerThread {
+  TopologyStore &store;
+
+  /** protects the request attributes below */
+  Mutex mutex;
+
+  bool pending;
+  WindowProjection projection;
+
+public:
+  TopologyUpdater(TopologyStore &_store)
+    :store(_store), pending(false) {}
+
+  /**
+   * Replaces the current request and wakes up the thread.  Returns
+   * immediately.
+   */
+  void Request(const WindowProjection &_projection);
+
+protected:
+  virtual void tick();
+};
+
+#endif
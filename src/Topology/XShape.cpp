@@ -22,76 +22,75 @@ Copyright_License {
 */
 
 #include "Topology/XShape.hpp"
+#include "Topology/TopologySnapshot.hpp"
 #include "Units.hpp"
 #include "shapelib/map.h"
 
 #include <tchar.h>
 #include <ctype.h>
-#include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #ifdef _UNICODE
 #include <windows.h>
 #endif
 
-static TCHAR *
-import_label(const char *src)
+XShape::XShape()
+  :label(NULL), levels(NULL)
 {
-  if (src == NULL || strcmp(src, "UNK") == 0 ||
-      strcmp(src, "RAILWAY STATION") == 0 ||
-      strcmp(src, "RAILROAD STATION") == 0)
+  msInitShape(&shape);
+}
+
+void
+XShape::set(const TopologySnapshot &snapshot, unsigned i, lineObj *lines)
+{
+  const TopologySnapshot::Shape &src = snapshot.get_shape(i);
+
+  shape.type = src.type;
+  shape.bounds = src.bounds;
+  shape.numlines = src.num_lines;
+  shape.line = lines + src.first_line;
+
+  for (unsigned j = 0; j < src.num_lines; ++j) {
+    const TopologySnapshot::Line &line =
+      snapshot.get_line(src.first_line + j);
+
+    /* the renderer does not modify the points, but shapelib's lineObj
+       has no const variant */
+    shape.line[j].numpoints = line.num_points;
+    shape.line[j].point = const_cast<pointObj *>(snapshot.get_points(line));
+  }
+
+  levels = src.num_lines > 0
+    ? snapshot.get_levels(snapshot.get_line(src.first_line))
+    : NULL;
+  label = snapshot.get_label(src);
+}
+
+const TCHAR *
+XShape::get_label(TCHAR *buffer, size_t size) const
+{
+  if (label == NULL)
     return NULL;
 
-  if (ispunct(src[0])) {
-    fixed value(strtod(src + 1, NULL));
+  if (ispunct(label[0])) {
+    fixed value(strtod(label + 1, NULL));
     value = Units::ToUserUnit(value, Units::AltitudeUnit);
 
-    TCHAR buffer[32];
     if (value > fixed(999))
-      _stprintf(buffer, _T("%.1f"), (double)(value / 1000));
+      _sntprintf(buffer, size, _T("%.1f"), (double)(value / 1000));
     else
-      _stprintf(buffer, _T("%d"), (int)value);
+      _sntprintf(buffer, size, _T("%d"), (int)value);
 
-    return _tcsdup(buffer);
+    return buffer;
   }
 
 #ifdef _UNICODE
-  size_t length = strlen(src);
-  TCHAR *dest = new TCHAR[length + 1];
-  if (::MultiByteToWideChar(CP_ACP, 0, src, -1, dest, length + 1) <= 0) {
-    delete[] dest;
+  if (::MultiByteToWideChar(CP_ACP, 0, label, -1, buffer, size) <= 0)
     return NULL;
-  }
 
-  return dest;
+  return buffer;
 #else
-  return strdup(src);
-#endif
-}
-
-XShape::XShape(shapefileObj *shpfile, int i, int label_field)
-  :label(NULL)
-{
-  msInitShape(&shape);
-  msSHPReadShape(shpfile->hSHP, i, &shape);
-
-#ifdef RADIANS
-  for (int tt = 0; tt < shape.numlines; ++tt) {
-    for (int jj = 0; jj < shape.line[tt].numpoints; ++jj) {
-      shape.line[tt].point[jj].x *= DEG_TO_RAD;
-      shape.line[tt].point[jj].y *= DEG_TO_RAD;
-    }
-  }
+  return label;
 #endif
-
-  if (label_field >= 0) {
-    const char *src = msDBFReadStringAttribute(shpfile->hDBF, i, label_field);
-    label = import_label(src);
-  }
-}
-
-XShape::~XShape()
-{
-  free(label);
-  msFreeShape(&shape);
 }
@@ -28,21 +28,51 @@ Copyright_License {
 #include "Util/NonCopyable.hpp"
 #include "shapelib/mapshape.h"
 
+#include <stddef.h>
 #include <tchar.h>
 
+class TopologySnapshot;
+
+/**
+ * One shape of a #TopologySnapshot.  It does not own any data: the
+ * lines point into the snapshot's tables, in native angle units.
+ */
 class XShape : private NonCopyable {
-  TCHAR *label;
+  /** the label in the character set of the shapefile, or NULL */
+  const char *label;
+
+  /**
+   * The level of detail of each point, line after line.  See
+   * DouglasPeuckerLevels().
+   */
+  const unsigned char *levels;
 
 public:
-  XShape(shapefileObj *shpfile, int i, int label_field=-1);
-  ~XShape();
+  XShape();
+
+  /**
+   * Points this object to a shape of the snapshot.
+   *
+   * @param lines the #lineObj array for all lines of the snapshot;
+   * this shape's entries are filled here
+   */
+  void set(const TopologySnapshot &snapshot, unsigned i, lineObj *lines);
 
   bool is_visible(int label_field) const {
     return label_field < 0 || label != NULL;
   }
 
-  const TCHAR *get_label() const {
-    return label;
+  /**
+   * Returns the label for display, or NULL if the shape has no
+   * label.  Numeric labels (altitudes) are converted to the user's
+   * altitude unit.
+   *
+   * @param buffer a buffer which may be used for the result
+   */
+  const TCHAR *get_label(TCHAR *buffer, size_t size) const;
+
+  const unsigned char *get_levels() const {
+    return levels;
   }
 
   shapeObj shape;
@@ -0,0 +1,376 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TrailRenderer.hpp"
+#include "WindowProjection.hpp"
+#include "Screen/Canvas.hpp"
+#include "Screen/Graphics.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+using std::min;
+using std::max;
+
+/**
+ * This function returns the corresponding SnailTrail
+ * color array index to the input
+ * @param cv Input value between -1.0 and 1.0
+ * @return SnailTrail color array index
+ */
+gcc_const
+static int
+GetSnailColorIndex(fixed cv)
+{
+  return max((short)0, min((short)(NUMSNAILCOLORS - 1),
+                           (short)((cv + fixed_one) / 2 * NUMSNAILCOLORS)));
+}
+
+/**
+ * Widens the colour scale to a multiple of the step, so it does not
+ * change (and all colours need to be recalculated) with every new
+ * extreme value.
+ */
+static void
+RoundRange(fixed &value_min, fixed &value_max, const fixed step)
+{
+  value_min = floor(value_min / step) * step;
+  value_max = ceil(value_max / step) * step;
+}
+
+void
+TrailRenderer::clear()
+{
+  points.clear();
+  first = 0;
+  min_time = 0;
+  snail_type = stStandardVario;
+  raw_range_valid = false;
+  value_min = value_max = fixed_zero;
+  scale = fixed_zero;
+  drift = false;
+  num_projected = num_coloured = 0;
+  ClearBatches();
+}
+
+void
+TrailRenderer::ClearBatches()
+{
+  for (unsigned i = 0; i < NUMSNAILCOLORS; ++i)
+    batches[i].clear();
+
+  num_batched = first;
+  last_drawn = -1;
+  last_colour = -1;
+}
+
+void
+TrailRenderer::Update(const ProtectedTaskManager &task,
+                      const unsigned _min_time, const SnailType_t _snail_type)
+{
+  if (_snail_type != snail_type || _min_time < min_time)
+    /* the old points are needed again, or their values are wrong */
+    clear();
+
+  snail_type = _snail_type;
+  min_time = _min_time;
+
+  TracePointVector fresh;
+
+  {
+    ProtectedTaskManager::Lease lease(task);
+    const Trace &trace = lease->get_trace();
+    if (trace.empty()) {
+      clear();
+      snail_type = _snail_type;
+      min_time = _min_time;
+      return;
+    }
+
+    if (!points.empty() &&
+        (trace.get_last_point().time < points.back().time ||
+         points.size() - first > 2 * trace.size() + 64)) {
+      /* the trace was reset, or it was thinned out so much that this
+         copy is much more detailed than the trace */
+      clear();
+      snail_type = _snail_type;
+      min_time = _min_time;
+    }
+
+    const unsigned after = !points.empty()
+      ? points.back().time
+      : (min_time > 0 ? min_time - 1 : 0);
+    fresh = trace.get_trace_points_after(after);
+  }
+
+  const bool altitude = snail_type == stAltitude;
+
+  for (TracePointVector::const_iterator it = fresh.begin();
+       it != fresh.end(); ++it) {
+    Point p;
+    p.location = it->get_location();
+    p.time = it->time;
+    p.drift_factor = it->drift_factor;
+    p.value = altitude ? it->NavAltitude : it->NettoVario;
+
+    /* points in between may have been removed from the trace since
+       the last update, which moves last_time back */
+    p.linked = !points.empty() && it->last_time >= points.back().time &&
+      it->last_time < it->time;
+    p.colour = 0;
+
+    if (raw_range_valid) {
+      raw_min = min(raw_min, p.value);
+      raw_max = max(raw_max, p.value);
+    }
+
+    points.push_back(p);
+  }
+}
+
+void
+TrailRenderer::Expire(const unsigned min_time)
+{
+  while (first < points.size() && points[first].time < min_time) {
+    if (raw_range_valid &&
+        (points[first].value <= raw_min || points[first].value >= raw_max))
+      raw_range_valid = false;
+
+    ++first;
+  }
+
+  if (first >= 256 && first * 2 >= points.size()) {
+    points.erase(points.begin(), points.begin() + first);
+    num_projected = max(num_projected, first) - first;
+    num_coloured = max(num_coloured, first) - first;
+    first = 0;
+
+    /* the indices in the batches have become invalid */
+    ClearBatches();
+  }
+}
+
+void
+TrailRenderer::UpdateRange()
+{
+  assert(first < points.size());
+
+  if (!raw_range_valid) {
+    raw_min = raw_max = points[first].value;
+    for (unsigned i = first + 1; i < points.size(); ++i) {
+      raw_min = min(raw_min, points[i].value);
+      raw_max = max(raw_max, points[i].value);
+    }
+
+    raw_range_valid = true;
+  }
+
+  fixed new_min, new_max;
+  if (snail_type == stAltitude) {
+    new_max = max(raw_max, fixed(1000));
+    new_min = min(raw_min, fixed(500));
+    RoundRange(new_min, new_max, fixed(50));
+  } else {
+    new_max = min(fixed(7.5), max(raw_max, fixed(0.75)));
+    new_min = max(fixed(-5.0), min(raw_min, fixed(-2.0)));
+    RoundRange(new_min, new_max, fixed(0.25));
+  }
+
+  if (new_min != value_min || new_max != value_max) {
+    value_min = new_min;
+    value_max = new_max;
+    num_coloured = first;
+    ClearBatches();
+  }
+}
+
+void
+TrailRenderer::SetProjection(const WindowProjection &projection,
+                             const GeoPoint *_drift_vector, const fixed now)
+{
+  bool changed = !(projection.GetGeoLocation() == geo_location) ||
+    projection.GetScreenOrigin().x != screen_origin.x ||
+    projection.GetScreenOrigin().y != screen_origin.y ||
+    projection.GetScreenAngle() != screen_angle ||
+    projection.GetScale() != scale;
+
+  if (_drift_vector != NULL)
+    /* the drift compensation moves all points with each new fix */
+    changed = changed || !drift || !(*_drift_vector == drift_vector) ||
+      now != drift_time;
+  else
+    changed = changed || drift;
+
+  if (!changed)
+    return;
+
+  geo_location = projection.GetGeoLocation();
+  screen_origin = projection.GetScreenOrigin();
+  screen_angle = projection.GetScreenAngle();
+  scale = projection.GetScale();
+
+  drift = _drift_vector != NULL;
+  if (drift) {
+    drift_vector = *_drift_vector;
+    drift_time = now;
+  }
+
+  num_projected = first;
+  ClearBatches();
+}
+
+void
+TrailRenderer::UpdateScreen(const WindowProjection &projection,
+                            const fixed now)
+{
+  for (unsigned i = max(num_projected, first); i < points.size(); ++i) {
+    Point &p = points[i];
+    p.screen = drift
+      ? projection.GeoToScreen(p.location.parametric(drift_vector,
+                                                     (now - fixed(p.time)) *
+                                                     p.drift_factor))
+      : projection.GeoToScreen(p.location);
+  }
+
+  num_projected = points.size();
+}
+
+unsigned char
+TrailRenderer::GetColour(const fixed value) const
+{
+  if (snail_type == stAltitude) {
+    int index = (value - value_min) / (value_max - value_min) *
+                (NUMSNAILCOLORS - 1);
+    return max(0, min(NUMSNAILCOLORS - 1, index));
+  } else {
+    const fixed colour_vario = negative(value) ?
+                               - value / value_min :
+                               value / value_max;
+    return GetSnailColorIndex(colour_vario);
+  }
+}
+
+void
+TrailRenderer::UpdateColours()
+{
+  for (unsigned i = max(num_coloured, first); i < points.size(); ++i)
+    points[i].colour = GetColour(points[i].value);
+
+  num_coloured = points.size();
+}
+
+void
+TrailRenderer::Append(const unsigned i)
+{
+  const Point &p = points[i];
+  if (!p.linked || last_drawn < 0) {
+    last_drawn = i;
+    last_colour = -1;
+    return;
+  }
+
+  const Point &last = points[last_drawn];
+  const int dx = p.screen.x - last.screen.x;
+  const int dy = p.screen.y - last.screen.y;
+  if (dx * dx + dy * dy < 9)
+    /* closer than 3 pixels: the next segment starts at the last
+       point instead */
+    return;
+
+  Batch &batch = batches[p.colour];
+  if (p.colour != last_colour) {
+    Run run;
+    run.offset = batch.points.size();
+    run.count = 1;
+    batch.runs.push_back(run);
+    batch.points.push_back(last.screen);
+    batch.indices.push_back(last_drawn);
+  }
+
+  batch.points.push_back(p.screen);
+  batch.indices.push_back(i);
+  ++batch.runs.back().count;
+
+  last_drawn = i;
+  last_colour = p.colour;
+}
+
+void
+TrailRenderer::UpdateBatches()
+{
+  for (unsigned i = max(num_batched, first); i < points.size(); ++i)
+    Append(i);
+
+  num_batched = points.size();
+}
+
+void
+TrailRenderer::Draw(Canvas &canvas, const ProtectedTaskManager &task,
+                    const WindowProjection &projection,
+                    const SnailType_t _snail_type, const unsigned _min_time,
+                    const GeoPoint *_drift_vector, const fixed now,
+                    const RasterPoint aircraft_pos)
+{
+  Update(task, _min_time, _snail_type);
+  Expire(_min_time);
+  if (first >= points.size())
+    return;
+
+  UpdateRange();
+  SetProjection(projection, _drift_vector, now);
+  UpdateScreen(projection, now);
+  UpdateColours();
+  UpdateBatches();
+
+  for (unsigned colour = 0; colour < NUMSNAILCOLORS; ++colour) {
+    const Batch &batch = batches[colour];
+    if (batch.runs.empty())
+      continue;
+
+    canvas.select(Graphics::hpSnailVario[colour]);
+
+    for (std::vector<Run>::const_iterator run = batch.runs.begin();
+         run != batch.runs.end(); ++run) {
+      const unsigned end = run->offset + run->count;
+      if (batch.indices[end - 1] < first)
+        /* expired */
+        continue;
+
+      /* skip the points of this run which have expired */
+      const unsigned offset =
+        std::lower_bound(batch.indices.begin() + run->offset,
+                         batch.indices.begin() + end, first) -
+        batch.indices.begin();
+      if (end - offset >= 2)
+        canvas.autoclip_polyline(&batch.points[offset], end - offset);
+    }
+  }
+
+  if (last_drawn >= (int)first) {
+    const Point &last = points[last_drawn];
+    canvas.select(Graphics::hpSnailVario[last_colour >= 0
+                                         ? last_colour : last.colour]);
+    canvas.line(last.screen, aircraft_pos);
+  }
+}
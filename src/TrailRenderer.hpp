@@ -0,0 +1,164 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TRAIL_RENDERER_HPP
+#define XCSOAR_TRAIL_RENDERER_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Navigation/GeoPoint.hpp"
+#include "Screen/Point.hpp"
+#include "SettingsMap.hpp"
+#include "Sizes.h"
+
+#include <vector>
+
+class Canvas;
+class WindowProjection;
+class ProtectedTaskManager;
+
+/**
+ * Draws the snail trail.  The trace points of the time window are
+ * kept together with their screen position and their colour; each
+ * frame only copies the points which were added to the trace since
+ * the last frame.  The segments are collected in one buffer per
+ * colour, so each pen is selected only once.
+ *
+ * The screen positions are recalculated when the projection changes
+ * (or, with thermal drift, when the time changes), and the colours
+ * when the colour scale changes.  While the map is static, a frame
+ * costs only the new points plus the drawing.
+ */
+class TrailRenderer : private NonCopyable {
+  struct Point {
+    GeoPoint location;
+    unsigned time;
+    fixed drift_factor;
+
+    /** altitude or netto vario, depending on the snail type */
+    fixed value;
+
+    /** is there a segment from the previous point to this one? */
+    bool linked;
+
+    /** the colour index of the segment ending at this point */
+    unsigned char colour;
+
+    RasterPoint screen;
+  };
+
+  /** a sequence of connected segments of one colour */
+  struct Run {
+    /** index of the first point in #Batch::points */
+    unsigned offset;
+
+    /** the number of points */
+    unsigned count;
+  };
+
+  struct Batch {
+    std::vector<RasterPoint> points;
+
+    /** the index in TrailRenderer::points of each point */
+    std::vector<unsigned> indices;
+
+    std::vector<Run> runs;
+
+    void clear() {
+      points.clear();
+      indices.clear();
+      runs.clear();
+    }
+  };
+
+  /**
+   * The trace points in chronological order.  The ones before #first
+   * have left the time window; they are removed in chunks.
+   */
+  std::vector<Point> points;
+  unsigned first;
+
+  /** the start of the time window of #points */
+  unsigned min_time;
+  SnailType_t snail_type;
+
+  /** the range of Point::value in the time window */
+  fixed raw_min, raw_max;
+  bool raw_range_valid;
+
+  /** the colour scale */
+  fixed value_min, value_max;
+
+  /** the projection of the screen positions */
+  GeoPoint geo_location;
+  RasterPoint screen_origin;
+  Angle screen_angle;
+  fixed scale;
+  bool drift;
+  GeoPoint drift_vector;
+  fixed drift_time;
+
+  /** the points before these indices are projected/coloured/batched */
+  unsigned num_projected, num_coloured, num_batched;
+
+  Batch batches[NUMSNAILCOLORS];
+
+  /** the end of the last segment in #batches, -1 if there is none */
+  int last_drawn;
+  /** the colour of the last segment, -1 after a gap */
+  int last_colour;
+
+public:
+  TrailRenderer() {
+    clear();
+  }
+
+  void clear();
+
+  /**
+   * @param min_time the time of the oldest point to be drawn
+   * @param drift_vector the thermal drift per second, or NULL to
+   * disable drift compensation
+   * @param now the current time, used for the drift compensation
+   */
+  void Draw(Canvas &canvas, const ProtectedTaskManager &task,
+            const WindowProjection &projection, SnailType_t snail_type,
+            unsigned min_time, const GeoPoint *drift_vector, fixed now,
+            const RasterPoint aircraft_pos);
+
+private:
+  void Update(const ProtectedTaskManager &task, unsigned min_time,
+              SnailType_t snail_type);
+  void Expire(unsigned min_time);
+  void UpdateRange();
+  void SetProjection(const WindowProjection &projection,
+                     const GeoPoint *drift_vector, fixed now);
+  void UpdateScreen(const WindowProjection &projection, fixed now);
+  void UpdateColours();
+  void UpdateBatches();
+  void ClearBatches();
+  void Append(unsigned i);
+
+  unsigned char GetColour(fixed value) const;
+};
+
+#endif
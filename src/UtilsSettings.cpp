@@ -115,7 +115,7 @@ SettingsLeave()
     terrain = RasterTerrain::OpenTerrain(file_cache);
 
     // re-load waypoints
-    WayPointGlue::ReadWaypoints(way_points, terrain);
+    WayPointGlue::ReadWaypoints(way_points, terrain, file_cache);
     ReadAirfieldFile(way_points);
 
     // re-set home
@@ -136,7 +136,7 @@ SettingsLeave()
   if (TopologyFileChanged) {
     XCSoarInterface::main_window.map.set_topology(NULL);
     topology->Reset();
-    LoadConfiguredTopology(*topology);
+    LoadConfiguredTopology(*topology, file_cache);
     XCSoarInterface::main_window.map.set_topology(topology);
   }
 
@@ -144,7 +144,7 @@ SettingsLeave()
     airspace_warnings.clear();
     airspace_database.clear();
     ReadAirspace(airspace_database, terrain,
-                 XCSoarInterface::Basic().pressure);
+                 XCSoarInterface::Basic().pressure, file_cache);
   }
 
   if (PolarFileChanged) {
@@ -26,6 +26,7 @@ Copyright_License {
 #include "WayPointFileZander.hpp"
 #include "WayPointFileSeeYou.hpp"
 #include "WayPointFileWinPilot.hpp"
+#include "WayPointSnapshot.hpp"
 
 #include "Terrain/RasterTerrain.hpp"
 #include "Waypoint/Waypoints.hpp"
@@ -35,11 +36,17 @@ Copyright_License {
 #include "IO/FileLineReader.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "IO/TextWriter.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
+
+#include <stdio.h>
 
 WayPointFile::WayPointFile(const TCHAR* file_name, const int _file_num,
                            const bool _compressed): 
   file_num(_file_num),
-  compressed(_compressed)
+  compressed(_compressed),
+  snapshot(NULL),
+  parsed_altitude(fixed_zero), parsed_altitude_ok(false)
 {
   _tcscpy(file, file_name);
 }
@@ -79,6 +86,14 @@ void
 WayPointFile::add_waypoint(Waypoints &way_points,
                            const Waypoint &new_waypoint)
 {
+  if (snapshot != NULL) {
+    // the snapshot stores the altitude from the file, so the terrain
+    // is looked up again when it is loaded
+    Waypoint parsed(new_waypoint);
+    parsed.Altitude = parsed_altitude;
+    snapshot->add(parsed, parsed_altitude_ok);
+  }
+
   // Append the new waypoint to the waypoint list and
   // return successful line parse
   Waypoint wp(new_waypoint);
@@ -91,6 +106,9 @@ WayPointFile::check_altitude(Waypoint &new_waypoint,
                              const RasterTerrain *terrain,
                              bool alt_ok)
 {
+  parsed_altitude = new_waypoint.Altitude;
+  parsed_altitude_ok = alt_ok;
+
   if (terrain == NULL || alt_ok)
     return;
 
@@ -103,14 +121,53 @@ WayPointFile::check_altitude(Waypoint &new_waypoint,
   }
 }
 
+bool
+WayPointFile::load_snapshot(Waypoints &way_points,
+                            const RasterTerrain *terrain,
+                            FileCache &cache, const TCHAR *cache_name)
+{
+  size_t offset;
+  FileMapping *mapping = cache.map(cache_name, file, offset);
+  if (mapping == NULL)
+    return false;
+
+  WayPointSnapshot loaded;
+  if (!loaded.load(*mapping, offset)) {
+    delete mapping;
+    cache.flush(cache_name);
+    return false;
+  }
+
+  for (unsigned i = 0; i < loaded.size(); ++i) {
+    bool alt_ok;
+    Waypoint new_waypoint = loaded.get(i, alt_ok);
+    check_altitude(new_waypoint, terrain, alt_ok);
+    add_waypoint(way_points, new_waypoint);
+  }
+
+  delete mapping;
+  return true;
+}
+
 bool
 WayPointFile::Parse(Waypoints &way_points, 
-                    const RasterTerrain *terrain)
+                    const RasterTerrain *terrain,
+                    FileCache *cache)
 {
   // If no file loaded yet -> return false
   if (file[0] == 0)
     return false;
 
+  // files inside the map file have no time stamp for the cache
+  TCHAR cache_name[32];
+  if (compressed)
+    cache = NULL;
+  else if (cache != NULL) {
+    _stprintf(cache_name, _T("waypoints-%d"), file_num);
+    if (load_snapshot(way_points, terrain, *cache, cache_name))
+      return true;
+  }
+
   ProgressGlue::SetRange(25);
 
   // If normal file
@@ -122,6 +179,10 @@ WayPointFile::Parse(Waypoints &way_points,
 
     double filesize = std::max(reader.size(), 1l);
 
+    WayPointSnapshot new_snapshot;
+    if (cache != NULL)
+      snapshot = &new_snapshot;
+
     // Read through the lines of the file
     TCHAR *line;
     for (unsigned i = 0; (line = reader.read()) != NULL; i++) {
@@ -133,6 +194,18 @@ WayPointFile::Parse(Waypoints &way_points,
         ProgressGlue::SetValue(status);
       }
     }
+
+    snapshot = NULL;
+
+    if (cache != NULL) {
+      FILE *cache_file = cache->save(cache_name, file);
+      if (cache_file != NULL) {
+        if (new_snapshot.save(cache_file))
+          cache->commit(cache_name, cache_file);
+        else
+          cache->cancel(cache_name, cache_file);
+      }
+    }
   // If compressed file inside map file
   } else {
     // convert path to ascii
@@ -31,6 +31,8 @@ Copyright_License {
 class Waypoints;
 class RasterTerrain;
 class TextWriter;
+class FileCache;
+class WayPointSnapshot;
 
 class WayPointFile 
 {
@@ -52,9 +54,12 @@ public:
    * Parses the waypoint file provided by SetFile() into the given waypoint list
    * @param way_points The waypoint list to fill
    * @param terrain RasterTerrain (for automatic waypoint height)
+   * @param cache if not NULL, the waypoints are loaded from a snapshot
+   * in this cache, which is created after the file has been parsed
    * @return True if the waypoint file parsing was okay, False otherwise
    */
-  bool Parse(Waypoints &way_points, const RasterTerrain *terrain);
+  bool Parse(Waypoints &way_points, const RasterTerrain *terrain,
+             FileCache *cache=NULL);
 
   /**
    * Saves the given waypoint list into the waypoint file provided by SetFile()
@@ -73,6 +78,13 @@ protected:
   const int file_num;
   const bool compressed;
 
+  /** the snapshot being created by Parse(), or NULL */
+  WayPointSnapshot *snapshot;
+
+  /** the altitude passed to the last check_altitude() call */
+  fixed parsed_altitude;
+  bool parsed_altitude_ok;
+
   void check_altitude(Waypoint &new_waypoint, 
                       const RasterTerrain *terrain,
                       bool alt_ok);
@@ -91,6 +103,9 @@ protected:
   virtual bool parseLine(const TCHAR* line, unsigned linenum,
                          Waypoints &way_points, const RasterTerrain *terrain) = 0;
 
+  bool load_snapshot(Waypoints &way_points, const RasterTerrain *terrain,
+                     FileCache &cache, const TCHAR *cache_name);
+
   virtual void saveFile(TextWriter &writer, const Waypoints &way_points) {};
 
   // Helper functions
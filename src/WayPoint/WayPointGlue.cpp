@@ -112,7 +112,8 @@ WayPointGlue::SetHome(Waypoints &way_points, const RasterTerrain *terrain,
 
 bool
 WayPointGlue::ReadWaypoints(Waypoints &way_points,
-                            const RasterTerrain *terrain)
+                            const RasterTerrain *terrain,
+                            FileCache *cache)
 {
   LogStartUp(_T("ReadWaypoints"));
   ProgressGlue::Create(_("Loading Waypoints..."));
@@ -137,7 +138,7 @@ WayPointGlue::ReadWaypoints(Waypoints &way_points,
   // If waypoint file exists
   if (wp_file0.get() != NULL) {
     // parse the file
-    if (wp_file0->Parse(way_points, terrain)) {
+    if (wp_file0->Parse(way_points, terrain, cache)) {
       found = true;
       // Set waypoints writable flag
       way_points.set_file0_writable(wp_file0->IsWritable());
@@ -157,7 +158,7 @@ WayPointGlue::ReadWaypoints(Waypoints &way_points,
   // If waypoint file exists
   if (wp_file1.get() != NULL) {
     // parse the file
-    if (wp_file1->Parse(way_points, terrain)) {
+    if (wp_file1->Parse(way_points, terrain, cache)) {
       found = true;
     } else {
       LogStartUp(_T("Parse error in waypoint file 2"));
@@ -180,7 +181,7 @@ WayPointGlue::ReadWaypoints(Waypoints &way_points,
     // If waypoint file inside map file exists
     if (wp_file2.get() != NULL) {
       // parse the file
-      if (wp_file2->Parse(way_points, terrain)) {
+      if (wp_file2->Parse(way_points, terrain, cache)) {
         found = true;
       } else {
         LogStartUp(_T("Parse error in map waypoint file"));
@@ -29,6 +29,7 @@ class RasterTerrain;
 struct SETTINGS_COMPUTER;
 
 class WayPointFile;
+class FileCache;
 
 /**
  * This class is used to parse different waypoint files
@@ -43,9 +44,11 @@ namespace WayPointGlue {
    * specified waypoint list
    * @param way_points The waypoint list to fill
    * @param terrain RasterTerrain (for automatic waypoint height)
+   * @param cache the cache for waypoint snapshots (may be NULL)
    */
   bool ReadWaypoints(Waypoints &way_points,
-                     const RasterTerrain *terrain);
+                     const RasterTerrain *terrain,
+                     FileCache *cache);
   void SaveWaypoints(const Waypoints &way_points);
 };
 
@@ -0,0 +1,200 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "WayPoint/WayPointSnapshot.hpp"
+#include "OS/FileMapping.hpp"
+
+#include <string.h>
+
+struct WayPointSnapshotHeader {
+  static const unsigned VERSION = 1;
+
+  unsigned version;
+
+  /** sizeof(TCHAR) of the writer */
+  unsigned char_size;
+
+  unsigned num_waypoints, num_strings;
+};
+
+/** tables in the snapshot are aligned to this number of bytes */
+static const unsigned SNAPSHOT_ALIGNMENT = 8;
+
+static size_t
+AlignSnapshotOffset(size_t offset)
+{
+  return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT
+    * SNAPSHOT_ALIGNMENT;
+}
+
+static void
+AddString(std::vector<TCHAR> &strings, const tstring &value,
+          unsigned &offset_r, unsigned &length_r)
+{
+  offset_r = strings.size();
+  length_r = value.length();
+  strings.insert(strings.end(), value.begin(), value.end());
+}
+
+static bool
+CheckString(unsigned offset, unsigned length, unsigned num_strings)
+{
+  return offset <= num_strings && length <= num_strings - offset;
+}
+
+static unsigned
+ExportFlags(const WaypointFlags &flags)
+{
+  return (flags.Airport ? 0x01 : 0) |
+    (flags.TurnPoint ? 0x02 : 0) |
+    (flags.LandPoint ? 0x04 : 0) |
+    (flags.Home ? 0x08 : 0) |
+    (flags.StartPoint ? 0x10 : 0) |
+    (flags.FinishPoint ? 0x20 : 0) |
+    (flags.Restricted ? 0x40 : 0) |
+    (flags.WaypointFlag ? 0x80 : 0);
+}
+
+static void
+ImportFlags(WaypointFlags &flags, unsigned value)
+{
+  flags.Airport = (value & 0x01) != 0;
+  flags.TurnPoint = (value & 0x02) != 0;
+  flags.LandPoint = (value & 0x04) != 0;
+  flags.Home = (value & 0x08) != 0;
+  flags.StartPoint = (value & 0x10) != 0;
+  flags.FinishPoint = (value & 0x20) != 0;
+  flags.Restricted = (value & 0x40) != 0;
+  flags.WaypointFlag = (value & 0x80) != 0;
+}
+
+void
+WayPointSnapshot::add(const Waypoint &waypoint, bool altitude_ok)
+{
+  Entry entry;
+  memset(&entry, 0, sizeof(entry));
+
+  entry.latitude = (double)waypoint.Location.Latitude.value_native();
+  entry.longitude = (double)waypoint.Location.Longitude.value_native();
+  entry.altitude = (double)waypoint.Altitude;
+  entry.flags = ExportFlags(waypoint.Flags);
+  entry.file_num = waypoint.FileNum;
+  entry.altitude_ok = altitude_ok;
+
+  AddString(new_strings, waypoint.Name,
+            entry.name_offset, entry.name_length);
+  AddString(new_strings, waypoint.Comment,
+            entry.comment_offset, entry.comment_length);
+  AddString(new_strings, waypoint.Details,
+            entry.details_offset, entry.details_length);
+
+  new_entries.push_back(entry);
+}
+
+bool
+WayPointSnapshot::save(FILE *file) const
+{
+  long base = ftell(file);
+  if (base < 0)
+    return false;
+
+  static const char zero[SNAPSHOT_ALIGNMENT] = { 0 };
+  const size_t padding = AlignSnapshotOffset(base) - base;
+  if (padding > 0 && fwrite(zero, 1, padding, file) != padding)
+    return false;
+
+  WayPointSnapshotHeader header;
+  header.version = WayPointSnapshotHeader::VERSION;
+  header.char_size = sizeof(TCHAR);
+  header.num_waypoints = new_entries.size();
+  header.num_strings = new_strings.size();
+
+  return fwrite(&header, sizeof(header), 1, file) == 1 &&
+    (new_entries.empty() ||
+     fwrite(&new_entries[0], sizeof(new_entries[0]), new_entries.size(),
+            file) == new_entries.size()) &&
+    (new_strings.empty() ||
+     fwrite(&new_strings[0], sizeof(new_strings[0]), new_strings.size(),
+            file) == new_strings.size());
+}
+
+bool
+WayPointSnapshot::load(const FileMapping &mapping, size_t offset)
+{
+  offset = AlignSnapshotOffset(offset);
+  if (mapping.size() < offset + sizeof(WayPointSnapshotHeader))
+    return false;
+
+  const WayPointSnapshotHeader &header =
+    *(const WayPointSnapshotHeader *)mapping.at(offset);
+  if (header.version != WayPointSnapshotHeader::VERSION ||
+      header.char_size != sizeof(TCHAR))
+    return false;
+
+  /* divide instead of multiplying the counts from the file, which
+     could overflow on 32 bit machines */
+  size_t available = mapping.size() - offset - sizeof(header);
+  if (header.num_waypoints > available / sizeof(Entry))
+    return false;
+
+  available -= header.num_waypoints * sizeof(Entry);
+  if (header.num_strings > available / sizeof(TCHAR))
+    return false;
+
+  const Entry *_entries = (const Entry *)(&header + 1);
+  for (unsigned i = 0; i < header.num_waypoints; ++i) {
+    const Entry &entry = _entries[i];
+    if (!CheckString(entry.name_offset, entry.name_length,
+                     header.num_strings) ||
+        !CheckString(entry.comment_offset, entry.comment_length,
+                     header.num_strings) ||
+        !CheckString(entry.details_offset, entry.details_length,
+                     header.num_strings))
+      return false;
+  }
+
+  entries = _entries;
+  strings = (const TCHAR *)(entries + header.num_waypoints);
+  num_entries = header.num_waypoints;
+  return true;
+}
+
+Waypoint
+WayPointSnapshot::get(unsigned i, bool &altitude_ok_r) const
+{
+  const Entry &entry = entries[i];
+
+  Waypoint waypoint(GeoPoint(Angle::native(fixed(entry.longitude)),
+                             Angle::native(fixed(entry.latitude))));
+  waypoint.Altitude = fixed(entry.altitude);
+  ImportFlags(waypoint.Flags, entry.flags);
+  waypoint.FileNum = entry.file_num;
+  waypoint.Name.assign(strings + entry.name_offset, entry.name_length);
+  waypoint.Comment.assign(strings + entry.comment_offset,
+                          entry.comment_length);
+  waypoint.Details.assign(strings + entry.details_offset,
+                          entry.details_length);
+
+  altitude_ok_r = entry.altitude_ok != 0;
+  return waypoint;
+}
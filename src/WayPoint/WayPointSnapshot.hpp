@@ -0,0 +1,110 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_WAY_POINT_SNAPSHOT_HPP
+#define XCSOAR_WAY_POINT_SNAPSHOT_HPP
+
+#include "Engine/Waypoint/Waypoint.hpp"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <tchar.h>
+#include <vector>
+
+class FileMapping;
+
+/**
+ * A binary snapshot of the waypoints of one file, which can be
+ * loaded without parsing the file.  Altitudes are stored as they were
+ * parsed; waypoints without a valid altitude are looked up in the
+ * terrain again when the snapshot is loaded.
+ */
+class WayPointSnapshot {
+public:
+  struct Entry {
+    double latitude, longitude, altitude;
+
+    unsigned flags;
+    int file_num;
+
+    /** the strings in the string table */
+    unsigned name_offset, name_length;
+    unsigned comment_offset, comment_length;
+    unsigned details_offset, details_length;
+
+    /** did the file contain a valid altitude? */
+    unsigned altitude_ok;
+
+    unsigned reserved;
+  };
+
+private:
+  /** entries and strings of a new snapshot */
+  std::vector<Entry> new_entries;
+  std::vector<TCHAR> new_strings;
+
+  /** entries and strings of a loaded snapshot */
+  const Entry *entries;
+  const TCHAR *strings;
+  unsigned num_entries;
+
+public:
+  WayPointSnapshot():entries(NULL), strings(NULL), num_entries(0) {}
+
+  /**
+   * Adds a waypoint to a new snapshot.
+   *
+   * @param altitude_ok false if the altitude of the waypoint is to be
+   * looked up in the terrain
+   */
+  void add(const Waypoint &waypoint, bool altitude_ok);
+
+  /**
+   * Writes the new snapshot to the specified file, which is
+   * positioned after the FileCache header.
+   */
+  bool save(FILE *file) const;
+
+  /**
+   * Checks a snapshot in the specified mapping, and prepares get().
+   * The mapping must remain valid while get() is used.
+   *
+   * @param offset the position of the snapshot in the mapping
+   * @return false if the snapshot is malformed
+   */
+  bool load(const FileMapping &mapping, size_t offset);
+
+  /**
+   * Returns the number of waypoints in the loaded snapshot.
+   */
+  unsigned size() const {
+    return num_entries;
+  }
+
+  /**
+   * Returns a waypoint of the loaded snapshot.
+   */
+  Waypoint get(unsigned i, bool &altitude_ok_r) const;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compares the SIMD slope shading kernel with the scalar reference
+ * on a synthetic height matrix of the size used on 800x480 screens.
+ */
+
+#include "Terrain/SlopeShading.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+static const unsigned width = 400, height = 240;
+
+static void
+FillHeights(std::vector<short> &heights)
+{
+  heights.resize(width * height);
+  for (unsigned y = 0; y < height; ++y) {
+    for (unsigned x = 0; x < width; ++x) {
+      short h = (short)(800 + 600 * sin(x * 0.05) * cos(y * 0.07)
+                        + 50 * sin(x * 0.9 + y * 1.3));
+
+      if ((x - 300) * (x - 300) + (y - 60) * (y - 60) < 900)
+        /* a lake */
+        h = 0;
+      else if (y >= 220 && x < 50)
+        /* outside the terrain file */
+        h = -32768;
+
+      heights[y * width + x] = h;
+    }
+  }
+}
+
+typedef void (SlopeShading::*ShadeRowFunction)(const short *row,
+                                               const short *above,
+                                               const short *below,
+                                               unsigned width, unsigned step,
+                                               unsigned row_span,
+                                               signed char *dest) const;
+
+static void
+ShadeImage(const SlopeShading &shading, ShadeRowFunction function,
+           const std::vector<short> &heights, unsigned step,
+           std::vector<signed char> &result)
+{
+  result.resize(width * height);
+
+  for (unsigned y = 0; y < height; ++y) {
+    const unsigned plus = y + step < height ? step : height - 1 - y;
+    const unsigned minus = y >= step ? step : y;
+    const short *row = &heights[y * width];
+
+    (shading.*function)(row, row - minus * width, row + plus * width,
+                        width, step, plus + minus, &result[y * width]);
+  }
+}
+
+static double
+BenchmarkImage(const SlopeShading &shading, ShadeRowFunction function,
+               const std::vector<short> &heights, unsigned step,
+               std::vector<signed char> &result)
+{
+  const unsigned n = 500;
+
+  clock_t t0 = clock();
+  for (unsigned i = 0; i < n; ++i)
+    ShadeImage(shading, function, heights, step, result);
+  clock_t t1 = clock();
+
+  return (double)(t1 - t0) * 1000000 / CLOCKS_PER_SEC / n;
+}
+
+int
+main(int argc, char **argv)
+{
+  std::vector<short> heights;
+  FillHeights(heights);
+
+  const SlopeShading shading(-150, -150, 148, 192, 250);
+
+  int max_difference = 0;
+
+  for (unsigned step = 1; step <= 3; ++step) {
+    std::vector<signed char> scalar, vector;
+
+    const double scalar_us =
+      BenchmarkImage(shading, &SlopeShading::ShadeRowScalar,
+                     heights, step, scalar);
+    const double vector_us =
+      BenchmarkImage(shading, &SlopeShading::ShadeRow,
+                     heights, step, vector);
+
+    unsigned differences = 0;
+    for (unsigned i = 0; i < scalar.size(); ++i) {
+      const int d = abs(scalar[i] - vector[i]);
+      if (d > 0)
+        ++differences;
+      if (d > max_difference)
+        max_difference = d;
+    }
+
+    printf("step %u: scalar %.0f us, kernel %.0f us (%.1fx), "
+           "%u of %u pixels differ\n",
+           step, scalar_us, vector_us, scalar_us / vector_us,
+           differences, (unsigned)scalar.size());
+  }
+
+  printf("max difference %d\n", max_difference);
+  return EXIT_SUCCESS;
+}
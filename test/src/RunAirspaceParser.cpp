@@ -24,30 +24,54 @@ Copyright_License {
 #include "Airspace/AirspaceParser.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "IO/FileLineReader.hpp"
+#include "IO/FileCache.hpp"
+#include "PeriodClock.hpp"
 
 #include <stdio.h>
 #include <tchar.h>
 
 int main(int argc, char **argv)
 {
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s PATH\n", argv[0]);
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "Usage: %s PATH [CACHE_DIR]\n", argv[0]);
     return 1;
   }
 
   Airspaces airspaces;
 
-  FileLineReader reader(argv[1]);
-  if (reader.error()) {
-    fprintf(stderr, "Failed to open input file\n");
-    return 1;
-  }
+  PeriodClock clock;
+  clock.update();
 
-  if (!ReadAirspace(airspaces, reader)) {
-    fprintf(stderr, "Failed to parse input file\n");
-    return 1;
+  if (argc == 3) {
+    /* load the snapshot from the cache, or create it */
+    FileCache cache(argv[2]);
+    if (!ReadAirspace(airspaces, argv[1], cache, _T("airspace"))) {
+      fprintf(stderr, "Failed to parse input file\n");
+      return 1;
+    }
+  } else {
+    FileLineReader reader(argv[1]);
+    if (reader.error()) {
+      fprintf(stderr, "Failed to open input file\n");
+      return 1;
+    }
+
+    if (!ReadAirspace(airspaces, reader)) {
+      fprintf(stderr, "Failed to parse input file\n");
+      return 1;
+    }
   }
 
+  const int parse_time = clock.elapsed();
+  clock.update();
+
+  airspaces.optimise();
+
+  const int optimise_time = clock.elapsed();
+
+  printf("# %u airspaces\n", (unsigned)airspaces.size());
+  printf("# parse time %d ms\n", parse_time);
+  printf("# optimise time %d ms\n", optimise_time);
   printf("OK\n");
 
   return 0;
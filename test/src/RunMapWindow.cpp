@@ -187,11 +187,11 @@ static void
 LoadFiles()
 {
   topology = new TopologyStore();
-  LoadConfiguredTopology(*topology);
+  LoadConfiguredTopology(*topology, NULL);
 
   terrain = RasterTerrain::OpenTerrain(NULL);
 
-  WayPointGlue::ReadWaypoints(way_points, terrain);
+  WayPointGlue::ReadWaypoints(way_points, terrain, NULL);
 
   TLineReader *reader = OpenConfiguredTextFile(szProfileAirspaceFile);
   if (reader != NULL) {
@@ -0,0 +1,121 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "IO/FileLineReader.hpp"
+#include "TestUtil.hpp"
+
+static const TCHAR *const path = _T("test/data/AirspaceAus-DAA.txt");
+
+static bool
+ReadFile(Airspaces &airspaces, unsigned num_chunks)
+{
+  FileLineReader reader(path);
+  if (reader.error() || !ReadAirspace(airspaces, reader, num_chunks))
+    return false;
+
+  airspaces.optimise();
+  return true;
+}
+
+static bool
+Equals(const AIRSPACE_ALT &a, const AIRSPACE_ALT &b)
+{
+  return a.Altitude == b.Altitude && a.FL == b.FL && a.AGL == b.AGL &&
+    a.Base == b.Base;
+}
+
+static bool
+Equals(const AbstractAirspace &a, const AbstractAirspace &b)
+{
+  if (a.shape != b.shape || a.get_type() != b.get_type() ||
+      a.get_name_text(true) != b.get_name_text(true) ||
+      !Equals(a.get_base(), b.get_base()) ||
+      !Equals(a.get_top(), b.get_top()))
+    return false;
+
+  if (a.shape == AbstractAirspace::CIRCLE) {
+    const AirspaceCircle &ca = (const AirspaceCircle &)a;
+    const AirspaceCircle &cb = (const AirspaceCircle &)b;
+    return ca.get_center() == cb.get_center() &&
+      ca.get_radius() == cb.get_radius();
+  }
+
+  const SearchPointVector &pa = ((const AirspacePolygon &)a).get_points();
+  const SearchPointVector &pb = ((const AirspacePolygon &)b).get_points();
+  if (pa.size() != pb.size())
+    return false;
+
+  for (unsigned i = 0; i < pa.size(); ++i)
+    if (!(pa[i].get_location() == pb[i].get_location()))
+      return false;
+
+  return true;
+}
+
+/**
+ * Compares two airspace databases, including the order in which the
+ * airspaces have been inserted.
+ */
+static bool
+Equals(const Airspaces &a, const Airspaces &b)
+{
+  Airspaces::AirspaceTree::const_iterator i = a.begin(), j = b.begin();
+  for (; i != a.end() && j != b.end(); ++i, ++j)
+    if (!Equals(*i->get_airspace(), *j->get_airspace()))
+      return false;
+
+  return i == a.end() && j == b.end();
+}
+
+/**
+ * Parses the file in several chunks, and compares the result with
+ * the serial parser.
+ */
+static void
+TestChunked(const Airspaces &serial, unsigned num_chunks)
+{
+  Airspaces airspaces;
+  ok1(ReadFile(airspaces, num_chunks));
+  ok1(airspaces.size() == serial.size());
+  ok1(Equals(airspaces, serial));
+}
+
+int main(int argc, char **argv)
+{
+  static const unsigned num_chunks[] = { 2, 7, 64, 0 };
+  static const unsigned n = sizeof(num_chunks) / sizeof(num_chunks[0]);
+
+  plan_tests(2 + 3 * n);
+
+  Airspaces serial;
+  ok1(ReadFile(serial, 1));
+  ok1(serial.size() > 0);
+
+  for (unsigned i = 0; i < n; ++i)
+    TestChunked(serial, num_chunks[i]);
+
+  return exit_status();
+}
@@ -0,0 +1,250 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Task/Tasks/PathSolvers/ContestCandidates.hpp"
+#include "Trace/Trace.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "TestUtil.hpp"
+
+#include <limits.h>
+#include <math.h>
+#include <vector>
+
+/** start time of the flight (s) */
+static const unsigned t_start = 36000;
+
+/**
+ * Generates a flight which alternates between cruising eastwards and
+ * circling in thermals, so the candidate set sees both widely spaced
+ * points and points which are too close to be kept.
+ */
+static AIRCRAFT_STATE
+MakeState(unsigned i)
+{
+  /* even phases are cruising, odd phases are circling */
+  const unsigned phase = i / 120, t = i % 120;
+  const unsigned cruise = (phase + 1) / 2 * 120 + (phase % 2 == 0 ? t : 0);
+
+  double lon = 7 + cruise * 0.0005;
+  double lat = 51 + sin(phase * 0.7) * 0.01;
+  double alt = 1000 + (phase % 2 == 0 ? -(double)t : (double)t) * 2;
+  if (phase % 2 == 1) {
+    /* circling with a period of 30 s */
+    const double angle = t * 2 * M_PI / 30;
+    lon += sin(angle) * 0.002;
+    lat += (1 - cos(angle)) * 0.0013;
+  }
+
+  AIRCRAFT_STATE state;
+  state.Location = GeoPoint(Angle::degrees(fixed(lon)),
+                            Angle::degrees(fixed(lat)));
+  state.NavAltitude = fixed(alt);
+  state.AltitudeAGL = fixed(alt);
+  state.Speed = fixed(35);
+  state.Time = fixed(t_start + i);
+  state.Flying = true;
+  return state;
+}
+
+/**
+ * Compares the distance matrix with the distances calculated from
+ * scratch.
+ */
+static bool
+CheckDistances(const ContestCandidates &candidates)
+{
+  for (unsigned i = 0; i < candidates.size(); ++i) {
+    const TracePoint &a = candidates.get_point(i);
+    for (unsigned j = 0; j < candidates.size(); ++j) {
+      const unsigned expected =
+        std::min(a.flat_distance(candidates.get_point(j)),
+                 (unsigned)USHRT_MAX);
+      if (candidates.get_distance(i, j) != expected)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Checks that all candidates are points of the flight, in time order,
+ * that none of them has expired from the master trace, and that the
+ * last one is the latest point of the master trace.
+ */
+static bool
+CheckPoints(const ContestCandidates &candidates, const Trace &trace)
+{
+  const unsigned n = candidates.size();
+  if (n == 0 || n > 350)
+    return false;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const TracePoint &point = candidates.get_point(i);
+    if (i > 0 && point.time <= candidates.get_point(i - 1).time)
+      return false;
+
+    const AIRCRAFT_STATE state = MakeState(point.time - t_start);
+    if (!(point.get_location() == state.Location))
+      return false;
+  }
+
+  return candidates.get_point(0).time >= trace.begin()->time &&
+    candidates.get_point(n - 1).time == trace.get_last_point().time;
+}
+
+static bool
+SamePoint(const TracePoint &a, const TracePoint &b)
+{
+  return a.time == b.time && a.get_location() == b.get_location();
+}
+
+/**
+ * Checks that the points before first_changed() are the same as in
+ * the previous version of the set.
+ */
+static bool
+CheckUnchanged(const ContestCandidates &candidates,
+               const TracePointVector &before, unsigned before_version)
+{
+  const unsigned first = candidates.first_changed(before_version);
+  if (first > candidates.size() || first > before.size())
+    return false;
+
+  for (unsigned i = 0; i < first; ++i)
+    if (!SamePoint(candidates.get_point(i), before[i]))
+      return false;
+
+  /* the points from first_changed() on are newer than that version */
+  return first == candidates.size() ||
+    candidates.first_changed(candidates.get_version()) == candidates.size();
+}
+
+/**
+ * Compares the set with one built from scratch.
+ */
+static bool
+SameSet(const ContestCandidates &a, const ContestCandidates &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (unsigned i = 0; i < a.size(); ++i) {
+    if (!SamePoint(a.get_point(i), b.get_point(i)))
+      return false;
+
+    for (unsigned j = 0; j < i; ++j)
+      if (a.get_distance(i, j) != b.get_distance(i, j))
+        return false;
+  }
+
+  return true;
+}
+
+static TracePointVector
+CopyPoints(const ContestCandidates &candidates)
+{
+  TracePointVector points;
+  for (unsigned i = 0; i < candidates.size(); ++i)
+    points.push_back(candidates.get_point(i));
+  return points;
+}
+
+/**
+ * Feeds the flight into the master trace, and checks the candidate
+ * set after each update.
+ *
+ * @param max_time the time window of the master trace, which prunes
+ * old points
+ */
+static void
+TestFlight(unsigned duration, unsigned max_time)
+{
+  Trace trace(max_time, 300, 1000);
+  ContestCandidates candidates(trace);
+
+  unsigned updates = 0, appends = 0, rebuilds = 0;
+  unsigned bad_version = 0, bad_points = 0, bad_distances = 0,
+    bad_unchanged = 0;
+
+  for (unsigned i = 0; i < duration; ++i) {
+    trace.append(MakeState(i));
+
+    const unsigned before_version = candidates.get_version();
+    const TracePointVector before = CopyPoints(candidates);
+    if (!candidates.update()) {
+      if (candidates.get_version() != before_version)
+        ++bad_version;
+      continue;
+    }
+
+    ++updates;
+    if (candidates.get_version() != before_version + 1)
+      ++bad_version;
+
+    if (candidates.first_changed(before_version) == 0)
+      ++rebuilds;
+    else
+      ++appends;
+
+    if (!CheckPoints(candidates, trace))
+      ++bad_points;
+    if (!CheckDistances(candidates))
+      ++bad_distances;
+    if (!CheckUnchanged(candidates, before, before_version))
+      ++bad_unchanged;
+  }
+
+  ok1(updates > 0 && appends > 0 && rebuilds > 1);
+  ok1(bad_version == 0);
+  ok1(bad_points == 0);
+  ok1(bad_distances == 0);
+  ok1(bad_unchanged == 0);
+
+  /* a brute-force rebuild from the same trace */
+  ContestCandidates fresh(trace);
+  ok1(fresh.update());
+  ok1(CheckPoints(fresh, trace) && CheckDistances(fresh));
+
+  /* after a reset, the set is rebuilt from the trace */
+  candidates.reset();
+  ok1(candidates.size() == 0 && candidates.get_version() == 0);
+  ok1(candidates.update());
+  ok1(candidates.get_version() == 1);
+  ok1(SameSet(candidates, fresh));
+
+  /* nothing changes without new points */
+  ok1(!candidates.update());
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 * 12);
+
+  /* the master trace is only thinned */
+  TestFlight(2 * 3600, Trace::null_time);
+
+  /* old points expire from the master trace */
+  TestFlight(2 * 3600, 1800);
+
+  return exit_status();
+}
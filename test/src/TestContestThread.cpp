@@ -0,0 +1,258 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ContestThread.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Task/TaskEvents.hpp"
+#include "Task/Tasks/ContestManager.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "PeriodClock.hpp"
+#include "OS/Sleep.h"
+#include "TestUtil.hpp"
+
+/**
+ * Exposes tick(), so the work of the thread can be done
+ * synchronously.
+ */
+class SyncContestThread : public ContestThread {
+public:
+  SyncContestThread(ProtectedTaskManager &task_manager)
+    :ContestThread(task_manager) {}
+
+  void run_tick() {
+    tick();
+  }
+};
+
+/**
+ * Feeds a flight zigzagging eastwards into the task manager.
+ *
+ * @param state the aircraft state, which is advanced
+ * @param duration the duration of the flight (s)
+ */
+static void
+Fly(TaskManager &task_manager, AIRCRAFT_STATE &state, unsigned duration)
+{
+  for (unsigned i = 0; i < duration; ++i) {
+    const AIRCRAFT_STATE state_last = state;
+
+    state.Time += fixed_one;
+    state.Location.Longitude += Angle::degrees(fixed(0.0005));
+    state.Location.Latitude += Angle::degrees(fixed((i / 120) % 2 == 0
+                                                    ? 0.0003 : -0.0003));
+
+    task_manager.update(state, state_last);
+    task_manager.update_idle(state);
+  }
+}
+
+static AIRCRAFT_STATE
+MakeState()
+{
+  AIRCRAFT_STATE state;
+  state.Location = GeoPoint(Angle::degrees(fixed(7)),
+                            Angle::degrees(fixed(51)));
+  state.NavAltitude = fixed(1000);
+  state.AltitudeAGL = fixed(1000);
+  state.Speed = fixed(35);
+  state.Time = fixed(36000);
+  state.Flying = true;
+  return state;
+}
+
+/**
+ * Solves the contest synchronously on copies of the task manager's
+ * traces.
+ */
+static ContestResult
+Solve(const TaskManager &task_manager)
+{
+  Trace full, sprint;
+  task_manager.copy_contest_traces(full, sprint);
+
+  const TaskBehaviour &behaviour = task_manager.get_task_behaviour();
+  unsigned handicap = behaviour.contest_handicap;
+  ContestResult result;
+  ContestManager contest_manager(behaviour.contest, handicap, result,
+                                 full, sprint);
+  do {
+    contest_manager.update_idle();
+  } while (contest_manager.is_searching());
+
+  return result;
+}
+
+static bool
+SameResult(const ContestResult &a, const ContestResult &b)
+{
+  return a.score == b.score && a.distance == b.distance &&
+    a.time == b.time;
+}
+
+/**
+ * A result found in traces copied before a reset must not be
+ * published after the reset.
+ */
+static void
+TestResetRace()
+{
+  Waypoints waypoints;
+  TaskEvents events;
+  TaskManager task_manager(events, waypoints);
+  task_manager.set_contest_background(true);
+  task_manager.get_task_behaviour().enable_olc = true;
+  task_manager.get_task_behaviour().contest = OLC_Classic;
+  task_manager.set_contest(OLC_Classic);
+
+  AIRCRAFT_STATE state = MakeState();
+  Fly(task_manager, state, 600);
+
+  const unsigned reset_serial = task_manager.get_contest_reset_serial();
+  const ContestResult result = Solve(task_manager);
+  ok1(positive(result.score));
+
+  TracePointVector solution;
+  solution.push_back(task_manager.get_trace().get_last_point());
+
+  /* the solver finishes after the task manager was reset */
+  task_manager.reset();
+  task_manager.set_contest_result(result, solution, reset_serial);
+  ok1(!positive(task_manager.get_common_stats().olc.score));
+  ok1(task_manager.get_contest_solution().empty());
+
+  /* a result for the current traces is accepted */
+  task_manager.set_contest_result(result, solution,
+                                  task_manager.get_contest_reset_serial());
+  ok1(SameResult(task_manager.get_common_stats().olc, result));
+  ok1(task_manager.get_contest_solution().size() == 1);
+}
+
+static void
+TestTick()
+{
+  Waypoints waypoints;
+  TaskEvents events;
+  TaskManager task_manager(events, waypoints);
+  task_manager.set_contest_background(true);
+  task_manager.get_task_behaviour().enable_olc = true;
+  task_manager.get_task_behaviour().contest = OLC_Classic;
+  task_manager.set_contest(OLC_Classic);
+
+  TaskBehaviour task_behaviour;
+  TaskEvents task_events;
+  ProtectedTaskManager protected_task_manager(task_manager, task_behaviour,
+                                              task_events);
+  SyncContestThread thread(protected_task_manager);
+
+  AIRCRAFT_STATE state = MakeState();
+  Fly(task_manager, state, 600);
+
+  /* nothing is solved after landing */
+  AIRCRAFT_STATE landed = state;
+  landed.Flying = false;
+  task_manager.update_idle(landed);
+  thread.run_tick();
+  ok1(!positive(task_manager.get_common_stats().olc.score));
+
+  /* nothing is solved with contests disabled */
+  task_manager.update_idle(state);
+  task_manager.get_task_behaviour().enable_olc = false;
+  thread.run_tick();
+  ok1(!positive(task_manager.get_common_stats().olc.score));
+  task_manager.get_task_behaviour().enable_olc = true;
+
+  thread.run_tick();
+  const ContestResult first = Solve(task_manager);
+  ok1(positive(first.score));
+  ok1(SameResult(task_manager.get_common_stats().olc, first));
+  ok1(!task_manager.get_contest_solution().empty());
+
+  /* the flight goes on */
+  Fly(task_manager, state, 300);
+  thread.run_tick();
+  const ContestResult second = Solve(task_manager);
+  ok1(second.score > first.score);
+  ok1(SameResult(task_manager.get_common_stats().olc, second));
+
+  /* after a reset, the thread starts over with the new flight */
+  task_manager.reset();
+  state = MakeState();
+  Fly(task_manager, state, 200);
+  thread.run_tick();
+  const ContestResult third = Solve(task_manager);
+  ok1(positive(third.score) && third.score < first.score);
+  ok1(SameResult(task_manager.get_common_stats().olc, third));
+}
+
+static void
+TestThread()
+{
+  Waypoints waypoints;
+  TaskEvents events;
+  TaskManager task_manager(events, waypoints);
+  task_manager.set_contest_background(true);
+  task_manager.get_task_behaviour().enable_olc = true;
+  task_manager.get_task_behaviour().contest = OLC_Sprint;
+  task_manager.set_contest(OLC_Sprint);
+
+  TaskBehaviour task_behaviour;
+  TaskEvents task_events;
+  ProtectedTaskManager protected_task_manager(task_manager, task_behaviour,
+                                              task_events);
+  ContestThread thread(protected_task_manager);
+  thread.start();
+
+  {
+    ProtectedTaskManager::ExclusiveLease lease(protected_task_manager);
+    AIRCRAFT_STATE state = MakeState();
+    Fly(lease, state, 600);
+  }
+
+  thread.trigger();
+
+  ContestResult result;
+  PeriodClock clock;
+  clock.update();
+  do {
+    Sleep(10);
+
+    ProtectedTaskManager::Lease lease(protected_task_manager);
+    result = lease->get_common_stats().olc;
+  } while (!positive(result.score) && !clock.check(30000));
+
+  thread.stop();
+  thread.join();
+
+  ok1(positive(result.score));
+  ok1(SameResult(result, Solve(task_manager)));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(5 + 9 + 2);
+
+  TestResetRace();
+  TestTick();
+  TestThread();
+
+  return exit_status();
+}
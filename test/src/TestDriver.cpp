@@ -25,11 +25,18 @@
 #include "Device/Driver/ILEC.hpp"
 #include "Device/Driver.hpp"
 #include "Device/Parser.hpp"
+#include "Device/device.hpp"
+#include "Device/Geoid.h"
 #include "NMEA/Info.hpp"
+#include "NMEA/InputLine.hpp"
+#include "InputEvents.hpp"
 #include "TestUtil.hpp"
 #include "Protection.hpp"
 
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdio.h>
 
 static bool vario_updated;
 
@@ -40,8 +47,28 @@ void TriggerVarioUpdate()
   vario_updated = true;
 }
 
+void TriggerGPSUpdate() {}
+
 bool
-NMEAParser::NMEAChecksum(const char *p)
+devHasBaroSource()
+{
+  return false;
+}
+
+bool
+HaveCondorDevice()
+{
+  return false;
+}
+
+fixed
+LookupGeoidSeparation(const GeoPoint pt)
+{
+  return fixed_zero;
+}
+
+bool
+InputEvents::processGlideComputer(unsigned gce_id)
 {
   return true;
 }
@@ -52,6 +79,75 @@ Declaration::size() const
   return 0;
 }
 
+static void
+TestGeneric()
+{
+  NMEAParser parser;
+
+  NMEA_INFO nmea_info;
+  memset(&nmea_info, 0, sizeof(nmea_info));
+
+  /* bad checksum */
+  ok1(!parser.ParseNMEAString_Internal("$GPRMC,082310,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.3,W*6C",
+                                       &nmea_info));
+
+  /* no checksum */
+  ok1(!parser.ParseNMEAString_Internal("$GPRMC,082310,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.3,W",
+                                       &nmea_info));
+
+  /* unknown sentence */
+  ok1(!parser.ParseNMEAString_Internal("$GPXYZ,1,2,3*50", &nmea_info));
+
+  ok1(parser.ParseNMEAString_Internal("$GPRMC,082310,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.3,W*6D",
+                                      &nmea_info));
+  ok1(!nmea_info.gps.NAVWarning);
+  ok1(equals(nmea_info.Location.Latitude, 51.059005));
+  ok1(equals(nmea_info.Location.Longitude, 7.69290));
+  ok1(equals(nmea_info.GroundSpeed, 055.3 * 1.852 / 3.6));
+  ok1(equals(nmea_info.TrackBearing, 22.4));
+  ok1(nmea_info.DateTime.year == 2010);
+  ok1(nmea_info.DateTime.month == 6);
+  ok1(nmea_info.DateTime.day == 23);
+  ok1(nmea_info.DateTime.hour == 8);
+  ok1(nmea_info.DateTime.minute == 23);
+  ok1(nmea_info.DateTime.second == 10);
+
+  ok1(parser.ParseNMEAString_Internal("$PGRMZ,2447,F,2*0F", &nmea_info));
+  ok1(nmea_info.BaroAltitudeAvailable);
+  ok1(equals(nmea_info.BaroAltitude, 745.8456));
+
+  /* a buffer with several lines, the last one incomplete */
+  static const char buffer[] =
+    "$GPRMC,082311,A,5103.5500,S,00741.5742,W,055.3,022.4,230610,000.3,W*61\r\n"
+    "garbage\n"
+    "$PGRMZ,1000,m,3*21\r\n"
+    "$GPRMC,0823";
+  ok1(parser.ParseNMEABuffer(buffer, sizeof(buffer) - 1, &nmea_info) ==
+      sizeof(buffer) - 1 - strlen("$GPRMC,0823"));
+  ok1(nmea_info.DateTime.second == 11);
+  ok1(equals(nmea_info.Location.Latitude, -51.059167));
+  ok1(equals(nmea_info.Location.Longitude, -7.69290));
+  ok1(equals(nmea_info.BaroAltitude, 1000));
+}
+
+static void
+TestInputLine()
+{
+  NMEAInputLine line("12,-34,1234567890123,9999999999999999999,"
+                     "-99999999999999999999999,x,56*00");
+  ok1(line.read(0L) == 12);
+  ok1(line.read(0L) == -34);
+
+  /* numbers which may not fit into a long are clamped like
+     strtol() does */
+  ok1(line.read(0L) == strtol("1234567890123", NULL, 10));
+  ok1(line.read(0L) == LONG_MAX);
+  ok1(line.read(0L) == LONG_MIN);
+
+  ok1(line.read(-1L) == -1);
+  ok1(line.read(0L) == 56);
+}
+
 static void
 TestCAI302()
 {
@@ -146,13 +242,94 @@ TestILEC()
   delete device;
 }
 
+static bool
+ParsePFLAA(NMEAParser &parser, NMEA_INFO &nmea_info, unsigned id)
+{
+  char line[64];
+  sprintf(line, "$PFLAA,0,100,-200,50,2,%06X,90,0,30,1.5,1*00", id);
+  return parser.ParseNMEAString_Internal(line, &nmea_info);
+}
+
+static void
+TestFLARM()
+{
+  const unsigned n = FLARM_STATE::FLARM_MAX_TRAFFIC;
+
+  NMEAParser parser;
+
+  NMEA_INFO nmea_info;
+  memset(&nmea_info, 0, sizeof(nmea_info));
+  nmea_info.flarm.FLARM_Available = true;
+  const FLARM_STATE &flarm = nmea_info.flarm;
+
+  /* fill the table */
+  nmea_info.Time = fixed(100);
+  bool parsed = true;
+  for (unsigned i = 0; i < n; ++i)
+    parsed = ParsePFLAA(parser, nmea_info, 0x100 + i) && parsed;
+  ok1(parsed);
+  ok1(flarm.GetActiveTrafficCount() == n);
+
+  FlarmId id;
+  id.parse("000100", NULL);
+  const FLARM_TRAFFIC *traffic = flarm.FindTraffic(id);
+  ok1(traffic != NULL && traffic->ID == id);
+  ok1(traffic != NULL && equals(traffic->RelativeEast, -200));
+
+  /* update the first target, then add one more: the second one,
+     which has not been updated for the longest time, is evicted */
+  nmea_info.Time = fixed(101);
+  ParsePFLAA(parser, nmea_info, 0x100);
+  ParsePFLAA(parser, nmea_info, 0x200);
+  ok1(flarm.GetActiveTrafficCount() == n);
+  ok1(flarm.FindTraffic(id) != NULL);
+  id.parse("000101", NULL);
+  ok1(flarm.FindTraffic(id) == NULL);
+  id.parse("000200", NULL);
+  ok1(flarm.FindTraffic(id) != NULL);
+
+  /* only the targets updated recently survive a refresh */
+  nmea_info.Time = fixed(103);
+  for (unsigned i = 0; i < 10; ++i)
+    ParsePFLAA(parser, nmea_info, 0x300 + i);
+  nmea_info.flarm.Refresh(nmea_info.Time);
+  ok1(flarm.GetActiveTrafficCount() == 12);
+  ok1(flarm.FLARMTraffic);
+
+  unsigned found = 0;
+  for (unsigned i = 0; i < 10; ++i) {
+    char buffer[8];
+    sprintf(buffer, "%06X", 0x300 + i);
+    id.parse(buffer, NULL);
+    if (flarm.FindTraffic(id) != NULL)
+      ++found;
+  }
+  ok1(found == 10);
+
+  id.parse("000105", NULL);
+  ok1(flarm.FindTraffic(id) == NULL);
+
+  /* time going backwards clears the table */
+  nmea_info.flarm.Refresh(fixed(50));
+  ok1(flarm.GetActiveTrafficCount() == 0);
+  ok1(!flarm.FLARMTraffic);
+  ok1(flarm.FirstTraffic() == NULL);
+}
+
 int main(int argc, char **argv)
 {
-  plan_tests(37);
+  plan_tests(82);
+
+  TestGeneric();
+  TestInputLine();
+
+  /* the driver tests don't have valid checksums */
+  NMEAParser::ignore_checksum = true;
 
   TestCAI302();
   TestLX();
   TestILEC();
+  TestFLARM();
 
   return exit_status();
 }
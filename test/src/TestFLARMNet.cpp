@@ -0,0 +1,107 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "FLARM/FLARMNet.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
+#include "TestUtil.hpp"
+
+static const TCHAR *const path = _T("test/data/flarmnet.fln");
+
+static FlarmId
+ParseId(const TCHAR *input)
+{
+  FlarmId id;
+  id.parse(input, NULL);
+  return id;
+}
+
+/**
+ * Checks the contents of test/data/flarmnet.fln.
+ */
+static void
+TestDatabase(const FLARMNetDatabase &db)
+{
+  ok1(db.size() == 3);
+
+  const FLARMNetRecord *record = db.Find(ParseId(_T("3E1A00")));
+  ok1(record != NULL && _tcscmp(record->name, _T("Pilot Two")) == 0 &&
+      _tcscmp(record->airfield, _T("Bergneustadt")) == 0 &&
+      _tcscmp(record->type, _T("ASK-21")) == 0 &&
+      _tcscmp(record->reg, _T("D-1234")) == 0 &&
+      _tcscmp(record->cn, _T("TH")) == 0 &&
+      _tcscmp(record->freq, _T("123.500")) == 0);
+
+  record = db.Find(ParseId(_T("A10F3B")));
+  ok1(record != NULL && _tcscmp(record->name, _T("Pilot Three")) == 0);
+
+  ok1(db.Find(ParseId(_T("123456"))) == NULL);
+
+  /* the second record with the same id is ignored */
+  record = db.Find(ParseId(_T("DDA85C")));
+  ok1(record != NULL && _tcscmp(record->name, _T("Pilot One")) == 0);
+
+  /* of all records sharing a callsign, the lowest id wins */
+  record = db.Find(_T("TH"));
+  ok1(record != NULL && record->GetId() == ParseId(_T("3E1A00")));
+
+  record = db.Find(_T("JS"));
+  ok1(record != NULL && record->GetId() == ParseId(_T("A10F3B")));
+
+  ok1(db.Find(_T("XX")) == NULL);
+  ok1(db.Find(_T("ZZ")) == NULL);
+}
+
+static void
+TestSnapshot()
+{
+  FileCache cache(_T("output"));
+  cache.flush(_T("flarmnet"));
+
+  // the first pass parses the file and creates the snapshot, the
+  // second one loads the snapshot
+  for (unsigned pass = 0; pass < 2; ++pass) {
+    FLARMNetDatabase db;
+    ok1(db.LoadFile(path, &cache) == 3);
+    TestDatabase(db);
+
+    size_t offset;
+    FileMapping *mapping = cache.map(_T("flarmnet"), path, offset);
+    ok1(mapping != NULL);
+    delete mapping;
+  }
+
+  cache.flush(_T("flarmnet"));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(10 + 2 * 11);
+
+  FLARMNetDatabase db;
+  ok1(db.LoadFile(path) == 3);
+  TestDatabase(db);
+
+  TestSnapshot();
+
+  return exit_status();
+}
@@ -0,0 +1,181 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/GeoClip.hpp"
+#include "Geo/DouglasPeucker.hpp"
+#include "TestUtil.hpp"
+
+static GeoPoint
+MakeGeoPoint(double longitude, double latitude)
+{
+  return GeoPoint(Angle::degrees(fixed(longitude)),
+                  Angle::degrees(fixed(latitude)));
+}
+
+static bool
+equals(const GeoPoint &pt, double longitude, double latitude)
+{
+  return equals(pt.Longitude, longitude) && equals(pt.Latitude, latitude);
+}
+
+static bool
+same(const GeoPoint &a, const GeoPoint &b)
+{
+  return a.Longitude == b.Longitude && a.Latitude == b.Latitude;
+}
+
+static void
+TestClipLine()
+{
+  const GeoClip clip(GeoBounds(MakeGeoPoint(0, 10), MakeGeoPoint(10, 0)));
+
+  /* inside */
+  GeoPoint a = MakeGeoPoint(1, 1), b = MakeGeoPoint(9, 9);
+  ok1(clip.clip_line(a, b));
+  ok1(same(a, MakeGeoPoint(1, 1)));
+  ok1(same(b, MakeGeoPoint(9, 9)));
+
+  /* entering from the west */
+  a = MakeGeoPoint(-5, 5);
+  b = MakeGeoPoint(5, 5);
+  ok1(clip.clip_line(a, b));
+  ok1(equals(a, 0, 5));
+  ok1(same(b, MakeGeoPoint(5, 5)));
+
+  /* crossing two edges */
+  a = MakeGeoPoint(-1, 5);
+  b = MakeGeoPoint(5, -1);
+  ok1(clip.clip_line(a, b));
+  ok1(equals(a, 0, 4));
+  ok1(equals(b, 4, 0));
+
+  /* passing by */
+  a = MakeGeoPoint(-5, -5);
+  b = MakeGeoPoint(-1, 20);
+  ok1(!clip.clip_line(a, b));
+
+  a = MakeGeoPoint(-3, 8);
+  b = MakeGeoPoint(2, 13);
+  ok1(!clip.clip_line(a, b));
+
+  /* a rectangle spanning the date line */
+  const GeoClip clip2(GeoBounds(MakeGeoPoint(175, 10),
+                                MakeGeoPoint(-175, 0)));
+  a = MakeGeoPoint(179, 5);
+  b = MakeGeoPoint(-179, 5);
+  ok1(clip2.clip_line(a, b));
+  ok1(same(a, MakeGeoPoint(179, 5)));
+  ok1(same(b, MakeGeoPoint(-179, 5)));
+}
+
+static void
+TestClipPolygon()
+{
+  GeoClip clip(GeoBounds(MakeGeoPoint(0, 10), MakeGeoPoint(10, 0)));
+
+  /* inside */
+  const GeoPoint inside[] = {
+    MakeGeoPoint(1, 1), MakeGeoPoint(9, 1), MakeGeoPoint(5, 9),
+  };
+  unsigned n = 3;
+  ok1(clip.clip_polygon(inside, n) == inside);
+  ok1(n == 3);
+
+  /* outside */
+  const GeoPoint outside[] = {
+    MakeGeoPoint(11, 1), MakeGeoPoint(19, 1), MakeGeoPoint(15, 9),
+  };
+  n = 3;
+  clip.clip_polygon(outside, n);
+  ok1(n == 0);
+
+  /* overlapping the south west corner */
+  const GeoPoint corner[] = {
+    MakeGeoPoint(-5, -5), MakeGeoPoint(5, -5),
+    MakeGeoPoint(5, 5), MakeGeoPoint(-5, 5),
+  };
+  n = 4;
+  const GeoPoint *result = clip.clip_polygon(corner, n);
+  ok1(n == 4);
+  ok1(equals(result[0], 0, 0));
+  ok1(equals(result[1], 5, 0));
+  ok1(equals(result[2], 5, 5));
+  ok1(equals(result[3], 0, 5));
+
+  /* enclosing the rectangle */
+  const GeoPoint around[] = {
+    MakeGeoPoint(-5, -5), MakeGeoPoint(15, -5),
+    MakeGeoPoint(15, 15), MakeGeoPoint(-5, 15),
+  };
+  n = 4;
+  result = clip.clip_polygon(around, n);
+  ok1(n == 4);
+  ok1(equals(result[0], 0, 10));
+  ok1(equals(result[1], 0, 0));
+  ok1(equals(result[2], 10, 0));
+  ok1(equals(result[3], 10, 10));
+}
+
+static void
+TestDouglasPeucker()
+{
+  const GeoPoint points[] = {
+    MakeGeoPoint(0, 0), MakeGeoPoint(1, 0), MakeGeoPoint(2, 1),
+    MakeGeoPoint(3, 0), MakeGeoPoint(4, 0), MakeGeoPoint(5, 0),
+  };
+  unsigned char levels[6];
+  DouglasPeuckerLevels(points, 6, levels);
+
+  ok1(levels[0] == LEVEL_ALWAYS);
+  ok1(levels[5] == LEVEL_ALWAYS);
+  ok1(levels[2] > levels[1]);
+  ok1(levels[2] > levels[3]);
+
+  /* (4, 0) is on the line from (3, 0) to (5, 0) */
+  ok1(levels[4] == 0);
+
+  const fixed degree = Angle::degrees(fixed_one).value_radians();
+
+  unsigned char min_level = DouglasPeuckerMinLevel(degree / 10);
+  ok1(levels[1] >= min_level && levels[2] >= min_level &&
+      levels[3] >= min_level && levels[4] < min_level);
+
+  min_level = DouglasPeuckerMinLevel(degree * fixed(1.2));
+  ok1(levels[1] < min_level && levels[2] >= min_level &&
+      levels[3] < min_level);
+
+  min_level = DouglasPeuckerMinLevel(degree * 2);
+  ok1(levels[2] < min_level && levels[0] >= min_level &&
+      levels[5] >= min_level);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(35);
+
+  TestClipLine();
+  TestClipPolygon();
+  TestDouglasPeucker();
+
+  return exit_status();
+}
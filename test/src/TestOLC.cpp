@@ -110,9 +110,6 @@ IgcReplayGlue::on_advance(const GeoPoint &loc, const fixed speed,
 
   full_trace.append(new_state);
   sprint_trace.append(new_state);
-
-  full_trace.optimise_if_old();
-  sprint_trace.optimise_if_old();
 }
 
 void
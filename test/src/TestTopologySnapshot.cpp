@@ -0,0 +1,363 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2010 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Topology/TopologySnapshot.hpp"
+#include "OS/FileMapping.hpp"
+#include "Topology/shapelib/map.h"
+#include "Math/Constants.h"
+#include "TestUtil.hpp"
+
+#include <zzip/zzip.h>
+
+#include <algorithm>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const char *const map_path = "test/data/benalla9.xcm";
+static const TCHAR *const snapshot_path = _T("output/topology.snapshot");
+static const TCHAR *const corrupt_path = _T("output/topology.corrupt");
+
+/**
+ * The snapshot is saved behind a few bytes of junk, to check the
+ * alignment of the tables.
+ */
+static const size_t PREFIX = 5;
+
+/** the position of the snapshot header, i.e. PREFIX aligned */
+static const size_t HEADER_OFFSET = 8;
+
+/** positions of some fields in the snapshot header */
+enum {
+  HEADER_VERSION,
+  HEADER_POINT_SIZE,
+  HEADER_RADIANS,
+  HEADER_LABEL_FIELD,
+  HEADER_NUM_SHAPES,
+  HEADER_NUM_LINES,
+  HEADER_NUM_POINTS,
+};
+
+/**
+ * A shape as parsed by shapelib, in native angle units.
+ */
+struct ParsedShape {
+  rectObj bounds;
+  int type;
+  std::vector<unsigned> num_points;
+  bool has_label;
+  std::string label;
+};
+
+static double
+ToNative(double degrees)
+{
+#ifdef RADIANS
+  return degrees * DEG_TO_RAD;
+#else
+  return degrees;
+#endif
+}
+
+static rectObj
+ToNative(const rectObj &src)
+{
+  rectObj dest;
+  dest.minx = ToNative(src.minx);
+  dest.miny = ToNative(src.miny);
+  dest.maxx = ToNative(src.maxx);
+  dest.maxy = ToNative(src.maxy);
+  return dest;
+}
+
+/**
+ * Parses the shapefile like TopologyFile::build_snapshot() does, and
+ * adds all shapes to the snapshot.
+ */
+static bool
+ParseShapefile(ZZIP_DIR *dir, const char *filename, int label_field,
+               TopologySnapshot &snapshot, std::vector<ParsedShape> &parsed,
+               rectObj &bounds)
+{
+  shapefileObj shpfile;
+  if (msSHPOpenFile(&shpfile, "rb", dir, filename) == -1)
+    return false;
+
+  bounds = ToNative(shpfile.bounds);
+
+  for (int i = 0; i < shpfile.numshapes; ++i) {
+    shapeObj shape;
+    msInitShape(&shape);
+    msSHPReadShape(shpfile.hSHP, i, &shape);
+
+    const char *label = label_field >= 0
+      ? msDBFReadStringAttribute(shpfile.hDBF, i, label_field)
+      : NULL;
+
+    ParsedShape p;
+    p.bounds = ToNative(shape.bounds);
+    p.type = shape.type;
+    for (int j = 0; j < shape.numlines; ++j)
+      p.num_points.push_back(shape.line[j].numpoints);
+    p.has_label = label != NULL;
+    if (label != NULL)
+      p.label = label;
+    parsed.push_back(p);
+
+    snapshot.add(shape, label);
+    msFreeShape(&shape);
+  }
+
+  msSHPCloseFile(&shpfile);
+
+  snapshot.finish(label_field);
+  return true;
+}
+
+static bool
+CompareShapes(const TopologySnapshot &snapshot,
+              const std::vector<ParsedShape> &parsed)
+{
+  if (snapshot.size() != parsed.size())
+    return false;
+
+  for (unsigned i = 0; i < parsed.size(); ++i) {
+    const TopologySnapshot::Shape &shape = snapshot.get_shape(i);
+    const ParsedShape &p = parsed[i];
+    if (shape.type != p.type ||
+        shape.bounds.minx != p.bounds.minx ||
+        shape.bounds.miny != p.bounds.miny ||
+        shape.bounds.maxx != p.bounds.maxx ||
+        shape.bounds.maxy != p.bounds.maxy ||
+        shape.num_lines != p.num_points.size())
+      return false;
+
+    for (unsigned j = 0; j < shape.num_lines; ++j)
+      if (snapshot.get_line(shape.first_line + j).num_points !=
+          p.num_points[j])
+        return false;
+
+    /* some labels are dropped, but the others must be preserved */
+    const char *label = snapshot.get_label(shape);
+    if (label != NULL && (!p.has_label || p.label != label))
+      return false;
+  }
+
+  return true;
+}
+
+struct CollectVisitor {
+  std::vector<unsigned> &result;
+
+  CollectVisitor(std::vector<unsigned> &_result):result(_result) {}
+
+  void operator()(unsigned i) {
+    result.push_back(i);
+  }
+};
+
+/**
+ * Compares the R-tree query with a linear search over all parsed
+ * shapes.
+ */
+static bool
+CompareQuery(const TopologySnapshot &snapshot,
+             const std::vector<ParsedShape> &parsed, const rectObj &rect)
+{
+  std::vector<unsigned> expected;
+  for (unsigned i = 0; i < parsed.size(); ++i)
+    if (parsed[i].type != MS_SHAPE_NULL && !parsed[i].num_points.empty() &&
+        TopologySnapshot::overlaps(parsed[i].bounds, rect))
+      expected.push_back(i);
+
+  std::vector<unsigned> result;
+  CollectVisitor visitor(result);
+  snapshot.visit(rect, visitor);
+  std::sort(result.begin(), result.end());
+
+  return result == expected;
+}
+
+/**
+ * Runs a number of queries: the whole shapefile, a grid of small
+ * rectangles across it, and a rectangle outside of it.
+ */
+static bool
+CompareQueries(const TopologySnapshot &snapshot,
+               const std::vector<ParsedShape> &parsed, const rectObj &bounds)
+{
+  if (!CompareQuery(snapshot, parsed, bounds))
+    return false;
+
+  const unsigned n = 8;
+  const double width = (bounds.maxx - bounds.minx) / n;
+  const double height = (bounds.maxy - bounds.miny) / n;
+  for (unsigned x = 0; x < n; ++x) {
+    for (unsigned y = 0; y < n; ++y) {
+      rectObj rect;
+      rect.minx = bounds.minx + x * width;
+      rect.miny = bounds.miny + y * height;
+      rect.maxx = rect.minx + width / 3;
+      rect.maxy = rect.miny + height / 3;
+      if (!CompareQuery(snapshot, parsed, rect))
+        return false;
+    }
+  }
+
+  rectObj outside;
+  outside.minx = bounds.maxx + width;
+  outside.miny = bounds.maxy + height;
+  outside.maxx = outside.minx + width;
+  outside.maxy = outside.miny + height;
+  return CompareQuery(snapshot, parsed, outside);
+}
+
+static bool
+WriteFile(const TCHAR *path, const void *data, size_t length)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+    return false;
+
+  bool success = fwrite(data, 1, length, file) == length;
+  return fclose(file) == 0 && success;
+}
+
+static bool
+SaveSnapshot(const TopologySnapshot &snapshot)
+{
+  FILE *file = fopen(snapshot_path, "wb");
+  if (file == NULL)
+    return false;
+
+  static const char junk[PREFIX] = { 1, 2, 3, 4, 5 };
+  bool success = fwrite(junk, 1, PREFIX, file) == PREFIX &&
+    snapshot.save(file);
+  return fclose(file) == 0 && success;
+}
+
+/**
+ * Attempts to load a modified copy of the saved snapshot.
+ */
+static bool
+LoadCorrupt(const std::vector<char> &data, size_t length, int label_field)
+{
+  if (!WriteFile(corrupt_path, &data[0], length))
+    return false;
+
+  FileMapping mapping(corrupt_path);
+  if (mapping.error())
+    return false;
+
+  TopologySnapshot snapshot;
+  return snapshot.load(mapping, PREFIX, label_field);
+}
+
+static bool
+LoadWithHeader(std::vector<char> data, unsigned field, unsigned value,
+               int label_field)
+{
+  memcpy(&data[HEADER_OFFSET + field * sizeof(value)], &value, sizeof(value));
+  return LoadCorrupt(data, data.size(), label_field);
+}
+
+static void
+TestCorrupt(int label_field)
+{
+  FileMapping mapping(snapshot_path);
+  const char *p = (const char *)mapping.data();
+  const std::vector<char> data(p, p + mapping.size());
+
+  /* the unmodified copy is accepted */
+  ok1(LoadCorrupt(data, data.size(), label_field));
+
+  /* truncated */
+  ok1(!LoadCorrupt(data, HEADER_OFFSET + 4, label_field));
+  ok1(!LoadCorrupt(data, data.size() / 2, label_field));
+  ok1(!LoadCorrupt(data, data.size() - 1, label_field));
+
+  ok1(!LoadWithHeader(data, HEADER_VERSION, 0, label_field));
+  ok1(!LoadWithHeader(data, HEADER_LABEL_FIELD, label_field + 1,
+                      label_field));
+
+  /* counts whose table size would wrap around on 32 bit machines */
+  ok1(!LoadWithHeader(data, HEADER_NUM_POINTS,
+                      UINT_MAX / sizeof(pointObj) + 1, label_field));
+  ok1(!LoadWithHeader(data, HEADER_NUM_SHAPES,
+                      UINT_MAX / sizeof(TopologySnapshot::Shape) + 1,
+                      label_field));
+  ok1(!LoadWithHeader(data, HEADER_NUM_LINES, UINT_MAX, label_field));
+}
+
+static void
+TestShapefile(ZZIP_DIR *dir, const char *filename, int label_field)
+{
+  TopologySnapshot snapshot;
+  std::vector<ParsedShape> parsed;
+  rectObj bounds;
+  if (!ParseShapefile(dir, filename, label_field, snapshot, parsed, bounds)) {
+    skip(16, 0, "failed to parse the shapefile");
+    return;
+  }
+
+  ok1(!parsed.empty());
+  ok1(CompareShapes(snapshot, parsed));
+  ok1(CompareQueries(snapshot, parsed, bounds));
+
+  ok1(SaveSnapshot(snapshot));
+
+  {
+    FileMapping mapping(snapshot_path);
+    TopologySnapshot loaded;
+    ok1(!mapping.error() && loaded.load(mapping, PREFIX, label_field));
+    ok1(CompareShapes(loaded, parsed));
+    ok1(CompareQueries(loaded, parsed, bounds));
+  }
+
+  TestCorrupt(label_field);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(1 + 2 * 16);
+
+  ZZIP_DIR *dir = zzip_dir_open(map_path, NULL);
+  ok1(dir != NULL);
+  if (dir == NULL)
+    skip(2 * 16, 0, "failed to open the map");
+  else {
+    /* polygons with labels */
+    TestShapefile(dir, "builtupapop_area.shp", 1);
+
+    /* many lines without labels, which make a deeper R-tree */
+    TestShapefile(dir, "watrcrslhydro_line.shp", -1);
+
+    zzip_dir_close(dir);
+  }
+
+  remove(snapshot_path);
+  remove(corrupt_path);
+
+  return exit_status();
+}
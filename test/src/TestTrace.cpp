@@ -31,6 +31,8 @@
 #include <windef.h>
 #include <assert.h>
 #include <cstdio>
+#include <vector>
+#include <time.h>
 
 class IgcReplayGlue:
   public IgcReplay
@@ -39,9 +41,13 @@ public:
   Trace trace;
   bool error;
 
-  IgcReplayGlue(unsigned ntrace): 
+  /** if true, states are only recorded for BenchmarkTrace() */
+  bool record;
+  std::vector<AIRCRAFT_STATE> states;
+
+  IgcReplayGlue(unsigned ntrace, bool _record=false):
     trace(1000, ntrace), 
-    error(false) {}
+    error(false), record(_record) {}
 
   void SetFilename(const char *name);
 
@@ -84,11 +90,14 @@ IgcReplayGlue::on_advance(const GeoPoint &loc, const fixed speed,
   new_state.Time = t;
   new_state.AltitudeAGL = alt;
 
+  if (record) {
+    if (t>fixed_one)
+      states.push_back(new_state);
+    return;
+  }
+
   if (t>fixed_one) {
     trace.append(new_state);
-
-    trace.optimise_if_old();
-
   }
 // get the trace, just so it's included in timing
   TracePointVector v = trace.get_trace_points(1000);
@@ -133,6 +142,66 @@ TestTrace(const char *filename, unsigned ntrace, bool output=false)
   return true;
 }
 
+/**
+ * Time appending the recorded states to a trace
+ *
+ * @return Processor time in seconds
+ */
+static double
+TimeAppend(Trace &trace, const std::vector<AIRCRAFT_STATE> &states,
+           unsigned repeat)
+{
+  const clock_t start = clock();
+  for (unsigned r = 0; r < repeat; ++r) {
+    trace.clear();
+    for (std::vector<AIRCRAFT_STATE>::const_iterator it = states.begin();
+         it != states.end(); ++it)
+      trace.append(*it);
+  }
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Report the cost of appending to the trace and of thinning it down
+ * to the requested size
+ */
+static bool
+BenchmarkTrace(const char *filename, unsigned max_points)
+{
+  IgcReplayGlue replay(0, true);
+  replay.SetFilename(filename);
+  replay.Start();
+  if (replay.error)
+    return false;
+
+  while (replay.Update()) {}
+
+  if (replay.states.empty())
+    return false;
+
+  const unsigned repeat = 20;
+  const std::vector<AIRCRAFT_STATE> &states = replay.states;
+
+  // unlimited size, so no thinning is ever performed
+  Trace full(Trace::null_time, 0, states.size());
+  const double t_append = TimeAppend(full, states, repeat);
+
+  Trace thinned(Trace::null_time, 0, max_points);
+  const double t_thinned = TimeAppend(thinned, states, repeat);
+
+  const unsigned n_points = full.size();
+  const unsigned n_removed = n_points - thinned.size();
+
+  printf("# benchmark %u samples, %u points, %u thinned to %u\n",
+         (unsigned)states.size(), n_points, n_removed, thinned.size());
+  printf("#   append %.3f us/point\n",
+         1.0e6 * t_append / (repeat * n_points));
+  if (n_removed > 0)
+    printf("#   thinning %.3f us/removed point\n",
+           1.0e6 * (t_thinned - t_append) / (repeat * n_removed));
+
+  return thinned.size() <= max_points;
+}
 
 int main(int argc, char **argv)
 {
@@ -142,6 +211,7 @@ int main(int argc, char **argv)
       n = atoi(argv[1]);
     }
     TestTrace("test/data/09kc3ov3.igc", n);
+    BenchmarkTrace("test/data/09kc3ov3.igc", n);
   } else {
     assert(argc >= 3);
     unsigned n = atoi(argv[2]);
@@ -153,6 +223,8 @@ int main(int argc, char **argv)
       sprintf(buf," trace size %d", nt);
       ok(TestTrace(argv[1], nt),buf, 0);
     }
+
+    BenchmarkTrace(argv[1], 100);
   }
   return 0;
 }
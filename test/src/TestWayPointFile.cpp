@@ -21,8 +21,11 @@
 */
 
 #include "WayPoint/WayPointFile.hpp"
+#include "WayPoint/WayPointFileSeeYou.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
 #include "TestUtil.hpp"
 #include "tstring.hpp"
 
@@ -180,6 +183,60 @@ TestZander(wp_vector org_wp)
   }
 }
 
+/**
+ * A SeeYou parser which counts the lines it parses, to find out
+ * whether the waypoints were loaded from the snapshot.
+ */
+class CountingWayPointFile : public WayPointFileSeeYou {
+public:
+  unsigned num_lines;
+
+  CountingWayPointFile(const TCHAR *file_name, const int _file_num)
+    :WayPointFileSeeYou(file_name, _file_num), num_lines(0) {}
+
+protected:
+  bool parseLine(const TCHAR* line, const unsigned linenum,
+                 Waypoints &way_points, const RasterTerrain *terrain) {
+    ++num_lines;
+    return WayPointFileSeeYou::parseLine(line, linenum, way_points, terrain);
+  }
+};
+
+static void
+TestSnapshot(wp_vector org_wp)
+{
+  FileCache cache(_T("output"));
+  cache.flush(_T("waypoints-0"));
+
+  // the first pass parses the file and creates the snapshot, the
+  // second one loads the snapshot
+  for (unsigned pass = 0; pass < 2; ++pass) {
+    Waypoints way_points;
+    CountingWayPointFile f(_T("test/data/waypoints.cup"), 0);
+    ok1(f.Parse(way_points, NULL, &cache));
+
+    // only the first pass may parse the file
+    ok1((f.num_lines > 0) == (pass == 0));
+
+    way_points.optimise();
+    ok1(way_points.size() == org_wp.size());
+
+    wp_vector::iterator it;
+    for (it = org_wp.begin(); it < org_wp.end(); it++) {
+      const Waypoint *wp = GetWayPoint(*it, way_points);
+      TestSeeYouWayPoint(*it, wp);
+    }
+
+    size_t offset;
+    FileMapping *mapping = cache.map(_T("waypoints-0"),
+                                     _T("test/data/waypoints.cup"), offset);
+    ok1(mapping != NULL);
+    delete mapping;
+  }
+
+  cache.flush(_T("waypoints-0"));
+}
+
 static wp_vector
 CreateOriginalWaypoints()
 {
@@ -279,11 +336,13 @@ int main(int argc, char **argv)
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(3 * 4 + (10 + 9 + 10) * org_wp.size());
+  plan_tests(3 * 4 + (10 + 9 + 10) * org_wp.size() +
+             2 * (4 + 9 * org_wp.size()));
 
   TestWinPilot(org_wp);
   TestSeeYou(org_wp);
   TestZander(org_wp);
+  TestSnapshot(org_wp);
 
   return exit_status();
 }
@@ -28,7 +28,18 @@
 #include "Airspace/AirspaceIntersectionVisitor.hpp"
 #include "Airspace/AirspaceNearestSort.hpp"
 #include "Airspace/AirspaceSoonestSort.hpp"
+#include "Airspace/AirspaceIntersectSort.hpp"
 #include "Navigation/Geometry/GeoVector.hpp"
+#include "Navigation/Flat/FlatRay.hpp"
+#include "Navigation/ConvexHull/PolygonInterior.hpp"
+#include "Navigation/TaskProjection.hpp"
+#include "Task/TaskManager.hpp"
+#include "TaskEventsPrint.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
 
 static void
 airspace_random_properties(AbstractAirspace& as)
@@ -56,14 +67,191 @@ bool test_airspace_extra(Airspaces &airspaces) {
   return true;
 }
 
-void setup_airspaces(Airspaces& airspaces, const unsigned n) {
+/**
+ * Reference implementation of AirspacePolygon::intersects(), which
+ * tests every edge of the border
+ */
+static AirspaceIntersectionVector
+intersects_all_edges(const AirspacePolygon &as, const TaskProjection &tp,
+                     const GeoPoint &start, const GeoVector &vec)
+{
+  const GeoPoint end = vec.end_point(start);
+  const FlatRay ray(tp.project(start), tp.project(end));
+  const SearchPointVector &border = as.get_points();
+
+  AirspaceIntersectSort sorter(start, end, as);
+  for (unsigned i = 0; i + 1 < border.size(); ++i) {
+    const FlatRay r_seg(border[i].get_flatLocation(),
+                        border[i + 1].get_flatLocation());
+    const fixed t = ray.intersects(r_seg);
+    if (t >= fixed_zero)
+      sorter.add(t, tp.unproject(ray.parametric(t)));
+  }
+  return sorter.all();
+}
+
+static GeoPoint
+random_location(const GeoPoint &center, double radius)
+{
+  GeoPoint p = center;
+  p.Longitude += Angle::degrees(fixed(radius * (rand() % 2001 - 1000) / 1000.0));
+  p.Latitude += Angle::degrees(fixed(radius * (rand() % 2001 - 1000) / 1000.0));
+  return p;
+}
+
+bool test_airspace_polygon(const unsigned n) {
+  // a star shaped, non-convex polygon about 100km across
+  GeoPoint c;
+  c.Longitude = Angle::degrees(fixed(7.5));
+  c.Latitude = Angle::degrees(fixed(51.2));
+
+  std::vector<GeoPoint> pts;
+  for (unsigned i = 0; i < n; ++i) {
+    const double theta = 2 * M_PI * i / n;
+    const double r = 0.5 * (1 + 0.3 * sin(7 * theta) + 0.05 * sin(97 * theta));
+    GeoPoint p = c;
+    p.Longitude += Angle::degrees(fixed(r * cos(theta)));
+    p.Latitude += Angle::degrees(fixed(r * sin(theta)));
+    pts.push_back(p);
+  }
+
+  AirspacePolygon *as = new AirspacePolygon(pts);
+  airspace_random_properties(*as);
+
+  Airspaces airspaces;
+  airspaces.insert(as);
+  airspaces.optimise();
+
+  // the projection chosen by Airspaces for a single airspace
+  TaskProjection tp;
+  tp.reset(as->get_center());
+  tp.update_fast();
+
+  const unsigned num_points = 20000, num_rays = 2000;
+  std::vector<GeoPoint> locations;
+  for (unsigned i = 0; i < num_points; ++i)
+    locations.push_back(random_location(c, 0.8));
+
+  unsigned n_inside = 0, n_wrong = 0;
+  clock_t start = clock();
+  for (unsigned i = 0; i < num_points; ++i)
+    if (as->inside(locations[i]))
+      ++n_inside;
+  const double t_indexed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (unsigned i = 0; i < num_points; ++i)
+    if (PolygonInterior(locations[i], as->get_points()) != as->inside(locations[i]))
+      ++n_wrong;
+  const double t_all = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  std::vector<GeoVector> vectors;
+  for (unsigned i = 0; i < num_rays; ++i)
+    vectors.push_back(GeoVector(locations[i], random_location(locations[i], 0.05)));
+
+  unsigned n_intersections = 0;
+  start = clock();
+  for (unsigned i = 0; i < num_rays; ++i)
+    n_intersections += as->intersects(locations[i], vectors[i]).size();
+  const double t_intersects = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (unsigned i = 0; i < num_rays; ++i)
+    if (intersects_all_edges(*as, tp, locations[i], vectors[i]) !=
+        as->intersects(locations[i], vectors[i]))
+      ++n_wrong;
+  const double t_intersects_all = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("# polygon %u vertices, %u/%u points inside, %u intersections\n",
+         n, n_inside, num_points, n_intersections);
+  printf("#   inside %.3f us indexed, %.3f us with all edges\n",
+         1.0e6 * t_indexed / num_points,
+         1.0e6 * (t_all - t_indexed) / num_points);
+  printf("#   intersects %.3f us indexed, %.3f us with all edges\n",
+         1.0e6 * t_intersects / num_rays,
+         1.0e6 * (t_intersects_all - t_intersects) / num_rays);
+
+  return n_wrong == 0 && n_inside > 0 && n_inside < num_points;
+}
+
+typedef std::vector< std::pair<const AbstractAirspace *, int> > WarningSummary;
+
+static WarningSummary
+summarise_warnings(const AirspaceWarningManager &warnings)
+{
+  WarningSummary summary;
+  for (unsigned i = 0; i < warnings.size(); ++i) {
+    const AirspaceWarning *warning = warnings.get_warning(i);
+    summary.push_back(std::make_pair(&warning->get_airspace(),
+                                     (int)warning->get_warning_state()));
+  }
+  std::sort(summary.begin(), summary.end());
+  return summary;
+}
+
+bool test_airspace_warnings(Airspaces &airspaces) {
+  TaskEventsPrint events(false);
+  Waypoints waypoints;
+  TaskManager task_manager(events, waypoints);
+
+  // a wandering flight through the test airspaces, one fix per second
+  std::vector<AIRCRAFT_STATE> states;
+  AIRCRAFT_STATE state;
+  state.Location.Longitude = Angle::degrees(fixed(-0.05));
+  state.Location.Latitude = Angle::degrees(fixed(0.5));
+  state.Speed = fixed(40);
+  state.TrackBearing = Angle::degrees(fixed(80));
+  for (unsigned i = 0; i < 3600; ++i) {
+    state.Time = fixed(i);
+    state.NavAltitude = state.AirspaceAltitude = fixed(500 + i % 2000);
+    state.TrackBearing += Angle::degrees(fixed(sin(i / 200.0) * 2));
+    states.push_back(state);
+    state.Location = GeoVector(state.Speed, state.TrackBearing)
+      .end_point(state.Location);
+  }
+
+  AirspaceWarningManager coherent(airspaces, states[0], task_manager);
+  AirspaceWarningManager full(airspaces, states[0], task_manager);
+  full.set_coherent(false);
+
+  unsigned n_wrong = 0, n_warnings = 0;
+  double t_coherent = 0, t_full = 0;
+  for (unsigned i = 0; i < states.size(); ++i) {
+    const bool circling = (i / 300) % 2;
+
+    clock_t start = clock();
+    const bool changed_coherent = coherent.update(states[i], circling);
+    t_coherent += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    const bool changed_full = full.update(states[i], circling);
+    t_full += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    n_warnings += full.size();
+    if (changed_coherent != changed_full ||
+        summarise_warnings(coherent) != summarise_warnings(full))
+      ++n_wrong;
+  }
+
+  printf("# warnings %u airspaces, %u fixes, %u warnings\n",
+         airspaces.size(), (unsigned)states.size(), n_warnings);
+  printf("#   update %.3f us coherent, %.3f us full\n",
+         1.0e6 * t_coherent / states.size(),
+         1.0e6 * t_full / states.size());
+
+  return n_wrong == 0 && n_warnings > 0;
+}
+
+void setup_airspaces(Airspaces& airspaces, const unsigned n,
+                     const double spread) {
+  const double scale = spread / 1.2;
   std::ofstream fin("results/res-bb-in.txt");
   for (unsigned i=0; i<n; i++) {
     AbstractAirspace* as;
     if (rand()%4!=0) {
       GeoPoint c;
-      c.Longitude = Angle::degrees(fixed((rand()%1200-600)/1000.0+0.5));
-      c.Latitude = Angle::degrees(fixed((rand()%1200-600)/1000.0+0.5));
+      c.Longitude = Angle::degrees(fixed((rand()%1200-600)/1000.0*scale+0.5));
+      c.Latitude = Angle::degrees(fixed((rand()%1200-600)/1000.0*scale+0.5));
       fixed radius(10000.0*(0.2+(rand()%12)/12.0));
       as = new AirspaceCircle(c,radius);
     } else {
@@ -72,8 +260,8 @@ void setup_airspaces(Airspaces& airspaces, const unsigned n) {
       // random points
       const unsigned num = rand()%10+5;
       GeoPoint c;
-      c.Longitude = Angle::degrees(fixed((rand()%1200-600)/1000.0+0.5));
-      c.Latitude = Angle::degrees(fixed((rand()%1200-600)/1000.0+0.5));
+      c.Longitude = Angle::degrees(fixed((rand()%1200-600)/1000.0*scale+0.5));
+      c.Latitude = Angle::degrees(fixed((rand()%1200-600)/1000.0*scale+0.5));
       
       std::vector<GeoPoint> pts;
       for (unsigned j=0; j<num; j++) {
@@ -31,7 +31,14 @@
 
 extern AirspaceWarningManager *airspace_warnings;
 
-void setup_airspaces(Airspaces& airspaces, const unsigned n=150);
+/**
+ * Fills the store with random circles and polygons
+ *
+ * @param n Number of airspaces
+ * @param spread Width and height (degrees) of the area they cover
+ */
+void setup_airspaces(Airspaces& airspaces, const unsigned n=150,
+                     const double spread=1.2);
 
 void scan_airspaces(const AIRCRAFT_STATE state, 
                     const Airspaces& airspaces,
@@ -41,6 +48,21 @@ void scan_airspaces(const AIRCRAFT_STATE state,
 
 bool test_airspace_extra(Airspaces &airspaces);
 
+/**
+ * Checks the indexed inside() and intersects() of a large polygon
+ * against a scan of all edges, and reports the time per query.
+ *
+ * @param n Number of vertices
+ */
+bool test_airspace_polygon(const unsigned n);
+
+/**
+ * Flies through the airspaces and checks that the warnings of the
+ * coherent AirspaceWarningManager match those of a full query on
+ * every fix, and reports the time per update.
+ */
+bool test_airspace_warnings(Airspaces &airspaces);
+
 
 void print_warnings();
 
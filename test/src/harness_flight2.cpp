@@ -441,5 +441,9 @@ bool test_olc(int n_wind, Contests olc_type)
 
   waypoints.clear(); // clear waypoints so abort wont do anything
 
-  return run_flight(task_manager, true, autopilot_parms, n_wind);
+  bool fine = run_flight(task_manager, true, autopilot_parms, n_wind);
+  if (!verbose) {
+    olc_counts();
+  }
+  return fine;
 }
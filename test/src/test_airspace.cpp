@@ -33,7 +33,7 @@ int main(int argc, char** argv)
     return 0;
   }
 
-  plan_tests(3);
+  plan_tests(5);
 
   ok(test_airspace(20),"airspace 20",0);
   ok(test_airspace(100),"airspace 100",0);
@@ -41,6 +41,11 @@ int main(int argc, char** argv)
   Airspaces airspaces;
   setup_airspaces(airspaces, 20);
   ok(test_airspace_extra(airspaces),"airspace extra",0);
+  ok(test_airspace_polygon(5000),"airspace polygon 5000",0);
+
+  Airspaces many_airspaces;
+  setup_airspaces(many_airspaces, 20000, 24);
+  ok(test_airspace_warnings(many_airspaces),"airspace warnings",0);
 
   return exit_status();
 }
@@ -94,6 +94,11 @@ void distance_counts() {
 #endif
 }
 
+void olc_counts() {
+  printf("# count_olc_solve %d\n", (int)ContestDijkstra::count_olc_solve);
+  printf("# count_olc_trace %d\n", (int)ContestDijkstra::count_olc_trace);
+}
+
 void print_queries(unsigned n, std::ostream &fout) {
 #ifdef INSTRUMENT_TASK
   if (n_queries>0) {
@@ -36,6 +36,7 @@ extern "C" {
 
 extern int n_samples;
 void distance_counts();
+void olc_counts();
 void print_queries(unsigned n, std::ostream &fout);
 char wait_prompt(const double time);
 extern int interactive;
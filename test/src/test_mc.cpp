@@ -25,8 +25,12 @@
 #include "GlideSolvers/GlidePolar.hpp"
 #include "GlideSolvers/GlideState.hpp"
 #include "GlideSolvers/GlideResult.hpp"
+#include "GlideSolvers/MacCready.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "Util/ZeroFinder.hpp"
+#include "Util/Tolerances.hpp"
 #include <stdio.h>
+#include <time.h>
 #include <fstream>
 #include <string>
 #include <math.h>
@@ -253,13 +257,94 @@ test_cb()
   return true;
 }
 
+/**
+ * Search for the optimum glide speed without initial guess, as a
+ * reference for the solutions of GlidePolar::solve()
+ */
+class ReferenceVopt: public ZeroFinder
+{
+  const GlideState &task;
+  const MacCready mac;
+  const fixed inv_mc;
+
+public:
+  GlideResult res;
+
+  ReferenceVopt(const GlidePolar &polar, const GlideState &_task)
+    :ZeroFinder(polar.get_Vmin(), polar.get_Vmax(),
+                fixed(TOLERANCE_MC_OPT_GLIDE)),
+     task(_task),
+     mac(polar, polar.get_cruise_efficiency()),
+     inv_mc(polar.get_inv_mc()) {}
+
+  fixed f(const fixed V) {
+    res = mac.solve_glide(task, V);
+    return res.calc_vspeed(inv_mc) * fixed_360;
+  }
+
+  GlideResult solve(const GlidePolar &polar) {
+    // starting at the edge of the range enforces the search
+    f(find_min(polar.get_Vmin()));
+    return res;
+  }
+};
+
+static bool
+test_vopt_timing()
+{
+  GlidePolar polar(fixed(1.5));
+
+  static const unsigned n = 360;
+  GlideResult results[n], references[n];
+
+  AIRCRAFT_STATE ac;
+  ac.wind.norm = fixed(10.0);
+  ac.wind.bearing = Angle::degrees(fixed(30));
+  ac.NavAltitude = fixed(2000);
+
+  clock_t start = clock();
+  for (unsigned i = 0; i < n; ++i) {
+    GlideState gs(GeoVector(fixed(40000), Angle::degrees(fixed(i))),
+                  fixed_zero, ac.NavAltitude, ac.wind);
+    results[i] = polar.solve(gs);
+  }
+  const double t_solve = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (unsigned i = 0; i < n; ++i) {
+    GlideState gs(GeoVector(fixed(40000), Angle::degrees(fixed(i))),
+                  fixed_zero, ac.NavAltitude, ac.wind);
+    ReferenceVopt reference(polar, gs);
+    references[i] = reference.solve(polar);
+  }
+  const double t_reference = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("# vopt %.3f us solve, %.3f us reference search\n",
+         t_solve * 1e6 / n, t_reference * 1e6 / n);
+
+  // the solutions must be at least as good as the reference
+  for (unsigned i = 0; i < n; ++i) {
+    if (fabs(results[i].VOpt - references[i].VOpt) > fixed_one)
+      return false;
+
+    const fixed t = results[i].TimeElapsed + results[i].TimeVirtual;
+    const fixed t_ref = references[i].TimeElapsed +
+      references[i].TimeVirtual;
+    if (t > t_ref * fixed(1.001))
+      return false;
+  }
+
+  return true;
+}
+
 int main() {
 
-  plan_tests(3);
+  plan_tests(4);
 
   ok(test_mc(),"mc output",0);
   ok(test_stf(),"mc stf",0);
   ok(test_cb(),"cruise bearing",0);
+  ok(test_vopt_timing(),"vopt timing",0);
 
   return exit_status();
 
@@ -213,6 +213,8 @@ test_replay(const Contests olc_type,
 
   if (verbose) {
     distance_counts();
+  } else {
+    olc_counts();
   }
   return compare_scores(official_score, 
                         task_manager.get_common_stats().olc);
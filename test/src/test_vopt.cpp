@@ -22,6 +22,80 @@
 
 #include "Math/FastMath.h"
 #include "harness_flight.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/GlideResult.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "Util/ZeroFinder.hpp"
+#include "Util/Tolerances.hpp"
+
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * Search for the dolphin speed to fly without initial guess, as a
+ * reference for GlidePolar::speed_to_fly()
+ */
+class ReferenceSpeedToFly: public ZeroFinder
+{
+  const GlidePolar &polar;
+  const fixed net_sink_rate;
+
+public:
+  ReferenceSpeedToFly(const GlidePolar &_polar, const fixed _net_sink_rate)
+    :ZeroFinder(max(fixed_one, _polar.get_Vmin()), _polar.get_Vmax(),
+                fixed(TOLERANCE_POLAR_DOLPHIN)),
+     polar(_polar), net_sink_rate(_net_sink_rate) {}
+
+  fixed f(const fixed V) {
+    return (polar.MSinkRate(V) + net_sink_rate) / V;
+  }
+
+  fixed solve() {
+    // starting at the edge of the range enforces the search
+    return find_min(polar.get_Vmax());
+  }
+};
+
+static bool
+test_stf_timing()
+{
+  GlidePolar polar(fixed_one);
+
+  static const unsigned n = 200;
+  fixed results[n], references[n];
+
+  AIRCRAFT_STATE state;
+  state.Gload = fixed_one;
+  const GlideResult solution;
+
+  clock_t start = clock();
+  for (unsigned i = 0; i < n; ++i) {
+    state.NettoVario = fixed(-3) + fixed(i) / 40;
+    results[i] = polar.speed_to_fly(state, solution, false);
+  }
+  const double t_stf = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (unsigned i = 0; i < n; ++i) {
+    const fixed netto = fixed(-3) + fixed(i) / 40;
+    if (netto > polar.get_mc() + polar.get_Smin()) {
+      references[i] = polar.get_Vmin();
+    } else {
+      ReferenceSpeedToFly reference(polar, -netto);
+      references[i] = max(polar.get_Vmin(), reference.solve());
+    }
+  }
+  const double t_reference = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("# stf %.3f us speed_to_fly, %.3f us reference search\n",
+         t_stf * 1e6 / n, t_reference * 1e6 / n);
+
+  for (unsigned i = 0; i < n; ++i)
+    if (fabs(results[i] - references[i]) > fixed(0.1))
+      return false;
+
+  return true;
+}
 
 int main(int argc, char** argv) 
 {
@@ -36,7 +110,9 @@ int main(int argc, char** argv)
   }
 
   unsigned i = rand()%NUM_WIND;
-  plan_tests(2);
+  plan_tests(3);
+
+  ok(test_stf_timing(), "stf timing", 0);
 
   // tests whether flying at VOpt for OR task is optimal
   test_speed_factor(3,i);